@@ -70,7 +70,7 @@ namespace Falcor
 
     bool ConstantBuffer::uploadToGPU(size_t offset, size_t size)
     {
-        if (mDirty) mpCbv = nullptr;
+        if (isDirty()) mpCbv = nullptr;
         return VariablesBuffer::uploadToGPU(offset, size);
     }
 
@@ -65,6 +65,61 @@ namespace Falcor
         gEventCounter.numFlushes++;
     }
     
+    CopyContext::ReadTextureTask::SharedPtr CopyContext::asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
+    {
+        return ReadTextureTask::create(this, pTexture, subresourceIndex);
+    }
+
+    std::vector<uint8> CopyContext::readTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
+    {
+        return asyncReadTextureSubresource(pTexture, subresourceIndex)->getData();
+    }
+
+    bool CopyContext::ReadTextureTask::isComplete() const
+    {
+        return mpFence->getGpuValue() >= mFenceValue;
+    }
+
+    void CopyContext::ReadTextureTask::wait()
+    {
+        mpFence->syncCpu(mFenceValue);
+    }
+
+    const uint8_t* CopyContext::ReadTextureTask::map()
+    {
+        wait();
+        return reinterpret_cast<const uint8_t*>(mpBuffer->map(Buffer::MapType::Read));
+    }
+
+    void CopyContext::ReadTextureTask::unmap()
+    {
+        mpBuffer->unmap();
+    }
+
+    std::vector<uint8> CopyContext::ReadTextureTask::getData()
+    {
+        std::vector<uint8> result((size_t)mRowSize * mRowCount * mDepth);
+        const uint8_t* pData = map();
+        if (mRowPitch == mRowSize)
+        {
+            std::memcpy(result.data(), pData, result.size());
+        }
+        else
+        {
+            for (uint32_t z = 0; z < mDepth; z++)
+            {
+                const uint8_t* pSrcZ = pData + (size_t)z * mRowPitch * mRowCount;
+                uint8_t* pDstZ = result.data() + (size_t)z * mRowSize * mRowCount;
+                for (uint32_t y = 0; y < mRowCount; y++)
+                {
+                    std::memcpy(pDstZ + (size_t)y * mRowSize, pSrcZ + (size_t)y * mRowPitch, mRowSize);
+                }
+            }
+        }
+        unmap();
+        return result;
+    }
+
     void CopyContext::updateTexture(const Texture* pTexture, const void* pData)
     {
         mCommandsPending = true;
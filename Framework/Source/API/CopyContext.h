@@ -43,6 +43,69 @@ namespace Falcor
         using SharedConstPtr = std::shared_ptr<const CopyContext>;
         virtual ~CopyContext();
 
+        /** Reads a texture subresource back to the CPU without stalling the pipeline.
+            The copy is submitted when the task is created. The data can be accessed once the GPU has finished executing it
+        */
+        class ReadTextureTask
+        {
+        public:
+            using SharedPtr = std::shared_ptr<ReadTextureTask>;
+
+            /** Record the copy and submit the command list
+                \param[in] pCtx The context to record the copy into
+                \param[in] pTexture The texture to read from
+                \param[in] subresourceIndex The subresource to read
+                \param[in] pStaging Optional readback buffer to reuse. If it is null or too small, a new buffer will be created
+            */
+            static SharedPtr create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex, const std::shared_ptr<Buffer>& pStaging = nullptr);
+
+            /** Check if the GPU has finished the copy. Never blocks
+            */
+            bool isComplete() const;
+
+            /** Block until the GPU has finished the copy
+            */
+            void wait();
+
+            /** Wait for the copy and return the data with the row padding removed
+            */
+            std::vector<uint8> getData();
+
+            /** Wait for the copy and map the readback buffer. Rows are getRowPitch() bytes apart. Call unmap() before reusing the buffer
+            */
+            const uint8_t* map();
+            void unmap();
+
+            /** Get the size in bytes of a row of texels
+            */
+            uint32_t getRowSize() const { return mRowSize; }
+
+            /** Get the distance in bytes between rows in the readback buffer
+            */
+            uint32_t getRowPitch() const { return mRowPitch; }
+
+            /** Get the number of rows in a depth slice
+            */
+            uint32_t getRowCount() const { return mRowCount; }
+
+            /** Get the number of depth slices
+            */
+            uint32_t getDepth() const { return mDepth; }
+
+            /** Get the readback buffer. Can be passed into create() to recycle it once the data was consumed
+            */
+            const std::shared_ptr<Buffer>& getBuffer() const { return mpBuffer; }
+        private:
+            ReadTextureTask() = default;
+            GpuFence::SharedPtr mpFence;
+            uint64_t mFenceValue = 0;
+            std::shared_ptr<Buffer> mpBuffer;
+            uint32_t mRowSize = 0;
+            uint32_t mRowPitch = 0;
+            uint32_t mRowCount = 0;
+            uint32_t mDepth = 0;
+        };
+
         static SharedPtr create(CommandQueueHandle queue);
         void updateBuffer(const Buffer* pBuffer, const void* pData, size_t offset = 0, size_t numBytes = 0);
         void updateTexture(const Texture* pTexture, const void* pData);
@@ -50,6 +113,10 @@ namespace Falcor
         void updateTextureSubresources(const Texture* pTexture, uint32_t firstSubresource, uint32_t subresourceCount, const void* pData);
         std::vector<uint8> readTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex);
 
+        /** Read a texture subresource without waiting for the GPU. See ReadTextureTask
+        */
+        ReadTextureTask::SharedPtr asyncReadTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex);
+
         /** Reset
         */
         virtual void reset();
@@ -32,5 +32,10 @@ namespace Falcor
     struct LowLevelContextApiData
     {
         FencedPool<CommandAllocatorHandle>::SharedPtr pAllocatorPool;
+
+        // The root signatures currently set on the command list. Used to skip redundant root signature changes. Reset when the command list is reset
+        // Holding a reference guarantees that the handle can't be recycled for a different root signature while it's tracked here
+        RootSignatureHandle pGraphicsRootSig;
+        RootSignatureHandle pComputeRootSig;
     };
 }
\ No newline at end of file
@@ -44,7 +44,7 @@ namespace Falcor
         }
         else
         {
-            mpLowLevelData->getCommandList()->SetComputeRootSignature(RootSignature::getEmpty()->getApiHandle());
+            RootSignature::getEmpty()->bindForCompute(this);
         }
         mBindComputeRootSig = false;
         mpLowLevelData->getCommandList()->SetPipelineState(mpComputeState->getCSO(mpComputeVars.get())->getApiHandle());
@@ -98,8 +98,54 @@ namespace Falcor
     GraphicsStateObject::ApiHandle getNvApiGraphicsPsoHandle(const std::vector<NvApiPsoExDesc>& psoDesc, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc) { should_not_get_here(); return nullptr; }
     bool getIsNvApiGraphicsPsoRequired(const GraphicsStateObject::Desc& desc) { return false; }
 #endif
-    
-    bool GraphicsStateObject::apiInit()
+
+    static void fnv1a(uint64_t& hash, const void* pData, size_t size)
+    {
+        const uint8_t* pBytes = (const uint8_t*)pData;
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= pBytes[i];
+            hash *= 1099511628211ull;
+        }
+    }
+
+    /** Generate the name used to store the PSO in the pipeline library. The name must be stable across runs, so it's generated from the API description and not from object pointers.
+        The root signature is not part of the name. If it doesn't match the stored PSO, LoadGraphicsPipeline() will fail and the PSO will be recreated.
+    */
+    static std::wstring getPipelineLibraryName(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        const D3D12_SHADER_BYTECODE* shaders[] = { &desc.VS, &desc.PS, &desc.GS, &desc.HS, &desc.DS };
+        for (const auto& pShader : shaders)
+        {
+            fnv1a(hash, &pShader->BytecodeLength, sizeof(pShader->BytecodeLength));
+            if(pShader->pShaderBytecode) fnv1a(hash, pShader->pShaderBytecode, pShader->BytecodeLength);
+        }
+
+        for (uint32_t i = 0; i < desc.InputLayout.NumElements; i++)
+        {
+            D3D12_INPUT_ELEMENT_DESC element = desc.InputLayout.pInputElementDescs[i];
+            fnv1a(hash, element.SemanticName, strlen(element.SemanticName));
+            element.SemanticName = nullptr;
+            fnv1a(hash, &element, sizeof(element));
+        }
+
+        fnv1a(hash, &desc.BlendState, sizeof(desc.BlendState));
+        fnv1a(hash, &desc.RasterizerState, sizeof(desc.RasterizerState));
+        fnv1a(hash, &desc.DepthStencilState, sizeof(desc.DepthStencilState));
+        fnv1a(hash, &desc.SampleMask, sizeof(desc.SampleMask));
+        fnv1a(hash, &desc.PrimitiveTopologyType, sizeof(desc.PrimitiveTopologyType));
+        fnv1a(hash, &desc.NumRenderTargets, sizeof(desc.NumRenderTargets));
+        fnv1a(hash, desc.RTVFormats, sizeof(desc.RTVFormats));
+        fnv1a(hash, &desc.DSVFormat, sizeof(desc.DSVFormat));
+        fnv1a(hash, &desc.SampleDesc, sizeof(desc.SampleDesc));
+
+        wchar_t name[17];
+        swprintf_s(name, arraysize(name), L"%016llx", hash);
+        return name;
+    }
+
+    bool GraphicsStateObject::apiInit(const PipelineCacheHandle& pCache)
     {
         D3D12_GRAPHICS_PIPELINE_STATE_DESC desc = {};
         assert(mDesc.mpProgram);
@@ -147,6 +193,16 @@ namespace Falcor
             getNvApiGraphicsPsoDesc(mDesc, nvApiDesc);
             mApiHandle = getNvApiGraphicsPsoHandle(nvApiDesc, desc);
         }
+        else if (pCache)
+        {
+            // A failure to load means the PSO wasn't stored yet, or the stored PSO doesn't match the description. A failure to store means there's already a PSO with the same name. Both are expected
+            std::wstring name = getPipelineLibraryName(desc);
+            if (FAILED(pCache->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(&mApiHandle))))
+            {
+                d3d_call(gpDevice->getApiHandle()->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&mApiHandle)));
+                pCache->StorePipeline(name.c_str(), mApiHandle);
+            }
+        }
         else
         {
             d3d_call(gpDevice->getApiHandle()->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&mApiHandle)));
@@ -0,0 +1,80 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/GsoCache.h"
+#include "API/Device.h"
+
+namespace Falcor
+{
+    bool GsoCache::apiCreatePipelineCache()
+    {
+        ID3D12Device1Ptr pDevice1;
+        if (FAILED(gpDevice->getApiHandle()->QueryInterface(IID_PPV_ARGS(&pDevice1))))
+        {
+            logWarning("GsoCache::enablePersistence() - the device doesn't support pipeline libraries. Persistence is disabled");
+            return false;
+        }
+
+        ID3D12PipelineLibraryPtr pLibrary;
+        if (mPersistentData.size())
+        {
+            HRESULT hr = pDevice1->CreatePipelineLibrary(mPersistentData.data(), mPersistentData.size(), IID_PPV_ARGS(&pLibrary));
+            if (FAILED(hr))
+            {
+                // The file was created by a different driver or adapter, or is corrupted. Start with an empty library, it will overwrite the file when saved
+                logInfo("GsoCache::enablePersistence() - the pipeline library can't be used with the current device. Creating a new library");
+                mPersistentData.clear();
+                pLibrary = nullptr;
+            }
+        }
+
+        if (pLibrary == nullptr)
+        {
+            if (FAILED(pDevice1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&pLibrary))))
+            {
+                logWarning("GsoCache::enablePersistence() - failed to create a pipeline library. Persistence is disabled");
+                return false;
+            }
+        }
+
+        mpPipelineCache = pLibrary;
+        return true;
+    }
+
+    bool GsoCache::apiSerializePipelineCache(std::vector<uint8_t>& data)
+    {
+        if (mpPipelineCache == nullptr) return false;
+        data.resize(mpPipelineCache->GetSerializedSize());
+        if (FAILED(mpPipelineCache->Serialize(data.data(), data.size())))
+        {
+            logError("GsoCache::savePersistentData() - failed to serialize the pipeline library");
+            return false;
+        }
+        return true;
+    }
+}
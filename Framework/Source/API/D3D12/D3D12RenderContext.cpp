@@ -227,7 +227,7 @@ namespace Falcor
         }
         else
         {
-            mpLowLevelData->getCommandList()->SetGraphicsRootSignature(RootSignature::getEmpty()->getApiHandle());
+            RootSignature::getEmpty()->bindForGraphics(this);
         }
 
 #if _ENABLE_NVAPI
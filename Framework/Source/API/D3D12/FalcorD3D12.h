@@ -123,6 +123,7 @@ namespace Falcor
 
     // Device
     MAKE_SMART_COM_PTR(ID3D12Device);
+    MAKE_SMART_COM_PTR(ID3D12Device1);
     MAKE_SMART_COM_PTR(ID3D12Debug);
     MAKE_SMART_COM_PTR(ID3D12CommandQueue);
     MAKE_SMART_COM_PTR(ID3D12CommandAllocator);
@@ -131,6 +132,7 @@ namespace Falcor
     MAKE_SMART_COM_PTR(ID3D12Resource);
     MAKE_SMART_COM_PTR(ID3D12Fence);
     MAKE_SMART_COM_PTR(ID3D12PipelineState);
+    MAKE_SMART_COM_PTR(ID3D12PipelineLibrary);
     MAKE_SMART_COM_PTR(ID3D12ShaderReflection);
     MAKE_SMART_COM_PTR(ID3D12RootSignature);
     MAKE_SMART_COM_PTR(ID3D12QueryHeap);
@@ -165,6 +167,7 @@ namespace Falcor
 
     using GraphicsStateHandle = ID3D12PipelineStatePtr;
     using ComputeStateHandle = ID3D12PipelineStatePtr;
+    using PipelineCacheHandle = ID3D12PipelineLibraryPtr;
     using ShaderHandle = D3D12_SHADER_BYTECODE;
     using RootSignatureHandle = ID3D12RootSignaturePtr;
     using DescriptorHeapHandle = ID3D12DescriptorHeapPtr;
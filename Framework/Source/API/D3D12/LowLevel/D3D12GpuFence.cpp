@@ -82,6 +82,17 @@ namespace Falcor
         }
     }
 
+    void GpuFence::syncCpu(uint64_t value)
+    {
+        assert(value < mCpuValue);
+        uint64_t gpuVal = getGpuValue();
+        if (gpuVal < value)
+        {
+            d3d_call(mApiHandle->SetEventOnCompletion(value, mpApiData->eventHandle));
+            WaitForSingleObject(mpApiData->eventHandle, INFINITE);
+        }
+    }
+
     uint64_t GpuFence::getGpuValue() const
     {
         return mApiHandle->GetCompletedValue();
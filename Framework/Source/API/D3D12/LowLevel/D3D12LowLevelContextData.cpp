@@ -91,6 +91,8 @@ namespace Falcor
         d3d_call(mpList->Close());
         d3d_call(mpAllocator->Reset());
         d3d_call(mpList->Reset(mpAllocator, nullptr));
+        mpApiData->pGraphicsRootSig = nullptr;
+        mpApiData->pComputeRootSig = nullptr;
     }
 
     void LowLevelContextData::flush()
@@ -100,5 +102,7 @@ namespace Falcor
         mpQueue->ExecuteCommandLists(1, &pList);
         mpFence->gpuSignal(mpQueue);
         mpList->Reset(mpAllocator, nullptr);
+        mpApiData->pGraphicsRootSig = nullptr;
+        mpApiData->pComputeRootSig = nullptr;
     }
 }
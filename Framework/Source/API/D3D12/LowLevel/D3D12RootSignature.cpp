@@ -29,6 +29,7 @@
 #include "API/LowLevel/RootSignature.h"
 #include "API/D3D12/D3D12State.h"
 #include "API/Device.h"
+#include "API/D3D12/D3D12ApiData.h"
 
 namespace Falcor
 {
@@ -170,10 +171,17 @@ namespace Falcor
     }
 
     template<bool forGraphics>
-    static void bindRootSigCommon(CopyContext* pCtx, RootSignature::ApiHandle rootSig)
+    static void bindRootSigCommon(CopyContext* pCtx, const RootSignature::ApiHandle& rootSig)
     {
+        // Root signatures are interned, so identical layouts share the same object. Setting the root signature which is already set is a no-op, and skipping it keeps the root arguments bound
+        LowLevelContextApiData* pApiData = pCtx->getLowLevelData()->getApiData();
+        RootSignature::ApiHandle& pBound = forGraphics ? pApiData->pGraphicsRootSig : pApiData->pComputeRootSig;
+        if (pBound == rootSig) return;
+        pBound = rootSig;
+
         if (forGraphics)
         {
+            gEventCounter.numRootSignatureChanges++;
             pCtx->getLowLevelData()->getCommandList()->SetGraphicsRootSignature(rootSig);
         }
         else
@@ -189,7 +197,7 @@ namespace Falcor
 
     void RootSignature::bindForGraphics(CopyContext* pCtx)
     {
-        gEventCounter.numRootSignatureChanges++;
+        gEventCounter.numRootSignatureBinds++;
         bindRootSigCommon<true>(pCtx, mApiHandle);
     }
 }
@@ -34,6 +34,7 @@ namespace Falcor
     DescriptorSet::SharedPtr DescriptorSet::create(const DescriptorPool::SharedPtr& pPool, const Layout& layout)
     {
         SharedPtr pThis = SharedPtr(new DescriptorSet(pPool, layout));
+        std::lock_guard<std::recursive_mutex> lock(pPool->mMutex);
         return pThis->apiInit() ? pThis : nullptr;
     }
 
@@ -55,4 +56,17 @@ namespace Falcor
         return *this;
     }
 
+    bool DescriptorSet::Layout::operator==(const Layout& other) const
+    {
+        if (mVisibility != other.mVisibility) return false;
+        if (mRanges.size() != other.mRanges.size()) return false;
+        for (size_t i = 0; i < mRanges.size(); i++)
+        {
+            const Range& a = mRanges[i];
+            const Range& b = other.mRanges[i];
+            if (a.type != b.type || a.baseRegIndex != b.baseRegIndex || a.descCount != b.descCount || a.regSpace != b.regSpace) return false;
+        }
+        return true;
+    }
+
 }
\ No newline at end of file
@@ -80,6 +80,11 @@ namespace Falcor
             size_t getRangeCount() const { return mRanges.size(); }
             const Range& getRange(size_t index) const { return mRanges[index]; }
             ShaderVisibility getVisibility() const { return mVisibility; }
+
+            /** Check if two layouts are identical. Compares the visibility and all the range fields, including the register space
+            */
+            bool operator==(const Layout& other) const;
+            bool operator!=(const Layout& other) const { return !(*this == other); }
         private:
             std::vector<Range> mRanges;
             ShaderVisibility mVisibility;
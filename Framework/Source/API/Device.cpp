@@ -73,6 +73,8 @@ namespace Falcor
         mpResourceAllocator = ResourceAllocator::create(1024 * 1024 * 2, mpRenderContext->getLowLevelData()->getFence());
 
         mpFrameFence = GpuFence::create();
+        mpGsoCache = GsoCache::create();
+        mpDescriptorSetCache = DescriptorSetCache::create(mpFrameFence);
 
         // Update the FBOs
         if (updateDefaultFBO(mpWindow->getClientAreaWidth(), mpWindow->getClientAreaHeight(), desc.colorFormat, desc.depthFormat) == false)
@@ -142,6 +144,7 @@ namespace Falcor
             // Some static objects get here when the application exits
             if(this)
             {
+                std::lock_guard<std::mutex> lock(mDeferredReleasesMutex);
                 mDeferredReleases.push({ mpFrameFence->getCpuValue(), pResource });
             }
         }
@@ -151,10 +154,13 @@ namespace Falcor
     {
         mpResourceAllocator->executeDeferredReleases();
         uint64_t gpuVal = mpFrameFence->getGpuValue();
+        std::unique_lock<std::mutex> lock(mDeferredReleasesMutex);
         while (mDeferredReleases.size() && mDeferredReleases.front().frameID <= gpuVal)
         {
             mDeferredReleases.pop();
         }
+        lock.unlock();
+        mpDescriptorSetCache->retire();
         mpCpuDescPool->executeDeferredReleases();
         mpGpuDescPool->executeDeferredReleases();
     }
@@ -175,6 +181,9 @@ namespace Falcor
 
         for (uint32_t i = 0; i < arraysize(mCmdQueues); i++) mCmdQueues[i].clear();
         for (uint32_t i = 0; i < mSwapChainBufferCount; i++) mpSwapChainFbos[i].reset();
+        // The GSOs release their API handles into the deferred-release queue, so the cache must be destroyed before the queue is cleared
+        mpGsoCache.reset();
+        mpDescriptorSetCache.reset();
         mDeferredReleases = decltype(mDeferredReleases)();
 
         mpRenderContext.reset();
@@ -33,6 +33,8 @@
 #include "API/LowLevel/DescriptorPool.h"
 #include "API/LowLevel/ResourceAllocator.h"
 #include "API/QueryHeap.h"
+#include "API/GsoCache.h"
+#include "API/LowLevel/DescriptorSetCache.h"
 
 namespace Falcor
 {
@@ -143,6 +145,14 @@ namespace Falcor
         const DescriptorPool::SharedPtr& getGpuDescriptorPool() const { return mpGpuDescPool; }
         const ResourceAllocator::SharedPtr& getResourceAllocator() const { return mpResourceAllocator; }
         const QueryHeap::SharedPtr& getTimestampQueryHeap() const { return mTimestampQueryHeap; }
+
+        /** Get the graphics state object cache. The cache is shared by all GraphicsState objects
+        */
+        const GsoCache::SharedPtr& getGsoCache() const { return mpGsoCache; }
+
+        /** Get the cache of descriptor sets allocated from the GPU descriptor pool
+        */
+        const DescriptorSetCache::SharedPtr& getDescriptorSetCache() const { return mpDescriptorSetCache; }
         void releaseResource(ApiObjectHandle pResource);
         double getGpuTimestampFrequency() const { return mGpuTimestampFrequency; } // ms/tick
         bool isRgb32FloatSupported() const { return mRgb32FloatSupported; }
@@ -166,6 +176,7 @@ namespace Falcor
             ApiObjectHandle pApiObject;
         };
         std::queue<ResourceRelease> mDeferredReleases;
+        std::mutex mDeferredReleasesMutex;  // Objects can be released from worker threads, for example when the GSO cache evicts objects
 
         uint32_t mCurrentBackBufferIndex;
         std::vector<Fbo::SharedPtr> mpSwapChainFbos;
@@ -181,6 +192,8 @@ namespace Falcor
         ResourceAllocator::SharedPtr mpResourceAllocator;
         DescriptorPool::SharedPtr mpCpuDescPool;
         DescriptorPool::SharedPtr mpGpuDescPool;
+        GsoCache::SharedPtr mpGsoCache;
+        DescriptorSetCache::SharedPtr mpDescriptorSetCache;
         bool mIsWindowOccluded = false;
         GpuFence::SharedPtr mpFrameFence;
 
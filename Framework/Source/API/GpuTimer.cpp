@@ -99,6 +99,7 @@ namespace Falcor
         double end = (double)result[1];
         double range = end - start;
         double elapsedTime = range * gpDevice->getGpuTimestampFrequency();
+        mStartTime = start * gpDevice->getGpuTimestampFrequency();
         mStatus = Status::Idle;
 
         return elapsedTime;
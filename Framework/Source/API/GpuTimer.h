@@ -65,6 +65,11 @@ namespace Falcor
         */
         double getElapsedTime();
 
+        /** Get the GPU timestamp of the begin() call of the range returned by the last call to getElapsedTime(), in miliseconds.
+            The value is in the GPU's clock domain. It's only meaningful relative to other GPU timestamps.
+        */
+        double getStartTime() const { return mStartTime; }
+
     private:
         GpuTimer();
         enum Status
@@ -78,6 +83,7 @@ namespace Falcor
         LowLevelContextData::SharedPtr mpLowLevelData;
         uint32_t mStart;
         uint32_t mEnd;
+        double mStartTime = 0;
         void apiBegin();
         void apiEnd();
         void apiResolve(uint64_t result[2]);
@@ -30,6 +30,7 @@
 #include "BlendState.h"
 #include "VAO.h"
 #include "Device.h"
+#include <mutex>
 
 namespace Falcor
 {
@@ -78,20 +79,62 @@ namespace Falcor
         return b;
     }
 
+    static void hashCombine(size_t& hash, uint64_t value)
+    {
+        // 64-bit finalizer from MurmurHash3, so that pointers which differ only in their low bits spread across the whole range
+        value ^= value >> 33;
+        value *= 0xff51afd7ed558ccdull;
+        value ^= value >> 33;
+        value *= 0xc4ceb9fe1a85ec53ull;
+        value ^= value >> 33;
+        hash ^= size_t(value) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    }
+
+    template<typename T>
+    static uint64_t stateKey(const T& pState, const T& pDefault)
+    {
+        // A null state and the default state are interchangeable, see Desc::operator==()
+        return (pState == pDefault) ? 0 : (uint64_t)pState.get();
+    }
+
+    size_t GraphicsStateObject::DescHash::operator()(const GraphicsStateObject::Desc& d) const
+    {
+        size_t hash = 0;
+        hashCombine(hash, (uint64_t)d.getVertexLayout().get());
+        hashCombine(hash, (uint64_t)d.getProgramVersion().get());
+        hashCombine(hash, (uint64_t)d.getRootSignature().get());
+        hashCombine(hash, stateKey(d.getRasterizerState(), spDefaultRasterizerState));
+        hashCombine(hash, stateKey(d.getDepthStencilState(), spDefaultDepthStencilState));
+        hashCombine(hash, stateKey(d.getBlendState(), spDefaultBlendState));
+        hashCombine(hash, d.getSampleMask());
+        hashCombine(hash, (uint64_t)d.getPrimitiveType());
+        hashCombine(hash, d.getSinglePassStereoEnabled() ? 1 : 0);
+
+        const Fbo::Desc& fboDesc = d.getFboDesc();
+        for (uint32_t i = 0; i < Fbo::getMaxColorTargetCount(); i++)
+        {
+            hashCombine(hash, ((uint64_t)fboDesc.getColorTargetFormat(i) << 1) | (fboDesc.isColorTargetUav(i) ? 1 : 0));
+        }
+        hashCombine(hash, ((uint64_t)fboDesc.getDepthStencilFormat() << 1) | (fboDesc.isDepthStencilUav() ? 1 : 0));
+        hashCombine(hash, fboDesc.getSampleCount());
+        return hash;
+    }
+
     GraphicsStateObject::~GraphicsStateObject()
     {
         gpDevice->releaseResource(mApiHandle);
     }
 
-    GraphicsStateObject::SharedPtr GraphicsStateObject::create(const Desc& desc)
+    GraphicsStateObject::SharedPtr GraphicsStateObject::create(const Desc& desc, const PipelineCacheHandle& pCache)
     {
-        if (spDefaultBlendState == nullptr)
+        // Create default objects. The GSO cache can create objects from multiple threads
+        static std::once_flag sDefaultsCreated;
+        std::call_once(sDefaultsCreated, []()
         {
-            // Create default objects
             spDefaultBlendState = BlendState::create(BlendState::Desc());
             spDefaultDepthStencilState = DepthStencilState::create(DepthStencilState::Desc());
             spDefaultRasterizerState = RasterizerState::create(RasterizerState::Desc());
-        }
+        });
 
         SharedPtr pState = SharedPtr(new GraphicsStateObject(desc));
 
@@ -100,7 +143,7 @@ namespace Falcor
         if (!pState->mDesc.mpRasterizerState)       pState->mDesc.mpRasterizerState         = spDefaultRasterizerState;
         if (!pState->mDesc.mpDepthStencilState)     pState->mDesc.mpDepthStencilState       = spDefaultDepthStencilState;
 
-        if (pState->apiInit() == false)
+        if (pState->apiInit(pCache) == false)
         {
             pState = nullptr;
         }
@@ -84,6 +84,7 @@ namespace Falcor
             VertexLayout::SharedConstPtr getVertexLayout() const { return mpLayout; }
             const Fbo::Desc& getFboDesc() const { return mFboDesc; }
             ProgramVersion::SharedConstPtr getProgramVersion() const { return mpProgram; }
+            RootSignature::SharedPtr getRootSignature() const { return mpRootSignature; }
 
             bool getSinglePassStereoEnabled() const { return mSinglePassStereoEnabled; }
 
@@ -114,7 +115,18 @@ namespace Falcor
 #endif
         };
 
-        static SharedPtr create(const Desc& desc);
+        /** Hash function for GraphicsStateObject::Desc. Consistent with Desc::operator==, i.e. a desc using the default states hashes to the same value as a desc without states
+        */
+        struct DescHash
+        {
+            std::size_t operator()(const Desc& d) const;
+        };
+
+        /** Create a new object. Usually you should use the device's GSO cache instead, see Device::getGsoCache()
+            \param[in] desc The object's description
+            \param[in] pCache Optional pipeline cache used to persist the compiled pipeline. Can be nullptr
+        */
+        static SharedPtr create(const Desc& desc, const PipelineCacheHandle& pCache = nullptr);
 
         ApiHandle getApiHandle() { return mApiHandle; }
 
@@ -130,6 +142,6 @@ namespace Falcor
         static RasterizerState::SharedPtr spDefaultRasterizerState;
         static DepthStencilState::SharedPtr spDefaultDepthStencilState;
 
-        bool apiInit();
+        bool apiInit(const PipelineCacheHandle& pCache);
     };
 }
\ No newline at end of file
@@ -0,0 +1,204 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "GsoCache.h"
+#include "Utils/BinaryFileStream.h"
+
+namespace Falcor
+{
+    GsoCache::SharedPtr GsoCache::create(size_t capacity)
+    {
+        return SharedPtr(new GsoCache(capacity));
+    }
+
+    GsoCache::GsoCache(size_t capacity) : mCapacity(capacity)
+    {
+    }
+
+    GsoCache::~GsoCache()
+    {
+        if (mPersistentFilename.size()) savePersistentData();
+    }
+
+    size_t GsoCache::getShardCapacity() const
+    {
+        // Round up, so that the cache can hold at least mCapacity objects
+        return std::max<size_t>(1, (mCapacity + kShardCount - 1) / kShardCount);
+    }
+
+    static uint32_t getShardIndex(size_t hash, uint32_t shardCount)
+    {
+        // The hash-map buckets use the low bits of the hash. Mix all the bits before selecting the shard, so that the shards don't depend on the same bits. size_t might be 32-bit
+        uint64_t h = (uint64_t)hash;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdull;
+        h ^= h >> 33;
+        return (uint32_t)(h % shardCount);
+    }
+
+    GraphicsStateObject::SharedPtr GsoCache::find(Shard& shard, size_t hash, const GraphicsStateObject::Desc& desc)
+    {
+        auto range = shard.map.equal_range(hash);
+        for (auto it = range.first; it != range.second; it++)
+        {
+            const auto& pGso = *it->second;
+            if (desc == pGso->getDesc())
+            {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                return pGso;
+            }
+        }
+        return nullptr;
+    }
+
+    GraphicsStateObject::SharedPtr GsoCache::getGso(const GraphicsStateObject::Desc& desc)
+    {
+        size_t hash = GraphicsStateObject::DescHash()(desc);
+        Shard& shard = mShards[getShardIndex(hash, kShardCount)];
+
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            GraphicsStateObject::SharedPtr pGso = find(shard, hash, desc);
+            if (pGso)
+            {
+                shard.hits++;
+                return pGso;
+            }
+            shard.misses++;
+        }
+
+        // Compiling the pipeline is slow, so do it without holding the lock. Lookups into the shard can continue in the meantime
+        GraphicsStateObject::SharedPtr pGso = GraphicsStateObject::create(desc, mpPipelineCache);
+        if (pGso == nullptr) return nullptr;
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        // Another thread might have created the same object while we were compiling. Use the cached one, so that all users share a single object
+        GraphicsStateObject::SharedPtr pCached = find(shard, hash, desc);
+        if (pCached) return pCached;
+
+        evict(shard, getShardCapacity() - 1);
+        shard.lru.push_front(pGso);
+        shard.map.emplace(hash, shard.lru.begin());
+        return pGso;
+    }
+
+    void GsoCache::evict(Shard& shard, size_t maxSize)
+    {
+        while (shard.lru.size() > maxSize)
+        {
+            const auto& pGso = shard.lru.back();
+            auto range = shard.map.equal_range(GraphicsStateObject::DescHash()(pGso->getDesc()));
+            for (auto it = range.first; it != range.second; it++)
+            {
+                if (&*it->second == &pGso)
+                {
+                    shard.map.erase(it);
+                    break;
+                }
+            }
+            shard.lru.pop_back();
+            shard.evictions++;
+        }
+    }
+
+    void GsoCache::setCapacity(size_t capacity)
+    {
+        mCapacity = capacity;
+        size_t shardCapacity = getShardCapacity();
+        for (auto& shard : mShards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            evict(shard, shardCapacity);
+        }
+    }
+
+    GsoCache::Stats GsoCache::getStats() const
+    {
+        Stats stats;
+        for (auto& shard : mShards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            stats.hits += shard.hits;
+            stats.misses += shard.misses;
+            stats.evictions += shard.evictions;
+            stats.size += shard.lru.size();
+        }
+        return stats;
+    }
+
+    void GsoCache::clear()
+    {
+        for (auto& shard : mShards)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.map.clear();
+            shard.lru.clear();
+        }
+    }
+
+    bool GsoCache::enablePersistence(const std::string& filename)
+    {
+        mPersistentData.clear();
+        if (doesFileExist(filename))
+        {
+            BinaryFileStream stream(filename, BinaryFileStream::Mode::Read);
+            mPersistentData.resize(stream.getRemainingStreamSize());
+            if (mPersistentData.size()) stream.read(mPersistentData.data(), mPersistentData.size());
+            if (stream.isFail())
+            {
+                logWarning("GsoCache::enablePersistence() - failed to read '" + filename + "'. Ignoring the file");
+                mPersistentData.clear();
+            }
+        }
+
+        if (apiCreatePipelineCache() == false) return false;
+        mPersistentFilename = filename;
+        return true;
+    }
+
+    bool GsoCache::savePersistentData()
+    {
+        if (mPersistentFilename.empty())
+        {
+            logError("GsoCache::savePersistentData() - persistence is not enabled. Call enablePersistence() first");
+            return false;
+        }
+
+        std::vector<uint8_t> data;
+        if (apiSerializePipelineCache(data) == false) return false;
+
+        BinaryFileStream stream(mPersistentFilename, BinaryFileStream::Mode::Write);
+        if (data.size()) stream.write(data.data(), data.size());
+        if (stream.isFail())
+        {
+            logError("GsoCache::savePersistentData() - failed to write '" + mPersistentFilename + "'");
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,129 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "API/GraphicsStateObject.h"
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace Falcor
+{
+    /** Cache of graphics state objects, keyed by GraphicsStateObject::Desc.
+        The cache is shared by all the GraphicsState objects (see Device::getGsoCache()) and is safe to use from multiple threads.
+        Objects are evicted in least-recently-used order once the cache reaches its capacity. An evicted object stays alive as long as someone holds a reference to it.
+        The cache can optionally persist the compiled pipelines to disk, so that subsequent runs can skip pipeline compilation.
+    */
+    class GsoCache
+    {
+    public:
+        using SharedPtr = std::shared_ptr<GsoCache>;
+        using SharedConstPtr = std::shared_ptr<const GsoCache>;
+
+        static const size_t kDefaultCapacity = 4096;
+
+        struct Stats
+        {
+            uint64_t hits = 0;          ///< Number of lookups which found an existing object
+            uint64_t misses = 0;        ///< Number of lookups which didn't find an object and compiled a new one
+            uint64_t evictions = 0;     ///< Number of objects evicted from the cache
+            size_t size = 0;            ///< Number of objects currently in the cache
+        };
+
+        /** Create a new cache
+            \param[in] capacity The maximum number of objects in the cache
+        */
+        static SharedPtr create(size_t capacity = kDefaultCapacity);
+        ~GsoCache();
+
+        /** Get a GSO matching a description. Will create a new object if the cache doesn't contain a matching object.
+            \return The GSO, or nullptr if object creation failed
+        */
+        GraphicsStateObject::SharedPtr getGso(const GraphicsStateObject::Desc& desc);
+
+        /** Set the maximum number of objects in the cache. If the cache contains more objects, the least-recently-used ones will be evicted
+        */
+        void setCapacity(size_t capacity);
+
+        /** Get the maximum number of objects in the cache
+        */
+        size_t getCapacity() const { return mCapacity; }
+
+        /** Get the cache statistics
+        */
+        Stats getStats() const;
+
+        /** Remove all the objects from the cache. Doesn't reset the statistics
+        */
+        void clear();
+
+        /** Enable persisting the compiled pipelines to disk. If the file exists, pipelines stored in it will be used instead of compiling new ones.
+            Call this before any GSO is created, usually right after device creation. The function is not thread-safe.
+            The data is written back to the file when calling savePersistentData() and when the cache is destroyed.
+            \param[in] filename The file to load the data from and save the data into
+            \return true if persistence was enabled, otherwise false. If the file is corrupted or was created by a different driver, it is ignored and the function succeeds
+        */
+        bool enablePersistence(const std::string& filename);
+
+        /** Write the compiled pipelines to the file specified in enablePersistence()
+            \return true on success, otherwise false
+        */
+        bool savePersistentData();
+
+    private:
+        GsoCache(size_t capacity);
+
+        using LruList = std::list<GraphicsStateObject::SharedPtr>;
+
+        // The cache is split into shards to reduce lock contention when multiple threads are looking up objects
+        static const uint32_t kShardCount = 16;
+        struct Shard
+        {
+            mutable std::mutex mutex;
+            LruList lru;    // Front is the most-recently-used object
+            std::unordered_multimap<size_t, LruList::iterator> map;
+            uint64_t hits = 0;
+            uint64_t misses = 0;
+            uint64_t evictions = 0;
+        };
+
+        GraphicsStateObject::SharedPtr find(Shard& shard, size_t hash, const GraphicsStateObject::Desc& desc);
+        void evict(Shard& shard, size_t maxSize);
+        size_t getShardCapacity() const;
+
+        Shard mShards[kShardCount];
+        std::atomic<size_t> mCapacity;
+        std::string mPersistentFilename;
+        PipelineCacheHandle mpPipelineCache = nullptr;
+        std::vector<uint8_t> mPersistentData;   // The data loaded from the file. Some APIs require it to stay alive as long as the pipeline cache is used
+
+        // API specific functions
+        bool apiCreatePipelineCache();
+        bool apiSerializePipelineCache(std::vector<uint8_t>& data);
+    };
+}
@@ -42,18 +42,13 @@ namespace Falcor
 
     void DescriptorPool::executeDeferredReleases()
     {
-        uint64_t gpuVal = mpFence->getGpuValue();
-        while (mpDeferredReleases.size() && mpDeferredReleases.top().fenceValue <= gpuVal)
-        {
-            mpDeferredReleases.pop();
-        }
+        std::lock_guard<std::recursive_mutex> lock(mMutex);
+        mDeferredReleases.retire(mpFence->getGpuValue());
     }
 
     void DescriptorPool::releaseAllocation(std::shared_ptr<DescriptorSetApiData> pData)
     {
-        DeferredRelease d;
-        d.pData = pData;
-        d.fenceValue = mpFence->getCpuValue();
-        mpDeferredReleases.push(d);
+        std::lock_guard<std::recursive_mutex> lock(mMutex);
+        mDeferredReleases.push(pData, mpFence->getCpuValue());
     }
 }
@@ -28,8 +28,9 @@
 #pragma once
 #include "Framework.h"
 #include <queue>
+#include <mutex>
 #include "API/LowLevel/GpuFence.h"
-#include <queue>
+#include "API/LowLevel/FencedPool.h"
 
 namespace Falcor
 {
@@ -95,6 +96,10 @@ namespace Falcor
         ApiHandle getApiHandle(uint32_t heapIndex) const;
         const ApiData* getApiData() const { return mpApiData.get(); }
         void executeDeferredReleases();
+
+        /** Get the number of released allocations which are waiting for the GPU
+        */
+        size_t getDeferredReleaseCount() const { std::lock_guard<std::recursive_mutex> lock(mMutex); return mDeferredReleases.size(); }
     private:
         friend DescriptorSet;
         DescriptorPool(const Desc& desc, GpuFence::SharedPtr pFence);
@@ -103,14 +108,8 @@ namespace Falcor
         Desc mDesc;
         std::shared_ptr<ApiData> mpApiData;
         GpuFence::SharedPtr mpFence;
+        mutable std::recursive_mutex mMutex;    // Guards allocations and releases. Recursive, since allocation failures execute the deferred releases
 
-        struct DeferredRelease
-        {
-            std::shared_ptr<DescriptorSetApiData> pData;
-            uint64_t fenceValue;
-            bool operator>(const DeferredRelease& other) const { return fenceValue > other.fenceValue; }
-        };
-
-        std::priority_queue<DeferredRelease, std::vector<DeferredRelease>, std::greater<DeferredRelease>> mpDeferredReleases;
+        FencedQueue<std::shared_ptr<DescriptorSetApiData>> mDeferredReleases;
     };
 }
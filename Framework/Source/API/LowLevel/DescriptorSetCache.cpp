@@ -0,0 +1,179 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "DescriptorSetCache.h"
+
+namespace Falcor
+{
+    static void hashCombine(size_t& hash, size_t value)
+    {
+        hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    }
+
+    DescriptorSetCache::Key::Key(const DescriptorSet::Layout& layout) : mLayout(layout), mHash(0)
+    {
+        std::hash<uint64_t> h;
+        hashCombine(mHash, h((uint64_t)layout.getVisibility()));
+        size_t descCount = 0;
+        for (size_t r = 0; r < layout.getRangeCount(); r++)
+        {
+            const auto& range = layout.getRange(r);
+            hashCombine(mHash, h(((uint64_t)range.type << 32) | range.regSpace));
+            hashCombine(mHash, h(((uint64_t)range.baseRegIndex << 32) | range.descCount));
+            descCount += range.descCount;
+        }
+        // Every descriptor adds an object, allocate the storage once
+        mObjects.reserve(descCount);
+    }
+
+    void DescriptorSetCache::Key::addObject(const std::shared_ptr<const void>& pObject)
+    {
+        hashCombine(mHash, std::hash<const void*>()(pObject.get()));
+        mObjects.push_back(pObject);
+    }
+
+    bool DescriptorSetCache::Key::operator==(const Key& other) const
+    {
+        if (mHash != other.mHash || mObjects.size() != other.mObjects.size()) return false;
+        for (size_t i = 0; i < mObjects.size(); i++)
+        {
+            if (mObjects[i] != other.mObjects[i]) return false;
+        }
+        return mLayout == other.mLayout;
+    }
+
+    DescriptorSetCache::SharedPtr DescriptorSetCache::create(const GpuFence::SharedConstPtr& pFence, size_t capacity, uint64_t retireAge)
+    {
+        return SharedPtr(new DescriptorSetCache(pFence, capacity, retireAge));
+    }
+
+    DescriptorSetCache::DescriptorSetCache(const GpuFence::SharedConstPtr& pFence, size_t capacity, uint64_t retireAge) : mpFence(pFence), mCapacity(capacity), mRetireAge(retireAge)
+    {
+    }
+
+    DescriptorSetCache::~DescriptorSetCache()
+    {
+        clear();
+    }
+
+    DescriptorSet::SharedPtr DescriptorSetCache::find(const Key& key)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto range = mMap.equal_range(key.getHash());
+        for (auto it = range.first; it != range.second; it++)
+        {
+            Entry& entry = *it->second;
+            if (entry.key == key)
+            {
+                gEventCounter.numDescriptorTableCacheHits++;
+                entry.lastUsed = mpFence->getCpuValue();
+                mEntries.splice(mEntries.begin(), mEntries, it->second);
+                return entry.pSet;
+            }
+        }
+        gEventCounter.numDescriptorTableCacheMisses++;
+        return nullptr;
+    }
+
+    void DescriptorSetCache::insert(Key&& key, const DescriptorSet::SharedPtr& pSet)
+    {
+        uint32_t descCount = 0;
+        for (size_t r = 0; r < pSet->getRangeCount(); r++)
+        {
+            descCount += pSet->getRange((uint32_t)r).descCount;
+        }
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        size_t hash = key.getHash();
+        uint64_t fenceValue = mpFence->getCpuValue();
+
+        // Only cache a set the second time its key shows up. Comparing hashes is enough here, a collision only means a set is cached too early
+        auto offered = mOfferedKeys.find(hash);
+        if (offered == mOfferedKeys.end() || offered->second + mRetireAge < fenceValue)
+        {
+            if (mOfferedKeys.size() >= mCapacity) mOfferedKeys.clear();
+            mOfferedKeys[hash] = fenceValue;
+            return;
+        }
+        mOfferedKeys.erase(offered);
+
+        while (mEntries.size() && mEntries.size() >= mCapacity)
+        {
+            erase(std::prev(mEntries.end()));
+        }
+
+        mEntries.push_front({ std::move(key), pSet, descCount, fenceValue });
+        mMap.emplace(hash, mEntries.begin());
+        gEventCounter.numCachedDescriptorTables++;
+        gEventCounter.numCachedDescriptors += descCount;
+    }
+
+    void DescriptorSetCache::erase(EntryList::iterator it)
+    {
+        auto range = mMap.equal_range(it->key.getHash());
+        for (auto mapIt = range.first; mapIt != range.second; mapIt++)
+        {
+            if (mapIt->second == it)
+            {
+                mMap.erase(mapIt);
+                break;
+            }
+        }
+        gEventCounter.numCachedDescriptorTables--;
+        gEventCounter.numCachedDescriptors -= it->descCount;
+
+        // The set releases its descriptors into the pool, which defers the release until the GPU is done with them
+        mEntries.erase(it);
+    }
+
+    void DescriptorSetCache::retire()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        uint64_t fenceValue = mpFence->getCpuValue();
+        while (mEntries.size() && mEntries.back().lastUsed + mRetireAge < fenceValue)
+        {
+            erase(std::prev(mEntries.end()));
+        }
+
+        for (auto it = mOfferedKeys.begin(); it != mOfferedKeys.end();)
+        {
+            if (it->second + mRetireAge < fenceValue) it = mOfferedKeys.erase(it);
+            else it++;
+        }
+    }
+
+    void DescriptorSetCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        while (mEntries.size())
+        {
+            erase(std::prev(mEntries.end()));
+        }
+        mOfferedKeys.clear();
+    }
+}
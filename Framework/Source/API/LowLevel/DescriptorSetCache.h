@@ -0,0 +1,119 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "API/DescriptorSet.h"
+#include "API/LowLevel/GpuFence.h"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace Falcor
+{
+    /** Cache of recently built descriptor sets, keyed by the set's layout and the objects bound into it.
+        Allows ParameterBlock to reuse a descriptor set when the same combination of resources is bound again, for example when alternating between a small number of materials.
+        The cached sets are immutable. Sets which weren't used for a number of frames are retired, and their descriptors are released once the GPU is done with them.
+        The cache is thread-safe.
+    */
+    class DescriptorSetCache
+    {
+    public:
+        using SharedPtr = std::shared_ptr<DescriptorSetCache>;
+        using SharedConstPtr = std::shared_ptr<const DescriptorSetCache>;
+
+        static const size_t kDefaultCapacity = 4096;
+        static const uint64_t kDefaultRetireAge = 8;
+
+        /** Describes the contents of a descriptor set.
+            The key holds references to the bound objects, which guarantees that their addresses can't be reused by other objects while the key is alive.
+        */
+        class Key
+        {
+        public:
+            Key(const DescriptorSet::Layout& layout);
+
+            /** Add a bound object. Objects must be added in the order in which they are bound into the set
+            */
+            void addObject(const std::shared_ptr<const void>& pObject);
+
+            size_t getHash() const { return mHash; }
+            bool operator==(const Key& other) const;
+        private:
+            DescriptorSet::Layout mLayout;
+            std::vector<std::shared_ptr<const void>> mObjects;
+            size_t mHash;
+        };
+
+        /** Create a new cache
+            \param[in] pFence Fence used to track the age of the sets. Should be signaled once per frame
+            \param[in] capacity The maximum number of sets in the cache
+            \param[in] retireAge Sets which weren't used for that number of fence values are retired
+        */
+        static SharedPtr create(const GpuFence::SharedConstPtr& pFence, size_t capacity = kDefaultCapacity, uint64_t retireAge = kDefaultRetireAge);
+        ~DescriptorSetCache();
+
+        /** Find a set matching a key.
+            \return The set, or nullptr if the cache doesn't contain a matching set
+        */
+        DescriptorSet::SharedPtr find(const Key& key);
+
+        /** Offer a set to the cache. The set must not be modified after that.
+            A set is only cached the second time its key is offered within the retire age. Most keys are only seen once, since a constant buffer gets a new view whenever its contents change, and caching them would evict the sets which are actually reused.
+        */
+        void insert(Key&& key, const DescriptorSet::SharedPtr& pSet);
+
+        /** Release the sets which weren't used recently. Usually called by the device once per frame
+        */
+        void retire();
+
+        /** Release all the sets
+        */
+        void clear();
+
+    private:
+        DescriptorSetCache(const GpuFence::SharedConstPtr& pFence, size_t capacity, uint64_t retireAge);
+
+        struct Entry
+        {
+            Key key;
+            DescriptorSet::SharedPtr pSet;
+            uint32_t descCount;
+            uint64_t lastUsed;
+        };
+        using EntryList = std::list<Entry>;
+
+        void erase(EntryList::iterator it);
+
+        GpuFence::SharedConstPtr mpFence;
+        size_t mCapacity;
+        uint64_t mRetireAge;
+        std::mutex mMutex;
+        EntryList mEntries;     // Front is the most-recently-used set
+        std::unordered_multimap<size_t, EntryList::iterator> mMap;
+        std::unordered_map<size_t, uint64_t> mOfferedKeys;      // Hash of the keys which were offered once, to the fence value at that time
+    };
+}
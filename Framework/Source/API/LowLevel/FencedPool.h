@@ -26,55 +26,188 @@
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
 #pragma once
-#include <queue>
+#include <deque>
+#include <vector>
 #include "GpuFence.h"
 
 namespace Falcor
 {
+    /** A queue of objects tagged with fence values.
+        Objects pushed with the same fence value are stored in a single batch, and are retired together once the fence reaches that value.
+    */
     template<typename ObjectType>
-    class FencedPool : public std::enable_shared_from_this<FencedPool<ObjectType>>
+    class FencedQueue
     {
     public:
-        using SharedPtr = std::shared_ptr<FencedPool<ObjectType>>;
-        using SharedConstPtr = std::shared_ptr<const FencedPool<ObjectType>>;
+        /** Add an object to the queue
+            \param[in] object The object
+            \param[in] fenceValue The object can be retired once the fence reaches this value. If the value is smaller than the value of the last batch, the object is added to the last batch
+        */
+        void push(const ObjectType& object, uint64_t fenceValue)
+        {
+            if (mBatches.empty() || mBatches.back().fenceValue < fenceValue)
+            {
+                mBatches.emplace_back();
+                mBatches.back().fenceValue = fenceValue;
+            }
+            mBatches.back().objects.push_back(object);
+            mSize++;
+        }
+
+        /** Retire all the batches whose fence value is smaller than or equal to the completed value
+            \param[in] completedValue The last value the fence reached
+            \param[in] func Function which is called for each retired object. Can be used to recycle the object
+            \return The number of retired objects
+        */
+        template<typename FuncType>
+        size_t retire(uint64_t completedValue, FuncType func)
+        {
+            size_t count = 0;
+            while (mBatches.size() && mBatches.front().fenceValue <= completedValue)
+            {
+                for (auto& object : mBatches.front().objects)
+                {
+                    func(object);
+                }
+                count += mBatches.front().objects.size();
+                mBatches.pop_front();
+            }
+            mSize -= count;
+            return count;
+        }
+
+        /** Retire all the batches whose fence value is smaller than or equal to the completed value, and release the objects
+        */
+        size_t retire(uint64_t completedValue) { return retire(completedValue, [](ObjectType&) {}); }
+
+        /** Get the number of objects in the queue
+        */
+        size_t size() const { return mSize; }
+
+        /** Check if the queue is empty
+        */
+        bool empty() const { return mSize == 0; }
+
+    private:
+        struct Batch
+        {
+            uint64_t fenceValue;
+            std::vector<ObjectType> objects;
+        };
+        std::deque<Batch> mBatches;
+        size_t mSize = 0;
+    };
+
+    /** A pool of objects which are used by the GPU, like command allocators.
+        An object handed out by newObject() is active until the next call to newObject(). At that point it's tagged with the fence's CPU value, and it's recycled once the GPU reaches that value.
+        The pool never holds more than maxObjects objects. When all the objects are in use, newObject() blocks until the GPU is done with them.
+        \tparam ObjectType The pooled object type
+        \tparam FenceType The fence type. Must provide getCpuValue(), getGpuValue() and syncCpu(). The default is GpuFence, other types can be used to simulate the GPU in tests
+    */
+    template<typename ObjectType, typename FenceType = GpuFence>
+    class FencedPool : public std::enable_shared_from_this<FencedPool<ObjectType, FenceType>>
+    {
+    public:
+        using SharedPtr = std::shared_ptr<FencedPool<ObjectType, FenceType>>;
+        using SharedConstPtr = std::shared_ptr<const FencedPool<ObjectType, FenceType>>;
         using NewObjectFuncType = ObjectType(*)(void*);
 
-        static SharedPtr create(GpuFence::SharedConstPtr pFence, NewObjectFuncType newFunc, void* pUserData = nullptr) { return SharedPtr(new FencedPool(pFence, newFunc, pUserData)); }
+        static const size_t kDefaultMaxObjects = 64;
+
+        struct Stats
+        {
+            size_t objectCount = 0;         ///< Number of objects owned by the pool, including the active object
+            size_t inFlightCount = 0;       ///< Number of objects waiting for the GPU
+            size_t freeCount = 0;           ///< Number of objects ready to be reused
+            uint64_t allocationCount = 0;   ///< Number of objects created
+            uint64_t reuseCount = 0;        ///< Number of times an object was recycled
+            uint64_t stallCount = 0;        ///< Number of times newObject() had to wait for the GPU because the pool was full
+        };
+
+        /** Create a new pool
+            \param[in] pFence The fence used to track the objects
+            \param[in] newFunc Function used to create new objects
+            \param[in] pUserData User data passed to newFunc
+            \param[in] maxObjects The maximum number of objects the pool will create. Must be at least 2
+        */
+        static SharedPtr create(std::shared_ptr<FenceType> pFence, NewObjectFuncType newFunc, void* pUserData = nullptr, size_t maxObjects = kDefaultMaxObjects)
+        {
+            return SharedPtr(new FencedPool(pFence, newFunc, pUserData, maxObjects));
+        }
+
+        /** Retire the active object and return a new one
+        */
         ObjectType newObject()
         {
             // Retire the active object
-            Data data;
-            data.alloc = mActiveObject;
-            data.timestamp = mpFence->getCpuValue();
-            mQueue.push(data);
-
-            // The queue is sorted based on time. Check if the first object is free
-            data = mQueue.front();
-            if (data.timestamp <= mpFence->getGpuValue())
+            mInFlight.push(mActiveObject, mpFence->getCpuValue());
+
+            // Recycle all the objects the GPU is done with
+            retireCompleted();
+
+            if (mFreeObjects.empty() && mStats.objectCount >= mMaxObjects)
+            {
+                // The pool is full. Wait for the GPU and try again
+                mStats.stallCount++;
+                mpFence->syncCpu();
+                retireCompleted();
+            }
+
+            if (mFreeObjects.empty())
             {
-                mQueue.pop();
+                // Depending on the API, the last signaled value might not cover the object we just retired, so a stall can still end up allocating an object
+                mFreeObjects.push_back(allocateObject());
             }
             else
             {
-                data.alloc = mNewObjFunc(mpUserData);
+                mStats.reuseCount++;
             }
 
-            mActiveObject = data.alloc;
+            mActiveObject = mFreeObjects.back();
+            mFreeObjects.pop_back();
             return mActiveObject;
         }
 
+        /** Get the pool statistics
+        */
+        Stats getStats() const
+        {
+            Stats stats = mStats;
+            stats.inFlightCount = mInFlight.size();
+            stats.freeCount = mFreeObjects.size();
+            return stats;
+        }
+
+        /** Get the maximum number of objects the pool will create
+        */
+        size_t getMaxObjects() const { return mMaxObjects; }
+
     private:
-        FencedPool(GpuFence::SharedConstPtr pFence, NewObjectFuncType newFunc, void* pUserData) : mpUserData(pUserData), mpFence(pFence), mNewObjFunc(newFunc) { mActiveObject = mNewObjFunc(pUserData); }
-        GpuFence::SharedConstPtr mpFence;
-        void* mpUserData;
+        FencedPool(std::shared_ptr<FenceType> pFence, NewObjectFuncType newFunc, void* pUserData, size_t maxObjects) : mpFence(pFence), mpUserData(pUserData), mNewObjFunc(newFunc), mMaxObjects(std::max<size_t>(maxObjects, 2))
+        {
+            mActiveObject = allocateObject();
+        }
 
-        struct Data
+        ObjectType allocateObject()
         {
-            ObjectType alloc;
-            uint64_t timestamp;
-        };
-        ObjectType mActiveObject;
+            mStats.objectCount++;
+            mStats.allocationCount++;
+            return mNewObjFunc(mpUserData);
+        }
+
+        void retireCompleted()
+        {
+            mInFlight.retire(mpFence->getGpuValue(), [this](ObjectType& object) { mFreeObjects.push_back(object); });
+        }
+
+        std::shared_ptr<FenceType> mpFence;
+        void* mpUserData;
         NewObjectFuncType mNewObjFunc = nullptr;
-        std::queue<Data> mQueue;
+        size_t mMaxObjects;
+
+        ObjectType mActiveObject;
+        FencedQueue<ObjectType> mInFlight;
+        std::vector<ObjectType> mFreeObjects;
+        Stats mStats;
     };
-}
\ No newline at end of file
+}
@@ -67,6 +67,11 @@ namespace Falcor
         */
         void syncCpu();
 
+        /** Tell the CPU to wait until the fence reaches a specific value. Unlike syncCpu(), doesn't wait for work which was signaled later
+            \param[in] value A value which was returned by gpuSignal()
+        */
+        void syncCpu(uint64_t value);
+
         /** Insert a signal command into the command queue. This will increase the internal value
         */
         uint64_t gpuSignal(CommandQueueHandle pQueue);
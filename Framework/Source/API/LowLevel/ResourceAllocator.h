@@ -29,6 +29,7 @@
 #ifdef FALCOR_LOW_LEVEL_API
 #include <unordered_map>
 #include <queue>
+#include <mutex>
 #include "GpuFence.h"
 
 namespace Falcor
@@ -80,6 +81,7 @@ namespace Falcor
         std::priority_queue<AllocationData> mDeferredReleases;
         std::unordered_map<size_t, PageData::UniquePtr> mUsedPages;
         std::queue<PageData::UniquePtr> mAvailablePages;
+        std::mutex mMutex;  // Buffers can be mapped from contexts recording on worker threads
 
         void allocateNewPage();
         static void initBasePageData(BaseData& data, size_t size);
@@ -28,12 +28,25 @@
 #include "Framework.h"
 #include "API/LowLevel/RootSignature.h"
 #include "Graphics/Program/ProgramReflection.h"
+#include <mutex>
+#include <unordered_map>
 
 namespace Falcor
 {
     RootSignature::SharedPtr RootSignature::spEmptySig;
     uint64_t RootSignature::sObjCount = 0;
 
+    namespace
+    {
+        // The intern table holds weak references, so that a root signature is released once the last program using it is released
+        struct InternTable
+        {
+            std::mutex mutex;
+            std::unordered_multimap<size_t, std::weak_ptr<RootSignature>> map;
+        };
+        InternTable gInternTable;
+    }
+
     RootSignature::Desc& RootSignature::Desc::addDescriptorSet(const DescriptorSetLayout& setLayout)
     {
         assert(setLayout.getRangeCount());
@@ -64,15 +77,50 @@ namespace Falcor
         return spEmptySig;
     }
 
+    size_t RootSignature::hashDesc(const Desc& desc)
+    {
+        std::hash<uint64_t> h;
+        size_t hash = 0;
+        auto combine = [&hash, &h](uint64_t v) { hash ^= h(v) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2); };
+        for (const auto& set : desc.mSets)
+        {
+            combine((uint64_t)set.getVisibility());
+            combine(set.getRangeCount());
+            for (size_t r = 0; r < set.getRangeCount(); r++)
+            {
+                const auto& range = set.getRange(r);
+                combine(((uint64_t)range.type << 32) | range.regSpace);
+                combine(((uint64_t)range.baseRegIndex << 32) | range.descCount);
+            }
+        }
+        return hash;
+    }
+
     RootSignature::SharedPtr RootSignature::create(const Desc& desc)
     {
         if (desc.mSets.size() == 0) return getEmpty();
 
+        size_t hash = hashDesc(desc);
+        std::lock_guard<std::mutex> lock(gInternTable.mutex);
+        auto range = gInternTable.map.equal_range(hash);
+        for (auto it = range.first; it != range.second;)
+        {
+            SharedPtr pSig = it->second.lock();
+            if (pSig == nullptr)
+            {
+                it = gInternTable.map.erase(it);
+                continue;
+            }
+            if (pSig->mDesc == desc) return pSig;
+            it++;
+        }
+
         SharedPtr pSig = SharedPtr(new RootSignature(desc));
         if (pSig->apiInit() == false)
         {
-            pSig = nullptr;
+            return nullptr;
         }
+        gInternTable.map.emplace(hash, pSig);
         return pSig;
     }
 
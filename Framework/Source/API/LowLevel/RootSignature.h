@@ -48,6 +48,7 @@ namespace Falcor
         {
         public:
             Desc& addDescriptorSet(const DescriptorSetLayout& setLayout);
+            bool operator==(const Desc& other) const { return mSets == other.mSets; }
         private:
             friend class RootSignature;
             std::vector<DescriptorSetLayout> mSets;
@@ -55,7 +56,14 @@ namespace Falcor
 
         ~RootSignature();
         static SharedPtr getEmpty();
+
+        /** Get a root signature matching a description.
+            Root signatures are interned - as long as a matching root signature is alive, this function will return it instead of creating a new object. This means that root signatures can be compared by pointer.
+        */
         static SharedPtr create(const Desc& desc);
+
+        /** Get a root signature matching the descriptor-set layouts of a program. See create(const Desc&)
+        */
         static SharedPtr create(const ProgramReflection* pReflection);
 
         ApiHandle getApiHandle() const { return mApiHandle; }
@@ -78,6 +86,7 @@ namespace Falcor
         Desc mDesc;
         static SharedPtr spEmptySig;
         static uint64_t sObjCount;
+        static size_t hashDesc(const Desc& desc);
 
         uint32_t mSizeInBytes;
         std::vector<uint32_t> mElementByteOffset;
@@ -0,0 +1,240 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#define NOMINMAX
+#ifdef _WIN32
+#include <windows.h>
+#endif
+#include "API/Formats.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#define UNSUPPORTED_IN_NULL(msg_) {Falcor::logWarning(msg_ + std::string(" is not supported by the null backend. Ignoring call."));}
+
+namespace Falcor
+{
+    class DescriptorSet;
+    /*!
+    *  \addtogroup Falcor
+    *  @{
+    */
+
+    /** The null backend doesn't talk to a GPU. It records the commands the framework submits and counts them when the command lists are executed, which makes it possible to profile the CPU side of the framework on machines without a GPU.
+        Buffers are backed by CPU memory so that they can be mapped and read back. Textures don't allocate any memory, reading them back returns zeros.
+    */
+    enum class NullCommand
+    {
+        Draw,               ///< Direct draws, indexed or not
+        DrawIndirect,       ///< Indirect draws, indexed or not
+        Dispatch,
+        DispatchIndirect,
+        Clear,              ///< RTV, DSV and UAV clears
+        Copy,               ///< Resource, subresource and buffer-region copies, including texture uploads and readbacks
+        ResourceBarrier,
+        SetPipelineState,
+        SetRootSignature,
+        SetDescriptorTable,
+        SetRenderTargets,
+        SetVertexBuffers,
+        Blit,
+        Timestamp,
+
+        Count
+    };
+
+    /** Get a string describing a NullCommand
+    */
+    const char* to_string(NullCommand command);
+
+    /** Statistics collected by the null backend. Commands are counted when a command list is executed by a queue.
+    */
+    struct NullBackendStats
+    {
+        uint64_t commands[(uint32_t)NullCommand::Count] = {};   ///< The number of executed commands of each type
+        uint64_t commandListsExecuted = 0;
+        uint64_t presents = 0;
+        uint64_t descriptorWrites = 0;      ///< Number of descriptors written into descriptor sets
+        uint64_t descriptorSetsCreated = 0;
+        uint64_t pipelineStatesCreated = 0; ///< Number of graphics and compute state objects created
+        uint64_t resourcesCreated = 0;      ///< Number of buffers and textures created, including the pages created by the resource allocator
+        uint64_t bufferBytesAllocated = 0;  ///< The size of the CPU memory allocated to back buffers
+
+        uint64_t getCommandCount(NullCommand command) const { return commands[(uint32_t)command]; }
+    };
+
+    /** Get the statistics collected since the last call to resetNullBackendStats()
+    */
+    NullBackendStats getNullBackendStats();
+
+    /** Reset the statistics
+    */
+    void resetNullBackendStats();
+
+    /** Base class for the objects created by the null backend. All the API handles derive from it, so that they can be passed to Device::releaseResource()
+    */
+    struct NullApiObject
+    {
+        using SharedPtr = std::shared_ptr<NullApiObject>;
+        virtual ~NullApiObject() = default;
+    };
+
+    /** A resource. Only buffers own memory
+    */
+    struct NullResource : public NullApiObject
+    {
+        using SharedPtr = std::shared_ptr<NullResource>;
+
+        /** Create a new resource
+            \param[in] size The size of the resource in bytes
+            \param[in] allocateMemory Whether to back the resource with CPU memory
+        */
+        static SharedPtr create(size_t size, bool allocateMemory);
+
+        size_t size = 0;
+        std::vector<uint8_t> data;
+    };
+
+    /** A command list. Commands are appended to it while recording and consumed when the list is executed
+    */
+    struct NullCommandList : public NullApiObject
+    {
+        using SharedPtr = std::shared_ptr<NullCommandList>;
+        void record(NullCommand command) { commands.push_back(command); }
+        std::vector<NullCommand> commands;
+    };
+
+    /** A command queue. Execution is synchronous - once execute() returns the commands are considered complete
+    */
+    struct NullCommandQueue : public NullApiObject
+    {
+        using SharedPtr = std::shared_ptr<NullCommandQueue>;
+        void execute(NullCommandList* pList);
+    };
+
+    /** A fence. Since queues execute synchronously, a signal completes as soon as it's issued
+    */
+    struct NullFence : public NullApiObject
+    {
+        using SharedPtr = std::shared_ptr<NullFence>;
+        std::atomic<uint64_t> completedValue{0};
+    };
+
+    /** A query heap. Timestamps are written when the query is recorded and hold the CPU time in nanoseconds
+    */
+    struct NullQueryHeap : public NullApiObject
+    {
+        using SharedPtr = std::shared_ptr<NullQueryHeap>;
+        void writeTimestamp(uint32_t index);
+        uint64_t getValue(uint32_t index);
+
+        std::mutex mutex;
+        std::vector<uint64_t> values; // Grows on demand. The heaps are allocated with a large query count, but only a few entries are ever used
+    };
+
+    /** A shader. The null backend doesn't compile shaders, it just stores the code generated by Slang
+    */
+    struct NullShader : public NullApiObject
+    {
+        using SharedPtr = std::shared_ptr<NullShader>;
+        std::vector<uint8_t> code;
+    };
+
+    /** A descriptor. Holds a pointer to the object the descriptor references, or nullptr for null descriptors
+    */
+    struct NullDescriptor
+    {
+        const NullApiObject* pObject = nullptr;
+    };
+
+    using ApiObjectHandle = NullApiObject::SharedPtr;
+
+    using HeapCpuHandle = NullDescriptor*;
+    using HeapGpuHandle = const NullDescriptor*;
+
+    class DescriptorHeapEntry;
+
+#ifdef _WIN32
+    using WindowHandle = HWND;
+#else
+    struct WindowHandle
+    {
+        void* pDisplay;
+        unsigned long window;
+    };
+#endif
+
+    using DeviceHandle = void*;
+    using CommandListHandle = NullCommandList::SharedPtr;
+    using CommandQueueHandle = NullCommandQueue::SharedPtr;
+    using ApiCommandQueueType = uint32_t;
+    using CommandAllocatorHandle = void*;
+    using CommandSignatureHandle = NullApiObject::SharedPtr;
+    using FenceHandle = NullFence::SharedPtr;
+    using ResourceHandle = NullResource::SharedPtr;
+    using RtvHandle = std::shared_ptr<DescriptorSet>;
+    using DsvHandle = std::shared_ptr<DescriptorSet>;
+    using SrvHandle = std::shared_ptr<DescriptorSet>;
+    using SamplerHandle = std::shared_ptr<DescriptorSet>;
+    using UavHandle = std::shared_ptr<DescriptorSet>;
+    using CbvHandle = std::shared_ptr<DescriptorSet>;
+    using FboHandle = void*;
+    using GpuAddress = uint64_t;
+    using QueryHeapHandle = NullQueryHeap::SharedPtr;
+
+    using GraphicsStateHandle = NullApiObject::SharedPtr;
+    using ComputeStateHandle = NullApiObject::SharedPtr;
+    using PipelineCacheHandle = NullApiObject::SharedPtr;
+    using ShaderHandle = NullShader::SharedPtr;
+    using ShaderReflectionHandle = void*;
+    using RootSignatureHandle = NullApiObject::SharedPtr;
+    using DescriptorHeapHandle = NullApiObject::SharedPtr;
+
+    using VaoHandle = void*;
+    using VertexShaderHandle = void*;
+    using FragmentShaderHandle = void*;
+    using DomainShaderHandle = void*;
+    using HullShaderHandle = void*;
+    using GeometryShaderHandle = void*;
+    using ComputeShaderHandle = void*;
+    using ProgramHandle = void*;
+    using DepthStencilStateHandle = void*;
+    using RasterizerStateHandle = void*;
+    using BlendStateHandle = void*;
+    using DescriptorSetApiHandle = void*;
+
+    static const uint32_t kDefaultSwapChainBuffers = 3;
+
+    inline constexpr uint32_t getMaxViewportCount() { return 16; }
+
+#define appendShaderExtension(_a)  _a ".hlsl"
+    /*! @} */
+}
+
+#define DEFAULT_API_MAJOR_VERSION 1
+#define DEFAULT_API_MINOR_VERSION 0
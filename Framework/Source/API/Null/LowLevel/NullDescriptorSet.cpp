@@ -0,0 +1,102 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/DescriptorSet.h"
+#include "NullDescriptorData.h"
+#include "API/Null/NullApiData.h"
+#include "API/Device.h"
+
+namespace Falcor
+{
+    bool DescriptorSet::apiInit()
+    {
+        mpApiData = std::make_shared<DescriptorSetApiData>();
+        uint32_t count = 0;
+        mpApiData->rangeBaseOffset.resize(mLayout.getRangeCount());
+
+        for (size_t i = 0; i < mLayout.getRangeCount(); i++)
+        {
+            mpApiData->rangeBaseOffset[i] = count;
+            count += mLayout.getRange(i).descCount;
+        }
+
+        mpApiData->descriptors.resize(count);
+        gEventCounter.numDescriptorTables++;
+        gNullBackendCounters.descriptorSetsCreated++;
+        return true;
+    }
+
+    DescriptorSet::CpuHandle DescriptorSet::getCpuHandle(uint32_t rangeIndex, uint32_t descInRange) const
+    {
+        uint32_t index = mpApiData->rangeBaseOffset[rangeIndex] + descInRange;
+        return &mpApiData->descriptors[index];
+    }
+
+    DescriptorSet::GpuHandle DescriptorSet::getGpuHandle(uint32_t rangeIndex, uint32_t descInRange) const
+    {
+        uint32_t index = mpApiData->rangeBaseOffset[rangeIndex] + descInRange;
+        return &mpApiData->descriptors[index];
+    }
+
+    static void setCpuHandle(DescriptorSet* pSet, uint32_t rangeIndex, uint32_t descIndex, const DescriptorSet::CpuHandle& handle)
+    {
+        *pSet->getCpuHandle(rangeIndex, descIndex) = *handle;
+        gNullBackendCounters.descriptorWrites++;
+    }
+
+    void DescriptorSet::setSrv(uint32_t rangeIndex, uint32_t descIndex, const ShaderResourceView* pSrv)
+    {
+        setCpuHandle(this, rangeIndex, descIndex, pSrv->getApiHandle()->getCpuHandle(0));
+    }
+
+    void DescriptorSet::setUav(uint32_t rangeIndex, uint32_t descIndex, const UnorderedAccessView* pUav)
+    {
+        setCpuHandle(this, rangeIndex, descIndex, pUav->getApiHandle()->getCpuHandle(0));
+    }
+
+    void DescriptorSet::setSampler(uint32_t rangeIndex, uint32_t descIndex, const Sampler* pSampler)
+    {
+        setCpuHandle(this, rangeIndex, descIndex, pSampler->getApiHandle()->getCpuHandle(0));
+    }
+
+    void DescriptorSet::bindForGraphics(CopyContext* pCtx, const RootSignature* pRootSig, uint32_t rootIndex)
+    {
+        gEventCounter.numSetRootDescriptorTableCalls++;
+        pCtx->getLowLevelData()->getCommandList()->record(NullCommand::SetDescriptorTable);
+    }
+
+    void DescriptorSet::bindForCompute(CopyContext* pCtx, const RootSignature* pRootSig, uint32_t rootIndex)
+    {
+        pCtx->getLowLevelData()->getCommandList()->record(NullCommand::SetDescriptorTable);
+    }
+
+    void DescriptorSet::setCbv(uint32_t rangeIndex, uint32_t descIndex, const ConstantBufferView::SharedPtr& pView)
+    {
+        setCpuHandle(this, rangeIndex, descIndex, pView->getApiHandle()->getCpuHandle(0));
+    }
+}
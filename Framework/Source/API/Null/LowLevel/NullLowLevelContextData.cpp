@@ -0,0 +1,66 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/LowLevel/LowLevelContextData.h"
+#include "API/Device.h"
+#include "API/Null/NullApiData.h"
+
+namespace Falcor
+{
+    LowLevelContextData::SharedPtr LowLevelContextData::create(CommandQueueType type, CommandQueueHandle queue)
+    {
+        SharedPtr pThis = SharedPtr(new LowLevelContextData);
+        pThis->mpFence = GpuFence::create();
+        pThis->mpQueue = queue;
+        pThis->mpApiData = new LowLevelContextApiData;
+        pThis->mpAllocator = nullptr;
+        pThis->mpList = std::make_shared<NullCommandList>();
+        return pThis;
+    }
+
+    LowLevelContextData::~LowLevelContextData()
+    {
+        safe_delete(mpApiData);
+    }
+
+    void LowLevelContextData::reset()
+    {
+        mpFence->gpuSignal(mpQueue);
+        mpList->commands.clear();
+        mpApiData->pGraphicsRootSig = nullptr;
+        mpApiData->pComputeRootSig = nullptr;
+    }
+
+    void LowLevelContextData::flush()
+    {
+        mpQueue->execute(mpList.get());
+        mpFence->gpuSignal(mpQueue);
+        mpApiData->pGraphicsRootSig = nullptr;
+        mpApiData->pComputeRootSig = nullptr;
+    }
+}
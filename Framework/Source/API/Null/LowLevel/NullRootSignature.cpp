@@ -0,0 +1,76 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/LowLevel/RootSignature.h"
+#include "API/Device.h"
+#include "API/Null/NullApiData.h"
+
+namespace Falcor
+{
+    bool RootSignature::apiInit()
+    {
+        // Use the D3D12 layout - each set is a descriptor table which costs a single DWORD
+        mSizeInBytes = 0;
+        mElementByteOffset.resize(mDesc.mSets.size());
+        for (size_t i = 0; i < mDesc.mSets.size(); i++)
+        {
+            mElementByteOffset[i] = mSizeInBytes;
+            mSizeInBytes += 4;
+        }
+
+        mApiHandle = std::make_shared<NullApiObject>();
+        return true;
+    }
+
+    template<bool forGraphics>
+    static void bindRootSigCommon(CopyContext* pCtx, const RootSignature::ApiHandle& rootSig)
+    {
+        // Same redundancy tracking as the D3D12 backend, so that the counters match
+        LowLevelContextApiData* pApiData = pCtx->getLowLevelData()->getApiData();
+        RootSignature::ApiHandle& pBound = forGraphics ? pApiData->pGraphicsRootSig : pApiData->pComputeRootSig;
+        if (pBound == rootSig) return;
+        pBound = rootSig;
+
+        if (forGraphics)
+        {
+            gEventCounter.numRootSignatureChanges++;
+        }
+        pCtx->getLowLevelData()->getCommandList()->record(NullCommand::SetRootSignature);
+    }
+
+    void RootSignature::bindForCompute(CopyContext* pCtx)
+    {
+        bindRootSigCommon<false>(pCtx, mApiHandle);
+    }
+
+    void RootSignature::bindForGraphics(CopyContext* pCtx)
+    {
+        gEventCounter.numRootSignatureBinds++;
+        bindRootSigCommon<true>(pCtx, mApiHandle);
+    }
+}
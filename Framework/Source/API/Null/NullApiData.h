@@ -0,0 +1,55 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <atomic>
+
+namespace Falcor
+{
+    struct LowLevelContextApiData
+    {
+        // The root signatures currently set on the command list. Used to skip redundant root signature changes, the same way the D3D12 backend does. Reset when the command list is reset
+        RootSignatureHandle pGraphicsRootSig;
+        RootSignatureHandle pComputeRootSig;
+    };
+
+    /** The counters backing getNullBackendStats(). Objects can be created and command lists executed from worker threads, hence the atomics
+    */
+    struct NullBackendCounters
+    {
+        std::atomic<uint64_t> commands[(uint32_t)NullCommand::Count];
+        std::atomic<uint64_t> commandListsExecuted;
+        std::atomic<uint64_t> presents;
+        std::atomic<uint64_t> descriptorWrites;
+        std::atomic<uint64_t> descriptorSetsCreated;
+        std::atomic<uint64_t> pipelineStatesCreated;
+        std::atomic<uint64_t> resourcesCreated;
+        std::atomic<uint64_t> bufferBytesAllocated;
+    };
+
+    extern NullBackendCounters gNullBackendCounters;
+}
@@ -0,0 +1,98 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/Buffer.h"
+#include "API/Device.h"
+#include "API/LowLevel/ResourceAllocator.h"
+
+namespace Falcor
+{
+    // Match the D3D12 placement rules, so that the allocator behaves the same as it does on the GPU backends
+    static const size_t kConstantBufferAlignment = 256;
+    static const size_t kDataPlacementAlignment = 512;
+
+    size_t getBufferDataAlignment(const Buffer* pBuffer)
+    {
+        const auto& bindFlags = pBuffer->getBindFlags();
+        if (is_set(bindFlags, Buffer::BindFlags::Constant)) return kConstantBufferAlignment;
+        if (is_set(bindFlags, Buffer::BindFlags::Index)) return sizeof(uint32_t);
+        return kDataPlacementAlignment;
+    }
+
+    void* mapBufferApi(const Buffer::ApiHandle& apiHandle, size_t size)
+    {
+        assert(size <= apiHandle->data.size());
+        return apiHandle->data.data();
+    }
+
+    bool Buffer::apiInit(bool hasInitData)
+    {
+        if (mBindFlags == BindFlags::Constant)
+        {
+            mSize = align_to(kConstantBufferAlignment, mSize);
+        }
+
+        if (mCpuAccess == CpuAccess::Write)
+        {
+            mState = Resource::State::GenericRead;
+            if (hasInitData == false) // Else the allocation will happen when updating the data
+            {
+                mDynamicData = gpDevice->getResourceAllocator()->allocate(mSize, getBufferDataAlignment(this));
+                mApiHandle = mDynamicData.pResourceHandle;
+            }
+        }
+        else
+        {
+            mState = (mCpuAccess == CpuAccess::Read && mBindFlags == BindFlags::None) ? Resource::State::CopyDest : Resource::State::Common;
+            mApiHandle = NullResource::create(mSize, true);
+        }
+
+        return true;
+    }
+
+    uint64_t Buffer::getGpuAddress() const
+    {
+        // There is no GPU address space. The address of the backing memory is unique, which is all the framework needs
+        return mDynamicData.offset + (uint64_t)mApiHandle->data.data();
+    }
+
+    void Buffer::unmap()
+    {
+    }
+
+    uint64_t Buffer::makeResident(Buffer::GpuAccessFlags flags) const
+    {
+        UNSUPPORTED_IN_NULL("Buffer::makeResident()");
+        return 0;
+    }
+
+    void Buffer::evict() const
+    {
+        UNSUPPORTED_IN_NULL("Buffer::evict()");
+    }
+}
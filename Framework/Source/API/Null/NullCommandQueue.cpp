@@ -0,0 +1,136 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/Null/NullApiData.h"
+#include <chrono>
+
+namespace Falcor
+{
+    NullBackendCounters gNullBackendCounters;
+
+    const char* to_string(NullCommand command)
+    {
+#define command_str(a_) case NullCommand::a_: return #a_;
+        switch (command)
+        {
+            command_str(Draw);
+            command_str(DrawIndirect);
+            command_str(Dispatch);
+            command_str(DispatchIndirect);
+            command_str(Clear);
+            command_str(Copy);
+            command_str(ResourceBarrier);
+            command_str(SetPipelineState);
+            command_str(SetRootSignature);
+            command_str(SetDescriptorTable);
+            command_str(SetRenderTargets);
+            command_str(SetVertexBuffers);
+            command_str(Blit);
+            command_str(Timestamp);
+        default:
+            should_not_get_here();
+            return "";
+        }
+#undef command_str
+    }
+
+    NullBackendStats getNullBackendStats()
+    {
+        const NullBackendCounters& c = gNullBackendCounters;
+        NullBackendStats stats;
+        for (uint32_t i = 0; i < (uint32_t)NullCommand::Count; i++)
+        {
+            stats.commands[i] = c.commands[i];
+        }
+        stats.commandListsExecuted = c.commandListsExecuted;
+        stats.presents = c.presents;
+        stats.descriptorWrites = c.descriptorWrites;
+        stats.descriptorSetsCreated = c.descriptorSetsCreated;
+        stats.pipelineStatesCreated = c.pipelineStatesCreated;
+        stats.resourcesCreated = c.resourcesCreated;
+        stats.bufferBytesAllocated = c.bufferBytesAllocated;
+        return stats;
+    }
+
+    void resetNullBackendStats()
+    {
+        NullBackendCounters& c = gNullBackendCounters;
+        for (auto& count : c.commands) count = 0;
+        c.commandListsExecuted = 0;
+        c.presents = 0;
+        c.descriptorWrites = 0;
+        c.descriptorSetsCreated = 0;
+        c.pipelineStatesCreated = 0;
+        c.resourcesCreated = 0;
+        c.bufferBytesAllocated = 0;
+    }
+
+    NullResource::SharedPtr NullResource::create(size_t size, bool allocateMemory)
+    {
+        SharedPtr pResource = std::make_shared<NullResource>();
+        pResource->size = size;
+        if (allocateMemory)
+        {
+            pResource->data.resize(size);
+            gNullBackendCounters.bufferBytesAllocated += size;
+        }
+        gNullBackendCounters.resourcesCreated++;
+        return pResource;
+    }
+
+    void NullCommandQueue::execute(NullCommandList* pList)
+    {
+        // Count locally first, so that we only touch the shared counters once per command type
+        uint64_t counts[(uint32_t)NullCommand::Count] = {};
+        for (NullCommand c : pList->commands)
+        {
+            counts[(uint32_t)c]++;
+        }
+
+        for (uint32_t i = 0; i < (uint32_t)NullCommand::Count; i++)
+        {
+            if (counts[i]) gNullBackendCounters.commands[i] += counts[i];
+        }
+        gNullBackendCounters.commandListsExecuted++;
+        pList->commands.clear();
+    }
+
+    void NullQueryHeap::writeTimestamp(uint32_t index)
+    {
+        uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (index >= values.size()) values.resize(index + 1);
+        values[index] = now;
+    }
+
+    uint64_t NullQueryHeap::getValue(uint32_t index)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return (index < values.size()) ? values[index] : 0;
+    }
+}
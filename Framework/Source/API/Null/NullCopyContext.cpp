@@ -0,0 +1,159 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/CopyContext.h"
+#include "API/Device.h"
+#include "API/Buffer.h"
+#include "API/Texture.h"
+#include <cstring>
+
+namespace Falcor
+{
+    void CopyContext::bindDescriptorHeaps()
+    {
+    }
+
+    static size_t getSubresourceSize(const Texture* pTexture, uint32_t subresource)
+    {
+        ResourceFormat format = pTexture->getFormat();
+        uint32_t mipLevel = pTexture->getSubresourceMipLevel(subresource);
+        uint32_t width = align_to(getFormatWidthCompressionRatio(format), pTexture->getWidth(mipLevel)) / getFormatWidthCompressionRatio(format);
+        uint32_t height = align_to(getFormatHeightCompressionRatio(format), pTexture->getHeight(mipLevel)) / getFormatHeightCompressionRatio(format);
+        return (size_t)width * height * pTexture->getDepth(mipLevel) * getFormatBytesPerBlock(format);
+    }
+
+    void CopyContext::updateTextureSubresources(const Texture* pTexture, uint32_t firstSubresource, uint32_t subresourceCount, const void* pData)
+    {
+        mCommandsPending = true;
+
+        uint32_t arraySize = (pTexture->getType() == Texture::Type::TextureCube) ? pTexture->getArraySize() * 6 : pTexture->getArraySize();
+        assert(firstSubresource + subresourceCount <= arraySize * pTexture->getMipCount());
+
+        size_t size = 0;
+        for (uint32_t s = 0; s < subresourceCount; s++)
+        {
+            size += getSubresourceSize(pTexture, firstSubresource + s);
+        }
+
+        // Stage the data the same way the GPU backends do, so that the CPU cost of uploads is accounted for. The texture itself doesn't store it
+        Buffer::SharedPtr pBuffer = Buffer::create(size, Buffer::BindFlags::None, Buffer::CpuAccess::Write, nullptr);
+        uint8_t* pDst = (uint8_t*)pBuffer->map(Buffer::MapType::WriteDiscard);
+        std::memcpy(pDst, pData, size);
+        pBuffer->unmap();
+
+        resourceBarrier(pTexture, Resource::State::CopyDest);
+        for (uint32_t s = 0; s < subresourceCount; s++)
+        {
+            mpLowLevelData->getCommandList()->record(NullCommand::Copy);
+        }
+    }
+
+    void CopyContext::updateTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex, const void* pData)
+    {
+        mCommandsPending = true;
+        updateTextureSubresources(pTexture, subresourceIndex, 1, pData);
+    }
+
+    CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex, const Buffer::SharedPtr& pStaging)
+    {
+        SharedPtr pThis = SharedPtr(new ReadTextureTask);
+        size_t size = getSubresourceSize(pTexture, subresourceIndex);
+
+        // Textures don't store their content, so the buffer will hold zeros
+        pThis->mpBuffer = (pStaging && pStaging->getSize() >= size) ? pStaging : Buffer::create(size, Buffer::BindFlags::None, Buffer::CpuAccess::Read, nullptr);
+        pCtx->resourceBarrier(pTexture, Resource::State::CopySource);
+        pCtx->getLowLevelData()->getCommandList()->record(NullCommand::Copy);
+        pCtx->setPendingCommands(true);
+        pCtx->flush(false);
+        pThis->mpFence = pCtx->getLowLevelData()->getFence();
+        pThis->mFenceValue = pThis->mpFence->getCpuValue() - 1;
+
+        ResourceFormat format = pTexture->getFormat();
+        uint32_t mipLevel = pTexture->getSubresourceMipLevel(subresourceIndex);
+        uint32_t perW = getFormatWidthCompressionRatio(format);
+        uint32_t perH = getFormatHeightCompressionRatio(format);
+        pThis->mRowSize = align_to(perW, pTexture->getWidth(mipLevel)) / perW * getFormatBytesPerBlock(format);
+        pThis->mRowPitch = pThis->mRowSize;
+        pThis->mRowCount = align_to(perH, pTexture->getHeight(mipLevel)) / perH;
+        pThis->mDepth = pTexture->getDepth(mipLevel);
+        return pThis;
+    }
+
+    void CopyContext::resourceBarrier(const Resource* pResource, Resource::State newState)
+    {
+        // If the resource is a buffer with CPU access, no need to do anything
+        const Buffer* pBuffer = dynamic_cast<const Buffer*>(pResource);
+        if (pBuffer && pBuffer->getCpuAccess() != Buffer::CpuAccess::None) return;
+
+        if (pResource->getState() != newState)
+        {
+            mpLowLevelData->getCommandList()->record(NullCommand::ResourceBarrier);
+            mCommandsPending = true;
+            pResource->mState = newState;
+        }
+    }
+
+    void CopyContext::copyResource(const Resource* pDst, const Resource* pSrc)
+    {
+        resourceBarrier(pDst, Resource::State::CopyDest);
+        resourceBarrier(pSrc, Resource::State::CopySource);
+
+        // Buffers own memory, so copy it. This keeps map() of read-back buffers consistent with the data that was uploaded
+        const Buffer* pDstBuffer = dynamic_cast<const Buffer*>(pDst);
+        const Buffer* pSrcBuffer = dynamic_cast<const Buffer*>(pSrc);
+        if (pDstBuffer && pSrcBuffer)
+        {
+            copyBufferRegion(pDstBuffer, 0, pSrcBuffer, 0, std::min(pDstBuffer->getSize(), pSrcBuffer->getSize()));
+            return;
+        }
+
+        mpLowLevelData->getCommandList()->record(NullCommand::Copy);
+        mCommandsPending = true;
+    }
+
+    void CopyContext::copySubresource(const Texture* pDst, uint32_t dstSubresourceIdx, const Texture* pSrc, uint32_t srcSubresourceIdx)
+    {
+        resourceBarrier(pDst, Resource::State::CopyDest);
+        resourceBarrier(pSrc, Resource::State::CopySource);
+        mpLowLevelData->getCommandList()->record(NullCommand::Copy);
+        mCommandsPending = true;
+    }
+
+    void CopyContext::copyBufferRegion(const Buffer* pDst, uint64_t dstOffset, const Buffer* pSrc, uint64_t srcOffset, uint64_t numBytes)
+    {
+        resourceBarrier(pDst, Resource::State::CopyDest);
+        resourceBarrier(pSrc, Resource::State::CopySource);
+
+        uint8_t* pDstData = pDst->getApiHandle()->data.data() + pDst->getGpuAddressOffset() + dstOffset;
+        const uint8_t* pSrcData = pSrc->getApiHandle()->data.data() + pSrc->getGpuAddressOffset() + srcOffset;
+        std::memcpy(pDstData, pSrcData, numBytes);
+
+        mpLowLevelData->getCommandList()->record(NullCommand::Copy);
+        mCommandsPending = true;
+    }
+}
@@ -0,0 +1,120 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/Device.h"
+#include "API/LowLevel/GpuFence.h"
+#include "API/Null/NullApiData.h"
+
+namespace Falcor
+{
+    struct DeviceApiData
+    {
+        std::vector<ResourceHandle> swapChainBuffers;
+    };
+
+    CommandQueueHandle Device::getCommandQueueHandle(LowLevelContextData::CommandQueueType type, uint32_t index) const
+    {
+        return mCmdQueues[(uint32_t)type][index];
+    }
+
+    ApiCommandQueueType Device::getApiCommandQueueType(LowLevelContextData::CommandQueueType type) const
+    {
+        return (ApiCommandQueueType)type;
+    }
+
+    bool Device::getApiFboData(uint32_t width, uint32_t height, ResourceFormat colorFormat, ResourceFormat depthFormat, std::vector<ResourceHandle>& apiHandles, uint32_t& currentBackBufferIndex)
+    {
+        mpApiData->swapChainBuffers.resize(mSwapChainBufferCount);
+        for (uint32_t i = 0; i < mSwapChainBufferCount; i++)
+        {
+            mpApiData->swapChainBuffers[i] = NullResource::create(width * height * getFormatBytesPerBlock(colorFormat), false);
+            apiHandles[i] = mpApiData->swapChainBuffers[i];
+        }
+        currentBackBufferIndex = 0;
+        return true;
+    }
+
+    void Device::destroyApiObjects()
+    {
+        safe_delete(mpApiData);
+        mpWindow.reset();
+    }
+
+    void Device::apiPresent()
+    {
+        gNullBackendCounters.presents++;
+        mCurrentBackBufferIndex = (mCurrentBackBufferIndex + 1) % mSwapChainBufferCount;
+    }
+
+    bool Device::apiInit(const Desc& desc)
+    {
+        mpApiData = new DeviceApiData;
+        mApiHandle = nullptr;
+
+        if (desc.enableVR)
+        {
+            logWarning("VR is not supported by the null backend. Frames will not be submitted to the HMD");
+        }
+
+        for (uint32_t i = 0; i < kQueueTypeCount; i++)
+        {
+            for (uint32_t j = 0; j < desc.cmdQueues[i]; j++)
+            {
+                mCmdQueues[i].push_back(std::make_shared<NullCommandQueue>());
+            }
+        }
+
+        // Timestamps are CPU times in nanoseconds
+        mGpuTimestampFrequency = 1.0e-6;
+
+        mpRenderContext = RenderContext::create(mCmdQueues[(uint32_t)LowLevelContextData::CommandQueueType::Direct][0]);
+        return createSwapChain(desc.colorFormat);
+    }
+
+    bool Device::createSwapChain(ResourceFormat colorFormat)
+    {
+        mpSwapChainFbos.resize(mSwapChainBufferCount);
+        return true;
+    }
+
+    void Device::apiResizeSwapChain(uint32_t width, uint32_t height, ResourceFormat colorFormat)
+    {
+        // The back-buffers are recreated by getApiFboData()
+        mpApiData->swapChainBuffers.clear();
+    }
+
+    bool Device::isWindowOccluded() const
+    {
+        return false;
+    }
+
+    bool Device::isExtensionSupported(const std::string& name) const
+    {
+        return false;
+    }
+}
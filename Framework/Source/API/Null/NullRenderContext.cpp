@@ -0,0 +1,192 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/RenderContext.h"
+#include "API/Device.h"
+#include "API/DescriptorSet.h"
+
+namespace Falcor
+{
+    RenderContext::~RenderContext()
+    {
+    }
+
+    RenderContext::SharedPtr RenderContext::create(CommandQueueHandle queue)
+    {
+        SharedPtr pCtx = SharedPtr(new RenderContext());
+        pCtx->mpLowLevelData = LowLevelContextData::create(LowLevelContextData::CommandQueueType::Direct, queue);
+        if (pCtx->mpLowLevelData == nullptr)
+        {
+            return nullptr;
+        }
+        return pCtx;
+    }
+
+    void RenderContext::clearRtv(const RenderTargetView* pRtv, const glm::vec4& color)
+    {
+        resourceBarrier(pRtv->getResource(), Resource::State::RenderTarget);
+        mpLowLevelData->getCommandList()->record(NullCommand::Clear);
+        mCommandsPending = true;
+    }
+
+    void RenderContext::clearDsv(const DepthStencilView* pDsv, float depth, uint8_t stencil, bool clearDepth, bool clearStencil)
+    {
+        resourceBarrier(pDsv->getResource(), Resource::State::DepthStencil);
+        mpLowLevelData->getCommandList()->record(NullCommand::Clear);
+        mCommandsPending = true;
+    }
+
+    static void NullSetVao(RenderContext* pCtx, CommandListHandle pList, const Vao* pVao)
+    {
+        if (pVao)
+        {
+            for (uint32_t i = 0; i < pVao->getVertexBuffersCount(); i++)
+            {
+                const Buffer* pVB = pVao->getVertexBuffer(i).get();
+                if (pVB)
+                {
+                    pCtx->resourceBarrier(pVB, Resource::State::VertexBuffer);
+                }
+            }
+
+            const Buffer* pIB = pVao->getIndexBuffer().get();
+            if (pIB)
+            {
+                pCtx->resourceBarrier(pIB, Resource::State::IndexBuffer);
+            }
+        }
+        pList->record(NullCommand::SetVertexBuffers);
+    }
+
+    static void NullSetFbo(RenderContext* pCtx, const Fbo* pFbo)
+    {
+        if (pFbo)
+        {
+            // Fetching the views matches the work the GPU backends do. The views are cached by the textures
+            for (uint32_t i = 0; i < Fbo::getMaxColorTargetCount(); i++)
+            {
+                auto& pTexture = pFbo->getColorTexture(i);
+                if (pTexture)
+                {
+                    pFbo->getRenderTargetView(i);
+                    pCtx->resourceBarrier(pTexture.get(), Resource::State::RenderTarget);
+                }
+            }
+
+            auto& pTexture = pFbo->getDepthStencilTexture();
+            if (pTexture)
+            {
+                pFbo->getDepthStencilView();
+                pCtx->resourceBarrier(pTexture.get(), Resource::State::DepthStencil);
+            }
+        }
+        pCtx->getLowLevelData()->getCommandList()->record(NullCommand::SetRenderTargets);
+    }
+
+    void RenderContext::prepareForDraw()
+    {
+        assert(mpGraphicsState);
+        // Vao must be valid so at least primitive topology is known
+        assert(mpGraphicsState->getVao().get());
+
+        // Apply the vars. Must be first because applyGraphicsVars() might cause a flush
+        if (mpGraphicsVars)
+        {
+            applyGraphicsVars();
+        }
+        else
+        {
+            RootSignature::getEmpty()->bindForGraphics(this);
+        }
+        mBindGraphicsRootSig = false;
+
+        CommandListHandle pList = mpLowLevelData->getCommandList();
+        NullSetVao(this, pList, mpGraphicsState->getVao().get());
+        NullSetFbo(this, mpGraphicsState->getFbo().get());
+        mpGraphicsState->getGSO(mpGraphicsVars.get());
+        pList->record(NullCommand::SetPipelineState);
+        mCommandsPending = true;
+    }
+
+    void RenderContext::drawInstanced(uint32_t vertexCount, uint32_t instanceCount, uint32_t startVertexLocation, uint32_t startInstanceLocation)
+    {
+        prepareForDraw();
+        gEventCounter.numDrawCalls++;
+        mpLowLevelData->getCommandList()->record(NullCommand::Draw);
+    }
+
+    void RenderContext::draw(uint32_t vertexCount, uint32_t startVertexLocation)
+    {
+        drawInstanced(vertexCount, 1, startVertexLocation, 0);
+    }
+
+    void RenderContext::drawIndexedInstanced(uint32_t indexCount, uint32_t instanceCount, uint32_t startIndexLocation, int32_t baseVertexLocation, uint32_t startInstanceLocation)
+    {
+        prepareForDraw();
+        gEventCounter.numDrawCalls++;
+        mpLowLevelData->getCommandList()->record(NullCommand::Draw);
+    }
+
+    void RenderContext::drawIndexed(uint32_t indexCount, uint32_t startIndexLocation, int32_t baseVertexLocation)
+    {
+        drawIndexedInstanced(indexCount, 1, startIndexLocation, baseVertexLocation, 0);
+    }
+
+    void RenderContext::drawIndirect(const Buffer* argBuffer, uint64_t argBufferOffset)
+    {
+        prepareForDraw();
+        resourceBarrier(argBuffer, Resource::State::IndirectArg);
+        gEventCounter.numDrawCalls++;
+        mpLowLevelData->getCommandList()->record(NullCommand::DrawIndirect);
+    }
+
+    void RenderContext::drawIndexedIndirect(const Buffer* argBuffer, uint64_t argBufferOffset)
+    {
+        prepareForDraw();
+        resourceBarrier(argBuffer, Resource::State::IndirectArg);
+        gEventCounter.numDrawCalls++;
+        mpLowLevelData->getCommandList()->record(NullCommand::DrawIndirect);
+    }
+
+    void RenderContext::initDrawCommandSignatures()
+    {
+        spDrawCommandSig = std::make_shared<NullApiObject>();
+        spDrawIndexCommandSig = std::make_shared<NullApiObject>();
+    }
+
+    void RenderContext::blit(ShaderResourceView::SharedPtr pSrc, RenderTargetView::SharedPtr pDst, const uvec4& srcRect, const uvec4& dstRect, Sampler::Filter filter)
+    {
+        // There are no pixels to filter, so skip the full-screen pass and only record the blit
+        assert(pSrc->getViewInfo().arraySize == 1 && pSrc->getViewInfo().mipCount == 1);
+        assert(pDst->getViewInfo().arraySize == 1 && pDst->getViewInfo().mipCount == 1);
+        resourceBarrier(pSrc->getResource(), Resource::State::ShaderResource);
+        resourceBarrier(pDst->getResource(), Resource::State::RenderTarget);
+        mpLowLevelData->getCommandList()->record(NullCommand::Blit);
+        mCommandsPending = true;
+    }
+}
@@ -0,0 +1,132 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/ResourceViews.h"
+#include "API/Resource.h"
+#include "API/Device.h"
+#include "API/DescriptorSet.h"
+#include "API/Null/NullApiData.h"
+
+namespace Falcor
+{
+    template<typename T>
+    ResourceView<T>::~ResourceView() = default;
+
+    ResourceWeakPtr getEmptyTexture()
+    {
+        return ResourceWeakPtr();
+    }
+
+    // Views are single-descriptor sets allocated from the CPU pool, like in the D3D12 backend. The descriptor references the resource, or nothing for null views
+    static std::shared_ptr<DescriptorSet> createViewDescriptor(DescriptorSet::Type type, const Resource* pResource)
+    {
+        DescriptorSet::Layout layout;
+        layout.addRange(type, 0, 1);
+        std::shared_ptr<DescriptorSet> pSet = DescriptorSet::create(gpDevice->getCpuDescriptorPool(), layout);
+        pSet->getCpuHandle(0)->pObject = pResource ? pResource->getApiHandle().get() : nullptr;
+        gNullBackendCounters.descriptorWrites++;
+        return pSet;
+    }
+
+    ShaderResourceView::SharedPtr ShaderResourceView::create(ResourceWeakPtr pResource, uint32_t mostDetailedMip, uint32_t mipCount, uint32_t firstArraySlice, uint32_t arraySize)
+    {
+        Resource::SharedConstPtr pSharedPtr = pResource.lock();
+        if (!pSharedPtr && sNullView)
+        {
+            return sNullView;
+        }
+
+        SharedPtr pNewObj;
+        SharedPtr& pObj = pSharedPtr ? pNewObj : sNullView;
+        ApiHandle handle = createViewDescriptor(DescriptorSet::Type::TextureSrv, pSharedPtr.get());
+        pObj = SharedPtr(new ShaderResourceView(pResource, handle, mostDetailedMip, mipCount, firstArraySlice, arraySize));
+        return pObj;
+    }
+
+    DepthStencilView::SharedPtr DepthStencilView::create(ResourceWeakPtr pResource, uint32_t mipLevel, uint32_t firstArraySlice, uint32_t arraySize)
+    {
+        Resource::SharedConstPtr pSharedPtr = pResource.lock();
+        if (!pSharedPtr && sNullView)
+        {
+            return sNullView;
+        }
+
+        SharedPtr pNewObj;
+        SharedPtr& pObj = pSharedPtr ? pNewObj : sNullView;
+        ApiHandle handle = createViewDescriptor(DescriptorSet::Type::Dsv, pSharedPtr.get());
+        pObj = SharedPtr(new DepthStencilView(pResource, handle, mipLevel, firstArraySlice, arraySize));
+        return pObj;
+    }
+
+    UnorderedAccessView::SharedPtr UnorderedAccessView::create(ResourceWeakPtr pResource, uint32_t mipLevel, uint32_t firstArraySlice, uint32_t arraySize)
+    {
+        Resource::SharedConstPtr pSharedPtr = pResource.lock();
+        if (!pSharedPtr && sNullView)
+        {
+            return sNullView;
+        }
+
+        SharedPtr pNewObj;
+        SharedPtr& pObj = pSharedPtr ? pNewObj : sNullView;
+        ApiHandle handle = createViewDescriptor(DescriptorSet::Type::TextureUav, pSharedPtr.get());
+        pObj = SharedPtr(new UnorderedAccessView(pResource, handle, mipLevel, firstArraySlice, arraySize));
+        return pObj;
+    }
+
+    RenderTargetView::~RenderTargetView() = default;
+
+    RenderTargetView::SharedPtr RenderTargetView::create(ResourceWeakPtr pResource, uint32_t mipLevel, uint32_t firstArraySlice, uint32_t arraySize)
+    {
+        Resource::SharedConstPtr pSharedPtr = pResource.lock();
+        if (!pSharedPtr && sNullView)
+        {
+            return sNullView;
+        }
+
+        SharedPtr pNewObj;
+        SharedPtr& pObj = pSharedPtr ? pNewObj : sNullView;
+        ApiHandle handle = createViewDescriptor(DescriptorSet::Type::Rtv, pSharedPtr.get());
+        pObj = SharedPtr(new RenderTargetView(pResource, handle, mipLevel, firstArraySlice, arraySize));
+        return pObj;
+    }
+
+    ConstantBufferView::SharedPtr ConstantBufferView::create(ResourceWeakPtr pResource)
+    {
+        Resource::SharedConstPtr pSharedPtr = pResource.lock();
+        if (!pSharedPtr && sNullView)
+        {
+            return sNullView;
+        }
+
+        SharedPtr pNewObj;
+        SharedPtr& pObj = pSharedPtr ? pNewObj : sNullView;
+        ApiHandle handle = createViewDescriptor(DescriptorSet::Type::Cbv, pSharedPtr.get());
+        pObj = SharedPtr(new ConstantBufferView(pResource, handle));
+        return pObj;
+    }
+}
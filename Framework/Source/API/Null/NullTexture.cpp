@@ -0,0 +1,57 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "API/Texture.h"
+#include "API/Device.h"
+
+namespace Falcor
+{
+    void Texture::apinit(const void* pData, bool autoGenMips)
+    {
+        // Textures are not backed by memory, but we still track their size
+        uint32_t arraySize = (mType == Texture::Type::TextureCube) ? mArraySize * 6 : mArraySize;
+        size_t size = 0;
+        for (uint32_t mip = 0; mip < mMipLevels; mip++)
+        {
+            uint32_t width = align_to(getFormatWidthCompressionRatio(mFormat), getWidth(mip)) / getFormatWidthCompressionRatio(mFormat);
+            uint32_t height = align_to(getFormatHeightCompressionRatio(mFormat), getHeight(mip)) / getFormatHeightCompressionRatio(mFormat);
+            size += (size_t)width * height * getDepth(mip) * getFormatBytesPerBlock(mFormat);
+        }
+        mApiHandle = NullResource::create(size * arraySize * mSampleCount, false);
+
+        if (pData)
+        {
+            uploadInitData(pData, autoGenMips);
+        }
+    }
+
+    Texture::~Texture()
+    {
+        gpDevice->releaseResource(mApiHandle);
+    }
+}
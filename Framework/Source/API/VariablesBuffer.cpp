@@ -33,6 +33,7 @@
 #include "Texture.h"
 #include "Graphics/Program/ProgramReflection.h"
 #include "API/Device.h"
+#include <algorithm>
 #include <cstring>
 
 namespace Falcor
@@ -85,6 +86,7 @@ namespace Falcor
     {
         Buffer::apiInit(false);
         mData.assign(mSize, 0);
+        markDirty(0, mSize);
     }
 
     size_t VariablesBuffer::getVariableOffset(const std::string& varName) const
@@ -95,7 +97,7 @@ namespace Falcor
 
     bool VariablesBuffer::uploadToGPU(size_t offset, size_t size)
     {
-        if(mDirty == false)
+        if(mDirtyRanges.empty())
         {
             return false;
         }
@@ -111,9 +113,67 @@ namespace Falcor
             return false;
         }
 
-        updateData(mData.data(), offset, size);
-        mDirty = false;
-        return true;
+        size_t uploadedBytes = 0;
+        if (mCpuAccess == CpuAccess::Write)
+        {
+            // The buffer is mapped with write-discard, which allocates new memory on every update. We have to provide the entire range.
+            updateData(mData.data(), offset, size);
+            uploadedBytes = size;
+        }
+        else
+        {
+            const size_t end = offset + size;
+            for (const auto& range : mDirtyRanges)
+            {
+                size_t rangeBegin = std::max(range.begin, offset);
+                size_t rangeEnd = std::min(range.end, end);
+                if (rangeBegin < rangeEnd)
+                {
+                    updateData(mData.data() + rangeBegin, rangeBegin, rangeEnd - rangeBegin);
+                    uploadedBytes += rangeEnd - rangeBegin;
+                }
+            }
+        }
+        mDirtyRanges.clear();
+
+        gEventCounter.numBufferUploads++;
+        gEventCounter.numBufferUploadBytes += (int)uploadedBytes;
+        return uploadedBytes != 0;
+    }
+
+    void VariablesBuffer::markDirty(size_t offset, size_t size)
+    {
+        if (size == 0) return;
+        size_t begin = offset;
+        size_t end = offset + size;
+
+        // Find the first range which is close enough to merge with, then absorb all the ranges which start before the end of the new one
+        auto first = std::lower_bound(mDirtyRanges.begin(), mDirtyRanges.end(), begin, [](const DirtyRange& r, size_t b) { return r.end + kDirtyRangeMergeDistance < b; });
+        auto last = first;
+        while (last != mDirtyRanges.end() && last->begin <= end + kDirtyRangeMergeDistance)
+        {
+            begin = std::min(begin, last->begin);
+            end = std::max(end, last->end);
+            last++;
+        }
+
+        if (first == last)
+        {
+            mDirtyRanges.insert(first, DirtyRange{ begin, end });
+        }
+        else
+        {
+            *first = DirtyRange{ begin, end };
+            mDirtyRanges.erase(first + 1, last);
+        }
+    }
+
+    void VariablesBuffer::writeData(const void* pSrc, size_t offset, size_t size)
+    {
+        uint8_t* pDst = mData.data() + offset;
+        if (mCpuAccess == CpuAccess::Write && std::memcmp(pDst, pSrc, size) == 0) return;
+        std::memcpy(pDst, pSrc, size);
+        markDirty(offset, size);
     }
 
     template<typename VarType>
@@ -175,9 +235,7 @@ namespace Falcor
         verify_element_index();
         if(checkVariableByOffset<VarType>(offset, 0, mpReflector.get()))
         {
-            const uint8_t* pVar = mData.data() + offset + elementIndex * mElementSize;
-            *(VarType*)pVar = value;
-            mDirty = true;
+            writeData(&value, offset + elementIndex * mElementSize, sizeof(VarType));
         }
     }
 
@@ -271,13 +329,7 @@ namespace Falcor
         verify_element_index();
         if(checkVariableByOffset<VarType>(offset, count, mpReflector.get()))
         {
-            const uint8_t* pVar = mData.data() + offset;
-            VarType* pData = (VarType*)pVar + elementIndex * mElementSize;
-            for(size_t i = 0; i < count; i++)
-            {
-                pData[i] = pValue[i];
-            }
-            mDirty = true;
+            writeData(pValue, offset + elementIndex * mElementSize, sizeof(VarType) * count);
         }
     }
 
@@ -390,7 +442,6 @@ namespace Falcor
             logError(Msg);
             return;
         }
-        std::memcpy(mData.data() + offset, pSrc, size);
-        mDirty = true;
+        writeData(pSrc, offset, size);
     }
 }
@@ -54,12 +54,18 @@ namespace Falcor
         virtual ~VariablesBuffer() = 0;
 
         /** Apply the changes to the actual GPU buffer.
+            Only the ranges which were modified since the last upload are copied. Buffers with CpuAccess::Write are renamed on every update, so for them the entire requested range is uploaded if anything changed.
             Note that it is possible to use this function to update only part of the GPU copy of the buffer. This might lead to inconsistencies between the GPU and CPU buffer, so make sure you know what you are doing.
             \param[in] offset Offset into the buffer to write to
             \param[in] size Number of bytes to upload. If this value is -1, will update the [Offset, EndOfBuffer] range.
+            \return true if data was uploaded, false if the range was not modified or the call was ignored
         */
         virtual bool uploadToGPU(size_t offset = 0, size_t size = -1);
 
+        /** Check if the CPU copy was modified since the last upload
+        */
+        bool isDirty() const { return mDirtyRanges.empty() == false; }
+
         /** Get the reflection object describing the CB
         */
         ReflectionType::SharedConstPtr getBufferReflector() const { return mpReflector; }
@@ -72,6 +78,19 @@ namespace Falcor
         */
         void setBlob(const void* pSrc, size_t offset, size_t size);
 
+        /** Set a variable into the buffer without validating it against the reflection data.
+            This is the fast path for per-draw updates. Resolve the offset once using getVariableOffset() and reuse it, instead of paying for the name lookup and type check on every call.
+            The range is only checked by an assert in debug builds.
+            \param[in] offset The variable byte offset inside the buffer
+            \param[in] value Value to set
+        */
+        template<typename T>
+        void setVariableUnchecked(size_t offset, const T& value)
+        {
+            assert(offset + sizeof(T) <= mSize);
+            writeData(&value, offset, sizeof(T));
+        }
+
         /** Get a variable offset inside the buffer. See notes about naming in the VariablesBuffer class description. Constant name can be provided with an implicit array-index, similar to VariablesBuffer#SetVariableArray.
         */
         size_t getVariableOffset(const std::string& varName) const;
@@ -93,9 +112,25 @@ namespace Falcor
         template<typename T>
         void setVariableArray(const std::string& name, size_t elementIndex, const T* pValue, size_t count);
 
+        /** Copy data into the CPU copy of the buffer and mark the range as dirty.
+            Buffers with CpuAccess::Write can't be written by the GPU, so writes which don't change the data are dropped.
+        */
+        void writeData(const void* pSrc, size_t offset, size_t size);
+
+        /** Add a range to the dirty list. Ranges closer than kDirtyRangeMergeDistance are coalesced, since one larger copy is cheaper than many small ones.
+        */
+        void markDirty(size_t offset, size_t size);
+
+        struct DirtyRange
+        {
+            size_t begin;
+            size_t end;
+        };
+        static const size_t kDirtyRangeMergeDistance = 256;
+
         ReflectionResourceType::SharedConstPtr mpReflector;
         std::vector<uint8_t> mData;
-        mutable bool mDirty = true;
+        std::vector<DirtyRange> mDirtyRanges;   ///< Sorted, non-overlapping list of ranges which were modified since the last upload
         size_t mElementCount;
         size_t mElementSize;
         std::string mName;
@@ -104,6 +104,7 @@ namespace Falcor
 
     using GraphicsStateHandle = VkHandle<VkPipeline>::SharedPtr;
     using ComputeStateHandle = VkHandle<VkPipeline>::SharedPtr;
+    using PipelineCacheHandle = void*;
     using ShaderHandle = VkHandle<VkShaderModule>::SharedPtr;
     using ShaderReflectionHandle = void*;
     using RootSignatureHandle = VkRootSignature::SharedPtr;
@@ -229,6 +229,23 @@ namespace Falcor
         releaseSemaphores(mpApiData);  // Call this after popping the fences
     }
 
+    void GpuFence::syncCpu(uint64_t value)
+    {
+        assert(value < mCpuValue);
+        // Each active fence signals the next value, so we only need to wait for the ones up to the requested value
+        uint64_t gpuVal = getGpuValue();
+        if (gpuVal >= value) return;
+
+        auto& activeFences = mpApiData->fenceQueue.getActiveObjects();
+        size_t count = (size_t)(value - gpuVal);
+        assert(count <= activeFences.size());
+        std::vector<VkFence> fenceVec(activeFences.begin(), activeFences.begin() + count);
+        vk_call(vkWaitForFences(gpDevice->getApiHandle(), (uint32_t)fenceVec.size(), fenceVec.data(), true, UINT64_MAX));
+        mpApiData->gpuValue += fenceVec.size();
+        mpApiData->fenceQueue.popFront(count);
+        releaseSemaphores(mpApiData);
+    }
+
     uint64_t GpuFence::getGpuValue() const
     {
         auto& activeFences = mpApiData->fenceQueue.getActiveObjects();
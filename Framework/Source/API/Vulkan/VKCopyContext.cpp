@@ -191,8 +191,8 @@ namespace Falcor
         uint32_t mipLevel = pTexture->getSubresourceMipLevel(subresourceIndex);
         dataSize = getMipLevelPackedDataSize(pTexture, mipLevel);
 
-        // Upload the data to a staging buffer
-        pStaging = Buffer::create(dataSize, Buffer::BindFlags::None, pSrcData ? Buffer::CpuAccess::Write : Buffer::CpuAccess::Read, pSrcData);
+        // Upload the data to a staging buffer. Readbacks can provide a buffer to recycle
+        if (pStaging == nullptr || pSrcData) pStaging = Buffer::create(dataSize, Buffer::BindFlags::None, pSrcData ? Buffer::CpuAccess::Write : Buffer::CpuAccess::Read, pSrcData);
 
         vkCopy = {};
         vkCopy.bufferOffset = pStaging->getGpuAddressOffset();
@@ -221,27 +221,37 @@ namespace Falcor
         vkCmdCopyBufferToImage(mpLowLevelData->getCommandList(), pStaging->getApiHandle(), pTexture->getApiHandle(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &vkCopy);
     }
 
-    std::vector<uint8> CopyContext::readTextureSubresource(const Texture* pTexture, uint32_t subresourceIndex)
+    CopyContext::ReadTextureTask::SharedPtr CopyContext::ReadTextureTask::create(CopyContext* pCtx, const Texture* pTexture, uint32_t subresourceIndex, const Buffer::SharedPtr& pStaging)
     {
-        mCommandsPending = true;
+        SharedPtr pThis = SharedPtr(new ReadTextureTask);
         VkBufferImageCopy vkCopy;
-        Buffer::SharedPtr pStaging;
         size_t dataSize = 0;
-        initTexAccessParams(pTexture, subresourceIndex, vkCopy, pStaging, nullptr, dataSize);
+        if (pStaging && pStaging->getSize() >= getMipLevelPackedDataSize(pTexture, pTexture->getSubresourceMipLevel(subresourceIndex)))
+        {
+            pThis->mpBuffer = pStaging;
+        }
+        initTexAccessParams(pTexture, subresourceIndex, vkCopy, pThis->mpBuffer, nullptr, dataSize);
 
         // Execute the copy
-        resourceBarrier(pTexture, Resource::State::CopySource);
-        resourceBarrier(pStaging.get(), Resource::State::CopyDest);
-        vkCmdCopyImageToBuffer(mpLowLevelData->getCommandList(), pTexture->getApiHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, pStaging->getApiHandle(), 1, &vkCopy);
+        pCtx->resourceBarrier(pTexture, Resource::State::CopySource);
+        pCtx->resourceBarrier(pThis->mpBuffer.get(), Resource::State::CopyDest);
+        vkCmdCopyImageToBuffer(pCtx->getLowLevelData()->getCommandList(), pTexture->getApiHandle(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, pThis->mpBuffer->getApiHandle(), 1, &vkCopy);
+        pCtx->setPendingCommands(true);
 
-        flush(true);
+        // Submit the copy. The fence value will be signaled once the GPU is done with it
+        pCtx->flush(false);
+        pThis->mpFence = pCtx->getLowLevelData()->getFence();
+        pThis->mFenceValue = pThis->mpFence->getCpuValue() - 1;
 
-        // Map and read the results
-        std::vector<uint8> result(dataSize);
-        uint8* pData = reinterpret_cast<uint8*>(pStaging->map(Buffer::MapType::Read));
-        std::memcpy(result.data(), pData, dataSize);
-
-        return result;
+        // The data is tightly packed
+        ResourceFormat format = pTexture->getFormat();
+        uint32_t perW = getFormatWidthCompressionRatio(format);
+        uint32_t perH = getFormatHeightCompressionRatio(format);
+        pThis->mRowSize = align_to(perW, vkCopy.imageExtent.width) / perW * getFormatBytesPerBlock(format);
+        pThis->mRowPitch = pThis->mRowSize;
+        pThis->mRowCount = align_to(perH, vkCopy.imageExtent.height) / perH;
+        pThis->mDepth = vkCopy.imageExtent.depth;
+        return pThis;
     }
 
     void CopyContext::resourceBarrier(const Resource* pResource, Resource::State newState)
@@ -34,7 +34,7 @@
 
 namespace Falcor
 {
-    bool GraphicsStateObject::apiInit()
+    bool GraphicsStateObject::apiInit(const PipelineCacheHandle& pCache)
     {
         // Shader Stages
         std::vector<VkPipelineShaderStageCreateInfo> shaderStageInfos;
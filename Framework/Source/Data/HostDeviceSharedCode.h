@@ -171,6 +171,21 @@ struct PreparedMaterialData
     MaterialValues  values;
 };
 
+/**
+    An entry of the scene material table. The textures and the sampler are indices into the table's descriptor arrays
+*/
+struct MaterialTableEntry
+{
+    MaterialDesc    desc;
+    MaterialValues  values;
+    uint32_t        layerTextures[MatMaxLayers];    ///< MatInvalidIndex if the layer has no texture
+    uint32_t        normalMap;
+    uint32_t        alphaMap;
+    uint32_t        heightMap;
+    uint32_t        ambientMap;
+    uint32_t        samplerIndex;
+};
+
 /**
     The structure stores the complete information about the shading point,
     except for a light source information.
@@ -238,6 +253,20 @@ struct LightData
     */
 };
 
+/**
+    Parameters of the light cluster grid. See ClusteredLights
+*/
+struct LightClusterData
+{
+    uint32_t        gridSizeX          DEFAULTS(16);              ///< Number of clusters along the screen X axis
+    uint32_t        gridSizeY          DEFAULTS(9);               ///< Number of clusters along the screen Y axis
+    uint32_t        gridSizeZ          DEFAULTS(24);              ///< Number of depth slices
+    uint32_t        lightCount         DEFAULTS(0);               ///< Number of lights in the clustered light buffer
+    float           depthSliceScale    DEFAULTS(0.f);             ///< The depth slice of view-space depth d is log(d) * depthSliceScale + depthSliceBias
+    float           depthSliceBias     DEFAULTS(0.f);
+    float2          pad;
+};
+
 /*******************************************************************
                     Shared material routines
 *******************************************************************/
@@ -427,6 +456,8 @@ static_assert((sizeof(MaterialLayerValues) % sizeof(float4)) == 0, "MaterialLaye
 static_assert((sizeof(MaterialDesc) % sizeof(float4)) == 0, "MaterialDesc has a wrong size");
 static_assert((sizeof(MaterialValues) % sizeof(float4)) == 0, "MaterialValues has a wrong size");
 static_assert((sizeof(MaterialData) % sizeof(float4)) == 0, "MaterialData has a wrong size");
+static_assert((sizeof(LightClusterData) % sizeof(float4)) == 0, "LightClusterData has a wrong size");
+static_assert((sizeof(MaterialTableEntry) % sizeof(float4)) == 0, "MaterialTableEntry has a wrong size");
 #undef SamplerState
 #undef Texture2D
 } // namespace Falcor
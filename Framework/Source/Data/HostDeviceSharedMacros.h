@@ -126,6 +126,12 @@
 */
 #define     MatMaxLayers    3
 
+/** Limits of the scene material table (see MaterialTable). MatInvalidIndex marks a texture slot without a texture
+*/
+#define     MatInvalidIndex                 0xFFFFFFFF
+#define     MAX_MATERIAL_TABLE_TEXTURES     1024
+#define     MAX_MATERIAL_TABLE_SAMPLERS     16
+
 #define ROUGHNESS_CHANNEL_BIT 2
 
 #endif //_HOST_DEVICE_SHARED_MACROS_H
@@ -47,6 +47,7 @@
 #include "API/Formats.h"
 #include "API/GpuTimer.h"
 #include "API/GraphicsStateObject.h"
+#include "API/GsoCache.h"
 #include "API/RasterizerState.h"
 #include "API/RenderContext.h"
 #include "API/Sampler.h"
@@ -62,13 +63,14 @@
 #include "API/ComputeContext.h"
 #include "API/QueryHeap.h"
 
-#if defined FALCOR_D3D12 || defined FALCOR_VK
+#if defined FALCOR_D3D12 || defined FALCOR_VK || defined FALCOR_NULL
 #include "API/DescriptorSet.h"
 #include "API/LowLevel/DescriptorPool.h"
+#include "API/LowLevel/DescriptorSetCache.h"
 #include "API/LowLevel/FencedPool.h"
 #include "API/LowLevel/GpuFence.h"
 #include "API/LowLevel/RootSignature.h"
-#endif //FALCOR_D3D12 || defined FALCOR_VK
+#endif //FALCOR_D3D12 || defined FALCOR_VK || defined FALCOR_NULL
 
 // Graphics
 #include "Graphics/Camera/Camera.h"
@@ -79,9 +81,11 @@
 #include "Graphics/Light.h"
 #include "Graphics/FboHelper.h"
 #include "Graphics/ComputeState.h"
+#include "Graphics/ClusteredLights.h"
 
 // Program
 #include "Graphics/Program/ProgramReflection.h"
+#include "Graphics/Program/FlatReflection.h"
 #include "Graphics/Program/ProgramVars.h"
 #include "Graphics/Program/ProgramVersion.h"
 #include "Graphics/Program/Program.h"
@@ -94,6 +98,7 @@
 #include "Graphics/Material/BasicMaterial.h"
 #include "Graphics/Material/MaterialSystem.h"
 #include "Graphics/Material/MaterialEditor.h"
+#include "Graphics/Material/MaterialTable.h"
 
 // Model
 #include "Graphics/Model/Mesh.h"
@@ -103,8 +108,12 @@
 // Scene
 #include "Graphics/Scene/Scene.h"
 #include "Graphics/Scene/SceneRenderer.h"
+#include "Graphics/Scene/ParallelSceneRenderer.h"
 #include "Graphics/Scene/Editor/SceneEditor.h"
 #include "Graphics/Scene/SceneUtils.h"
+#include "Graphics/Scene/TransformHierarchy.h"
+#include "Graphics/Scene/SceneChangeSet.h"
+#include "Graphics/Scene/BinarySceneFile.h"
 
 
 // Math
@@ -120,16 +129,22 @@
 #include "Utils/Logger.h"
 #include "Utils/TextRenderer.h"
 #include "Utils/CpuTimer.h"
+#include "Utils/TimingHistogram.h"
+#include "Utils/BoundsTree.h"
 #include "Utils/UserInput.h"
 #include "Utils/Profiler.h"
 #include "Utils/StringUtils.h"
 #include "Utils/BinaryFileStream.h"
 #include "Utils/Video/VideoEncoder.h"
 #include "Utils/Video/VideoEncoderUI.h"
+#include "Utils/Video/VideoCapture.h"
 #include "Utils/Video/VideoDecoder.h"
 #include "Utils/Platform/OS.h"
 #include "Utils/Platform/ProgressBar.h"
 #include "Utils/ThreadPool.h"
+#include "Utils/Threading.h"
+#include "Utils/AsyncFileWriter.h"
+#include "Utils/ImageExporter.h"
 
 // VR
 #include "VR/OpenVR/VRSystem.h"
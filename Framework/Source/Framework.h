@@ -190,11 +190,13 @@ namespace Falcor
 #include "API/D3D12/FalcorD3D12.h"
 #elif defined(FALCOR_VK)
 #include "API/Vulkan/FalcorVK.h"
+#elif defined(FALCOR_NULL)
+#include "API/Null/FalcorNull.h"
 #else
 #error Undefined falcor backend. Make sure that a backend is selected in "FalcorConfig.h"
 #endif
 
-#if defined(FALCOR_D3D12) || defined(FALCOR_VK)
+#if defined(FALCOR_D3D12) || defined(FALCOR_VK) || defined(FALCOR_NULL)
 #define FALCOR_LOW_LEVEL_API
 #endif
 
@@ -0,0 +1,463 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ClusteredLights.h"
+#include "Graphics/Scene/Scene.h"
+#include "Graphics/Camera/Camera.h"
+#include "Graphics/Program/ProgramVars.h"
+#include "Utils/Gui.h"
+#include "Utils/CpuTimer.h"
+#include "Utils/Threading.h"
+#include <cfloat>
+#include <cstring>
+#include <emmintrin.h>
+
+namespace Falcor
+{
+    static const char* kClusterCbName = "LightClustersCB";
+    static const char* kLightBufferName = "gClusteredLights";
+    static const char* kRangeBufferName = "gLightClusterRanges";
+    static const char* kIndexBufferName = "gLightClusterIndices";
+
+    namespace
+    {
+        // Four lights in SoA layout, so that the cluster tests can run on all of them at once
+        struct alignas(16) LightPacket
+        {
+            float centerX[4];
+            float centerY[4];
+            float centerZ[4];
+            float radius[4];
+            float axisX[4];
+            float axisY[4];
+            float axisZ[4];
+            float cosAngle[4];
+            float sinAngle[4];
+            int32_t beginX[4];
+            int32_t endX[4];
+            int32_t beginY[4];
+            int32_t endY[4];
+            int32_t spotMask[4];
+            uint32_t lightIndex[4];
+        };
+
+        void initEmptyPacket(LightPacket& packet)
+        {
+            memset(&packet, 0, sizeof(packet));
+            // An empty cluster range, so that the padding lanes never pass the range test
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                packet.beginX[i] = 1;
+                packet.beginY[i] = 1;
+            }
+        }
+
+        float getPlaneDistance(const glm::vec4& plane, const glm::vec3& p)
+        {
+            return glm::dot(glm::vec3(plane), p) + plane.w;
+        }
+
+        // Plane of the frustum sub-volume where the clip-space coordinate (row . p) / w equals ndc. The normal points towards increasing NDC
+        glm::vec4 getNdcPlane(const glm::mat4& proj, uint32_t row, float ndc)
+        {
+            glm::vec4 r(proj[0][row], proj[1][row], proj[2][row], proj[3][row]);
+            glm::vec4 w(proj[0][3], proj[1][3], proj[2][3], proj[3][3]);
+            glm::vec4 plane = r - ndc * w;
+            return plane / glm::length(glm::vec3(plane));
+        }
+    }
+
+    ClusteredLights::SharedPtr ClusteredLights::create(const Desc& desc)
+    {
+        if (desc.gridSizeX == 0 || desc.gridSizeY == 0 || desc.gridSizeZ == 0)
+        {
+            logError("ClusteredLights::create() - the grid size can't be zero");
+            return nullptr;
+        }
+        if (desc.intensityCutoff <= 0)
+        {
+            logError("ClusteredLights::create() - the intensity cutoff must be positive");
+            return nullptr;
+        }
+        return SharedPtr(new ClusteredLights(desc));
+    }
+
+    void ClusteredLights::update(const Scene* pScene, const Camera* pCamera)
+    {
+        CpuTimer timer;
+        timer.update();
+
+        mUnclusteredLights.clear();
+        mLightData.clear();
+        for (const auto& pLight : pScene->getLights())
+        {
+            // Spot lights are point lights with an opening angle
+            if (pLight->getType() == LightPoint)
+            {
+                mLightData.push_back(pLight->getData());
+            }
+            else
+            {
+                mUnclusteredLights.push_back(pLight.get());
+            }
+        }
+
+        const uint32_t sizeX = mDesc.gridSizeX;
+        const uint32_t sizeY = mDesc.gridSizeY;
+        const uint32_t sizeZ = mDesc.gridSizeZ;
+        mProj = pCamera->getProjMatrix();
+
+        // Cluster boundaries. Y goes top-down, to match the screen-space UV
+        mPlanesX.resize(sizeX + 1);
+        for (uint32_t x = 0; x <= sizeX; x++)
+        {
+            mPlanesX[x] = getNdcPlane(mProj, 0, -1.0f + 2.0f * float(x) / float(sizeX));
+        }
+        mPlanesY.resize(sizeY + 1);
+        for (uint32_t y = 0; y <= sizeY; y++)
+        {
+            mPlanesY[y] = getNdcPlane(mProj, 1, 1.0f - 2.0f * float(y) / float(sizeY));
+        }
+
+        float nearZ = std::max(pCamera->getNearPlane(), 1e-4f);
+        float farZ = std::max(pCamera->getFarPlane(), nearZ * 1.001f);
+        mSliceDepth.resize(sizeZ + 1);
+        for (uint32_t z = 0; z <= sizeZ; z++)
+        {
+            mSliceDepth[z] = nearZ * std::pow(farZ / nearZ, float(z) / float(sizeZ));
+        }
+
+        mClusterData.gridSizeX = sizeX;
+        mClusterData.gridSizeY = sizeY;
+        mClusterData.gridSizeZ = sizeZ;
+        mClusterData.lightCount = (uint32_t)mLightData.size();
+        mClusterData.depthSliceScale = float(sizeZ) / std::log(farZ / nearZ);
+        mClusterData.depthSliceBias = -std::log(nearZ) * mClusterData.depthSliceScale;
+
+        computeLightBounds(pCamera);
+
+        // Bin the slices in parallel. Every slice writes into its own index list
+        const uint32_t clusterCount = sizeX * sizeY * sizeZ;
+        mClusterCounts.assign(clusterCount, 0);
+        mSliceIndices.resize(sizeZ);
+        mSliceOverflow.assign(sizeZ, 0);
+        Threading::parallelFor(sizeZ, sizeZ, [this](uint32_t begin, uint32_t end, uint32_t)
+        {
+            for (uint32_t z = begin; z < end; z++) binSlice(z);
+        });
+
+        // Concatenate the slices into a single index list
+        mStats = Stats();
+        mClusterRanges.resize(clusterCount);
+        mIndices.clear();
+        uint32_t offset = 0;
+        for (uint32_t i = 0; i < clusterCount; i++)
+        {
+            uint32_t count = mClusterCounts[i];
+            mClusterRanges[i] = glm::uvec2(offset, count);
+            offset += count;
+            mStats.maxClusterLightCount = std::max(mStats.maxClusterLightCount, count);
+        }
+        mIndices.reserve(offset);
+        for (uint32_t z = 0; z < sizeZ; z++)
+        {
+            mIndices.insert(mIndices.end(), mSliceIndices[z].begin(), mSliceIndices[z].end());
+            mStats.overflowCount += mSliceOverflow[z];
+        }
+
+        mStats.clusteredLightCount = (uint32_t)mLightData.size();
+        for (const auto& b : mLightBounds)
+        {
+            if (b.end[0] >= b.begin[0] && b.end[1] >= b.begin[1] && b.end[2] >= b.begin[2]) mStats.visibleLightCount++;
+        }
+        mStats.indexCount = (uint32_t)mIndices.size();
+
+        timer.update();
+        mStats.binningTime = timer.getElapsedTime() * 1000.0f;
+    }
+
+    void ClusteredLights::computeLightBounds(const Camera* pCamera)
+    {
+        const glm::mat4 view = pCamera->getViewMatrix();
+        const int32_t sizeX = (int32_t)mDesc.gridSizeX;
+        const int32_t sizeY = (int32_t)mDesc.gridSizeY;
+        const int32_t sizeZ = (int32_t)mDesc.gridSizeZ;
+        const float nearZ = mSliceDepth.front();
+        const float farZ = mSliceDepth.back();
+
+        auto getSlice = [this, sizeZ](float depth)
+        {
+            if (depth <= mSliceDepth.front()) return 0;
+            int32_t z = (int32_t)(std::log(depth) * mClusterData.depthSliceScale + mClusterData.depthSliceBias);
+            return glm::clamp(z, 0, sizeZ - 1);
+        };
+
+        mLightBounds.resize(mLightData.size());
+        Threading::parallelFor((uint32_t)mLightData.size(), 0, [&](uint32_t first, uint32_t last, uint32_t)
+        {
+            for (uint32_t i = first; i < last; i++)
+            {
+                const LightData& light = mLightData[i];
+                LightBounds& b = mLightBounds[i];
+
+                float maxIntensity = std::max(light.intensity.x, std::max(light.intensity.y, light.intensity.z));
+                b.radius = std::sqrt(std::max(maxIntensity, 0.0f) / mDesc.intensityCutoff);
+                b.center = glm::vec3(view * glm::vec4(light.worldPos, 1));
+                b.axis = glm::normalize(glm::vec3(view * glm::vec4(light.worldDir, 0)));
+                // The cone test is only useful for cones narrower than a hemisphere. Wider cones use the sphere test alone
+                b.isSpot = light.openingAngle < glm::radians(90.0f);
+                b.cosAngle = std::cos(light.openingAngle);
+                b.sinAngle = std::sin(light.openingAngle);
+
+                // Start with an empty range, and keep it empty if the light is outside the frustum
+                for (uint32_t j = 0; j < 3; j++)
+                {
+                    b.begin[j] = 0;
+                    b.end[j] = -1;
+                }
+
+                const float r = b.radius;
+                const float depth = -b.center.z;
+                if (depth + r < nearZ || depth - r > farZ) continue;
+                if (getPlaneDistance(mPlanesX[0], b.center) < -r || getPlaneDistance(mPlanesX[sizeX], b.center) > r) continue;
+                if (getPlaneDistance(mPlanesY[0], b.center) > r || getPlaneDistance(mPlanesY[sizeY], b.center) < -r) continue;
+
+                // The X planes point towards increasing X. Skip the columns which are completely on the negative side of the sphere
+                int32_t xBegin = 0;
+                while (xBegin < sizeX - 1 && getPlaneDistance(mPlanesX[xBegin + 1], b.center) > r) xBegin++;
+                int32_t xEnd = sizeX - 1;
+                while (xEnd > xBegin && getPlaneDistance(mPlanesX[xEnd], b.center) < -r) xEnd--;
+
+                // The Y planes point up, while the rows go down
+                int32_t yBegin = 0;
+                while (yBegin < sizeY - 1 && getPlaneDistance(mPlanesY[yBegin + 1], b.center) < -r) yBegin++;
+                int32_t yEnd = sizeY - 1;
+                while (yEnd > yBegin && getPlaneDistance(mPlanesY[yEnd], b.center) > r) yEnd--;
+
+                b.begin[0] = xBegin;
+                b.end[0] = xEnd;
+                b.begin[1] = yBegin;
+                b.end[1] = yEnd;
+                b.begin[2] = getSlice(depth - r);
+                b.end[2] = getSlice(depth + r);
+            }
+        });
+    }
+
+    void ClusteredLights::binSlice(uint32_t z)
+    {
+        const uint32_t sizeX = mDesc.gridSizeX;
+        const uint32_t sizeY = mDesc.gridSizeY;
+        std::vector<uint32_t>& indices = mSliceIndices[z];
+        indices.clear();
+
+        // Gather the lights which overlap the slice
+        std::vector<LightPacket> packets;
+        uint32_t lane = 4;
+        for (uint32_t i = 0; i < (uint32_t)mLightBounds.size(); i++)
+        {
+            const LightBounds& b = mLightBounds[i];
+            if ((int32_t)z < b.begin[2] || (int32_t)z > b.end[2]) continue;
+            if (b.end[0] < b.begin[0] || b.end[1] < b.begin[1]) continue;
+
+            if (lane == 4)
+            {
+                packets.emplace_back();
+                initEmptyPacket(packets.back());
+                lane = 0;
+            }
+            LightPacket& p = packets.back();
+            p.centerX[lane] = b.center.x;
+            p.centerY[lane] = b.center.y;
+            p.centerZ[lane] = b.center.z;
+            p.radius[lane] = b.radius;
+            p.axisX[lane] = b.axis.x;
+            p.axisY[lane] = b.axis.y;
+            p.axisZ[lane] = b.axis.z;
+            p.cosAngle[lane] = b.cosAngle;
+            p.sinAngle[lane] = b.sinAngle;
+            p.beginX[lane] = b.begin[0];
+            p.endX[lane] = b.end[0];
+            p.beginY[lane] = b.begin[1];
+            p.endY[lane] = b.end[1];
+            p.spotMask[lane] = b.isSpot ? -1 : 0;
+            p.lightIndex[lane] = i;
+            lane++;
+        }
+        if (packets.empty()) return;
+
+        // View-space position of a point on the cluster boundaries. Assumes a projection without skew, which is what Camera creates
+        const float nearDepth = mSliceDepth[z];
+        const float farDepth = mSliceDepth[z + 1];
+        auto unproject = [this](float ndcX, float ndcY, float depth)
+        {
+            float viewZ = -depth;
+            float w = mProj[2][3] * viewZ + mProj[3][3];
+            float x = (ndcX * w - mProj[2][0] * viewZ - mProj[3][0]) / mProj[0][0];
+            float y = (ndcY * w - mProj[2][1] * viewZ - mProj[3][1]) / mProj[1][1];
+            return glm::vec3(x, y, viewZ);
+        };
+
+        const __m128 zero = _mm_setzero_ps();
+        uint32_t overflow = 0;
+        for (uint32_t y = 0; y < sizeY; y++)
+        {
+            const float ndcTop = 1.0f - 2.0f * float(y) / float(sizeY);
+            const float ndcBottom = 1.0f - 2.0f * float(y + 1) / float(sizeY);
+            for (uint32_t x = 0; x < sizeX; x++)
+            {
+                const float ndcLeft = -1.0f + 2.0f * float(x) / float(sizeX);
+                const float ndcRight = -1.0f + 2.0f * float(x + 1) / float(sizeX);
+
+                // The AABB and bounding sphere of the cluster
+                glm::vec3 minCorner(FLT_MAX);
+                glm::vec3 maxCorner(-FLT_MAX);
+                for (uint32_t c = 0; c < 8; c++)
+                {
+                    glm::vec3 p = unproject((c & 1) ? ndcRight : ndcLeft, (c & 2) ? ndcBottom : ndcTop, (c & 4) ? farDepth : nearDepth);
+                    minCorner = glm::min(minCorner, p);
+                    maxCorner = glm::max(maxCorner, p);
+                }
+                const glm::vec3 clusterCenter = (minCorner + maxCorner) * 0.5f;
+                const float clusterRadius = glm::length(maxCorner - minCorner) * 0.5f;
+
+                const __m128 minX = _mm_set1_ps(minCorner.x), minY = _mm_set1_ps(minCorner.y), minZ = _mm_set1_ps(minCorner.z);
+                const __m128 maxX = _mm_set1_ps(maxCorner.x), maxY = _mm_set1_ps(maxCorner.y), maxZ = _mm_set1_ps(maxCorner.z);
+                const __m128 centerX = _mm_set1_ps(clusterCenter.x), centerY = _mm_set1_ps(clusterCenter.y), centerZ = _mm_set1_ps(clusterCenter.z);
+                const __m128 radius = _mm_set1_ps(clusterRadius);
+                const __m128 negRadius = _mm_set1_ps(-clusterRadius);
+                const __m128i vecX = _mm_set1_epi32((int32_t)x);
+                const __m128i vecY = _mm_set1_epi32((int32_t)y);
+
+                uint32_t count = 0;
+                for (const LightPacket& p : packets)
+                {
+                    // Screen-space range test
+                    __m128i outside = _mm_or_si128(_mm_cmpgt_epi32(_mm_load_si128((const __m128i*)p.beginX), vecX), _mm_cmplt_epi32(_mm_load_si128((const __m128i*)p.endX), vecX));
+                    outside = _mm_or_si128(outside, _mm_cmpgt_epi32(_mm_load_si128((const __m128i*)p.beginY), vecY));
+                    outside = _mm_or_si128(outside, _mm_cmplt_epi32(_mm_load_si128((const __m128i*)p.endY), vecY));
+                    if (_mm_movemask_epi8(outside) == 0xFFFF) continue;
+
+                    // Sphere vs. cluster AABB
+                    const __m128 lightX = _mm_load_ps(p.centerX);
+                    const __m128 lightY = _mm_load_ps(p.centerY);
+                    const __m128 lightZ = _mm_load_ps(p.centerZ);
+                    const __m128 lightRadius = _mm_load_ps(p.radius);
+                    __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minX, lightX), _mm_sub_ps(lightX, maxX)), zero);
+                    __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minY, lightY), _mm_sub_ps(lightY, maxY)), zero);
+                    __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minZ, lightZ), _mm_sub_ps(lightZ, maxZ)), zero);
+                    __m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                    __m128 hit = _mm_cmple_ps(distSq, _mm_mul_ps(lightRadius, lightRadius));
+
+                    // Spot cone vs. cluster bounding sphere. V is the vector from the apex to the sphere center, V1 its projection on the cone axis
+                    __m128 vx = _mm_sub_ps(centerX, lightX);
+                    __m128 vy = _mm_sub_ps(centerY, lightY);
+                    __m128 vz = _mm_sub_ps(centerZ, lightZ);
+                    __m128 lenSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+                    __m128 v1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, _mm_load_ps(p.axisX)), _mm_mul_ps(vy, _mm_load_ps(p.axisY))), _mm_mul_ps(vz, _mm_load_ps(p.axisZ)));
+                    __m128 perpendicular = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(lenSq, _mm_mul_ps(v1, v1)), zero));
+                    __m128 coneDist = _mm_sub_ps(_mm_mul_ps(_mm_load_ps(p.cosAngle), perpendicular), _mm_mul_ps(v1, _mm_load_ps(p.sinAngle)));
+                    __m128 coneCulled = _mm_or_ps(_mm_cmpgt_ps(coneDist, radius), _mm_cmplt_ps(v1, negRadius));
+                    coneCulled = _mm_and_ps(coneCulled, _mm_castsi128_ps(_mm_load_si128((const __m128i*)p.spotMask)));
+
+                    hit = _mm_andnot_ps(_mm_or_ps(coneCulled, _mm_castsi128_ps(outside)), hit);
+                    int mask = _mm_movemask_ps(hit);
+                    for (uint32_t i = 0; mask; i++, mask >>= 1)
+                    {
+                        if ((mask & 1) == 0) continue;
+                        if (count < mDesc.maxLightsPerCluster)
+                        {
+                            indices.push_back(p.lightIndex[i]);
+                            count++;
+                        }
+                        else
+                        {
+                            overflow++;
+                        }
+                    }
+                }
+                mClusterCounts[(z * sizeY + y) * sizeX + x] = count;
+            }
+        }
+        mSliceOverflow[z] = overflow;
+    }
+
+    static bool setBuffer(ProgramVars* pVars, const char* name, StructuredBuffer::SharedPtr& pBuffer, const void* pData, size_t elementSize, size_t elementCount)
+    {
+        // The buffers are created from the reflection of the first program which uses them, and grow in powers of two
+        size_t requiredCount = std::max<size_t>(elementCount, 1);
+        if (pBuffer == nullptr || pBuffer->getElementCount() < requiredCount)
+        {
+            const ReflectionVar* pVar = pVars->getReflection()->getResource(name).get();
+            const ReflectionResourceType* pResourceType = pVar ? pVar->getType()->unwrapArray()->asResourceType() : nullptr;
+            if (pResourceType == nullptr || pResourceType->getType() != ReflectionResourceType::Type::StructuredBuffer) return false;
+
+            size_t capacity = pBuffer ? pBuffer->getElementCount() : 1;
+            while (capacity < requiredCount) capacity *= 2;
+            pBuffer = StructuredBuffer::create(name, pResourceType->inherit_shared_from_this::shared_from_this(), capacity, Resource::BindFlags::ShaderResource);
+            if (pBuffer->getElementSize() != elementSize)
+            {
+                logError(std::string("ClusteredLights - the element size of '") + name + "' doesn't match the host structure");
+                pBuffer = nullptr;
+                return false;
+            }
+        }
+
+        if (elementCount) pBuffer->setBlob(pData, 0, elementCount * elementSize);
+        return pVars->setStructuredBuffer(name, pBuffer);
+    }
+
+    bool ClusteredLights::setIntoProgramVars(ProgramVars* pVars)
+    {
+        ConstantBuffer::SharedPtr pCB = pVars->getConstantBuffer(kClusterCbName);
+        if (pCB == nullptr) return false;
+
+        if (setBuffer(pVars, kLightBufferName, mpLightBuffer, mLightData.data(), sizeof(LightData), mLightData.size()) == false) return false;
+        if (setBuffer(pVars, kRangeBufferName, mpRangeBuffer, mClusterRanges.data(), sizeof(glm::uvec2), mClusterRanges.size()) == false) return false;
+        if (setBuffer(pVars, kIndexBufferName, mpIndexBuffer, mIndices.data(), sizeof(uint32_t), mIndices.size()) == false) return false;
+
+        pCB->setBlob(&mClusterData, 0, sizeof(mClusterData));
+        return true;
+    }
+
+    void ClusteredLights::renderUI(Gui* pGui, const char* uiGroup)
+    {
+        if ((uiGroup == nullptr) || pGui->beginGroup(uiGroup))
+        {
+            pGui->addFloatVar("Intensity Cutoff", mDesc.intensityCutoff, 1e-5f, 100.0f, 0.001f);
+
+            std::string stats = "Lights: " + std::to_string(mStats.visibleLightCount) + " visible / " + std::to_string(mStats.clusteredLightCount) + "\n";
+            stats += "Indices: " + std::to_string(mStats.indexCount) + ", max per cluster: " + std::to_string(mStats.maxClusterLightCount) + "\n";
+            stats += "Overflow: " + std::to_string(mStats.overflowCount) + "\n";
+            stats += "Binning: " + std::to_string(mStats.binningTime) + " ms";
+            pGui->addText(stats.c_str());
+
+            if (uiGroup) pGui->endGroup();
+        }
+    }
+}
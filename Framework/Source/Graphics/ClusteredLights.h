@@ -0,0 +1,149 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include "Data/HostDeviceData.h"
+#include "API/StructuredBuffer.h"
+#include "Graphics/Light.h"
+
+namespace Falcor
+{
+    class Scene;
+    class Camera;
+    class ProgramVars;
+    class Gui;
+
+    /** Assigns point and spot lights to a grid of view-space clusters (froxels), so that shaders only evaluate the lights which can affect a pixel.
+        The clusters tile the screen in X and Y and split the depth range into exponentially distributed slices. Binning runs on the CPU, on the worker threads.
+        The lights, the per-cluster light ranges and the compact light index lists are uploaded into structured buffers. To use them, import 'ClusteredLights' in the shader.
+        Directional and area lights are not clustered. They are returned by getUnclusteredLights() and should be evaluated for every pixel.
+        Point lights have no range in Falcor, so the influence radius of a light is the distance at which its intensity falls below Desc::intensityCutoff.
+    */
+    class ClusteredLights
+    {
+    public:
+        using SharedPtr = std::shared_ptr<ClusteredLights>;
+        using SharedConstPtr = std::shared_ptr<const ClusteredLights>;
+
+        struct Desc
+        {
+            uint32_t gridSizeX = 16;                ///< Number of clusters along the screen X axis
+            uint32_t gridSizeY = 9;                 ///< Number of clusters along the screen Y axis
+            uint32_t gridSizeZ = 24;                ///< Number of depth slices
+            uint32_t maxLightsPerCluster = 256;     ///< Lights beyond this count are dropped from a cluster. See Stats::overflowCount
+            float intensityCutoff = 1e-2f;          ///< A light is ignored where its intensity (after the 1/d^2 falloff) is below this value
+        };
+
+        struct Stats
+        {
+            uint32_t clusteredLightCount = 0;       ///< Number of point and spot lights in the light buffer
+            uint32_t visibleLightCount = 0;         ///< Number of lights whose bounds overlap the cluster grid
+            uint32_t indexCount = 0;                ///< Total number of light indices in all the clusters
+            uint32_t maxClusterLightCount = 0;      ///< The highest number of lights in a single cluster
+            uint32_t overflowCount = 0;             ///< Number of light indices which were dropped because of Desc::maxLightsPerCluster
+            float binningTime = 0;                  ///< CPU time of the last update() in milliseconds
+        };
+
+        /** Create a new object
+        */
+        static SharedPtr create(const Desc& desc = Desc());
+
+        /** Bin the scene lights into the clusters of a camera. Call once per frame, before setIntoProgramVars()
+        */
+        void update(const Scene* pScene, const Camera* pCamera);
+
+        /** Bind the light buffers and the cluster parameters
+            \return false if the program doesn't declare the clustered light resources
+        */
+        bool setIntoProgramVars(ProgramVars* pVars);
+
+        /** Get the lights which were not clustered in the last update() call
+        */
+        const std::vector<Light*>& getUnclusteredLights() const { return mUnclusteredLights; }
+
+        /** Get the statistics of the last update() call
+        */
+        const Stats& getStats() const { return mStats; }
+
+        const Desc& getDesc() const { return mDesc; }
+
+        /** Get the light range of each cluster from the last update() call, as an (offset, count) pair into getClusterIndices(). The clusters are ordered by X, then Y, then Z
+        */
+        const std::vector<glm::uvec2>& getClusterRanges() const { return mClusterRanges; }
+
+        /** Get the light indices of all the clusters from the last update() call. An index refers to the scene's point and spot lights, in the order in which the scene stores them
+        */
+        const std::vector<uint32_t>& getClusterIndices() const { return mIndices; }
+
+        /** Render UI elements
+            \param[in] pGui The GUI to create the elements with
+            \param[in] uiGroup Optional. If specified, creates a UI group to display elements within
+        */
+        void renderUI(Gui* pGui, const char* uiGroup = nullptr);
+
+    private:
+        ClusteredLights(const Desc& desc) : mDesc(desc) {}
+
+        // View-space bounds of a light, and the range of clusters it overlaps
+        struct LightBounds
+        {
+            glm::vec3 center;
+            float radius;
+            glm::vec3 axis;
+            float cosAngle;
+            float sinAngle;
+            bool isSpot;
+            int32_t begin[3];   ///< First cluster along X, Y, Z
+            int32_t end[3];     ///< Last cluster along X, Y, Z. If any end is smaller than its begin, the light is culled
+        };
+
+        void computeLightBounds(const Camera* pCamera);
+        void binSlice(uint32_t z);
+
+        Desc mDesc;
+        Stats mStats;
+        LightClusterData mClusterData;
+        glm::mat4 mProj;
+
+        std::vector<Light*> mUnclusteredLights;
+        std::vector<LightData> mLightData;
+        std::vector<LightBounds> mLightBounds;
+        std::vector<glm::vec4> mPlanesX;            ///< The X and Y cluster boundaries as view-space planes
+        std::vector<glm::vec4> mPlanesY;
+        std::vector<float> mSliceDepth;             ///< View-space depth of the slice boundaries
+        std::vector<std::vector<uint32_t>> mSliceIndices;   ///< Light indices of each slice, cluster after cluster
+        std::vector<uint32_t> mSliceOverflow;
+        std::vector<uint32_t> mClusterCounts;
+        std::vector<glm::uvec2> mClusterRanges;
+        std::vector<uint32_t> mIndices;
+
+        StructuredBuffer::SharedPtr mpLightBuffer;
+        StructuredBuffer::SharedPtr mpRangeBuffer;
+        StructuredBuffer::SharedPtr mpIndexBuffer;
+    };
+}
@@ -43,6 +43,8 @@ namespace Falcor
         return false;
 #elif defined FALCOR_VK
         return false;
+#elif defined FALCOR_NULL
+        return false;
 #else
 #error Unknown API
 #endif
@@ -28,6 +28,7 @@
 #include "Framework.h"
 #include "GraphicsState.h"
 #include "Graphics/Program/ProgramVars.h"
+#include "API/Device.h"
 
 namespace Falcor
 {
@@ -61,8 +62,6 @@ namespace Falcor
         {
             setViewport(i, mViewports[i], true);
         }
-
-        mpGsoGraph = StateGraph::create();
     }
 
     GraphicsState::~GraphicsState() = default;
@@ -70,16 +69,20 @@ namespace Falcor
     GraphicsStateObject::SharedPtr GraphicsState::getGSO(const GraphicsVars* pVars)
     {
         assert(mpVao);
-        if (mpProgram && mpVao->getVertexLayout() != nullptr)
+        ProgramVersion::SharedConstPtr pProgVersion = mpProgramVersion;
+        if (pProgVersion == nullptr && mpProgram)
         {
-            mpVao->getVertexLayout()->addVertexAttribDclToProg(mpProgram.get());
+            if (mpVao->getVertexLayout() != nullptr)
+            {
+                mpVao->getVertexLayout()->addVertexAttribDclToProg(mpProgram.get());
+            }
+            pProgVersion = mpProgram->getActiveVersion();
         }
-        const ProgramVersion::SharedConstPtr pProgVersion = mpProgram ? mpProgram->getActiveVersion() : nullptr;
         bool newProgVersion = pProgVersion.get() != mCachedData.pProgramVersion;
         if (newProgVersion)
         {
             mCachedData.pProgramVersion = pProgVersion.get();
-            mpGsoGraph->walk((void*)pProgVersion.get());
+            mpGso = nullptr;
         }
     
         RootSignature::SharedPtr pRoot = pVars ? pVars->getRootSignature() : RootSignature::getEmpty();
@@ -87,18 +90,17 @@ namespace Falcor
         if (mCachedData.pRootSig != pRoot.get())
         {
             mCachedData.pRootSig = pRoot.get();
-            mpGsoGraph->walk((void*)mCachedData.pRootSig);
+            mpGso = nullptr;
         }
 
         const Fbo::Desc* pFboDesc = mpFbo ? &mpFbo->getDesc() : nullptr;
         if(mCachedData.pFboDesc != pFboDesc)
         {
-            mpGsoGraph->walk((void*)pFboDesc);
             mCachedData.pFboDesc = pFboDesc;
+            mpGso = nullptr;
         }
 
-        GraphicsStateObject::SharedPtr pGso = mpGsoGraph->getCurrentNode();
-        if(pGso == nullptr)
+        if(mpGso == nullptr)
         {
             mDesc.setProgramVersion(pProgVersion);
             mDesc.setFboFormats(mpFbo ? mpFbo->getDesc() : Fbo::Desc());
@@ -110,23 +112,9 @@ namespace Falcor
             mDesc.setRootSignature(pRoot);
 
             mDesc.setSinglePassStereoEnable(mEnableSinglePassStereo);
-            
-            StateGraph::CompareFunc cmpFunc = [&desc = mDesc](GraphicsStateObject::SharedPtr pGso) -> bool
-            {
-                return pGso && (desc == pGso->getDesc());
-            };
-
-            if (mpGsoGraph->scanForMatchingNode(cmpFunc))
-            {
-                pGso = mpGsoGraph->getCurrentNode();
-            }
-            else
-            {
-                pGso = GraphicsStateObject::create(mDesc);
-                mpGsoGraph->setCurrentNodeData(pGso);
-            }
+            mpGso = gpDevice->getGsoCache()->getGso(mDesc);
         }
-        return pGso;
+        return mpGso;
     }
 
     GraphicsState& GraphicsState::setFbo(const Fbo::SharedPtr& pFbo, bool setVp0Sc0)
@@ -164,13 +152,16 @@ namespace Falcor
     {
         if(mpVao != pVao)
         {
+            // Meshes usually share the vertex layout, so switching VAOs between draws doesn't require a different GSO
+            bool invalidateGso = (mpVao == nullptr) || (pVao == nullptr) || (mpVao->getVertexLayout() != pVao->getVertexLayout()) || (mpVao->getPrimitiveTopology() != pVao->getPrimitiveTopology());
             mpVao = pVao;
 
 #ifdef FALCOR_VK
             mDesc.setVao(pVao);
+            invalidateGso = true;
 #endif
 
-            mpGsoGraph->walk(pVao ? (void*)pVao->getVertexLayout().get() : nullptr);
+            if (invalidateGso) mpGso = nullptr;
         }
         return *this;
     }
@@ -180,7 +171,7 @@ namespace Falcor
         if(mDesc.getBlendState() != pBlendState)
         {
             mDesc.setBlendState(pBlendState);
-            mpGsoGraph->walk((void*)pBlendState.get());
+            mpGso = nullptr;
         }
         return *this;
     }
@@ -190,7 +181,7 @@ namespace Falcor
         if(mDesc.getRasterizerState() != pRasterizerState)
         {
             mDesc.setRasterizerState(pRasterizerState);
-            mpGsoGraph->walk((void*)pRasterizerState.get());
+            mpGso = nullptr;
         }
         return *this;
     }
@@ -200,7 +191,7 @@ namespace Falcor
         if(mDesc.getSampleMask() != sampleMask)
         {
             mDesc.setSampleMask(sampleMask);
-            mpGsoGraph->walk((void*)(uint64_t)sampleMask);
+            mpGso = nullptr;
         }
         return *this; 
     }
@@ -210,7 +201,7 @@ namespace Falcor
         if(mDesc.getDepthStencilState() != pDepthStencilState)
         {
             mDesc.setDepthStencilState(pDepthStencilState);
-            mpGsoGraph->walk((void*)pDepthStencilState.get());
+            mpGso = nullptr;
         }
         return *this;
     }
@@ -274,8 +265,11 @@ namespace Falcor
     void GraphicsState::toggleSinglePassStereo(bool enable)
     {
 #if _ENABLE_NVAPI
-        mEnableSinglePassStereo = enable;
-        mpGsoGraph->walk((void*)enable);
+        if (mEnableSinglePassStereo != enable)
+        {
+            mEnableSinglePassStereo = enable;
+            mpGso = nullptr;
+        }
 #else
         if (enable)
         {
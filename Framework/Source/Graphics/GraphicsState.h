@@ -34,7 +34,6 @@
 #include "API/DepthStencilState.h"
 #include "API/BlendState.h"
 #include <stack>
-#include "Utils/Graph.h"
 
 namespace Falcor
 {
@@ -190,6 +189,16 @@ namespace Falcor
         */
         GraphicsProgram::SharedPtr getProgram() const { return mpProgram; }
 
+        /** Use a specific program version instead of the active version of the bound program.
+            Resolving the active version mutates the program, so contexts recording on worker threads use a version which was resolved in advance.
+            \param[in] pVersion The program version to use. If this is nullptr, the active version of the bound program will be used
+        */
+        GraphicsState& setProgramVersion(const ProgramVersion::SharedConstPtr& pVersion) { mpProgramVersion = pVersion; return *this; }
+
+        /** Get the program version set by setProgramVersion().
+        */
+        ProgramVersion::SharedConstPtr getProgramVersion() const { return mpProgramVersion; }
+
         /** Set a blend-state.
         */
         GraphicsState& setBlendState(BlendState::SharedPtr pBlendState);
@@ -239,6 +248,7 @@ namespace Falcor
         Vao::SharedConstPtr mpVao;
         Fbo::SharedPtr mpFbo;
         GraphicsProgram::SharedPtr mpProgram;
+        ProgramVersion::SharedConstPtr mpProgramVersion;
         RootSignature::SharedPtr mpRootSignature;
         GraphicsStateObject::Desc mDesc;
         uint8_t mStencilRef = 0;
@@ -259,7 +269,6 @@ namespace Falcor
         };
         CachedData mCachedData;
 
-        using StateGraph = Graph<GraphicsStateObject::SharedPtr, void*>;
-        StateGraph::SharedPtr mpGsoGraph;
+        GraphicsStateObject::SharedPtr mpGso;  // The GSO matching the current state. Reset whenever the state changes, the next getGSO() call will fetch it from the device's GSO cache
     };
 }
@@ -40,15 +40,14 @@
 namespace Falcor
 {
     static const char* kMaterialVarName = "materialBlock";
-    uint32_t Material::sMaterialCounter = 0;
-    std::vector<Material::DescId> Material::sDescIdentifier;
+    std::atomic<uint32_t> Material::sMaterialCounter(0);
+    Material::DescIdMap Material::sDescIdentifier;
+    std::mutex Material::sDescIdentifierMutex;
     ParameterBlockReflection::SharedConstPtr Material::spBlockReflection;
 
     Material::Material(const std::string& name) : mName(name)
     {
-        mData.values.id = sMaterialCounter;
-        sMaterialCounter++;
-        createParameterBlock();
+        mData.values.id = sMaterialCounter++;
     }
 
     Material::SharedPtr Material::create(const std::string& name)
@@ -302,12 +301,51 @@ namespace Falcor
     }
 
 #if _LOG_ENABLED
-#define check_offset(_a) assert(pCB->getVariableOffset(std::string(varName) + #_a) == (offsetof(MaterialData, _a) + offset))
+#define check_offset(_a) assert(pCB->getVariableOffset(handles.prefix + #_a) == (offsetof(MaterialData, _a) + handles.offset))
 #else
 #define check_offset(_a)
 #endif
 
-    static void setMaterialIntoBlockCommon(ParameterBlock* pBlock, ConstantBuffer* pCB, size_t offset, const std::string& varName, const MaterialData& data)
+    /** The material's locations inside a block. Resolving them takes string concatenation and several hash lookups, so they are resolved once per block layout and reused for every draw
+    */
+    struct MaterialBindLocations
+    {
+        ParameterBlockReflection::SharedConstPtr pBlockReflection;
+        ReflectionType::SharedConstPtr pCbReflection;
+        std::string varName;
+        std::string prefix;
+        size_t offset = ConstantBuffer::kInvalidOffset;
+        ParameterBlockReflection::BindLocation layers;
+        ParameterBlock::BindHandle normalMap;
+        ParameterBlock::BindHandle ambientMap;
+        ParameterBlock::BindHandle alphaMap;
+        ParameterBlock::BindHandle heightMap;
+        ParameterBlock::BindHandle samplerState;
+    };
+
+    static const MaterialBindLocations& getBindHandles(const ParameterBlock* pBlock, const ConstantBuffer* pCB, const char* varName)
+    {
+        // Materials are bound from the parallel scene renderer's workers, so each thread caches the last layout it has seen
+        thread_local MaterialBindLocations tHandles;
+        const auto& pBlockReflection = pBlock->getReflection();
+        const auto& pCbReflection = pCB->getBufferReflector();
+        if (tHandles.pBlockReflection == pBlockReflection && tHandles.pCbReflection == pCbReflection && tHandles.varName == varName) return tHandles;
+
+        tHandles.pBlockReflection = pBlockReflection;
+        tHandles.pCbReflection = pCbReflection;
+        tHandles.varName = varName;
+        tHandles.prefix = varName[0] ? std::string(varName) + '.' : std::string();
+        tHandles.offset = varName[0] ? pCB->getVariableOffset(varName) : 0;
+        tHandles.layers = pBlockReflection->getResourceBinding(tHandles.prefix + "textures.layers");
+        tHandles.normalMap = pBlock->getBindHandle(tHandles.prefix + "textures.normalMap");
+        tHandles.ambientMap = pBlock->getBindHandle(tHandles.prefix + "textures.ambientMap");
+        tHandles.alphaMap = pBlock->getBindHandle(tHandles.prefix + "textures.alphaMap");
+        tHandles.heightMap = pBlock->getBindHandle(tHandles.prefix + "textures.heightMap");
+        tHandles.samplerState = pBlock->getBindHandle(tHandles.prefix + "samplerState");
+        return tHandles;
+    }
+
+    static void setMaterialIntoBlockCommon(ParameterBlock* pBlock, ConstantBuffer* pCB, const MaterialBindLocations& handles, const MaterialData& data)
     {
         // First set the desc and the values
         static const size_t dataSize = sizeof(MaterialDesc) + sizeof(MaterialValues);
@@ -315,14 +353,12 @@ namespace Falcor
 
         check_offset(values.layers[0].albedo);
         check_offset(values.id);
-        assert(offset + dataSize <= pCB->getSize());
+        assert(handles.offset + dataSize <= pCB->getSize());
 
-        pCB->setBlob(&data, offset, dataSize);
+        pCB->setBlob(&data, handles.offset, dataSize);
 
         // Now set the textures
-        std::string resourceName = varName + "textures.layers";
-        const auto binding = pBlock->getReflection()->getResourceBinding(resourceName);
-        if (binding.setIndex == ParameterBlockReflection::BindLocation::kInvalidLocation)
+        if (handles.layers.setIndex == ParameterBlockReflection::BindLocation::kInvalidLocation)
         {
             logWarning(std::string("setMaterialIntoBlockCommon() - can't find the first texture object"));
             return;
@@ -332,47 +368,96 @@ namespace Falcor
         for (uint32_t i = 0; i < MatMaxLayers; i++)
         {
             const auto& pSrv = (data.textures.layers[i] != nullptr) ? data.textures.layers[i]->getSRV() : nullptr;
-            pBlock->setSrv(binding, i, pSrv);
+            pBlock->setSrv(handles.layers, i, pSrv);
         }
 
-        pBlock->setTexture(varName + "textures.normalMap", data.textures.normalMap);
-        pBlock->setTexture(varName + "textures.ambientMap", data.textures.ambientMap);
-        pBlock->setTexture(varName + "textures.alphaMap", data.textures.alphaMap);
-        pBlock->setTexture(varName + "textures.heightMap", data.textures.heightMap);
-        pBlock->setSampler(varName + "samplerState", data.samplerState);
+        pBlock->setTexture(handles.normalMap, data.textures.normalMap);
+        pBlock->setTexture(handles.ambientMap, data.textures.ambientMap);
+        pBlock->setTexture(handles.alphaMap, data.textures.alphaMap);
+        pBlock->setTexture(handles.heightMap, data.textures.heightMap);
+        pBlock->setSampler(handles.samplerState, data.samplerState);
     }
 
     void Material::setIntoParameterBlock(ParameterBlock* pBlock) const
     {
         finalize();
         ConstantBuffer* pCB = pBlock->getConstantBuffer(pBlock->getReflection()->getName()).get();
-        setMaterialIntoBlockCommon(pBlock, pCB, 0, "", mData);
+        setMaterialIntoBlockCommon(pBlock, pCB, getBindHandles(pBlock, pCB, ""), mData);
     }
 
     void Material::setIntoProgramVars(ProgramVars* pVars, ConstantBuffer* pCb, const char varName[]) const
     {
         finalize();
-        size_t offset = pCb->getVariableOffset(varName);
+        ParameterBlock* pBlock = pVars->getDefaultBlock().get();
+        const MaterialBindLocations& handles = getBindHandles(pBlock, pCb, varName);
 
-        if (offset == ConstantBuffer::kInvalidOffset)
+        if (handles.offset == ConstantBuffer::kInvalidOffset)
         {
             logError(std::string("Material::setIntoProgramVars() - variable \"") + varName + "\" not found in constant buffer\n");
             return;
         }
-        setMaterialIntoBlockCommon(pVars->getDefaultBlock().get(), pCb, offset, std::string(varName) + '.', mData);
+        setMaterialIntoBlockCommon(pBlock, pCb, handles, mData);
     }
 
     void Material::setSampler(const Sampler::SharedPtr& pSampler)
     {
         mData.samplerState = pSampler;
-        mpParamBlock->setSampler("samplerState", pSampler);
+        if(mpParamBlock) mpParamBlock->setSampler("samplerState", pSampler);
     }
 
+    static void fnv1a(uint64_t& hash, const void* pData, size_t size)
+    {
+        const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(pData);
+        for(size_t i = 0; i < size; i++)
+        {
+            hash ^= pBytes[i];
+            hash *= 1099511628211ull;
+        }
+    }
+
+    // The ID identifies the material object, it's not part of the data the materials are compared by
+    static_assert(offsetof(MaterialValues, id) + sizeof(int32_t) == sizeof(MaterialValues), "Material ID must be the last field of MaterialValues");
+
     bool Material::operator==(const Material& other) const
     {
         return std::memcmp(&mData, &other.mData, sizeof(mData)) == 0 && mData.samplerState == other.mData.samplerState;
     }
 
+    bool Material::equalsData(const Material& other) const
+    {
+        if (std::memcmp(&mData.desc, &other.mData.desc, sizeof(MaterialDesc)) != 0 ||
+            std::memcmp(&mData.values, &other.mData.values, offsetof(MaterialValues, id)) != 0 ||
+            mData.samplerState != other.mData.samplerState)
+        {
+            return false;
+        }
+
+        // The textures are shared pointers. Their bytes include the control block, so compare the textures they point to
+        auto pTextures = (const Texture::SharedPtr*)&mData.textures;
+        auto pOtherTextures = (const Texture::SharedPtr*)&other.mData.textures;
+        for (uint32_t i = 0; i < kTexCount; i++)
+        {
+            if (pTextures[i].get() != pOtherTextures[i].get()) return false;
+        }
+        return true;
+    }
+
+    size_t Material::getDataHash() const
+    {
+        uint64_t hash = 14695981039346656037ull;
+        fnv1a(hash, &mData.desc, sizeof(MaterialDesc));
+        fnv1a(hash, &mData.values, offsetof(MaterialValues, id));
+        auto pTextures = (const Texture::SharedPtr*)&mData.textures;
+        for (uint32_t i = 0; i < kTexCount; i++)
+        {
+            const Texture* pTexture = pTextures[i].get();
+            fnv1a(hash, &pTexture, sizeof(pTexture));
+        }
+        const Sampler* pSampler = mData.samplerState.get();
+        fnv1a(hash, &pSampler, sizeof(pSampler));
+        return (size_t)hash;
+    }
+
     void Material::setLayerTexture(uint32_t layerId, const Texture::SharedPtr& pTexture)
     {
         mData.textures.layers[layerId] = pTexture;
@@ -408,42 +493,48 @@ namespace Falcor
         mDescDirty = true;
     }
 
+    size_t Material::DescHash::operator()(const MaterialDesc& desc) const
+    {
+        // MaterialDesc only contains 32-bit fields, so there's no padding to worry about
+        uint64_t hash = 14695981039346656037ull;
+        fnv1a(hash, &desc, sizeof(desc));
+        return (size_t)hash;
+    }
+
+    bool Material::DescEqual::operator()(const MaterialDesc& a, const MaterialDesc& b) const
+    {
+        return std::memcmp(&a, &b, sizeof(MaterialDesc)) == 0;
+    }
+
     void Material::removeDescIdentifier() const
     {
-        for(size_t i = 0 ; i < sDescIdentifier.size() ; i++)
+        if(mpDescId == nullptr) return;
+
+        std::lock_guard<std::mutex> lock(sDescIdentifierMutex);
+        mpDescId->second.refCount--;
+        if(mpDescId->second.refCount == 0)
         {
-            if(mDescIdentifier == sDescIdentifier[i].id)
-            {
-                sDescIdentifier[i].refCount--;
-                if(sDescIdentifier[i].refCount == 0)
-                {
-                    MaterialSystem::removeMaterial(mDescIdentifier);
-                    sDescIdentifier.erase(sDescIdentifier.begin() + i);
-                }
-            }
+            MaterialSystem::removeMaterial(mpDescId->second.id);
+            sDescIdentifier.erase(sDescIdentifier.find(mpDescId->first));
         }
+        mpDescId = nullptr;
     }
 
     void Material::updateDescIdentifier() const
     {
-        static uint64_t identifier = 0;
-
-        removeDescIdentifier();
+        static uint64_t identifier = 0;     // Guarded by sDescIdentifierMutex
         mDescDirty = false;
-        for(auto& a : sDescIdentifier)
-        {
-            if(std::memcmp(&mData.desc, &a.desc, sizeof(mData.desc)) == 0)
-            {
-                mDescIdentifier = a.id;
-                a.refCount++;
-                return;
-            }
-        }
 
-        // Not found, add it to the vector
-        sDescIdentifier.push_back({mData.desc, identifier, 1});
-        mDescIdentifier = identifier;
-        identifier++;
+        // Changing a value which doesn't affect the desc shouldn't release the identifier, otherwise the last reference would drop it and the next lookup would create a new one
+        if(mpDescId && DescEqual()(mpDescId->first, mData.desc)) return;
+
+        removeDescIdentifier();
+        std::lock_guard<std::mutex> lock(sDescIdentifierMutex);
+        auto result = sDescIdentifier.emplace(mData.desc, DescId{identifier, 0});
+        if(result.second) identifier++;
+        result.first->second.refCount++;
+        mpDescId = &(*result.first);
+        mDescIdentifier = mpDescId->second.id;
     }
 
     size_t Material::getDescIdentifier() const
@@ -461,7 +552,7 @@ namespace Falcor
             updateTextureCount();
             updateDescString();
             mDescDirty = false; // setIntoParameterBlock() calls finalize(), need to clear the flag
-            setIntoParameterBlock(mpParamBlock.get());
+            if(mpParamBlock) setIntoParameterBlock(mpParamBlock.get());
         }
     }
 
@@ -547,10 +638,15 @@ namespace Falcor
     ParameterBlock::SharedConstPtr Material::getParameterBlock() const
     {
         finalize();
+        if(mpParamBlock == nullptr)
+        {
+            createParameterBlock();
+            setIntoParameterBlock(mpParamBlock.get());
+        }
         return ParameterBlock::SharedConstPtr(mpParamBlock);
     }
 
-    void Material::createParameterBlock()
+    void Material::createParameterBlock() const
     {
         if (spBlockReflection == nullptr)
         {
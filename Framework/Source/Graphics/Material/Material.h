@@ -27,7 +27,10 @@
 ***************************************************************************/
 #pragma once
 #include "glm/vec3.hpp"
+#include <atomic>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 #include "glm/common.hpp"
 #include "glm/geometric.hpp"
@@ -309,6 +312,18 @@ namespace Falcor
         */
         bool operator==(const Material& other) const;
 
+        /** Compares the data values which are used for shading. Unlike operator==, the material ID is not compared, so distinct materials can be equal.
+        */
+        bool equalsData(const Material& other) const;
+
+        /** Get a hash of the material data. Materials for which equalsData() returns true have the same hash.
+        */
+        size_t getDataHash() const;
+
+        /** Get the material data, with all the pending changes applied.
+        */
+        const MaterialData& getData() const { finalize(); return mData; }
+
         /** The a string for a MaterialDesc string which can be patched into the shader. It can be used to statically compile the material into a program, resulting in better generated code
         */
         const std::string& getMaterialDescStr() const { finalize(); return mDescString; }
@@ -317,7 +332,8 @@ namespace Falcor
         */
         uint64_t getDescIdentifier() const;
 
-        /** Get the ParameterBlock object for the material. Each material is created with a parameter-block. Using it is more efficient than assigning data to a custom constant-buffer.
+        /** Get the ParameterBlock object for the material. The parameter-block is created on first use. Using it is more efficient than assigning data to a custom constant-buffer.
+            The first call isn't thread-safe. When binding the material from multiple threads, call it once before the threads start.
         */
         ParameterBlock::SharedConstPtr getParameterBlock() const;
     private:
@@ -338,21 +354,32 @@ namespace Falcor
         // We only compile based on the material descriptor, so as an optimization we minimize the number of shader permutations based on the desc
         struct DescId
         {
-            MaterialDesc desc;
             uint64_t id;
             uint32_t refCount;
         };
+        struct DescHash
+        {
+            size_t operator()(const MaterialDesc& desc) const;
+        };
+        struct DescEqual
+        {
+            bool operator()(const MaterialDesc& a, const MaterialDesc& b) const;
+        };
+        using DescIdMap = std::unordered_map<MaterialDesc, DescId, DescHash, DescEqual>;
+
         mutable bool mDescDirty = true;
         mutable std::string mDescString;
-        mutable size_t mDescIdentifier;
+        mutable size_t mDescIdentifier = 0;
+        mutable DescIdMap::value_type* mpDescId = nullptr;  ///< The interned desc this material holds a reference to. Map nodes don't move on rehash, so the pointer stays valid
         void updateDescIdentifier() const;
         void removeDescIdentifier() const;
         void updateDescString() const;
-        static uint32_t sMaterialCounter;
-        static std::vector<DescId> sDescIdentifier; // vector is slower then map, but map requires 'less' operator. This vector is only being used when the material is dirty, which shouldn't happen often
+        static std::atomic<uint32_t> sMaterialCounter;
+        static DescIdMap sDescIdentifier;   // Interned descs, hashed by content. Materials can be finalized from worker threads, so access is guarded by sDescIdentifierMutex
+        static std::mutex sDescIdentifierMutex;
 
-        ParameterBlock::SharedPtr mpParamBlock;
+        mutable ParameterBlock::SharedPtr mpParamBlock;
         static ParameterBlockReflection::SharedConstPtr spBlockReflection;
-        void createParameterBlock();
+        void createParameterBlock() const;
     };
 }
@@ -0,0 +1,238 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "MaterialTable.h"
+#include "Graphics/Scene/Scene.h"
+#include "Graphics/Program/ProgramVars.h"
+
+namespace Falcor
+{
+    static const char* kEntryBufferName = "gMaterialTable";
+    static const char* kTextureArrayName = "gMaterialTextures";
+    static const char* kSamplerArrayName = "gMaterialSamplers";
+
+    MaterialTable::SharedPtr MaterialTable::create()
+    {
+        return SharedPtr(new MaterialTable());
+    }
+
+    uint32_t MaterialTable::addMaterial(const Material::SharedPtr& pMaterial)
+    {
+        auto it = mMaterialIndices.find(pMaterial.get());
+        if (it != mMaterialIndices.end()) return it->second;
+
+        // Look for an equal material. The hash only narrows down the candidates
+        uint32_t index = kInvalidIndex;
+        size_t hash = pMaterial->getDataHash();
+        auto range = mEntryHashes.equal_range(hash);
+        for (auto candidate = range.first; candidate != range.second; candidate++)
+        {
+            if (mEntryMaterials[candidate->second]->equalsData(*pMaterial))
+            {
+                index = candidate->second;
+                break;
+            }
+        }
+
+        if (index == kInvalidIndex)
+        {
+            index = (uint32_t)mEntryMaterials.size();
+            mEntryMaterials.push_back(pMaterial);
+            mEntryHashes.emplace(hash, index);
+            mDirty = true;
+        }
+
+        mMaterialIndices[pMaterial.get()] = index;
+        mAddedMaterials.push_back(pMaterial);
+        return index;
+    }
+
+    void MaterialTable::addScene(const Scene* pScene)
+    {
+        for (uint32_t modelID = 0; modelID < pScene->getModelCount(); modelID++)
+        {
+            const Model* pModel = pScene->getModel(modelID).get();
+            for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+            {
+                const Material::SharedPtr& pMaterial = pModel->getMesh(meshID)->getMaterial();
+                if (pMaterial) addMaterial(pMaterial);
+            }
+        }
+    }
+
+    uint32_t MaterialTable::getMaterialIndex(const Material* pMaterial) const
+    {
+        auto it = mMaterialIndices.find(pMaterial);
+        return (it == mMaterialIndices.end()) ? kInvalidIndex : it->second;
+    }
+
+    void MaterialTable::clear()
+    {
+        mEntryMaterials.clear();
+        mEntryHashes.clear();
+        mMaterialIndices.clear();
+        mAddedMaterials.clear();
+        mDirty = true;
+    }
+
+    void MaterialTable::invalidate()
+    {
+        // An edit can make a material differ from the rest of its entry, or equal to another entry, so group all of them again
+        std::vector<Material::SharedPtr> materials = std::move(mAddedMaterials);
+        clear();
+        for (const auto& pMaterial : materials)
+        {
+            addMaterial(pMaterial);
+        }
+    }
+
+    uint32_t MaterialTable::addTexture(const Texture::SharedPtr& pTexture)
+    {
+        if (pTexture == nullptr) return kInvalidIndex;
+
+        auto it = mTextureIndices.find(pTexture.get());
+        if (it != mTextureIndices.end()) return it->second;
+
+        if (mTextures.size() >= MAX_MATERIAL_TABLE_TEXTURES)
+        {
+            logError("MaterialTable - the materials use more than " + std::to_string(MAX_MATERIAL_TABLE_TEXTURES) + " textures. The rest will not be bound");
+            return kInvalidIndex;
+        }
+
+        uint32_t index = (uint32_t)mTextures.size();
+        mTextures.push_back(pTexture);
+        mTextureIndices[pTexture.get()] = index;
+        return index;
+    }
+
+    uint32_t MaterialTable::addSampler(const Sampler::SharedPtr& pSampler)
+    {
+        auto it = mSamplerIndices.find(pSampler.get());
+        if (it != mSamplerIndices.end()) return it->second;
+
+        if (mSamplers.size() >= MAX_MATERIAL_TABLE_SAMPLERS)
+        {
+            logError("MaterialTable - the materials use more than " + std::to_string(MAX_MATERIAL_TABLE_SAMPLERS) + " samplers. Using the first sampler instead");
+            return 0;
+        }
+
+        uint32_t index = (uint32_t)mSamplers.size();
+        mSamplers.push_back(pSampler);
+        mSamplerIndices[pSampler.get()] = index;
+        return index;
+    }
+
+    void MaterialTable::pack()
+    {
+        if (mDirty == false) return;
+
+        mTextures.clear();
+        mTextureIndices.clear();
+        mSamplers.clear();
+        mSamplerIndices.clear();
+        mEntries.resize(mEntryMaterials.size());
+
+        for (size_t i = 0; i < mEntryMaterials.size(); i++)
+        {
+            const MaterialData& data = mEntryMaterials[i]->getData();
+            MaterialTableEntry& entry = mEntries[i];
+            entry.desc = data.desc;
+            entry.values = data.values;
+            for (uint32_t layer = 0; layer < MatMaxLayers; layer++)
+            {
+                entry.layerTextures[layer] = addTexture(data.textures.layers[layer]);
+            }
+            entry.normalMap = addTexture(data.textures.normalMap);
+            entry.alphaMap = addTexture(data.textures.alphaMap);
+            entry.heightMap = addTexture(data.textures.heightMap);
+            entry.ambientMap = addTexture(data.textures.ambientMap);
+            entry.samplerIndex = addSampler(data.samplerState);
+        }
+
+        mDirty = false;
+        mUploadPending = true;
+    }
+
+    bool MaterialTable::setIntoProgramVars(ProgramVars* pVars)
+    {
+        const ReflectionVar* pVar = pVars->getReflection()->getResource(kEntryBufferName).get();
+        const ReflectionResourceType* pResourceType = pVar ? pVar->getType()->unwrapArray()->asResourceType() : nullptr;
+        if (pResourceType == nullptr || pResourceType->getType() != ReflectionResourceType::Type::StructuredBuffer) return false;
+
+        pack();
+
+        // The buffer grows in powers of two
+        size_t requiredCount = std::max<size_t>(mEntries.size(), 1);
+        if (mpEntryBuffer == nullptr || mpEntryBuffer->getElementCount() < requiredCount)
+        {
+            size_t capacity = mpEntryBuffer ? mpEntryBuffer->getElementCount() : 1;
+            while (capacity < requiredCount) capacity *= 2;
+            mpEntryBuffer = StructuredBuffer::create(kEntryBufferName, pResourceType->inherit_shared_from_this::shared_from_this(), capacity, Resource::BindFlags::ShaderResource);
+            if (mpEntryBuffer->getElementSize() != sizeof(MaterialTableEntry))
+            {
+                logError("MaterialTable - the size of the shader's MaterialTableEntry doesn't match the host structure");
+                mpEntryBuffer = nullptr;
+                return false;
+            }
+            mUploadPending = true;
+        }
+        if (mUploadPending && mEntries.size())
+        {
+            mpEntryBuffer->setBlob(mEntries.data(), 0, mEntries.size() * sizeof(MaterialTableEntry));
+        }
+        mUploadPending = false;
+        pVars->setStructuredBuffer(kEntryBufferName, mpEntryBuffer);
+
+        ParameterBlock* pBlock = pVars->getDefaultBlock().get();
+        const ParameterBlockReflection* pBlockReflection = pBlock->getReflection().get();
+        const auto textureBinding = pBlockReflection->getResourceBinding(kTextureArrayName);
+        if (textureBinding.setIndex != ParameterBlockReflection::BindLocation::kInvalidLocation)
+        {
+            for (uint32_t i = 0; i < (uint32_t)mTextures.size(); i++)
+            {
+                pBlock->setSrv(textureBinding, i, mTextures[i]->getSRV());
+            }
+        }
+
+        const auto samplerBinding = pBlockReflection->getResourceBinding(kSamplerArrayName);
+        if (samplerBinding.setIndex != ParameterBlockReflection::BindLocation::kInvalidLocation)
+        {
+            for (uint32_t i = 0; i < (uint32_t)mSamplers.size(); i++)
+            {
+                Sampler::SharedPtr pSampler = mSamplers[i];
+                if (pSampler == nullptr)
+                {
+                    if (mpDefaultSampler == nullptr) mpDefaultSampler = Sampler::create(Sampler::Desc());
+                    pSampler = mpDefaultSampler;
+                }
+                pBlock->setSampler(samplerBinding, i, pSampler);
+            }
+        }
+        return true;
+    }
+}
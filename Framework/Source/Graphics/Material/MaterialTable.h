@@ -0,0 +1,123 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include "Graphics/Material/Material.h"
+#include "API/StructuredBuffer.h"
+
+namespace Falcor
+{
+    class Scene;
+    class ProgramVars;
+
+    /** A scene-wide material table, for shaders which index materials instead of binding them for every draw.
+        Materials with equal data (see Material::equalsData()) share a table entry. The entries are packed into a single structured buffer, and the textures and samplers they use are collected into descriptor arrays, so the per-draw material state is a single index.
+        Packing is CPU work and doesn't require a device. To use the table in a shader, import 'MaterialTable' and index it with gMaterialIndex.
+    */
+    class MaterialTable
+    {
+    public:
+        using SharedPtr = std::shared_ptr<MaterialTable>;
+        using SharedConstPtr = std::shared_ptr<const MaterialTable>;
+
+        static const uint32_t kInvalidIndex = MatInvalidIndex;
+
+        /** Create a new object
+        */
+        static SharedPtr create();
+
+        /** Add a material to the table.
+            \return The index of the material's entry. If an equal material was added before, this is the existing entry
+        */
+        uint32_t addMaterial(const Material::SharedPtr& pMaterial);
+
+        /** Add the materials of all the meshes in a scene
+        */
+        void addScene(const Scene* pScene);
+
+        /** Get the entry index of a material, or kInvalidIndex if the material wasn't added to the table
+        */
+        uint32_t getMaterialIndex(const Material* pMaterial) const;
+
+        /** Get the number of unique materials
+        */
+        uint32_t getEntryCount() const { return (uint32_t)mEntryMaterials.size(); }
+
+        /** Get the material an entry was created from
+        */
+        const Material::SharedPtr& getEntryMaterial(uint32_t index) const { return mEntryMaterials[index]; }
+
+        /** Call after changing materials which were added to the table. The materials are grouped into entries again and repacked before the next bind, so the entry indices may change
+        */
+        void invalidate();
+
+        /** Get the packed entries. Packs the table if it changed
+        */
+        const std::vector<MaterialTableEntry>& getEntries() { pack(); return mEntries; }
+
+        /** Get the texture array the entries index into
+        */
+        const std::vector<Texture::SharedPtr>& getTextures() { pack(); return mTextures; }
+
+        /** Get the sampler array the entries index into. A nullptr sampler is bound as a default sampler
+        */
+        const std::vector<Sampler::SharedPtr>& getSamplers() { pack(); return mSamplers; }
+
+        /** Bind the table
+            \return false if the program doesn't declare the material table
+        */
+        bool setIntoProgramVars(ProgramVars* pVars);
+
+        /** Remove all the materials
+        */
+        void clear();
+
+    private:
+        MaterialTable() = default;
+        void pack();
+        uint32_t addTexture(const Texture::SharedPtr& pTexture);
+        uint32_t addSampler(const Sampler::SharedPtr& pSampler);
+
+        std::vector<Material::SharedPtr> mEntryMaterials;
+        std::unordered_multimap<size_t, uint32_t> mEntryHashes;            ///< Material data hash to entry index
+        std::unordered_map<const Material*, uint32_t> mMaterialIndices;
+        std::vector<Material::SharedPtr> mAddedMaterials;                   ///< Keeps the duplicates alive, so that the addresses in mMaterialIndices stay unique
+
+        bool mDirty = true;
+        bool mUploadPending = true;
+        std::vector<MaterialTableEntry> mEntries;
+        std::vector<Texture::SharedPtr> mTextures;
+        std::unordered_map<const Texture*, uint32_t> mTextureIndices;
+        std::vector<Sampler::SharedPtr> mSamplers;
+        std::unordered_map<const Sampler*, uint32_t> mSamplerIndices;
+
+        StructuredBuffer::SharedPtr mpEntryBuffer;
+        Sampler::SharedPtr mpDefaultSampler;
+    };
+}
@@ -34,6 +34,8 @@
 #include "glm/gtc/matrix_transform.hpp"
 #include "glm/gtx/euler_angles.hpp"
 #include "Utils/Math/FalcorMath.h"
+#include <algorithm>
+#include <vector>
 
 namespace Falcor
 {
@@ -42,6 +44,7 @@ namespace Falcor
 
     /** Handles transformations for Mesh and Model instances. Primary transform is stored in the "Base" transform. An additional "Movable"
         transform is applied after the Base transform can be set through the IMovableObject interface. This is currently used by paths.
+        Instances attached to a parent apply the parent's world transform after both of these.
     */
     template<typename ObjectType>
     class ObjectInstance : public IMovableObject, public inherit_shared_from_this<IMovableObject, ObjectInstance<ObjectType>>
@@ -128,6 +131,7 @@ namespace Falcor
 
             mBase.translation = translation;
             mBase.matrixDirty = true;
+            onTransformChanged();
         };
 
         /** Gets the position/translation of the instance
@@ -138,7 +142,7 @@ namespace Falcor
         /** Sets scale of the instance
             \param[in] scaling Instance scale
         */
-        void setScaling(const glm::vec3& scaling) { mBase.scale = scaling; mBase.matrixDirty = true; }
+        void setScaling(const glm::vec3& scaling) { mBase.scale = scaling; mBase.matrixDirty = true; onTransformChanged(); }
 
         /** Gets scale of the instance
             \return Scale of the instance
@@ -158,6 +162,7 @@ namespace Falcor
             mBase.target = mBase.translation + rotMtx[2]; // position + forward
 
             mBase.matrixDirty = true;
+            onTransformChanged();
         }
 
         /** Gets rotation for the instance
@@ -175,11 +180,11 @@ namespace Falcor
 
         /** Sets the up vector orientation
         */
-        void setUpVector(const glm::vec3& up) { mBase.up = glm::normalize(up); mBase.matrixDirty = true; }
+        void setUpVector(const glm::vec3& up) { mBase.up = glm::normalize(up); mBase.matrixDirty = true; onTransformChanged(); }
 
         /** Sets the look-at target
         */
-        void setTarget(const glm::vec3& target) { mBase.target = target; mBase.matrixDirty = true; }
+        void setTarget(const glm::vec3& target) { mBase.target = target; mBase.matrixDirty = true; onTransformChanged(); }
 
         /** Gets the up vector of the instance
             \return Up vector
@@ -206,6 +211,30 @@ namespace Falcor
             return mPrevFinalTransformMatrix;
         }
 
+        /** Gets the transform matrix without the parent transform
+            \return Transform matrix relative to the parent
+        */
+        const glm::mat4& getLocalTransformMatrix() const
+        {
+            updateInstanceProperties();
+            return mLocalTransformMatrix;
+        }
+
+        /** Sets the world transform of the parent the instance is attached to. Scene calls this for instances attached with Scene::setModelInstanceParent()
+            \param[in] parent Parent transform
+            \param[in] prevParent Parent transform in the previous frame, used for the previous transform matrix
+        */
+        void setParentTransform(const glm::mat4& parent, const glm::mat4& prevParent)
+        {
+            mParent = parent;
+            mPrevParent = prevParent;
+            mParentDirty = true;
+            onTransformChanged();
+        }
+
+        const glm::mat4& getParentTransform() const { return mParent; }
+        const glm::mat4& getPrevParentTransform() const { return mPrevParent; }
+
         /** Gets the bounding box
             \return Bounding box
         */
@@ -224,8 +253,34 @@ namespace Falcor
             mMovable.up = up;
             mMovable.scale = glm::vec3(1.0f);
             mMovable.matrixDirty = true;
+            onTransformChanged();
+        }
+
+        /** Interface for objects which need to know when an instance's transform changes, without polling all the instances
+        */
+        class ITransformObserver
+        {
+        public:
+            virtual ~ITransformObserver() = default;
+            virtual void onInstanceTransformChanged(const ObjectInstance* pInstance) = 0;
+        };
+
+        /** Register an observer. It is notified from the transform setters, and must be removed before it is destroyed
+        */
+        void addTransformObserver(ITransformObserver* pObserver) const { mTransformObservers.push_back(pObserver); }
+
+        /** Remove an observer
+        */
+        void removeTransformObserver(ITransformObserver* pObserver) const
+        {
+            auto it = std::find(mTransformObservers.begin(), mTransformObservers.end(), pObserver);
+            if (it != mTransformObservers.end()) mTransformObservers.erase(it);
         }
 
+        /** Get the number of registered observers
+        */
+        uint32_t getTransformObserverCount() const { return (uint32_t)mTransformObservers.size(); }
+
         SharedPtr shared_from_this()
         {
             return inherit_shared_from_this < IMovableObject, ObjectInstance>::shared_from_this();
@@ -237,9 +292,14 @@ namespace Falcor
         }
     private:
 
+        void onTransformChanged()
+        {
+            for (ITransformObserver* pObserver : mTransformObservers) pObserver->onInstanceTransformChanged(this);
+        }
+
         void updateInstanceProperties() const
         {
-            if (mBase.matrixDirty || mMovable.matrixDirty)
+            if (mBase.matrixDirty || mMovable.matrixDirty || mParentDirty)
             {
                 if (mBase.matrixDirty)
                 {
@@ -254,8 +314,10 @@ namespace Falcor
                     mMovable.matrixDirty = false;
                 }
 
-                mFinalTransformMatrix = mMovable.matrix * mBase.matrix;
-                mPrevFinalTransformMatrix = mPrevMovable.matrix * mBase.matrix;
+                mLocalTransformMatrix = mMovable.matrix * mBase.matrix;
+                mFinalTransformMatrix = mParent * mLocalTransformMatrix;
+                mPrevFinalTransformMatrix = mPrevParent * mPrevMovable.matrix * mBase.matrix;
+                mParentDirty = false;
 
                 mBoundingBox = mpObject->getBoundingBox().transform(mFinalTransformMatrix);
             }
@@ -312,6 +374,7 @@ namespace Falcor
 
         std::string mName;
         bool mVisible = true;
+        mutable std::vector<ITransformObserver*> mTransformObservers;
 
         typename ObjectType::SharedPtr mpObject;
 
@@ -331,6 +394,11 @@ namespace Falcor
         mutable Transform mMovable;
         mutable Transform mPrevMovable;
 
+        glm::mat4 mParent;
+        glm::mat4 mPrevParent;
+        mutable bool mParentDirty = false;
+
+        mutable glm::mat4 mLocalTransformMatrix;
         mutable glm::mat4 mFinalTransformMatrix;
         mutable glm::mat4 mPrevFinalTransformMatrix;
         mutable BoundingBox mBoundingBox;
@@ -0,0 +1,398 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "FlatReflection.h"
+#include "ProgramReflection.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace Falcor
+{
+    namespace
+    {
+        const uint32_t kMagic = 0x4c464c46;     // 'FLFL'
+        const uint32_t kVersion = 1;
+
+        uint64_t fnv1a(const uint8_t* pData, size_t size, uint64_t hash = 0xcbf29ce484222325ull)
+        {
+            for (size_t i = 0; i < size; i++)
+            {
+                hash ^= pData[i];
+                hash *= 0x100000001b3ull;
+            }
+            return hash;
+        }
+
+        uint64_t calcDigest(const std::vector<uint8_t>& arena)
+        {
+            // Skip the digest field itself, which is the last member of the header
+            const size_t digestOffset = offsetof(FlatReflection::Header, digest);
+            uint64_t hash = fnv1a(arena.data(), digestOffset);
+            return fnv1a(arena.data() + sizeof(FlatReflection::Header), arena.size() - sizeof(FlatReflection::Header), hash);
+        }
+
+        size_t calcArenaSize(const FlatReflection::Header& header)
+        {
+            return sizeof(FlatReflection::Header) +
+                header.typeCount * sizeof(FlatReflection::TypeNode) +
+                header.varCount * sizeof(FlatReflection::VarNode) +
+                header.blockCount * sizeof(FlatReflection::BlockNode) +
+                header.resourceCount * sizeof(FlatReflection::ResourceNode) +
+                header.shaderVarCount * sizeof(FlatReflection::ShaderVarNode) +
+                header.stringBytes;
+        }
+
+        /** Walks a ProgramReflection and collects the flattened nodes. Identical types are only stored once
+        */
+        class Flattener
+        {
+        public:
+            using TypeNode = FlatReflection::TypeNode;
+            using VarNode = FlatReflection::VarNode;
+
+            Flattener() { intern(""); }
+
+            uint32_t intern(const std::string& str)
+            {
+                auto it = mStringMap.find(str);
+                if (it != mStringMap.end()) return it->second;
+                uint32_t offset = (uint32_t)mStrings.size();
+                mStrings.insert(mStrings.end(), str.begin(), str.end());
+                mStrings.push_back('\0');
+                mStringMap[str] = offset;
+                return offset;
+            }
+
+            uint32_t addType(const ReflectionType* pType)
+            {
+                if (pType == nullptr) return FlatReflection::kInvalidIndex;
+
+                TypeNode node = {};
+                node.size = (uint32_t)pType->getSize();
+                node.child = FlatReflection::kInvalidIndex;
+                node.name = 0;
+                std::vector<VarNode> members;
+
+                if (const ReflectionBasicType* pBasic = pType->asBasicType())
+                {
+                    node.kind = TypeNode::Kind::Basic;
+                    node.a = (uint32_t)pBasic->getType();
+                    node.b = pBasic->isRowMajor() ? 1 : 0;
+                }
+                else if (const ReflectionArrayType* pArray = pType->asArrayType())
+                {
+                    node.kind = TypeNode::Kind::Array;
+                    node.a = pArray->getArraySize();
+                    node.b = pArray->getArrayStride();
+                    node.child = addType(pArray->getType().get());
+                }
+                else if (const ReflectionStructType* pStruct = pType->asStructType())
+                {
+                    node.kind = TypeNode::Kind::Struct;
+                    node.name = intern(pStruct->getName());
+                    node.b = pStruct->getMemberCount();
+                    for (const auto& pMember : *pStruct)
+                    {
+                        VarNode var;
+                        var.name = intern(pMember->getName());
+                        var.type = addType(pMember->getType().get());
+                        var.offset = (uint32_t)pMember->getOffset();
+                        var.regSpace = pMember->getRegisterSpace();
+                        var.descOffset = pMember->getDescOffset();
+                        members.push_back(var);
+                    }
+                }
+                else if (const ReflectionResourceType* pResource = pType->asResourceType())
+                {
+                    node.kind = TypeNode::Kind::Resource;
+                    node.a = (uint32_t)pResource->getType() | ((uint32_t)pResource->getDimensions() << 8) | ((uint32_t)pResource->getStructuredBufferType() << 16) | ((uint32_t)pResource->getReturnType() << 24);
+                    node.b = (uint32_t)pResource->getShaderAccess();
+                    node.child = addType(pResource->getStructType().get());
+                }
+                else
+                {
+                    should_not_get_here();
+                    return FlatReflection::kInvalidIndex;
+                }
+
+                // The children were added first, so identical types produce identical keys. The struct's member range is not part of the key.
+                std::string key((const char*)&node, sizeof(node));
+                if (members.size()) key.append((const char*)members.data(), members.size() * sizeof(VarNode));
+
+                auto it = mTypeMap.find(key);
+                if (it != mTypeMap.end()) return it->second;
+
+                if (node.kind == TypeNode::Kind::Struct)
+                {
+                    node.a = (uint32_t)mVars.size();
+                    mVars.insert(mVars.end(), members.begin(), members.end());
+                }
+                uint32_t index = (uint32_t)mTypes.size();
+                mTypes.push_back(node);
+                mTypeMap[key] = index;
+                return index;
+            }
+
+            std::vector<TypeNode> mTypes;
+            std::vector<VarNode> mVars;
+            std::vector<FlatReflection::BlockNode> mBlocks;
+            std::vector<FlatReflection::ResourceNode> mResources;
+            std::vector<FlatReflection::ShaderVarNode> mShaderVars;
+            std::vector<char> mStrings;
+
+        private:
+            std::unordered_map<std::string, uint32_t> mStringMap;
+            std::unordered_map<std::string, uint32_t> mTypeMap;
+        };
+
+        template<typename T>
+        void appendArray(std::vector<uint8_t>& arena, const std::vector<T>& data)
+        {
+            const uint8_t* pBytes = (const uint8_t*)data.data();
+            arena.insert(arena.end(), pBytes, pBytes + data.size() * sizeof(T));
+        }
+    }
+
+    FlatReflection::FlatReflection(std::vector<uint8_t>&& arena) : mArena(std::move(arena))
+    {
+        const Header& header = getHeader();
+        const uint8_t* pData = mArena.data() + sizeof(Header);
+        mpTypes = (const TypeNode*)pData;
+        pData += header.typeCount * sizeof(TypeNode);
+        mpVars = (const VarNode*)pData;
+        pData += header.varCount * sizeof(VarNode);
+        mpBlocks = (const BlockNode*)pData;
+        pData += header.blockCount * sizeof(BlockNode);
+        mpResources = (const ResourceNode*)pData;
+        pData += header.resourceCount * sizeof(ResourceNode);
+        mpShaderVars = (const ShaderVarNode*)pData;
+        pData += header.shaderVarCount * sizeof(ShaderVarNode);
+        mpStrings = (const char*)pData;
+    }
+
+    FlatReflection::SharedPtr FlatReflection::create(const ProgramReflection* pReflector)
+    {
+        Flattener flattener;
+
+        for (uint32_t b = 0; b < (uint32_t)pReflector->getParameterBlockCount(); b++)
+        {
+            const auto& pBlock = pReflector->getParameterBlock(b);
+            BlockNode block;
+            block.name = flattener.intern(pBlock->getName());
+            block.firstResource = (uint32_t)flattener.mResources.size();
+            block.resourceCount = (uint32_t)pBlock->getResourceVec().size();
+            for (const auto& desc : pBlock->getResourceVec())
+            {
+                ResourceNode res;
+                res.name = flattener.intern(desc.name);
+                res.type = flattener.addType(desc.pType.get());
+                res.descOffset = desc.descOffset;
+                res.descCount = desc.descCount;
+                res.regIndex = desc.regIndex;
+                res.regSpace = desc.regSpace;
+                res.setType = (uint32_t)desc.setType;
+                flattener.mResources.push_back(res);
+            }
+            flattener.mBlocks.push_back(block);
+        }
+
+        // The shader variables are stored in unordered maps. Sort them by name so that the digest doesn't depend on the iteration order.
+        auto addShaderVars = [&flattener](const ProgramReflection::VariableMap& varMap, ShaderVarNode::Kind kind)
+        {
+            std::vector<const ProgramReflection::VariableMap::value_type*> sorted;
+            for (const auto& v : varMap) sorted.push_back(&v);
+            std::sort(sorted.begin(), sorted.end(), [](const auto* pA, const auto* pB) { return pA->first < pB->first; });
+            for (const auto* pVar : sorted)
+            {
+                ShaderVarNode node;
+                node.kind = kind;
+                node.name = flattener.intern(pVar->first);
+                node.semanticName = flattener.intern(pVar->second.semanticName);
+                node.bindLocation = pVar->second.bindLocation;
+                node.type = (uint32_t)pVar->second.type;
+                flattener.mShaderVars.push_back(node);
+            }
+        };
+        addShaderVars(pReflector->mVertAttr, ShaderVarNode::Kind::VertexAttribute);
+        addShaderVars(pReflector->mPsOut, ShaderVarNode::Kind::PixelShaderOutput);
+
+        Header header = {};
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.typeCount = (uint32_t)flattener.mTypes.size();
+        header.varCount = (uint32_t)flattener.mVars.size();
+        header.blockCount = (uint32_t)flattener.mBlocks.size();
+        header.resourceCount = (uint32_t)flattener.mResources.size();
+        header.shaderVarCount = (uint32_t)flattener.mShaderVars.size();
+        header.stringBytes = (uint32_t)flattener.mStrings.size();
+        uvec3 groupSize = pReflector->getThreadGroupSize();
+        header.threadGroupSize[0] = groupSize.x;
+        header.threadGroupSize[1] = groupSize.y;
+        header.threadGroupSize[2] = groupSize.z;
+        header.isSampleFrequency = pReflector->isSampleFrequency() ? 1 : 0;
+
+        std::vector<uint8_t> arena;
+        arena.reserve(calcArenaSize(header));
+        arena.insert(arena.end(), (const uint8_t*)&header, (const uint8_t*)&header + sizeof(Header));
+        appendArray(arena, flattener.mTypes);
+        appendArray(arena, flattener.mVars);
+        appendArray(arena, flattener.mBlocks);
+        appendArray(arena, flattener.mResources);
+        appendArray(arena, flattener.mShaderVars);
+        appendArray(arena, flattener.mStrings);
+
+        uint64_t digest = calcDigest(arena);
+        memcpy(arena.data() + offsetof(Header, digest), &digest, sizeof(digest));
+
+        return SharedPtr(new FlatReflection(std::move(arena)));
+    }
+
+    FlatReflection::SharedPtr FlatReflection::create(const void* pData, size_t size)
+    {
+        if (pData == nullptr || size < sizeof(Header))
+        {
+            logWarning("FlatReflection::create() - the data is too small to contain a reflection header");
+            return nullptr;
+        }
+
+        Header header;
+        memcpy(&header, pData, sizeof(Header));
+        if (header.magic != kMagic || header.version != kVersion)
+        {
+            logWarning("FlatReflection::create() - the data was created by a different version of the reflection code");
+            return nullptr;
+        }
+
+        if (calcArenaSize(header) != size)
+        {
+            logWarning("FlatReflection::create() - the data size doesn't match the size recorded in the header");
+            return nullptr;
+        }
+
+        std::vector<uint8_t> arena((const uint8_t*)pData, (const uint8_t*)pData + size);
+        if (calcDigest(arena) != header.digest)
+        {
+            logWarning("FlatReflection::create() - digest mismatch, the data is corrupt");
+            return nullptr;
+        }
+
+        SharedPtr pReflection = SharedPtr(new FlatReflection(std::move(arena)));
+        if (pReflection->validate() == false)
+        {
+            logWarning("FlatReflection::create() - the data contains out-of-range indices");
+            return nullptr;
+        }
+        return pReflection;
+    }
+
+    bool FlatReflection::validate() const
+    {
+        const Header& header = getHeader();
+        if (header.stringBytes == 0 || mpStrings[header.stringBytes - 1] != '\0') return false;
+
+        auto validString = [&header](uint32_t offset) { return offset < header.stringBytes; };
+        // Types only reference types which were added before them, which guarantees there are no cycles
+        auto validChild = [&header](uint32_t child, uint32_t parent) { return child < parent; };
+
+        for (uint32_t i = 0; i < header.typeCount; i++)
+        {
+            const TypeNode& t = mpTypes[i];
+            if (validString(t.name) == false) return false;
+            switch (t.kind)
+            {
+            case TypeNode::Kind::Basic:
+                break;
+            case TypeNode::Kind::Array:
+                if (validChild(t.child, i) == false) return false;
+                break;
+            case TypeNode::Kind::Struct:
+                if (t.a > header.varCount || t.b > header.varCount - t.a) return false;
+                for (uint32_t m = t.a; m < t.a + t.b; m++)
+                {
+                    if (validChild(mpVars[m].type, i) == false || validString(mpVars[m].name) == false) return false;
+                }
+                break;
+            case TypeNode::Kind::Resource:
+                if (t.child != kInvalidIndex && validChild(t.child, i) == false) return false;
+                break;
+            default:
+                return false;
+            }
+        }
+
+        for (uint32_t i = 0; i < header.blockCount; i++)
+        {
+            const BlockNode& b = mpBlocks[i];
+            if (validString(b.name) == false) return false;
+            if (b.firstResource > header.resourceCount || b.resourceCount > header.resourceCount - b.firstResource) return false;
+        }
+
+        for (uint32_t i = 0; i < header.resourceCount; i++)
+        {
+            const ResourceNode& r = mpResources[i];
+            if (validString(r.name) == false || r.type >= header.typeCount) return false;
+        }
+
+        for (uint32_t i = 0; i < header.shaderVarCount; i++)
+        {
+            const ShaderVarNode& v = mpShaderVars[i];
+            if (validString(v.name) == false || validString(v.semanticName) == false) return false;
+        }
+        return true;
+    }
+
+    uint32_t FlatReflection::findBlock(const std::string& name) const
+    {
+        for (uint32_t i = 0; i < getBlockCount(); i++)
+        {
+            if (name == getString(mpBlocks[i].name)) return i;
+        }
+        return kInvalidIndex;
+    }
+
+    uint32_t FlatReflection::findResource(uint32_t blockIndex, const std::string& name) const
+    {
+        const BlockNode& block = getBlock(blockIndex);
+        for (uint32_t i = block.firstResource; i < block.firstResource + block.resourceCount; i++)
+        {
+            if (name == getString(mpResources[i].name)) return i;
+        }
+        return kInvalidIndex;
+    }
+
+    uint32_t FlatReflection::findMember(uint32_t typeIndex, const std::string& name) const
+    {
+        const TypeNode& type = getType(typeIndex);
+        if (type.kind != TypeNode::Kind::Struct) return kInvalidIndex;
+        for (uint32_t i = type.a; i < type.a + type.b; i++)
+        {
+            if (name == getString(mpVars[i].name)) return i;
+        }
+        return kInvalidIndex;
+    }
+}
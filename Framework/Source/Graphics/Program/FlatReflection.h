@@ -0,0 +1,212 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "Framework.h"
+#include <vector>
+#include <cstring>
+
+namespace Falcor
+{
+    class ProgramReflection;
+
+    /** A compact, immutable copy of a ProgramReflection.
+        All the data lives in a single contiguous arena - a header followed by arrays of types, variables, parameter blocks, resources and shader I/O variables, and a string table.
+        Objects reference each other by index and names are interned into the string table, so the arena contains no pointers and can be copied or written to disk as-is.
+        A 64-bit digest of the arena is computed on creation. Two objects can be compared in O(1) and the digest can be used directly as a hash key.
+    */
+    class FlatReflection
+    {
+    public:
+        using SharedPtr = std::shared_ptr<FlatReflection>;
+        using SharedConstPtr = std::shared_ptr<const FlatReflection>;
+
+        static const uint32_t kInvalidIndex = uint32_t(-1);
+
+        /** Arena header
+        */
+        struct Header
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t typeCount;
+            uint32_t varCount;
+            uint32_t blockCount;
+            uint32_t resourceCount;
+            uint32_t shaderVarCount;
+            uint32_t stringBytes;
+            uint32_t threadGroupSize[3];
+            uint32_t isSampleFrequency;
+            uint64_t digest;                ///> FNV-1a hash of the arena, computed with this field set to zero
+        };
+
+        /** Type node. The meaning of the fields depends on the kind of the type
+        */
+        struct TypeNode
+        {
+            enum class Kind : uint32_t
+            {
+                Basic,      ///> a = ReflectionBasicType::Type, b = isRowMajor
+                Array,      ///> a = array size, b = array stride, child = element type
+                Struct,     ///> a = first member in the var array, b = member count, name = struct name
+                Resource,   ///> a = ReflectionResourceType::Type | (Dimensions << 8) | (StructuredType << 16) | (ReturnType << 24), b = ShaderAccess, child = struct type (or kInvalidIndex)
+            };
+            Kind kind;
+            uint32_t size;
+            uint32_t a;
+            uint32_t b;
+            uint32_t child;
+            uint32_t name;                  ///> Offset into the string table
+        };
+
+        /** A struct member
+        */
+        struct VarNode
+        {
+            uint32_t name;                  ///> Offset into the string table
+            uint32_t type;                  ///> Index into the type array
+            uint32_t offset;
+            uint32_t regSpace;
+            uint32_t descOffset;
+        };
+
+        /** A parameter block. Its resources are stored contiguously in the resource array
+        */
+        struct BlockNode
+        {
+            uint32_t name;                  ///> Offset into the string table
+            uint32_t firstResource;
+            uint32_t resourceCount;
+        };
+
+        /** A resource in a parameter block. Mirrors ParameterBlockReflection::ResourceDesc
+        */
+        struct ResourceNode
+        {
+            uint32_t name;                  ///> Offset into the string table
+            uint32_t type;                  ///> Index into the type array
+            uint32_t descOffset;
+            uint32_t descCount;
+            uint32_t regIndex;
+            uint32_t regSpace;
+            uint32_t setType;               ///> DescriptorSet::Type
+        };
+
+        /** A vertex attribute or a pixel-shader output
+        */
+        struct ShaderVarNode
+        {
+            enum class Kind : uint32_t
+            {
+                VertexAttribute,
+                PixelShaderOutput,
+            };
+            Kind kind;
+            uint32_t name;                  ///> Offset into the string table
+            uint32_t semanticName;          ///> Offset into the string table
+            uint32_t bindLocation;
+            uint32_t type;                  ///> ReflectionBasicType::Type
+        };
+
+        /** Create a flattened copy of a program reflection object
+        */
+        static SharedPtr create(const ProgramReflection* pReflector);
+
+        /** Create an object from data previously returned by getData(). The data is copied and validated.
+            \return A new object, or nullptr if the data is corrupt or was created by a different version of the code
+        */
+        static SharedPtr create(const void* pData, size_t size);
+
+        /** Get the raw arena. Use it to serialize the object
+        */
+        const uint8_t* getData() const { return mArena.data(); }
+
+        /** Get the size of the arena in bytes
+        */
+        size_t getSize() const { return mArena.size(); }
+
+        /** Get the digest of the arena
+        */
+        uint64_t getDigest() const { return getHeader().digest; }
+
+        const Header& getHeader() const { return *(const Header*)mArena.data(); }
+        uint32_t getTypeCount() const { return getHeader().typeCount; }
+        uint32_t getVarCount() const { return getHeader().varCount; }
+        uint32_t getBlockCount() const { return getHeader().blockCount; }
+        uint32_t getResourceCount() const { return getHeader().resourceCount; }
+        uint32_t getShaderVarCount() const { return getHeader().shaderVarCount; }
+
+        const TypeNode& getType(uint32_t index) const { assert(index < getTypeCount()); return mpTypes[index]; }
+        const VarNode& getVar(uint32_t index) const { assert(index < getVarCount()); return mpVars[index]; }
+        const BlockNode& getBlock(uint32_t index) const { assert(index < getBlockCount()); return mpBlocks[index]; }
+        const ResourceNode& getResource(uint32_t index) const { assert(index < getResourceCount()); return mpResources[index]; }
+        const ShaderVarNode& getShaderVar(uint32_t index) const { assert(index < getShaderVarCount()); return mpShaderVars[index]; }
+
+        /** Get a string from the string table
+        */
+        const char* getString(uint32_t offset) const { assert(offset < getHeader().stringBytes); return mpStrings + offset; }
+
+        /** Get the index of a parameter block by name, or kInvalidIndex if the block doesn't exist
+        */
+        uint32_t findBlock(const std::string& name) const;
+
+        /** Get the index of a resource in a block by name, or kInvalidIndex if the resource doesn't exist
+        */
+        uint32_t findResource(uint32_t blockIndex, const std::string& name) const;
+
+        /** Get the index in the var array of a struct member, or kInvalidIndex if the type is not a struct or doesn't contain the member
+        */
+        uint32_t findMember(uint32_t typeIndex, const std::string& name) const;
+
+        /** Compare two objects. The size and digest reject most mismatches in O(1), equal objects are confirmed by comparing the full arena
+        */
+        bool operator==(const FlatReflection& other) const
+        {
+            return getSize() == other.getSize() && getDigest() == other.getDigest() && std::memcmp(getData(), other.getData(), getSize()) == 0;
+        }
+        bool operator!=(const FlatReflection& other) const { return !(*this == other); }
+
+        /** Hash functor, for use in unordered containers. Returns the digest, so objects with colliding digests share a bucket and are told apart by operator==
+        */
+        struct Hash
+        {
+            size_t operator()(const FlatReflection& r) const { return (size_t)r.getDigest(); }
+        };
+
+    private:
+        FlatReflection(std::vector<uint8_t>&& arena);
+        bool validate() const;
+
+        std::vector<uint8_t> mArena;
+        const TypeNode* mpTypes = nullptr;
+        const VarNode* mpVars = nullptr;
+        const BlockNode* mpBlocks = nullptr;
+        const ResourceNode* mpResources = nullptr;
+        const ShaderVarNode* mpShaderVars = nullptr;
+        const char* mpStrings = nullptr;
+    };
+}
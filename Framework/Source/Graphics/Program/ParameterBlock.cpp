@@ -135,6 +135,16 @@ namespace Falcor
         return SharedPtr(new ParameterBlock(pReflection, createBuffers));
     }
 
+    ParameterBlock::SharedPtr ParameterBlock::clone() const
+    {
+        SharedPtr pClone = SharedPtr(new ParameterBlock(*this));
+        for (auto& rootSet : pClone->mRootSets)
+        {
+            rootSet = RootSet();
+        }
+        return pClone;
+    }
+
     ParameterBlock::ParameterBlock(const ParameterBlockReflection::SharedConstPtr& pReflection, bool createBuffers) : mpReflector(pReflection)
     {
         // Initialize the resource vectors
@@ -240,7 +250,7 @@ namespace Falcor
         return getConstantBuffer(binding, arrayIndex);
     }
 
-    bool ParameterBlock::checkResourceIndices(const BindLocation& bindLocation, uint32_t arrayIndex, DescriptorSet::Type type, const std::string& funcName) const
+    bool ParameterBlock::checkResourceIndices(const BindLocation& bindLocation, uint32_t arrayIndex, DescriptorSet::Type type, const char* funcName) const
     {
         bool OK = true;
 #if _LOG_ENABLED
@@ -256,6 +266,51 @@ namespace Falcor
         return OK;
     }
 
+    bool ParameterBlock::checkHandle(const BindHandle& handle, DescriptorSet::Type srvType, DescriptorSet::Type uavType, const char* funcName) const
+    {
+        if (handle.isValid() == false) return false;
+        if (handle.type != srvType && handle.type != uavType)
+        {
+            logWarning(std::string("ParameterBlock::") + funcName + " was called with a handle to a different resource type. Ignoring call");
+            return false;
+        }
+
+        const BindLocation& loc = handle.bindLocation;
+        bool OK = loc.setIndex < mAssignedResources.size();
+        OK = OK && loc.rangeIndex < mAssignedResources[loc.setIndex].size();
+        OK = OK && handle.arrayIndex < mAssignedResources[loc.setIndex][loc.rangeIndex].size();
+        OK = OK && mAssignedResources[loc.setIndex][loc.rangeIndex][handle.arrayIndex].type == handle.type;
+        if (!OK)
+        {
+            logWarning(std::string("ParameterBlock::") + funcName + " was called with a handle which doesn't match the block's layout. Ignoring call");
+        }
+        return OK;
+    }
+
+    ParameterBlock::BindHandle ParameterBlock::getBindHandle(const std::string& name) const
+    {
+        BindHandle handle;
+        const ReflectionVar::SharedConstPtr pVar = mpReflector->getResource(name);
+        if (pVar == nullptr) return handle;
+
+        std::string baseName = name;
+        uint32_t index;
+        while (parseArrayIndex(baseName, baseName, index)) {};
+
+        // This is done once per handle, so always check the indices. The handle setters rely on them
+        BindLocation bindLoc = mpReflector->getResourceBinding(baseName);
+        uint32_t arrayIndex = pVar->getDescOffset();
+        if (bindLoc.setIndex >= mAssignedResources.size() || bindLoc.rangeIndex >= mAssignedResources[bindLoc.setIndex].size() || arrayIndex >= mAssignedResources[bindLoc.setIndex][bindLoc.rangeIndex].size())
+        {
+            return handle;
+        }
+
+        handle.bindLocation = bindLoc;
+        handle.arrayIndex = arrayIndex;
+        handle.type = mAssignedResources[bindLoc.setIndex][bindLoc.rangeIndex][arrayIndex].type;
+        return handle;
+    }
+
     ConstantBuffer::SharedPtr ParameterBlock::getConstantBuffer(const BindLocation& bindLocation, uint32_t arrayIndex) const
     {
         if (checkResourceIndices(bindLocation, arrayIndex, DescriptorSet::Type::Cbv, "getConstantBuffer") == false) return nullptr;
@@ -312,12 +367,20 @@ namespace Falcor
         uint32_t index;
         while (parseArrayIndex(name, name, index)) {};
 
-        ParameterBlockReflection::BindLocation bindLoc = mpReflector->getResourceBinding(name);
-        if (checkResourceIndices(bindLoc, descOffset, type, funcName) == false) return;
-        auto& desc = mAssignedResources[bindLoc.setIndex][bindLoc.rangeIndex][descOffset];
+        BindHandle handle;
+        handle.bindLocation = mpReflector->getResourceBinding(name);
+        handle.arrayIndex = descOffset;
+        handle.type = type;
+        setResourceSrvUavCommon(handle, type, type, pResource, funcName.c_str());
+    }
+
+    bool ParameterBlock::setResourceSrvUavCommon(const BindHandle& handle, DescriptorSet::Type srvType, DescriptorSet::Type uavType, const Resource::SharedPtr& pResource, const char* funcName)
+    {
+        if (checkHandle(handle, srvType, uavType, funcName) == false) return false;
+        auto& desc = mAssignedResources[handle.bindLocation.setIndex][handle.bindLocation.rangeIndex][handle.arrayIndex];
         desc.pResource = pResource;
 
-        switch (type)
+        switch (handle.type)
         {
         case DescriptorSet::Type::TextureSrv:
         case DescriptorSet::Type::TypedBufferSrv:
@@ -332,14 +395,35 @@ namespace Falcor
         default:
             should_not_get_here();
         }
-        mRootSets[bindLoc.setIndex].pSet = nullptr;
+        mRootSets[handle.bindLocation.setIndex].pSet = nullptr;
+        return true;
+    }
+
+    bool ParameterBlock::setRawBuffer(const BindHandle& handle, const Buffer::SharedPtr& pBuf)
+    {
+        return setResourceSrvUavCommon(handle, DescriptorSet::Type::TextureSrv, DescriptorSet::Type::TextureUav, pBuf, "setRawBuffer()");
+    }
+
+    bool ParameterBlock::setTypedBuffer(const BindHandle& handle, const TypedBufferBase::SharedPtr& pBuf)
+    {
+        return setResourceSrvUavCommon(handle, DescriptorSet::Type::TypedBufferSrv, DescriptorSet::Type::TypedBufferUav, pBuf, "setTypedBuffer()");
+    }
+
+    bool ParameterBlock::setStructuredBuffer(const BindHandle& handle, const StructuredBuffer::SharedPtr& pBuf)
+    {
+        return setResourceSrvUavCommon(handle, DescriptorSet::Type::StructuredBufferSrv, DescriptorSet::Type::StructuredBufferUav, pBuf, "setStructuredBuffer()");
+    }
+
+    bool ParameterBlock::setTexture(const BindHandle& handle, const Texture::SharedPtr& pTexture)
+    {
+        return setResourceSrvUavCommon(handle, DescriptorSet::Type::TextureSrv, DescriptorSet::Type::TextureUav, pTexture, "setTexture()");
     }
 
     template<typename ResourceType>
     typename ResourceType::SharedPtr ParameterBlock::getResourceSrvUavCommon(const std::string& name, uint32_t descOffset, DescriptorSet::Type type, const std::string& funcName) const
     {
         ParameterBlockReflection::BindLocation bindLoc = mpReflector->getResourceBinding(name);
-        if (checkResourceIndices(bindLoc, descOffset, type, funcName) == false) return nullptr;
+        if (checkResourceIndices(bindLoc, descOffset, type, funcName.c_str()) == false) return nullptr;
         auto& desc = mAssignedResources[bindLoc.setIndex][bindLoc.rangeIndex][descOffset];
         return std::dynamic_pointer_cast<ResourceType>(desc.pResource);
     }
@@ -473,13 +557,13 @@ namespace Falcor
 
     ShaderResourceView::SharedPtr ParameterBlock::getSrv(const BindLocation& bindLocation, uint32_t arrayIndex) const
     {
-        if (checkResourceIndices(bindLocation, arrayIndex, DescriptorSet::Type::Sampler, "getSrv()") == false) return nullptr;
+        if (checkResourceIndices(bindLocation, arrayIndex, DescriptorSet::Type::Count, "getSrv()") == false) return nullptr;
         return mAssignedResources[bindLocation.setIndex][bindLocation.rangeIndex][arrayIndex].pSRV;
     }
 
     UnorderedAccessView::SharedPtr ParameterBlock::getUav(const BindLocation& bindLocation, uint32_t arrayIndex) const
     {
-        if (checkResourceIndices(bindLocation, arrayIndex, DescriptorSet::Type::Sampler, "getUav()") == false) return nullptr;
+        if (checkResourceIndices(bindLocation, arrayIndex, DescriptorSet::Type::Count, "getUav()") == false) return nullptr;
         return mAssignedResources[bindLocation.setIndex][bindLocation.rangeIndex][arrayIndex].pUAV;
     }
 
@@ -601,6 +685,87 @@ namespace Falcor
         return dirty;
     }
 
+    ConstantBufferView::SharedPtr ParameterBlock::getCbv(const AssignedResource& resource)
+    {
+        ConstantBuffer* pCB = dynamic_cast<ConstantBuffer*>(resource.pResource.get());
+        return pCB ? pCB->getCbv() : ConstantBufferView::getNullView();
+    }
+
+    DescriptorSetCache::Key ParameterBlock::createCacheKey(uint32_t setIndex) const
+    {
+        // The views are immutable and are recreated when a resource is reallocated, so the view objects uniquely identify the descriptors' contents
+        DescriptorSetCache::Key key(mpReflector->getDescriptorSetLayouts()[setIndex]);
+        for (const auto& range : mAssignedResources[setIndex])
+        {
+            for (const auto& desc : range)
+            {
+                switch (desc.type)
+                {
+                case DescriptorSet::Type::Cbv:
+                    key.addObject(getCbv(desc));
+                    break;
+                case DescriptorSet::Type::Sampler:
+                    key.addObject(desc.pSampler);
+                    break;
+                case DescriptorSet::Type::StructuredBufferSrv:
+                case DescriptorSet::Type::TypedBufferSrv:
+                case DescriptorSet::Type::TextureSrv:
+                    key.addObject(desc.pSRV);
+                    break;
+                case DescriptorSet::Type::StructuredBufferUav:
+                case DescriptorSet::Type::TypedBufferUav:
+                case DescriptorSet::Type::TextureUav:
+                    key.addObject(desc.pUAV);
+                    break;
+                default:
+                    should_not_get_here();
+                }
+            }
+        }
+        return key;
+    }
+
+    void ParameterBlock::updateDescriptorSet(uint32_t setIndex)
+    {
+        const auto& pDescSet = mRootSets[setIndex].pSet;
+        gEventCounter.numParamBlockUpdates++;
+
+        const auto& set = mAssignedResources[setIndex];
+        for (uint32_t r = 0 ; r < set.size() ; r++)
+        {
+            const auto& range = set[r];
+            for (uint32_t d = 0; d < range.size(); d++)
+            {
+                const auto& desc = range[d];
+                switch (desc.type)
+                {
+                case DescriptorSet::Type::Cbv:
+                    pDescSet->setCbv(r, d, getCbv(desc));
+                    break;
+                case DescriptorSet::Type::Sampler:
+                    assert(desc.pSampler);
+                    pDescSet->setSampler(r, d, desc.pSampler.get());
+                    break;
+                case DescriptorSet::Type::StructuredBufferSrv:
+                case DescriptorSet::Type::TypedBufferSrv:
+                case DescriptorSet::Type::TextureSrv:
+                    assert(desc.pSRV);
+                    pDescSet->setSrv(r, d, desc.pSRV.get());
+                    break;
+                case DescriptorSet::Type::StructuredBufferUav:
+                case DescriptorSet::Type::TypedBufferUav:
+                case DescriptorSet::Type::TextureUav:
+                    assert(desc.pUAV);
+                    pDescSet->setUav(r, d, desc.pUAV.get());
+                    break;
+
+                default:
+                    should_not_get_here();
+                }
+            }
+        }
+    }
+
     bool ParameterBlock::prepareForDraw(CopyContext* pContext)
     {
         // Prepare the resources
@@ -619,69 +784,31 @@ namespace Falcor
             }
         }
 
-        // Allocate the missing sets
+        // Allocate the missing sets. Look them up in the cache first, a set with the same resources might have been created recently
+        const auto& pCache = gpDevice->getDescriptorSetCache();
         for (uint32_t i = 0; i < mRootSets.size(); i++)
         {
             mRootSets[i].dirty = (mRootSets[i].pSet == nullptr);
             if (mRootSets[i].pSet == nullptr)
             {
-                DescriptorSet::Layout layout;
                 const auto& set = mpReflector->getDescriptorSetLayouts()[i];
+                DescriptorSetCache::Key key = createCacheKey(i);
+                mRootSets[i].pSet = pCache->find(key);
+                if (mRootSets[i].pSet) continue;
+
                 mRootSets[i].pSet = DescriptorSet::create(gpDevice->getGpuDescriptorPool(), set);
                 if (mRootSets[i].pSet == nullptr)
                 {
+                    // Release the cached sets, so that the caller can reclaim their descriptors
+                    pCache->clear();
                     return false;
                 }
+                updateDescriptorSet(i);
+                // The cache decides whether the set is worth keeping. Sets with a freshly updated constant buffer usually aren't
+                pCache->insert(std::move(key), mRootSets[i].pSet);
             }
         }
 
-        // bind the resources
-        for (uint32_t s = 0; s < mAssignedResources.size(); s++)
-        {
-            if (mRootSets[s].dirty == false) continue;
-            const auto& pDescSet = mRootSets[s].pSet;
-
-            gEventCounter.numParamBlockUpdates++;
-
-            const auto& set = mAssignedResources[s];
-            for (uint32_t r = 0 ; r < set.size() ; r++)
-            {
-                const auto& range = set[r];
-                for (uint32_t d = 0; d < range.size(); d++)
-                {
-                    const auto& desc = range[d];
-                    switch (desc.type)
-                    {
-                    case DescriptorSet::Type::Cbv:
-                    {
-                        ConstantBuffer* pCB = dynamic_cast<ConstantBuffer*>(desc.pResource.get());
-                        ConstantBufferView::SharedPtr pView = pCB ? pCB->getCbv() : ConstantBufferView::getNullView();
-                        pDescSet->setCbv(r, d, pView);
-                    }
-                    break;
-                    case DescriptorSet::Type::Sampler:
-                        assert(desc.pSampler);
-                        pDescSet->setSampler(r, d, desc.pSampler.get());
-                        break;
-                    case DescriptorSet::Type::StructuredBufferSrv:
-                    case DescriptorSet::Type::TypedBufferSrv:
-                    case DescriptorSet::Type::TextureSrv:
-                        assert(desc.pSRV);
-                        pDescSet->setSrv(r, d, desc.pSRV.get());
-                        break;
-                    case DescriptorSet::Type::StructuredBufferUav:
-                    case DescriptorSet::Type::TypedBufferUav:
-                    case DescriptorSet::Type::TextureUav:
-                        assert(desc.pUAV);
-                        pDescSet->setUav(r, d, desc.pUAV.get());
-                        break;
-
-                    default:
-                        should_not_get_here();
-                    }
-                }
-            }
-        }
-         return true;
+        return true;
     }
 }
\ No newline at end of file
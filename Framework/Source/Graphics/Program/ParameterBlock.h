@@ -30,6 +30,7 @@
 #include "API/ConstantBuffer.h"
 #include "API/StructuredBuffer.h"
 #include "API/TypedBuffer.h"
+#include "API/LowLevel/DescriptorSetCache.h"
 
 namespace Falcor
 {
@@ -58,10 +59,27 @@ namespace Falcor
 
         using BindLocation = ParameterBlockReflection::BindLocation;
 
+        /** A resource location which was resolved from the reflection ahead of time.
+            Setting a resource by name parses array indices and performs several hash-map lookups. Get a handle once using getBindHandle() and use it in the draw loop, so that binding doesn't do any string work or allocations.
+            A handle is valid for every block created from the same reflection, or from a reflection with the same layout. It is checked against the block on every call.
+            Calls made with an invalid handle are ignored.
+        */
+        struct BindHandle
+        {
+            BindLocation bindLocation;                              ///< The bind-location in the block
+            uint32_t arrayIndex = 0;                                ///< The array index, or 0 for non-arrays
+            DescriptorSet::Type type = DescriptorSet::Type::Count;  ///< The descriptor type expected at the location
+            bool isValid() const { return bindLocation.setIndex != BindLocation::kInvalidLocation; }
+        };
+
         /** Create a new object
         */
         static SharedPtr create(const ParameterBlockReflection::SharedConstPtr& pReflection, bool createBuffers);
 
+        /** Create a copy of the block. The copy references the same resources as the original block, but owns its descriptor-sets
+        */
+        SharedPtr clone() const;
+
         /** Bind a constant buffer object by name.
         If the name doesn't exists or the CBs size doesn't match the required size, the call will fail.
         If a buffer was previously bound it will be released.
@@ -71,6 +89,24 @@ namespace Falcor
         */
         bool setConstantBuffer(const std::string& name, const ConstantBuffer::SharedPtr& pCB);
 
+        /** Resolve a resource name into a handle. Returns an invalid handle if the name doesn't exist in the block.
+            \param[in] name The name of the resource. Can include array indices
+        */
+        BindHandle getBindHandle(const std::string& name) const;
+
+        /** Bind a constant buffer object using a handle.
+            \param[in] handle A handle returned by getBindHandle()
+            \param[in] pCB The constant buffer object
+            \return false is the call failed, otherwise true
+        */
+        bool setConstantBuffer(const BindHandle& handle, const ConstantBuffer::SharedPtr& pCB) { return checkHandle(handle, DescriptorSet::Type::Cbv, DescriptorSet::Type::Cbv, "setConstantBuffer()") && setConstantBuffer(handle.bindLocation, handle.arrayIndex, pCB); }
+
+        /** Get a constant buffer object using a handle.
+            \param[in] handle A handle returned by getBindHandle()
+            \return If the handle is valid, a shared pointer to the CB. Otherwise returns nullptr
+        */
+        ConstantBuffer::SharedPtr getConstantBuffer(const BindHandle& handle) const { return checkHandle(handle, DescriptorSet::Type::Cbv, DescriptorSet::Type::Cbv, "getConstantBuffer()") ? getConstantBuffer(handle.bindLocation, handle.arrayIndex) : nullptr; }
+
         /** Bind a constant buffer object by index.
             If the no CB exists in the specified index or the CB size doesn't match the required size, the call will fail.
             If a buffer was previously bound it will be released.
@@ -112,6 +148,24 @@ namespace Falcor
         */
         bool setStructuredBuffer(const std::string& name, StructuredBuffer::SharedPtr pBuf);
 
+        /** Set a raw-buffer using a handle. The view type is taken from the handle
+            \param[in] handle A handle returned by getBindHandle()
+            \param[in] pBuf The buffer object
+        */
+        bool setRawBuffer(const BindHandle& handle, const Buffer::SharedPtr& pBuf);
+
+        /** Set a typed buffer using a handle. The view type is taken from the handle
+            \param[in] handle A handle returned by getBindHandle()
+            \param[in] pBuf The buffer object
+        */
+        bool setTypedBuffer(const BindHandle& handle, const TypedBufferBase::SharedPtr& pBuf);
+
+        /** Set a structured buffer using a handle. The view type is taken from the handle
+            \param[in] handle A handle returned by getBindHandle()
+            \param[in] pBuf The buffer object
+        */
+        bool setStructuredBuffer(const BindHandle& handle, const StructuredBuffer::SharedPtr& pBuf);
+
         /** Get a raw-buffer object.
             \param[in] name The name of the buffer
             \return If the name is valid, a shared pointer to the buffer object. Otherwise returns nullptr
@@ -136,6 +190,12 @@ namespace Falcor
         */
         bool setTexture(const std::string& name, const Texture::SharedPtr& pTexture);
 
+        /** Bind a texture using a handle. The view type is taken from the handle
+            \param[in] handle A handle returned by getBindHandle()
+            \param[in] pTexture The texture object to bind
+        */
+        bool setTexture(const BindHandle& handle, const Texture::SharedPtr& pTexture);
+
         /** Get a texture object.
             \param[in] name The name of the texture
             \return If the name is valid, a shared pointer to the texture object. Otherwise returns nullptr
@@ -184,6 +244,13 @@ namespace Falcor
         */
         bool setSampler(const BindLocation& bindLocation, uint32_t arrayIndex, const Sampler::SharedPtr& pSampler);
 
+        /** Bind a sampler using a handle.
+            \param[in] handle A handle returned by getBindHandle()
+            \param[in] pSampler The sampler object to bind
+            \return false if the handle doesn't point to a sampler, otherwise true
+        */
+        bool setSampler(const BindHandle& handle, const Sampler::SharedPtr& pSampler) { return checkHandle(handle, DescriptorSet::Type::Sampler, DescriptorSet::Type::Sampler, "setSampler()") && setSampler(handle.bindLocation, handle.arrayIndex, pSampler); }
+
         /** Gets a sampler object.
         \return If the index is valid, a shared pointer to the sampler. Otherwise returns nullptr
         */
@@ -222,6 +289,7 @@ namespace Falcor
         /** Get the root-sets
         */
         std::vector<RootSet>& getRootSets() { return mRootSets; }
+        const std::vector<RootSet>& getRootSets() const { return mRootSets; }
     private:
         ParameterBlock(const ParameterBlockReflection::SharedConstPtr& pReflection, bool createBuffers);
         ParameterBlockReflection::SharedConstPtr mpReflector;
@@ -247,10 +315,16 @@ namespace Falcor
         using ResourceVec = std::vector<AssignedResource>;
         using SetResourceVec = std::vector<ResourceVec>;
         std::vector<SetResourceVec> mAssignedResources;
-        bool checkResourceIndices(const BindLocation& bindLocation, uint32_t arrayIndex, DescriptorSet::Type type, const std::string& funcName) const;
+        bool checkResourceIndices(const BindLocation& bindLocation, uint32_t arrayIndex, DescriptorSet::Type type, const char* funcName) const;
+        // Unlike checkResourceIndices(), this is done in every build. A handle can come from a block with a different layout
+        bool checkHandle(const BindHandle& handle, DescriptorSet::Type srvType, DescriptorSet::Type uavType, const char* funcName) const;
 
         std::vector<RootSet> mRootSets;
+        static ConstantBufferView::SharedPtr getCbv(const AssignedResource& resource);
+        DescriptorSetCache::Key createCacheKey(uint32_t setIndex) const;
+        void updateDescriptorSet(uint32_t setIndex);
         void setResourceSrvUavCommon(std::string name, uint32_t descOffset, DescriptorSet::Type type, const Resource::SharedPtr& pResource, const std::string& funcName);
+        bool setResourceSrvUavCommon(const BindHandle& handle, DescriptorSet::Type srvType, DescriptorSet::Type uavType, const Resource::SharedPtr& pResource, const char* funcName);
         template<typename ResourceType>
         typename ResourceType::SharedPtr getResourceSrvUavCommon(const std::string& name, uint32_t descOffset, DescriptorSet::Type type, const std::string& funcName) const;
     };
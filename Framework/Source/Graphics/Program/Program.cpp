@@ -38,6 +38,10 @@
 #include "API/Sampler.h"
 #include "API/RenderContext.h"
 #include "Utils/StringUtils.h"
+#include "Graphics/Program/FlatReflection.h"
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
 
 namespace Falcor
 {
@@ -48,6 +52,33 @@ namespace Falcor
         return pShader;
     }
 
+    // Program versions compiled with different defines often end up with the same layout. Look for a live reflector with an identical flattened reflection and return it instead, so that all those versions share a single copy.
+    static ProgramReflection::SharedPtr getSharedReflector(const ProgramReflection::SharedPtr& pReflector)
+    {
+        static std::mutex sMutex;
+        static std::unordered_multimap<uint64_t, std::weak_ptr<ProgramReflection>> sReflectors;
+
+        if (pReflector == nullptr || pReflector->getFlatReflection() == nullptr) return pReflector;
+        const FlatReflection& flat = *pReflector->getFlatReflection();
+
+        std::lock_guard<std::mutex> lock(sMutex);
+        auto range = sReflectors.equal_range(flat.getDigest());
+        for (auto it = range.first; it != range.second;)
+        {
+            ProgramReflection::SharedPtr pExisting = it->second.lock();
+            if (pExisting == nullptr)
+            {
+                it = sReflectors.erase(it);
+                continue;
+            }
+            // The digest only narrows down the candidates. Sharing the wrong reflector would bind resources to the wrong locations, so compare the full arena
+            if (*pExisting->getFlatReflection() == flat) return pExisting;
+            ++it;
+        }
+        sReflectors.emplace(flat.getDigest(), pReflector);
+        return pReflector;
+    }
+
     Program::Desc::Desc()
     {}
 
@@ -328,7 +359,8 @@ namespace Falcor
         spSetCodeGenTarget(slangRequest, SLANG_SPIRV);
         spAddPreprocessorDefine(slangRequest, "FALCOR_GLSL", "1");
         SlangSourceLanguage sourceLanguage = SLANG_SOURCE_LANGUAGE_GLSL;
-#elif defined FALCOR_D3D
+#elif defined FALCOR_D3D || defined FALCOR_NULL
+        // The null backend never compiles the generated HLSL, it only needs the reflection data
         // Note: we could compile Slang directly to DXBC (by having Slang invoke the MS compiler for us,
         // but that path seems to have more issues at present, so let's just go to HLSL instead...)
         spSetCodeGenTarget(slangRequest, SLANG_HLSL);
@@ -453,7 +485,7 @@ namespace Falcor
         }
 
         // Extract the reflection data
-        mPreprocessedReflector = ProgramReflection::create(slang::ShaderReflection::get(slangRequest), log);
+        mPreprocessedReflector = getSharedReflector(ProgramReflection::create(slang::ShaderReflection::get(slangRequest), log));
 
         // Extract list of files referenced, for dependency-tracking purposes
         int depFileCount = spGetDependencyFileCount(slangRequest);
@@ -27,6 +27,7 @@
 ***************************************************************************/
 #include "Framework.h"
 #include "ProgramReflection.h"
+#include "FlatReflection.h"
 #include "Utils/StringUtils.h"
 using namespace slang;
 
@@ -602,7 +603,9 @@ namespace Falcor
 
     ProgramReflection::SharedPtr ProgramReflection::create(slang::ShaderReflection* pSlangReflector, std::string& log)
     {
-        return SharedPtr(new ProgramReflection(pSlangReflector, log));
+        SharedPtr pReflector = SharedPtr(new ProgramReflection(pSlangReflector, log));
+        pReflector->mpFlatReflection = FlatReflection::create(pReflector.get());
+        return pReflector;
     }
 
     ProgramReflection::BindType getBindTypeFromSetType(DescriptorSet::Type type)
@@ -898,7 +901,7 @@ namespace Falcor
         struct SetIndex
         {
             SetIndex(const ResourceDesc& desc) : regSpace(desc.regSpace)
-#ifdef FALCOR_D3D12
+#if defined FALCOR_D3D12 || defined FALCOR_NULL
                 ,isSampler(desc.setType == ResourceDesc::Type::Sampler)
 #endif
             {}
@@ -39,6 +39,7 @@ namespace Falcor
     class ReflectionBasicType;
     class ReflectionStructType;
     class ReflectionArrayType;
+    class FlatReflection;
 
     /** Base class for reflection types
     */
@@ -621,7 +622,12 @@ namespace Falcor
         */
         const ParameterBlockReflection::BindLocation translateRegisterIndicesToBindLocation(uint32_t regSpace, uint32_t baseRegIndex, BindType type) const { return mResourceBindMap.at({regSpace, baseRegIndex, type}); }
 
+        /** Get a flattened copy of the reflection data. Use it to compare or hash reflection objects, or to serialize them
+        */
+        const std::shared_ptr<const FlatReflection>& getFlatReflection() const { return mpFlatReflection; }
+
     private:
+        friend class FlatReflection;
         ProgramReflection(slang::ShaderReflection* pSlangReflector, std::string& log);
         void addParameterBlock(const ParameterBlockReflection::SharedConstPtr& pBlock);
 
@@ -635,6 +641,7 @@ namespace Falcor
         VariableMap mPsOut;
         VariableMap mVertAttr;
         VariableMap mVertAttrBySemantic;
+        std::shared_ptr<const FlatReflection> mpFlatReflection;
 
         struct ResourceBinding
         {
@@ -46,7 +46,7 @@ namespace Falcor
             const auto& rangeB = b.getRange(i);
             if (rangeA.baseRegIndex != rangeB.baseRegIndex) return false;
             if (rangeA.descCount != rangeB.descCount) return false;
-#ifdef FALCOR_D3D12
+#if defined FALCOR_D3D12 || defined FALCOR_NULL
             if (rangeA.regSpace != rangeB.regSpace) return false;
 #endif
             if (rangeA.type != rangeB.type) return false;
@@ -61,7 +61,7 @@ namespace Falcor
             const auto& rootSet = pRootSig->getDescriptorSet(i);
             if (compareRootSets(rootSet, blockSet))
             {
-#ifdef FALCOR_D3D12
+#if defined FALCOR_D3D12 || defined FALCOR_NULL
                 return i;
 #else
                 return rootSet.getRange(0).regSpace;
@@ -101,6 +101,19 @@ namespace Falcor
         mDefaultBlock = mParameterBlocks[mpReflector->getParameterBlockIndex("")];
     }
 
+    ProgramVars::ProgramVars(const ProgramVars& other) : mpRootSignature(other.mpRootSignature), mpReflector(other.mpReflector)
+    {
+        uint32_t defaultIndex = mpReflector->getParameterBlockIndex("");
+        mParameterBlocks = other.mParameterBlocks;
+        for (uint32_t i = 0; i < mParameterBlocks.size(); i++)
+        {
+            const ParameterBlock* pSrc = (i == defaultIndex) ? other.mDefaultBlock.pBlock.get() : other.mParameterBlocks[i].pBlock.get();
+            mParameterBlocks[i].pBlock = pSrc->clone();
+            mParameterBlocks[i].bind = true;
+        }
+        mDefaultBlock = mParameterBlocks[defaultIndex];
+    }
+
     const ParameterBlock::SharedConstPtr ProgramVars::getParameterBlock(const std::string& name) const
     {
         uint32_t index = mpReflector->getParameterBlockIndex(name);
@@ -145,6 +158,11 @@ namespace Falcor
         return SharedPtr(new GraphicsVars(pReflector, createBuffers, pRootSig));
     }
 
+    GraphicsVars::SharedPtr GraphicsVars::clone() const
+    {
+        return SharedPtr(new GraphicsVars(*this));
+    }
+
     ComputeVars::SharedPtr ComputeVars::create(const ProgramReflection::SharedConstPtr& pReflector, bool createBuffers, const RootSignature::SharedPtr& pRootSig)
     {
         return SharedPtr(new ComputeVars(pReflector, createBuffers, pRootSig));
@@ -246,6 +264,36 @@ namespace Falcor
         return mDefaultBlock.pBlock->getTexture(name);
     }
 
+    ParameterBlock::BindHandle ProgramVars::getBindHandle(const std::string& name) const
+    {
+        return mDefaultBlock.pBlock->getBindHandle(name);
+    }
+
+    bool ProgramVars::setConstantBuffer(const ParameterBlock::BindHandle& handle, const ConstantBuffer::SharedPtr& pCB)
+    {
+        return mDefaultBlock.pBlock->setConstantBuffer(handle, pCB);
+    }
+
+    ConstantBuffer::SharedPtr ProgramVars::getConstantBuffer(const ParameterBlock::BindHandle& handle) const
+    {
+        return mDefaultBlock.pBlock->getConstantBuffer(handle);
+    }
+
+    bool ProgramVars::setStructuredBuffer(const ParameterBlock::BindHandle& handle, const StructuredBuffer::SharedPtr& pBuf)
+    {
+        return mDefaultBlock.pBlock->setStructuredBuffer(handle, pBuf);
+    }
+
+    bool ProgramVars::setTexture(const ParameterBlock::BindHandle& handle, const Texture::SharedPtr& pTexture)
+    {
+        return mDefaultBlock.pBlock->setTexture(handle, pTexture);
+    }
+
+    bool ProgramVars::setSampler(const ParameterBlock::BindHandle& handle, const Sampler::SharedPtr& pSampler)
+    {
+        return mDefaultBlock.pBlock->setSampler(handle, pSampler);
+    }
+
     bool ProgramVars::setSrv(uint32_t regSpace, uint32_t baseRegIndex, uint32_t arrayIndex, const ShaderResourceView::SharedPtr& pSrv)
     {
         const auto& loc = mpReflector->translateRegisterIndicesToBindLocation(regSpace, baseRegIndex, ProgramReflection::BindType::Srv);
@@ -304,6 +352,17 @@ namespace Falcor
         return true;
     }
 
+    bool ProgramVars::prepareForDraw(CopyContext* pContext)
+    {
+        for (auto& block : mParameterBlocks)
+        {
+            if (block.pBlock->prepareForDraw(pContext) == false) return false;
+            // The sets were updated but not bound, make sure the next apply() binds them
+            block.bind = true;
+        }
+        return true;
+    }
+
     bool ComputeVars::apply(ComputeContext* pContext, bool bindRootSig)
     {
         return applyProgramVarsCommon<false>(pContext, bindRootSig);
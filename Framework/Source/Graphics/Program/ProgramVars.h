@@ -146,6 +146,18 @@ namespace Falcor
         */
         Texture::SharedPtr getTexture(const std::string& name) const;
 
+        /** Resolve a resource name in the default block into a handle. Use the handle overloads below in hot paths to skip the name lookup. See ParameterBlock::BindHandle
+        */
+        ParameterBlock::BindHandle getBindHandle(const std::string& name) const;
+
+        /** Handle-based versions of the setters and getters above. The handle must be resolved from this object's default block, or from a block with the same layout
+        */
+        bool setConstantBuffer(const ParameterBlock::BindHandle& handle, const ConstantBuffer::SharedPtr& pCB);
+        ConstantBuffer::SharedPtr getConstantBuffer(const ParameterBlock::BindHandle& handle) const;
+        bool setStructuredBuffer(const ParameterBlock::BindHandle& handle, const StructuredBuffer::SharedPtr& pBuf);
+        bool setTexture(const ParameterBlock::BindHandle& handle, const Texture::SharedPtr& pTexture);
+        bool setSampler(const ParameterBlock::BindHandle& handle, const Sampler::SharedPtr& pSampler);
+
         /** Bind an SRV.
             Please note that the register space and index are the global indices used in the program. Do not confuse those indices with ParameterBlock::BindLocation.
             \param[in] regSpace The register space
@@ -261,8 +273,14 @@ namespace Falcor
         template<bool forGraphics>
         bool applyProgramVarsCommon(CopyContext* pContext, bool bindRootSig);
 
+        /** Upload the dirty buffers and transition the bound resources of all the parameter-blocks, without binding them.
+            Call this before sharing the resources with vars which record on other contexts, so that those vars only read the shared objects
+        */
+        bool prepareForDraw(CopyContext* pContext);
+
     protected:
         ProgramVars(const ProgramReflection::SharedConstPtr& pReflector, bool createBuffers, const RootSignature::SharedPtr& pRootSig);
+        ProgramVars(const ProgramVars& other);
         
         RootSignature::SharedPtr mpRootSignature;
         ProgramReflection::SharedConstPtr mpReflector;
@@ -290,10 +308,16 @@ namespace Falcor
             \param[in] pRootSignature A root-signature describing how to bind resources into the shader. If this parameter is nullptr, a root-signature object will be created from the program reflection object
         */
         static SharedPtr create(const ProgramReflection::SharedConstPtr& pReflector, bool createBuffers = true, const RootSignature::SharedPtr& pRootSig = nullptr);
+
+        /** Create a copy of the object. The parameter-blocks are cloned, so the copy references the same resources but can be bound and modified independently of the original
+        */
+        SharedPtr clone() const;
+
         bool apply(RenderContext* pContext, bool bindRootSig);
     private:
         GraphicsVars(const ProgramReflection::SharedConstPtr& pReflector, bool createBuffers, const RootSignature::SharedPtr& pRootSig) :
             ProgramVars(pReflector, createBuffers, pRootSig) {}
+        GraphicsVars(const GraphicsVars& other) : ProgramVars(other) {}
     };
 
     class ComputeVars : public ProgramVars, public std::enable_shared_from_this<ProgramVars>
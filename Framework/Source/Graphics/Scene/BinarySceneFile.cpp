@@ -0,0 +1,652 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/error/en.h"
+#include "Framework.h"
+#include "BinarySceneFile.h"
+#include "Utils/Platform/OS.h"
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include "SceneExportImportCommon.h"
+
+namespace Falcor
+{
+    const char* BinarySceneFile::kFileExtension = ".fsceneb";
+
+    namespace
+    {
+        const uint32_t kMagic = 0x42435346;   // 'FSCB'
+        const uint32_t kVersion = 1;
+        const uint32_t kSectionAlignment = 16;
+
+        enum class SectionType : uint32_t
+        {
+            Strings,
+            Instances,
+            Tree,
+            Count
+        };
+
+        struct FileHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t sectionCount;
+            uint32_t reserved;
+        };
+
+        struct SectionDesc
+        {
+            SectionType type;
+            uint32_t reserved;
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        // Each tree node starts with a word containing the node type in the low 4 bits and a payload in the upper 28 bits
+        enum class NodeType : uint32_t
+        {
+            Null,
+            False,
+            True,
+            SmallUint,          // Payload is the value
+            Int64,              // Followed by 2 words
+            Uint64,             // Followed by 2 words. Only used for values which don't fit an int64
+            Double,             // Followed by 2 words
+            String,             // Payload is the string ID
+            Array,              // Payload is the element count. Followed by the elements
+            Object,             // Payload is the member count. Followed by pairs of key string ID and value
+            PackedInstances,    // Payload is the instance range index
+        };
+
+        const uint32_t kNodeTypeBits = 4;
+        const uint32_t kMaxPayload = (1 << (32 - kNodeTypeBits)) - 1;
+
+        // Nesting limit for arrays and objects. Decoding is recursive, so a corrupted file must not be able to exhaust the stack
+        const uint32_t kMaxDepth = 256;
+
+        uint32_t makeNode(NodeType type, uint32_t payload) { return (uint32_t)type | (payload << kNodeTypeBits); }
+        NodeType getNodeType(uint32_t node) { return (NodeType)(node & ((1 << kNodeTypeBits) - 1)); }
+        uint32_t getNodePayload(uint32_t node) { return node >> kNodeTypeBits; }
+
+        // Packed instances are objects with exactly these members. The format word stores the member order in the low 8 bits (2 bits per member),
+        // followed by a bit per vector component which is set if the component was written as an integer
+        enum InstanceMember : uint32_t
+        {
+            NameMember,
+            TranslationMember,
+            RotationMember,
+            ScalingMember,
+            InstanceMemberCount
+        };
+        const char* kInstanceMemberKeys[] = { SceneKeys::kName, SceneKeys::kTranslationVec, SceneKeys::kRotationVec, SceneKeys::kScalingVec };
+        const uint32_t kIntegerMaskShift = 2 * InstanceMemberCount;
+
+        size_t alignSize(size_t size)
+        {
+            return (size + kSectionAlignment - 1) & ~(size_t)(kSectionAlignment - 1);
+        }
+
+        class Encoder
+        {
+        public:
+            bool encode(const rapidjson::Value& document, std::vector<uint8_t>& data);
+
+        private:
+            bool encodeValue(const rapidjson::Value& value, uint32_t depth);
+            bool packInstances(const rapidjson::Value& instances);
+            uint32_t getStringID(const char* str, uint32_t length);
+
+            std::unordered_map<std::string, uint32_t> mStringIDs;
+            std::vector<const std::string*> mStrings;
+            std::vector<uint32_t> mTree;
+
+            std::vector<BinarySceneFile::InstanceRange> mRanges;
+            std::vector<glm::vec3> mInstanceVectors[3];     // Translation, rotation, scaling
+            std::vector<uint32_t> mInstanceNames;
+            std::vector<uint32_t> mInstanceFormats;
+        };
+
+        uint32_t Encoder::getStringID(const char* str, uint32_t length)
+        {
+            auto it = mStringIDs.emplace(std::string(str, length), (uint32_t)mStrings.size());
+            if (it.second) mStrings.push_back(&it.first->first);
+            return it.first->second;
+        }
+
+        void pushWords(std::vector<uint32_t>& tree, const void* pValue)
+        {
+            uint32_t words[2];
+            memcpy(words, pValue, sizeof(words));
+            tree.push_back(words[0]);
+            tree.push_back(words[1]);
+        }
+
+        // Check if a vector can be stored as floats without changing the document
+        bool getPackedVector(const rapidjson::Value& value, glm::vec3& vec, uint32_t& integerMask)
+        {
+            integerMask = 0;
+            if (value.IsArray() == false || value.Size() != 3) return false;
+            for (uint32_t i = 0; i < 3; i++)
+            {
+                const rapidjson::Value& c = value[i];
+                if (c.IsDouble())
+                {
+                    vec[i] = (float)c.GetDouble();
+                    if ((double)vec[i] != c.GetDouble()) return false;
+                }
+                else if (c.IsInt())
+                {
+                    vec[i] = (float)c.GetInt();
+                    if ((int32_t)vec[i] != c.GetInt()) return false;
+                    integerMask |= 1 << i;
+                }
+                else return false;
+            }
+            return true;
+        }
+
+        bool Encoder::packInstances(const rapidjson::Value& instances)
+        {
+            std::vector<uint32_t> names(instances.Size());
+            std::vector<uint32_t> formats(instances.Size());
+            std::vector<glm::vec3> vectors[3];
+            for (auto& v : vectors) v.resize(instances.Size());
+
+            for (uint32_t i = 0; i < instances.Size(); i++)
+            {
+                const rapidjson::Value& instance = instances[i];
+                if (instance.IsObject() == false || instance.MemberCount() != InstanceMemberCount) return false;
+
+                uint32_t foundMask = 0;
+                uint32_t format = 0;
+                uint32_t slot = 0;
+                for (auto m = instance.MemberBegin(); m != instance.MemberEnd(); m++, slot++)
+                {
+                    uint32_t member = 0;
+                    while (member < InstanceMemberCount && strcmp(m->name.GetString(), kInstanceMemberKeys[member]) != 0) member++;
+                    if (member == InstanceMemberCount || (foundMask & (1 << member))) return false;
+                    foundMask |= 1 << member;
+                    format |= member << (2 * slot);
+
+                    if (member == NameMember)
+                    {
+                        if (m->value.IsString() == false) return false;
+                        names[i] = getStringID(m->value.GetString(), m->value.GetStringLength());
+                    }
+                    else
+                    {
+                        uint32_t integerMask;
+                        if (getPackedVector(m->value, vectors[member - TranslationMember][i], integerMask) == false) return false;
+                        format |= integerMask << (kIntegerMaskShift + 3 * (member - TranslationMember));
+                    }
+                }
+                formats[i] = format;
+            }
+
+            BinarySceneFile::InstanceRange range;
+            range.first = (uint32_t)mInstanceNames.size();
+            range.count = instances.Size();
+            mRanges.push_back(range);
+            mInstanceNames.insert(mInstanceNames.end(), names.begin(), names.end());
+            mInstanceFormats.insert(mInstanceFormats.end(), formats.begin(), formats.end());
+            for (uint32_t v = 0; v < 3; v++)
+            {
+                mInstanceVectors[v].insert(mInstanceVectors[v].end(), vectors[v].begin(), vectors[v].end());
+            }
+            return true;
+        }
+
+        bool Encoder::encodeValue(const rapidjson::Value& value, uint32_t depth)
+        {
+            if (depth > kMaxDepth) return false;
+            switch (value.GetType())
+            {
+            case rapidjson::kNullType:
+                mTree.push_back(makeNode(NodeType::Null, 0));
+                break;
+            case rapidjson::kFalseType:
+                mTree.push_back(makeNode(NodeType::False, 0));
+                break;
+            case rapidjson::kTrueType:
+                mTree.push_back(makeNode(NodeType::True, 0));
+                break;
+            case rapidjson::kNumberType:
+                if (value.IsDouble())
+                {
+                    double d = value.GetDouble();
+                    mTree.push_back(makeNode(NodeType::Double, 0));
+                    pushWords(mTree, &d);
+                }
+                else if (value.IsUint() && value.GetUint() <= kMaxPayload)
+                {
+                    mTree.push_back(makeNode(NodeType::SmallUint, value.GetUint()));
+                }
+                else if (value.IsInt64())
+                {
+                    int64_t i = value.GetInt64();
+                    mTree.push_back(makeNode(NodeType::Int64, 0));
+                    pushWords(mTree, &i);
+                }
+                else
+                {
+                    uint64_t u = value.GetUint64();
+                    mTree.push_back(makeNode(NodeType::Uint64, 0));
+                    pushWords(mTree, &u);
+                }
+                break;
+            case rapidjson::kStringType:
+                mTree.push_back(makeNode(NodeType::String, getStringID(value.GetString(), value.GetStringLength())));
+                break;
+            case rapidjson::kArrayType:
+                if (value.Size() > kMaxPayload) return false;
+                mTree.push_back(makeNode(NodeType::Array, value.Size()));
+                for (uint32_t i = 0; i < value.Size(); i++)
+                {
+                    if (encodeValue(value[i], depth + 1) == false) return false;
+                }
+                break;
+            case rapidjson::kObjectType:
+                if (value.MemberCount() > kMaxPayload) return false;
+                mTree.push_back(makeNode(NodeType::Object, value.MemberCount()));
+                for (auto m = value.MemberBegin(); m != value.MemberEnd(); m++)
+                {
+                    mTree.push_back(getStringID(m->name.GetString(), m->name.GetStringLength()));
+
+                    // Instance arrays which can be stored as floats without losing information are packed. Anything else is stored as a regular value
+                    if (strcmp(m->name.GetString(), SceneKeys::kModelInstances) == 0 && m->value.IsArray() && mRanges.size() < kMaxPayload && packInstances(m->value))
+                    {
+                        mTree.push_back(makeNode(NodeType::PackedInstances, (uint32_t)mRanges.size() - 1));
+                    }
+                    else if (encodeValue(m->value, depth + 1) == false)
+                    {
+                        return false;
+                    }
+                }
+                break;
+            default:
+                should_not_get_here();
+                return false;
+            }
+            return true;
+        }
+
+        template<typename T>
+        void appendArray(std::vector<uint8_t>& data, const T* pData, size_t count)
+        {
+            const uint8_t* pBytes = (const uint8_t*)pData;
+            data.insert(data.end(), pBytes, pBytes + count * sizeof(T));
+        }
+
+        bool Encoder::encode(const rapidjson::Value& document, std::vector<uint8_t>& data)
+        {
+            if (encodeValue(document, 0) == false) return false;
+
+            // Build the sections
+            std::vector<uint8_t> sections[(uint32_t)SectionType::Count];
+
+            auto& strings = sections[(uint32_t)SectionType::Strings];
+            std::vector<uint32_t> offsets;
+            offsets.reserve(mStrings.size() + 1);
+            uint32_t offset = 0;
+            for (const std::string* pStr : mStrings)
+            {
+                offsets.push_back(offset);
+                offset += (uint32_t)pStr->size() + 1;
+            }
+            offsets.push_back(offset);
+            uint32_t stringCount = (uint32_t)mStrings.size();
+            appendArray(strings, &stringCount, 1);
+            appendArray(strings, offsets.data(), offsets.size());
+            for (const std::string* pStr : mStrings)
+            {
+                appendArray(strings, pStr->c_str(), pStr->size() + 1);
+            }
+
+            auto& instances = sections[(uint32_t)SectionType::Instances];
+            uint32_t counts[2] = { (uint32_t)mRanges.size(), (uint32_t)mInstanceNames.size() };
+            appendArray(instances, counts, 2);
+            appendArray(instances, mRanges.data(), mRanges.size());
+            for (const auto& vectors : mInstanceVectors) appendArray(instances, vectors.data(), vectors.size());
+            appendArray(instances, mInstanceNames.data(), mInstanceNames.size());
+            appendArray(instances, mInstanceFormats.data(), mInstanceFormats.size());
+
+            appendArray(sections[(uint32_t)SectionType::Tree], mTree.data(), mTree.size());
+
+            // Write the header, the section table and the sections
+            FileHeader header = { kMagic, kVersion, (uint32_t)SectionType::Count, 0 };
+            size_t tableSize = sizeof(FileHeader) + arraysize(sections) * sizeof(SectionDesc);
+            data.clear();
+            appendArray(data, &header, 1);
+            data.resize(alignSize(tableSize));
+            for (uint32_t i = 0; i < arraysize(sections); i++)
+            {
+                SectionDesc desc = { (SectionType)i, 0, data.size(), sections[i].size() };
+                memcpy(data.data() + sizeof(FileHeader) + i * sizeof(SectionDesc), &desc, sizeof(SectionDesc));
+                data.insert(data.end(), sections[i].begin(), sections[i].end());
+                data.resize(alignSize(data.size()));
+            }
+            return true;
+        }
+
+        bool readFile(const std::string& filename, std::vector<uint8_t>& data)
+        {
+            std::ifstream stream(filename, std::ios::binary | std::ios::ate);
+            if (stream.fail()) return false;
+            data.resize((size_t)stream.tellg());
+            stream.seekg(0);
+            stream.read((char*)data.data(), data.size());
+            return stream.fail() == false;
+        }
+    }
+
+    BinarySceneFile::UniquePtr BinarySceneFile::open(const std::string& filename)
+    {
+        UniquePtr pFile = UniquePtr(new BinarySceneFile());
+        if (readFile(filename, pFile->mData) == false)
+        {
+            logError("BinarySceneFile::open() - can't read '" + filename + "'");
+            return nullptr;
+        }
+        if (pFile->init() == false)
+        {
+            logError("BinarySceneFile::open() - '" + filename + "' is not a valid binary scene file");
+            return nullptr;
+        }
+        return pFile;
+    }
+
+    bool BinarySceneFile::isBinarySceneFile(const std::string& filename)
+    {
+        std::ifstream stream(filename, std::ios::binary);
+        uint32_t magic = 0;
+        stream.read((char*)&magic, sizeof(magic));
+        return stream.fail() == false && magic == kMagic;
+    }
+
+    bool BinarySceneFile::init()
+    {
+        if (mData.size() < sizeof(FileHeader)) return false;
+        FileHeader header;
+        memcpy(&header, mData.data(), sizeof(FileHeader));
+        if (header.magic != kMagic || header.version != kVersion || header.sectionCount != (uint32_t)SectionType::Count) return false;
+        if (mData.size() < sizeof(FileHeader) + header.sectionCount * sizeof(SectionDesc)) return false;
+
+        // Locate the sections. Their offsets are aligned, so the data can be accessed in place
+        const uint8_t* pSections[(uint32_t)SectionType::Count];
+        size_t sizes[(uint32_t)SectionType::Count];
+        for (uint32_t i = 0; i < header.sectionCount; i++)
+        {
+            SectionDesc desc;
+            memcpy(&desc, mData.data() + sizeof(FileHeader) + i * sizeof(SectionDesc), sizeof(SectionDesc));
+            if (desc.type != (SectionType)i || desc.offset % kSectionAlignment || desc.offset > mData.size() || desc.size > mData.size() - desc.offset) return false;
+            pSections[i] = mData.data() + desc.offset;
+            sizes[i] = (size_t)desc.size;
+        }
+
+        // Strings
+        const uint32_t* pStrings = (const uint32_t*)pSections[(uint32_t)SectionType::Strings];
+        size_t stringsSize = sizes[(uint32_t)SectionType::Strings];
+        if (stringsSize < sizeof(uint32_t)) return false;
+        mStringCount = pStrings[0];
+        if ((stringsSize / sizeof(uint32_t)) - 1 < (size_t)mStringCount + 1) return false;
+        mpStringOffsets = pStrings + 1;
+        mpStringData = (const char*)(mpStringOffsets + mStringCount + 1);
+        size_t stringDataSize = stringsSize - (mStringCount + 2) * sizeof(uint32_t);
+        if (mpStringOffsets[mStringCount] > stringDataSize) return false;
+        for (uint32_t i = 0; i < mStringCount; i++)
+        {
+            if (mpStringOffsets[i] >= mpStringOffsets[i + 1] || mpStringData[mpStringOffsets[i + 1] - 1] != 0) return false;
+        }
+
+        // Instances
+        const uint32_t* pInstances = (const uint32_t*)pSections[(uint32_t)SectionType::Instances];
+        size_t instancesSize = sizes[(uint32_t)SectionType::Instances];
+        if (instancesSize < 2 * sizeof(uint32_t)) return false;
+        mInstanceRangeCount = pInstances[0];
+        mInstanceCount = pInstances[1];
+        size_t requiredSize = 2 * sizeof(uint32_t) + (size_t)mInstanceRangeCount * sizeof(InstanceRange) + (size_t)mInstanceCount * (3 * sizeof(glm::vec3) + 2 * sizeof(uint32_t));
+        if (instancesSize < requiredSize) return false;
+        mpInstanceRanges = (const InstanceRange*)(pInstances + 2);
+        mpTranslations = (const glm::vec3*)(mpInstanceRanges + mInstanceRangeCount);
+        mpRotations = mpTranslations + mInstanceCount;
+        mpScalings = mpRotations + mInstanceCount;
+        mpInstanceNames = (const uint32_t*)(mpScalings + mInstanceCount);
+        mpInstanceFormats = mpInstanceNames + mInstanceCount;
+        for (uint32_t i = 0; i < mInstanceRangeCount; i++)
+        {
+            if (mpInstanceRanges[i].first > mInstanceCount || mpInstanceRanges[i].count > mInstanceCount - mpInstanceRanges[i].first) return false;
+        }
+        for (uint32_t i = 0; i < mInstanceCount; i++)
+        {
+            if (mpInstanceNames[i] >= mStringCount) return false;
+        }
+
+        // Tree
+        mpTree = (const uint32_t*)pSections[(uint32_t)SectionType::Tree];
+        mpTreeEnd = mpTree + sizes[(uint32_t)SectionType::Tree] / sizeof(uint32_t);
+        return true;
+    }
+
+    bool BinarySceneFile::decodeValue(const uint32_t*& pWord, rapidjson::Value& value, rapidjson::Document::AllocatorType& allocator, bool expandInstances, uint32_t depth) const
+    {
+        if (pWord >= mpTreeEnd || depth > kMaxDepth) return false;
+        uint32_t node = *pWord++;
+        uint32_t payload = getNodePayload(node);
+
+        switch (getNodeType(node))
+        {
+        case NodeType::Null:
+            value.SetNull();
+            break;
+        case NodeType::False:
+            value.SetBool(false);
+            break;
+        case NodeType::True:
+            value.SetBool(true);
+            break;
+        case NodeType::SmallUint:
+            value.SetUint(payload);
+            break;
+        case NodeType::Int64:
+        case NodeType::Uint64:
+        case NodeType::Double:
+        {
+            if (mpTreeEnd - pWord < 2) return false;
+            uint64_t bits;
+            memcpy(&bits, pWord, sizeof(bits));
+            pWord += 2;
+            if (getNodeType(node) == NodeType::Int64) value.SetInt64((int64_t)bits);
+            else if (getNodeType(node) == NodeType::Uint64) value.SetUint64(bits);
+            else
+            {
+                double d;
+                memcpy(&d, &bits, sizeof(d));
+                value.SetDouble(d);
+            }
+            break;
+        }
+        case NodeType::String:
+            if (payload >= mStringCount) return false;
+            value.SetString(rapidjson::StringRef(getString(payload), getStringLength(payload)));
+            break;
+        case NodeType::Array:
+            // Every element takes at least one word. Check before reserving, the count comes from the file
+            if (payload > (size_t)(mpTreeEnd - pWord)) return false;
+            value.SetArray();
+            value.Reserve(payload, allocator);
+            for (uint32_t i = 0; i < payload; i++)
+            {
+                rapidjson::Value element;
+                if (decodeValue(pWord, element, allocator, expandInstances, depth + 1) == false) return false;
+                value.PushBack(element, allocator);
+            }
+            break;
+        case NodeType::Object:
+            // Every member takes at least two words, the key and the value
+            if (payload > (size_t)(mpTreeEnd - pWord) / 2) return false;
+            value.SetObject();
+            for (uint32_t i = 0; i < payload; i++)
+            {
+                if (pWord >= mpTreeEnd || *pWord >= mStringCount) return false;
+                uint32_t keyID = *pWord++;
+                rapidjson::Value key(rapidjson::StringRef(getString(keyID), getStringLength(keyID)));
+                rapidjson::Value member;
+                if (decodeValue(pWord, member, allocator, expandInstances, depth + 1) == false) return false;
+                value.AddMember(key, member, allocator);
+            }
+            break;
+        case NodeType::PackedInstances:
+        {
+            if (payload >= mInstanceRangeCount) return false;
+            if (expandInstances == false)
+            {
+                value.SetUint(payload);
+                break;
+            }
+
+            const InstanceRange& range = mpInstanceRanges[payload];
+            value.SetArray();
+            value.Reserve(range.count, allocator);
+            for (uint32_t i = range.first; i < range.first + range.count; i++)
+            {
+                const glm::vec3* pVectors[] = { &mpTranslations[i], &mpRotations[i], &mpScalings[i] };
+                uint32_t format = mpInstanceFormats[i];
+                rapidjson::Value instance(rapidjson::kObjectType);
+                for (uint32_t slot = 0; slot < InstanceMemberCount; slot++)
+                {
+                    uint32_t member = (format >> (2 * slot)) & 3;
+                    rapidjson::Value memberValue;
+                    if (member == NameMember)
+                    {
+                        memberValue.SetString(rapidjson::StringRef(getString(mpInstanceNames[i]), getStringLength(mpInstanceNames[i])));
+                    }
+                    else
+                    {
+                        uint32_t integerMask = format >> (kIntegerMaskShift + 3 * (member - TranslationMember));
+                        const glm::vec3& vec = *pVectors[member - TranslationMember];
+                        memberValue.SetArray();
+                        for (uint32_t c = 0; c < 3; c++)
+                        {
+                            rapidjson::Value component;
+                            if (integerMask & (1 << c)) component.SetInt((int32_t)vec[c]);
+                            else component.SetDouble((double)vec[c]);
+                            memberValue.PushBack(component, allocator);
+                        }
+                    }
+                    instance.AddMember(rapidjson::StringRef(kInstanceMemberKeys[member]), memberValue, allocator);
+                }
+                value.PushBack(instance, allocator);
+            }
+            break;
+        }
+        default:
+            return false;
+        }
+        return true;
+    }
+
+    bool BinarySceneFile::createDocument(rapidjson::Document& document, bool expandInstances) const
+    {
+        const uint32_t* pWord = mpTree;
+        if (decodeValue(pWord, document, document.GetAllocator(), expandInstances, 0) == false || pWord != mpTreeEnd)
+        {
+            logError("BinarySceneFile::createDocument() - the document tree is corrupted");
+            return false;
+        }
+        return true;
+    }
+
+    bool BinarySceneFile::save(const rapidjson::Value& document, const std::string& filename)
+    {
+        std::vector<uint8_t> data;
+        Encoder encoder;
+        if (encoder.encode(document, data) == false)
+        {
+            logError("BinarySceneFile::save() - the document is too large or too deeply nested for the binary format");
+            return false;
+        }
+
+        std::ofstream stream(filename, std::ios::binary);
+        stream.write((const char*)data.data(), data.size());
+        if (stream.fail())
+        {
+            logError("BinarySceneFile::save() - can't write '" + filename + "'");
+            return false;
+        }
+        return true;
+    }
+
+    bool BinarySceneFile::convertToBinary(const std::string& jsonFilename, const std::string& binaryFilename)
+    {
+        std::ifstream stream(jsonFilename);
+        if (stream.fail())
+        {
+            logError("BinarySceneFile::convertToBinary() - can't open '" + jsonFilename + "'");
+            return false;
+        }
+        std::stringstream strStream;
+        strStream << stream.rdbuf();
+        std::string json = strStream.str();
+
+        // Parse with full precision, so that the numbers are converted exactly like the JSON writer wrote them
+        rapidjson::Document document;
+        document.Parse<rapidjson::kParseFullPrecisionFlag>(json.c_str());
+        if (document.HasParseError())
+        {
+            logError("BinarySceneFile::convertToBinary() - JSON parse error in '" + jsonFilename + "'. " + rapidjson::GetParseError_En(document.GetParseError()));
+            return false;
+        }
+        return save(document, binaryFilename);
+    }
+
+    bool BinarySceneFile::convertToJson(const std::string& binaryFilename, const std::string& jsonFilename)
+    {
+        UniquePtr pFile = open(binaryFilename);
+        if (pFile == nullptr) return false;
+
+        rapidjson::Document document;
+        if (pFile->createDocument(document, true) == false) return false;
+
+        rapidjson::StringBuffer buffer;
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        writer.SetIndent(' ', 4);
+        document.Accept(writer);
+
+        std::ofstream stream(jsonFilename);
+        stream.write(buffer.GetString(), buffer.GetSize());
+        if (stream.fail())
+        {
+            logError("BinarySceneFile::convertToJson() - can't write '" + jsonFilename + "'");
+            return false;
+        }
+        return true;
+    }
+}
@@ -0,0 +1,121 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <memory>
+#include <vector>
+#include "Externals/RapidJson/include/rapidjson/document.h"
+#include "glm/vec3.hpp"
+
+namespace Falcor
+{
+    /** Binary container for .fscene data.
+        The file holds the same document as the JSON format, so the importer handles both the same way. Parsing the JSON text and
+        comparing the instance keys dominates the load time of large scenes, so the binary file stores:
+        - An interned string table. Object keys and string values are string IDs.
+        - The model instances as packed arrays of translation, rotation, scaling and name.
+        - The rest of the document as a compact tree of 32-bit words.
+        Each section starts at a 16-byte aligned offset and only uses file-relative offsets, so the file can be used directly from a memory mapping.
+        The conversion is lossless in both directions - converting JSON to binary and back produces the same document, including the key order and number types.
+    */
+    class BinarySceneFile
+    {
+    public:
+        using UniquePtr = std::unique_ptr<BinarySceneFile>;
+        static const char* kFileExtension;
+
+        /** Range of packed model instances, see createDocument()
+        */
+        struct InstanceRange
+        {
+            uint32_t first;
+            uint32_t count;
+        };
+
+        /** Open a binary scene file
+            \return A new object, or nullptr if the file can't be read or is not a valid binary scene file
+        */
+        static UniquePtr open(const std::string& filename);
+
+        /** Check if a file is a binary scene file, based on its content
+        */
+        static bool isBinarySceneFile(const std::string& filename);
+
+        /** Encode a scene document and write it to a file. Arrays and objects can be nested up to 256 levels deep
+        */
+        static bool save(const rapidjson::Value& document, const std::string& filename);
+
+        /** Convert a JSON scene file to a binary scene file
+        */
+        static bool convertToBinary(const std::string& jsonFilename, const std::string& binaryFilename);
+
+        /** Convert a binary scene file to a JSON scene file
+        */
+        static bool convertToJson(const std::string& binaryFilename, const std::string& jsonFilename);
+
+        /** Create the scene document. String values and keys point into the file data, so the document must not outlive this object.
+            \param[out] document The document
+            \param[in] expandInstances If true, packed model instances are converted back to arrays of objects. Otherwise, each packed 'instances' array is replaced
+                with an unsigned integer, which is an index to pass to getInstanceRange()
+        */
+        bool createDocument(rapidjson::Document& document, bool expandInstances) const;
+
+        /** Packed instance data
+        */
+        const InstanceRange& getInstanceRange(uint32_t index) const { return mpInstanceRanges[index]; }
+        uint32_t getInstanceRangeCount() const { return mInstanceRangeCount; }
+        const glm::vec3& getInstanceTranslation(uint32_t instance) const { return mpTranslations[instance]; }
+        const glm::vec3& getInstanceRotation(uint32_t instance) const { return mpRotations[instance]; }    ///< In degrees, like the JSON format
+        const glm::vec3& getInstanceScaling(uint32_t instance) const { return mpScalings[instance]; }
+        const char* getInstanceName(uint32_t instance) const { return getString(mpInstanceNames[instance]); }
+
+    private:
+        BinarySceneFile() = default;
+        bool init();
+
+        const char* getString(uint32_t id) const { return mpStringData + mpStringOffsets[id]; }
+        uint32_t getStringLength(uint32_t id) const { return mpStringOffsets[id + 1] - mpStringOffsets[id] - 1; }
+        bool decodeValue(const uint32_t*& pWord, rapidjson::Value& value, rapidjson::Document::AllocatorType& allocator, bool expandInstances, uint32_t depth) const;
+
+        std::vector<uint8_t> mData;
+
+        // Pointers into mData
+        uint32_t mStringCount = 0;
+        const uint32_t* mpStringOffsets = nullptr;
+        const char* mpStringData = nullptr;
+        uint32_t mInstanceRangeCount = 0;
+        const InstanceRange* mpInstanceRanges = nullptr;
+        uint32_t mInstanceCount = 0;
+        const glm::vec3* mpTranslations = nullptr;
+        const glm::vec3* mpRotations = nullptr;
+        const glm::vec3* mpScalings = nullptr;
+        const uint32_t* mpInstanceNames = nullptr;
+        const uint32_t* mpInstanceFormats = nullptr;
+        const uint32_t* mpTree = nullptr;
+        const uint32_t* mpTreeEnd = nullptr;
+    };
+}
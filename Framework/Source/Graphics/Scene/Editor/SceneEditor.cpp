@@ -54,6 +54,21 @@ namespace Falcor
         const char* kActiveCameraStr = "Active Camera";
         const char* kPathsStr = "Paths";
         const char* kSelectedPathStr = "Selected Path";
+
+        // The journal doesn't record textures. Comparing these before and after editing a material detects texture changes
+        std::vector<const Texture*> getMaterialTextures(const Material* pMaterial)
+        {
+            std::vector<const Texture*> textures;
+            for (uint32_t i = 0; i < MatMaxLayers; i++)
+            {
+                textures.push_back(pMaterial->getLayer(i).pTexture.get());
+            }
+            textures.push_back(pMaterial->getNormalMap().get());
+            textures.push_back(pMaterial->getAlphaMap().get());
+            textures.push_back(pMaterial->getAmbientOcclusionMap().get());
+            textures.push_back(pMaterial->getHeightMap().get());
+            return textures;
+        }
     };
 
     const float SceneEditor::kCameraModelScale = 0.5f;
@@ -116,7 +131,7 @@ namespace Falcor
         if (pGui->addTextBox(kModelNameStr, modelName, arraysize(modelName)))
         {
             mpScene->getModel(mSelectedModel)->setName(modelName);
-            mSceneDirty = true;
+            markUnjournaledChange();
         }
     }
 
@@ -127,6 +142,7 @@ namespace Falcor
         if (pGui->addCheckBox("Visible", visible))
         {
             instance->setVisible(visible);
+            mpChangeSet->recordInstanceVisibility(mpScene.get(), mSelectedModel, mSelectedModelInstance);
             mSceneDirty = true;
         }
     }
@@ -137,7 +153,7 @@ namespace Falcor
         if (pGui->addFloatVar("Focal Length", focalLength, 0.0f, FLT_MAX, 0.5f))
         {
             mpScene->getActiveCamera()->setFocalLength(focalLength);
-            mSceneDirty = true;
+            markUnjournaledChange();
         }
     }
 
@@ -148,7 +164,7 @@ namespace Falcor
         {
             auto pCamera = mpScene->getActiveCamera();
             pCamera->setAspectRatio(aspectRatio);
-            mSceneDirty = true;
+            markUnjournaledChange();
         }
     }
 
@@ -162,7 +178,7 @@ namespace Falcor
             if (pGui->addFloatVar("Near Plane", nearPlane, 0, FLT_MAX, 0.1f) || (pGui->addFloatVar("Far Plane", farPlane, 0, FLT_MAX, 0.1f)))
             {
                 pCamera->setDepthRange(nearPlane, farPlane);
-                mSceneDirty = true;
+                markUnjournaledChange();
             }
             pGui->endGroup();
         }
@@ -180,7 +196,7 @@ namespace Falcor
                 if (pGui->addDropdown(kSelectedPathStr, pathList, activePath))
                 {
                     mSelectedPath = activePath;
-                    mSceneDirty = true;
+                    markUnjournaledChange();
                 }
             }
         }
@@ -206,7 +222,7 @@ namespace Falcor
         if (pGui->addDropdown(kActiveCameraStr, cameraList, camIndex))
         {
             mpScene->setActiveCamera(camIndex);
-            mSceneDirty = true;
+            markUnjournaledChange();
         }
     }
 
@@ -230,7 +246,7 @@ namespace Falcor
             mCameraNames.erase(oldName);
             mCameraNames.emplace(newName);
 
-            mSceneDirty = true;
+            markUnjournaledChange();
         }
     }
 
@@ -240,7 +256,7 @@ namespace Falcor
         if (pGui->addFloatVar("Camera Speed", speed, 0, FLT_MAX, 0.1f))
         {
             mpScene->setCameraSpeed(speed);
-            mSceneDirty = true;
+            markUnjournaledChange();
         }
     }
 
@@ -250,7 +266,7 @@ namespace Falcor
         if (pGui->addRgbColor("Ambient intensity", ambientIntensity))
         {
             mpScene->setAmbientIntensity(ambientIntensity);
-            mSceneDirty = true;
+            markUnjournaledChange();
         }
     }
 
@@ -261,6 +277,7 @@ namespace Falcor
         if (pGui->addFloat3Var("Translation", t, -FLT_MAX, FLT_MAX))
         {
             pInstance->setTranslation(t, true);
+            mpChangeSet->recordInstanceTransform(mpScene.get(), mSelectedModel, mSelectedModelInstance);
             mSceneDirty = true;
         }
     }
@@ -284,6 +301,7 @@ namespace Falcor
         if (pGui->addFloat3Var("Scaling", s, 0, FLT_MAX))
         {
             pInstance->setScaling(s);
+            mpChangeSet->recordInstanceTransform(mpScene.get(), mSelectedModel, mSelectedModelInstance);
             mSceneDirty = true;
         }
     }
@@ -295,7 +313,7 @@ namespace Falcor
         if (pGui->addFloat3Var("Position", position, -FLT_MAX, FLT_MAX))
         {
             pCamera->setPosition(position);
-            mSceneDirty = true;
+            markUnjournaledChange();
         }
     }
 
@@ -306,7 +324,7 @@ namespace Falcor
         if (pGui->addFloat3Var("Target", target, -FLT_MAX, FLT_MAX))
         {
             pCamera->setTarget(target);
-            mSceneDirty = true;
+            markUnjournaledChange();
         }
     }
 
@@ -317,7 +335,7 @@ namespace Falcor
         if (pGui->addFloat3Var("Up", up, -FLT_MAX, FLT_MAX))
         {
             pCamera->setUpVector(up);
-            mSceneDirty = true;
+            markUnjournaledChange();
         }
     }
 
@@ -332,6 +350,7 @@ namespace Falcor
             mpEditorScene->deleteModelInstance(mEditorLightModelID, instanceID);
         }
 
+        mpChangeSet->recordRemoveLight(mpScene.get(), id);
         mpScene->deleteLight(id);
 
         updateEditorModelIDs();
@@ -372,6 +391,7 @@ namespace Falcor
 
                 select(mpEditorScene->getModelInstance(mEditorLightModelID, mLightIDSceneToEditor[mSelectedLight]));
 
+                mpChangeSet->recordAddLight(mpScene.get(), mSelectedLight);
                 mSceneDirty = true;
             }
         }
@@ -390,13 +410,14 @@ namespace Falcor
                 }
 
                 auto pNewLight = DirectionalLight::create();
-                mpScene->addLight(pNewLight);
+                uint32_t lightID = mpScene->addLight(pNewLight);
 
                 // Name
                 std::string name = getUniqueNumberedName("DirLight", 0, mLightNames);
                 pNewLight->setName(name);
                 mLightNames.insert(name);
 
+                mpChangeSet->recordAddLight(mpScene.get(), lightID);
                 mSceneDirty = true;
             }
         }
@@ -407,8 +428,40 @@ namespace Falcor
         std::string filename;
         if (saveFileDialog(Scene::kFileFormatString, filename))
         {
-            SceneExporter::saveScene(filename, mpScene);
-            mSceneDirty = false;
+            // The exporter deletes the journal, so the recorded changes are no longer needed
+            if (mpChangeSet->compact(filename, mpScene))
+            {
+                mpScene->setFilename(filename);
+                mSceneDirty = false;
+                mJournalIncomplete = false;
+            }
+        }
+    }
+
+    void SceneEditor::saveChanges(Gui* pGui)
+    {
+        const std::string& filename = mpScene->getFilename();
+        if (filename.empty()) return;
+
+        // Only the delta is written, unless there are edits the journal can't record. Those require exporting the full scene
+        std::string label = mJournalIncomplete ? "Save Changes (Full Export)" : "Save Changes (" + std::to_string(mpChangeSet->getChangeCount()) + ")";
+        if (pGui->addButton(label.c_str()))
+        {
+            bool saved = mJournalIncomplete ? mpChangeSet->compact(filename, mpScene) : mpChangeSet->appendToJournal(SceneChangeSet::getJournalFilename(filename));
+            if (saved)
+            {
+                mSceneDirty = false;
+                mJournalIncomplete = false;
+            }
+        }
+
+        if (pGui->addButton("Compact Journal", true))
+        {
+            if (mpChangeSet->compact(filename, mpScene))
+            {
+                mSceneDirty = false;
+                mJournalIncomplete = false;
+            }
         }
     }
 
@@ -425,8 +478,12 @@ namespace Falcor
         : mpScene(pScene)
         , mModelLoadFlags(modelLoadFlags)
     {
+        mpChangeSet = SceneChangeSet::create();
         mpDebugDrawer = DebugDrawer::create();
 
+        // Appending to the journal would lose the edits of a journal which failed to replay
+        mJournalIncomplete = mpScene->needsFullExport();
+
         initializeEditorRendering();
         initializeEditorObjects();
 
@@ -621,6 +678,7 @@ namespace Falcor
     {
         mInstanceRotationAngles[mSelectedModel][mSelectedModelInstance] = rotation;
         mpScene->getModelInstance(mSelectedModel, mSelectedModelInstance)->setRotation(rotation);
+        mpChangeSet->recordInstanceTransform(mpScene.get(), mSelectedModel, mSelectedModelInstance);
         mSceneDirty = true;
     }
 
@@ -712,6 +770,12 @@ namespace Falcor
 
     void SceneEditor::materialEditorFinishedCB()
     {
+        mpChangeSet->recordMaterial(mpScene.get(), mSelectedMaterial);
+        mSceneDirty = true;
+        if (getMaterialTextures(mpScene->getMaterial(mSelectedMaterial).get()) != mEditedMaterialTextures)
+        {
+            markUnjournaledChange();
+        }
         mpMaterialEditor = nullptr;
     }
 
@@ -742,6 +806,11 @@ namespace Falcor
 
     void SceneEditor::detachObjectFromPaths(const IMovableObject::SharedPtr& pMovable)
     {
+        if (mObjToPathMap.count(pMovable.get()) > 0)
+        {
+            markUnjournaledChange();
+        }
+
         for (uint32_t i = 0; i < mpScene->getPathCount(); i++)
         {
             mpScene->getPath(i)->detachObject(pMovable);
@@ -783,11 +852,13 @@ namespace Falcor
             {
                 mInstanceRotationAngles[mSelectedModel][mSelectedModelInstance] = pInstance->getRotation();
             }
+            mpChangeSet->recordInstanceTransform(mpScene.get(), mSelectedModel, mSelectedModelInstance);
             break;
         }
 
         case ObjectType::Camera:
             activeGizmo->applyDelta(mpScene->getActiveCamera());
+            markUnjournaledChange();
             break;
 
         case ObjectType::Light:
@@ -797,6 +868,7 @@ namespace Falcor
             {
                 activeGizmo->applyDelta(pPointLight);
                 mpEditorScene->getModelInstance(mEditorLightModelID, mLightIDSceneToEditor[mSelectedLight])->setTranslation(pPointLight->getWorldPosition(), true);
+                mpChangeSet->recordLight(mpScene.get(), mSelectedLight);
             }
             break;
         }
@@ -813,6 +885,7 @@ namespace Falcor
                 pPath->setFramePosition(activeFrame, pInstance->getTranslation());
                 pPath->setFrameTarget(activeFrame, pInstance->getTarget());
                 pPath->setFrameUp(activeFrame, pInstance->getUpVector());
+                markUnjournaledChange();
             }
             break;
         }
@@ -998,6 +1071,7 @@ namespace Falcor
         {
             setCameraSpeed(pGui);
             setAmbientIntensity(pGui);
+            saveChanges(pGui);
             pGui->endGroup();
         }
     }
@@ -1081,7 +1155,13 @@ namespace Falcor
                 if (pGui->beginGroup(name.c_str()))
                 {
                     const auto& pLight = mpScene->getLight(i);
+                    LightData oldData = pLight->getData();
                     pLight->renderUI(pGui);
+                    if (memcmp(&oldData, &pLight->getData(), sizeof(LightData)) != 0)
+                    {
+                        mpChangeSet->recordLight(mpScene.get(), i);
+                        mSceneDirty = true;
+                    }
 
                     if (pLight->getType() == LightPoint)
                     {
@@ -1323,6 +1403,7 @@ namespace Falcor
 
                     mSelectedModel = mpScene->getModelCount() - 1;
                     mSelectedModelInstance = 0;
+                    mpChangeSet->recordAddInstance(mpScene.get(), mSelectedModel, mSelectedModelInstance, mModelLoadFlags);
 
                     mInstanceRotationAngles.emplace_back();
                     mInstanceRotationAngles.back().push_back(mpScene->getModelInstance(mSelectedModel, mSelectedModelInstance)->getRotation());
@@ -1336,6 +1417,13 @@ namespace Falcor
     {
         // Cleanup individual instances
         const uint32_t instanceCount = mpScene->getModelInstanceCount(mSelectedModel);
+
+        // Record the removal from the last instance to the first, so the recorded indices are valid when replayed
+        for (uint32_t i = instanceCount; i > 0; i--)
+        {
+            mpChangeSet->recordRemoveInstance(mpScene.get(), mSelectedModel, i - 1);
+        }
+
         for (uint32_t i = 0; i < instanceCount; i++)
         {
             auto& pInstance = mpScene->getModelInstance(mSelectedModel, i);
@@ -1386,6 +1474,7 @@ namespace Falcor
                 auto& pNewInstance = mpScene->getModelInstance(mSelectedModel, mSelectedModelInstance);
                 mInstanceRotationAngles[mSelectedModel].push_back(pNewInstance->getRotation());
                 select(pNewInstance);
+                mpChangeSet->recordAddInstance(mpScene.get(), mSelectedModel, mSelectedModelInstance, mModelLoadFlags);
 
                 mSceneDirty = true;
             }
@@ -1421,6 +1510,7 @@ namespace Falcor
                 detachObjectFromPaths(pInstance);
                 mInstanceNames.erase(pInstance->getName());
 
+                mpChangeSet->recordRemoveInstance(mpScene.get(), mSelectedModel, mSelectedModelInstance);
                 mpScene->deleteModelInstance(mSelectedModel, mSelectedModelInstance);
 
                 auto& modelRotations = mInstanceRotationAngles[mSelectedModel];
@@ -1458,7 +1548,7 @@ namespace Falcor
 
                 select(mpEditorScene->getModelInstance(mEditorCameraModelID, camIndex));
 
-                mSceneDirty = true;
+                markUnjournaledChange();
             }
         }
     }
@@ -1477,7 +1567,7 @@ namespace Falcor
                 updateEditorModelIDs();
                 deselect();
 
-                mSceneDirty = true;
+                markUnjournaledChange();
             }
         }
     }
@@ -1493,7 +1583,7 @@ namespace Falcor
                 mSelectedPath = mpScene->addPath(pPath);
 
                 startPathEditor();
-                mSceneDirty = true;
+                markUnjournaledChange();
             }
         }
     }
@@ -1517,7 +1607,7 @@ namespace Falcor
                     mSelectedPath = mpScene->getPathCount() - 1;
                 }
 
-                mSceneDirty = true;
+                markUnjournaledChange();
             }
         }
     }
@@ -1608,7 +1698,7 @@ namespace Falcor
             select(mpEditorScene->getModelInstance(mEditorKeyframeModelID, 0));
         }
 
-        mSceneDirty = true;
+        markUnjournaledChange();
     }
 
     void SceneEditor::startPathEditor(Gui* pGui)
@@ -1652,6 +1742,8 @@ namespace Falcor
         uint32_t newPathID = oldPathID;
         if (pGui->addDropdown(label.c_str(), getPathDropdownList(mpScene.get(), true), newPathID))
         {
+            markUnjournaledChange();
+
             // Detach from old path
             if (oldPathID != Scene::kNoPath)
             {
@@ -1688,6 +1780,8 @@ namespace Falcor
                 std::string name("Material" + std::to_string(mpScene->getMaterialCount()));
                 mpScene->addMaterial(Material::create(name));
                 mSelectedMaterial = mpScene->getMaterialCount() - 1;
+                mpChangeSet->recordAddMaterial(mpScene.get(), mSelectedMaterial);
+                mSceneDirty = true;
             }
         }
     }
@@ -1698,6 +1792,7 @@ namespace Falcor
         {
             if (pGui->addButton("Edit Material", true))
             {
+                mEditedMaterialTextures = getMaterialTextures(mpScene->getMaterial(mSelectedMaterial).get());
                 mpMaterialEditor = MaterialEditor::create(mpScene->getMaterial(mSelectedMaterial), [this](){ materialEditorFinishedCB(); });
             }
         }
@@ -1736,10 +1831,21 @@ namespace Falcor
 
             auto& pMaterialHistory = mpScene->getMaterialHistory();
 
+            // The journal refers to the mesh by its index in the model
+            const auto& pModel = mpScene->getModel(mSelectedModel);
+            uint32_t meshID = 0;
+            while (meshID < pModel->getMeshCount() && pModel->getMesh(meshID) != mpSelectedMesh)
+            {
+                meshID++;
+            }
+            assert(meshID < pModel->getMeshCount());
+
             if (pGui->addButton("Apply to Mesh"))
             {
                 // Save original material
                 pMaterialHistory->replace(mpSelectedMesh.get(), mpScene->getMaterial(mSelectedMaterial));
+                mpChangeSet->recordMaterialOverride(mpScene.get(), mSelectedModel, meshID, mSelectedMaterial);
+                mSceneDirty = true;
             }
 
             // Check if mesh has been overridden
@@ -1748,6 +1854,8 @@ namespace Falcor
                 if (pGui->addButton("Revert Override", true))
                 {
                     pMaterialHistory->revert(mpSelectedMesh.get());
+                    mpChangeSet->recordMaterialOverride(mpScene.get(), mSelectedModel, meshID, uint32_t(-1));
+                    mSceneDirty = true;
                 }
             }
         }
@@ -1759,8 +1867,10 @@ namespace Falcor
         {
             if (pGui->addButton("Delete Material", true))
             {
+                mpChangeSet->recordRemoveMaterial(mpScene.get(), mSelectedMaterial);
                 mpScene->deleteMaterial(mSelectedMaterial);
                 mSelectedMaterial = 0;
+                mSceneDirty = true;
             }
         }
     }
@@ -35,6 +35,7 @@
 #include "Graphics/Scene/Editor/Gizmo.h"
 #include "Graphics/Scene/Editor/SceneEditorRenderer.h"
 #include "Graphics/Material/MaterialHistory.h"
+#include "Graphics/Scene/SceneChangeSet.h"
 
 namespace Falcor
 {
@@ -97,6 +98,13 @@ namespace Falcor
 
         bool mSceneDirty = false;
 
+        // Edits to instances, lights and materials. Saved incrementally to the scene's journal
+        SceneChangeSet::SharedPtr mpChangeSet;
+
+        // Set while there are unsaved changes the journal can't record (cameras, paths, model names, textures...). Saving them requires a full export
+        bool mJournalIncomplete = false;
+        void markUnjournaledChange() { mSceneDirty = true; mJournalIncomplete = true; }
+
         // Main GUI functions
         void renderModelElements(Gui* pGui);
         void renderCameraElements(Gui* pGui);
@@ -157,6 +165,7 @@ namespace Falcor
         // Global functions
         void setAmbientIntensity(Gui* pGui);
         void saveScene();
+        void saveChanges(Gui* pGui);
 
         void renderModelAnimation(Gui* pGui);
 
@@ -293,6 +302,7 @@ namespace Falcor
         void materialEditorFinishedCB();
 
         MaterialEditor::UniquePtr mpMaterialEditor;
+        std::vector<const Texture*> mEditedMaterialTextures;    // The textures of the material when the editor was opened
         std::string mSelectedMeshString;
         Mesh::SharedPtr mpSelectedMesh;
 
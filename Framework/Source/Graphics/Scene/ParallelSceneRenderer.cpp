@@ -0,0 +1,465 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ParallelSceneRenderer.h"
+#include "API/Device.h"
+#include "Graphics/Material/MaterialSystem.h"
+#include "Utils/Threading.h"
+#include <unordered_set>
+
+namespace Falcor
+{
+    static void prepareTexture(RenderContext* pContext, const Texture* pTexture)
+    {
+        if (pTexture)
+        {
+            // Views are created lazily, make sure the workers only read them
+            pTexture->getSRV();
+            pContext->resourceBarrier(pTexture, Resource::State::ShaderResource);
+        }
+    }
+
+    static void prepareMaterial(RenderContext* pContext, const Material* pMaterial)
+    {
+        // Finalizes the material and creates its parameter-block. Both are done lazily and aren't thread-safe
+        pMaterial->getParameterBlock();
+
+        for (uint32_t i = 0; i < pMaterial->getNumLayers(); i++)
+        {
+            prepareTexture(pContext, pMaterial->getLayer(i).pTexture.get());
+        }
+        prepareTexture(pContext, pMaterial->getNormalMap().get());
+        prepareTexture(pContext, pMaterial->getAlphaMap().get());
+        prepareTexture(pContext, pMaterial->getAmbientOcclusionMap().get());
+        prepareTexture(pContext, pMaterial->getHeightMap().get());
+    }
+
+    static void prepareVao(RenderContext* pContext, const Vao* pVao)
+    {
+        for (uint32_t i = 0; i < pVao->getVertexBuffersCount(); i++)
+        {
+            const Buffer* pVB = pVao->getVertexBuffer(i).get();
+            if (pVB)
+            {
+                pContext->resourceBarrier(pVB, Resource::State::VertexBuffer);
+            }
+        }
+
+        const Buffer* pIB = pVao->getIndexBuffer().get();
+        if (pIB)
+        {
+            pContext->resourceBarrier(pIB, Resource::State::IndexBuffer);
+        }
+    }
+
+    static void prepareFbo(RenderContext* pContext, const Fbo* pFbo)
+    {
+        if (pFbo == nullptr) return;
+
+        for (uint32_t i = 0; i < Fbo::getMaxColorTargetCount(); i++)
+        {
+            const Texture* pTexture = pFbo->getColorTexture(i).get();
+            if (pTexture)
+            {
+                pFbo->getRenderTargetView(i);
+                pContext->resourceBarrier(pTexture, Resource::State::RenderTarget);
+            }
+        }
+
+        const Texture* pDepth = pFbo->getDepthStencilTexture().get();
+        if (pDepth)
+        {
+            pFbo->getDepthStencilView();
+            pContext->resourceBarrier(pDepth, Resource::State::DepthStencil);
+        }
+    }
+
+    static void copyGraphicsState(const GraphicsState* pSrc, GraphicsState* pDst)
+    {
+        pDst->setProgram(pSrc->getProgram());
+        pDst->setFbo(pSrc->getFbo(), false);
+        for (uint32_t i = 0; i < (uint32_t)pSrc->getViewports().size(); i++)
+        {
+            pDst->setViewport(i, pSrc->getViewport(i), false);
+            pDst->setScissors(i, pSrc->getScissors(i));
+        }
+        pDst->setBlendState(pSrc->getBlendState());
+        pDst->setRasterizerState(pSrc->getRasterizerState());
+        pDst->setDepthStencilState(pSrc->getDepthStencilState());
+        pDst->setSampleMask(pSrc->getSampleMask());
+        pDst->setStencilRef(pSrc->getStencilRef());
+        pDst->toggleSinglePassStereo(pSrc->isSinglePassStereoEnabled());
+    }
+
+    static ConstantBuffer::SharedPtr createConstantBuffer(const ParameterBlockReflection* pReflection, const std::string& name)
+    {
+        for (const auto& resource : pReflection->getResourceVec())
+        {
+            if (resource.name == name && resource.setType == DescriptorSet::Type::Cbv)
+            {
+                return ConstantBuffer::create(resource.name, resource.pType);
+            }
+        }
+        return nullptr;
+    }
+
+    ParallelSceneRenderer::SharedPtr ParallelSceneRenderer::create(const Scene::SharedPtr& pScene)
+    {
+        return SharedPtr(new ParallelSceneRenderer(pScene));
+    }
+
+    ParallelSceneRenderer::ParallelSceneRenderer(const Scene::SharedPtr& pScene) : SceneRenderer(pScene)
+    {
+        Threading::start();
+    }
+
+    ProgramVersion::SharedConstPtr ParallelSceneRenderer::resolveProgramVersion(GraphicsProgram* pProgram, const Mesh* pMesh)
+    {
+        // Apply the same defines SceneRenderer applies before a draw
+        if (pMesh->hasBones())
+        {
+            pProgram->addDefine("_VERTEX_BLENDING");
+        }
+        if (mCompileMaterialWithProgram)
+        {
+            MaterialSystem::patchProgram(pProgram, pMesh->getMaterial().get());
+        }
+        const auto& pLayout = pMesh->getVao()->getVertexLayout();
+        if (pLayout)
+        {
+            pLayout->addVertexAttribDclToProg(pProgram);
+        }
+
+        ProgramVersion::SharedConstPtr pVersion = pProgram->getActiveVersion();
+
+        pProgram->removeDefine("_MS_STATIC_MATERIAL_DESC");
+        if (pMesh->hasBones())
+        {
+            pProgram->removeDefine("_VERTEX_BLENDING");
+        }
+        return pVersion;
+    }
+
+    bool ParallelSceneRenderer::buildDrawList(GraphicsProgram* pProgram, const Camera* pCamera)
+    {
+        mDrawList.clear();
+        mMeshInstances.clear();
+        mProgramVersions.clear();
+
+        uint32_t drawID = 0;
+        for (uint32_t modelID = 0; modelID < mpScene->getModelCount(); modelID++)
+        {
+            const Model* pModel = mpScene->getModel(modelID).get();
+            for (uint32_t instanceID = 0; instanceID < mpScene->getModelInstanceCount(modelID); instanceID++)
+            {
+                const Scene::ModelInstance* pModelInstance = mpScene->getModelInstance(modelID, instanceID).get();
+                if (pModelInstance->isVisible() == false) continue;
+
+                for (uint32_t meshID = 0; meshID < pModel->getMeshCount(); meshID++)
+                {
+                    const Mesh* pMesh = pModel->getMesh(meshID).get();
+                    DrawItem item;
+                    item.pModel = pModel;
+                    item.pModelInstance = pModelInstance;
+                    item.modelInstanceID = instanceID;
+                    item.pMesh = pMesh;
+                    item.firstMeshInstance = (uint32_t)mMeshInstances.size();
+                    item.firstDrawID = drawID;
+
+                    for (uint32_t i = 0; i < pModel->getMeshInstanceCount(meshID); i++)
+                    {
+                        const Model::MeshInstance* pMeshInstance = pModel->getMeshInstance(meshID, i).get();
+                        if (pMeshInstance->isVisible() == false) continue;
+                        if (mCullEnabled && pCamera->isObjectCulled(pMeshInstance->getBoundingBox().transform(pModelInstance->getTransformMatrix()))) continue;
+
+                        mMeshInstances.push_back(pMeshInstance);
+                        item.meshInstanceCount++;
+                        drawID++;
+
+                        if (item.meshInstanceCount == mMaxInstanceCount)
+                        {
+                            mDrawList.push_back(item);
+                            item.firstMeshInstance = (uint32_t)mMeshInstances.size();
+                            item.firstDrawID = drawID;
+                            item.meshInstanceCount = 0;
+                        }
+                    }
+
+                    if (item.meshInstanceCount)
+                    {
+                        mDrawList.push_back(item);
+                    }
+                }
+            }
+        }
+
+        // Resolving the program version changes the program's defines, so it has to happen here and not on the workers
+        for (auto& item : mDrawList)
+        {
+            auto& pVersion = mProgramVersions[item.pMesh];
+            if (pVersion == nullptr)
+            {
+                pVersion = resolveProgramVersion(pProgram, item.pMesh);
+                if (pVersion == nullptr) return false;
+            }
+            item.pProgramVersion = pVersion;
+        }
+        return true;
+    }
+
+    void ParallelSceneRenderer::prepareSharedResources(RenderContext* pContext, GraphicsVars* pVars, const GraphicsState* pState)
+    {
+        std::unordered_set<const Material*> materials;
+        std::unordered_set<const Vao*> vaos;
+        for (const auto& item : mDrawList)
+        {
+            const Material* pMaterial = item.pMesh->getMaterial().get();
+            if (materials.insert(pMaterial).second)
+            {
+                prepareMaterial(pContext, pMaterial);
+            }
+            const Vao* pVao = item.pMesh->getVao().get();
+            if (vaos.insert(pVao).second)
+            {
+                prepareVao(pContext, pVao);
+            }
+        }
+
+        prepareFbo(pContext, pState->getFbo().get());
+
+        // Upload the per-frame data and the user's buffers. The chunks reference the same buffers and only read them
+        pVars->prepareForDraw(pContext);
+
+        // The bone offsets are initialized lazily by setPerModelData(). Do it here so that the workers don't race on it
+        if (sBonesOffset == ConstantBuffer::kInvalidOffset || sBonesInvTransposeOffset == ConstantBuffer::kInvalidOffset)
+        {
+            ConstantBuffer::SharedPtr pBoneCB = pVars->getDefaultBlock()->getReflection()->getResource(kBoneCbName) ? pVars->getConstantBuffer(kBoneCbName) : nullptr;
+            if (pBoneCB)
+            {
+                sBonesOffset = pBoneCB->getVariableOffset("gBoneMat[0]");
+                sBonesInvTransposeOffset = pBoneCB->getVariableOffset("gInvTransposeBoneMat[0]");
+            }
+        }
+    }
+
+    void ParallelSceneRenderer::updateVarsSignature(const GraphicsVars* pVars)
+    {
+        // Must be called after prepareForDraw(). Binding a resource releases the descriptor-set, and a set is only shared through the cache by blocks with the same resources
+        mVarsSignature.clear();
+        mVarsSignature.push_back(pVars);
+        auto addBlock = [this](const ParameterBlock* pBlock)
+        {
+            mVarsSignature.push_back(pBlock);
+            for (const auto& rootSet : pBlock->getRootSets())
+            {
+                mVarsSignature.push_back(rootSet.pSet.get());
+            }
+        };
+        addBlock(pVars->getDefaultBlock().get());
+        for (uint32_t i = 0; i < pVars->getParameterBlockCount(); i++)
+        {
+            addBlock(pVars->getParameterBlock(i).get());
+        }
+    }
+
+    void ParallelSceneRenderer::prepareChunk(ChunkData& chunk, const GraphicsVars* pVars, const GraphicsState* pState)
+    {
+        if (chunk.pContext == nullptr)
+        {
+            chunk.pContext = RenderContext::create(gpDevice->getCommandQueueHandle(LowLevelContextData::CommandQueueType::Direct, 0));
+            chunk.pState = GraphicsState::create();
+        }
+
+        // Recycles the command allocator used by the chunk in a previous frame
+        chunk.pContext->reset();
+
+        // Each chunk owns the buffers which change between draws
+        const ParameterBlockReflection* pBlockReflection = pVars->getDefaultBlock()->getReflection().get();
+        if (chunk.pBlockReflection != pBlockReflection)
+        {
+            chunk.pBlockReflection = pBlockReflection;
+            chunk.constantBuffers.clear();
+            chunk.varsSignature.clear();
+            for (const char* name : { kPerMeshCbName, kPerMaterialCbName, kBoneCbName })
+            {
+                ConstantBuffer::SharedPtr pCB = createConstantBuffer(pBlockReflection, name);
+                if (pCB) chunk.constantBuffers.push_back({ name, pCB });
+            }
+        }
+
+        // The clone references the same resources as the source vars. Only clone again when something was bound to the source
+        if (chunk.pVars == nullptr || chunk.varsSignature != mVarsSignature)
+        {
+            chunk.pVars = pVars->clone();
+            for (const auto& cb : chunk.constantBuffers)
+            {
+                chunk.pVars->setConstantBuffer(cb.first, cb.second);
+            }
+            chunk.varsSignature = mVarsSignature;
+        }
+
+        copyGraphicsState(pState, chunk.pState.get());
+        chunk.pContext->setGraphicsState(chunk.pState);
+        chunk.pContext->setGraphicsVars(chunk.pVars);
+    }
+
+    void ParallelSceneRenderer::recordChunk(ChunkData& chunk, const Camera* pCamera, uint32_t begin, uint32_t end)
+    {
+        CurrentWorkingData currentData;
+        currentData.pContext = chunk.pContext.get();
+        currentData.pState = chunk.pState.get();
+        currentData.pVars = chunk.pVars.get();
+        currentData.pCamera = pCamera;
+        currentData.pModel = nullptr;
+        currentData.pMaterial = nullptr;
+        currentData.drawID = 0;
+        resolveBindHandles(currentData);
+
+        const Scene::ModelInstance* pModelInstance = nullptr;
+        const Mesh* pMesh = nullptr;
+        const Material* pMaterial = nullptr;
+        bool modelValid = false;
+        bool modelInstanceValid = false;
+        bool meshValid = false;
+
+        for (uint32_t i = begin; i < end; i++)
+        {
+            const DrawItem& item = mDrawList[i];
+
+            if (currentData.pModel != item.pModel)
+            {
+                currentData.pModel = item.pModel;
+                modelValid = setPerModelData(currentData);
+                pModelInstance = nullptr;
+            }
+            if (modelValid == false) continue;
+
+            if (pModelInstance != item.pModelInstance)
+            {
+                pModelInstance = item.pModelInstance;
+                modelInstanceValid = setPerModelInstanceData(currentData, pModelInstance, item.modelInstanceID);
+                pMesh = nullptr;
+                pMaterial = nullptr;
+            }
+            if (modelInstanceValid == false) continue;
+
+            if (pMesh != item.pMesh)
+            {
+                pMesh = item.pMesh;
+                meshValid = setPerMeshData(currentData, pMesh);
+                currentData.pState->setVao(pMesh->getVao());
+                currentData.pState->setProgramVersion(item.pProgramVersion);
+            }
+            if (meshValid == false) continue;
+
+            currentData.pMaterial = pMesh->getMaterial().get();
+            if (pMaterial != currentData.pMaterial)
+            {
+                if (setPerMaterialData(currentData, currentData.pMaterial) == false) continue;
+                pMaterial = currentData.pMaterial;
+                gEventCounter.numMaterialChanges++;
+            }
+
+            currentData.drawID = item.firstDrawID;
+            uint32_t activeInstances = 0;
+            for (uint32_t j = 0; j < item.meshInstanceCount; j++)
+            {
+                if (setPerMeshInstanceData(currentData, pModelInstance, mMeshInstances[item.firstMeshInstance + j], activeInstances))
+                {
+                    currentData.drawID++;
+                    activeInstances++;
+                }
+            }
+
+            if (activeInstances)
+            {
+                executeDraw(currentData, pMesh->getIndexCount(), activeInstances);
+                postFlushDraw(currentData);
+            }
+        }
+    }
+
+    void ParallelSceneRenderer::renderScene(RenderContext* pContext, Camera* pCamera)
+    {
+        const GraphicsState::SharedPtr& pState = pContext->getGraphicsState();
+        const GraphicsVars::SharedPtr& pVars = pContext->getGraphicsVars();
+        updateVariableOffsets(pVars->getReflection().get());
+
+        uint32_t maxChunkCount = mMaxChunkCount ? mMaxChunkCount : Threading::getThreadCount() + 1;
+        uint32_t chunkCount = 0;
+        if (maxChunkCount > 1 && buildDrawList(pState->getProgram().get(), pCamera))
+        {
+            chunkCount = std::min(maxChunkCount, (uint32_t)mDrawList.size() / mMinDrawsPerChunk);
+        }
+
+        if (chunkCount < 2)
+        {
+            mLastChunkCount = 0;
+            SceneRenderer::renderScene(pContext, pCamera);
+            return;
+        }
+        mLastChunkCount = chunkCount;
+
+        CurrentWorkingData currentData;
+        currentData.pContext = pContext;
+        currentData.pState = pState.get();
+        currentData.pVars = pVars.get();
+        currentData.pCamera = pCamera;
+        currentData.pMaterial = nullptr;
+        currentData.pModel = nullptr;
+        currentData.drawID = 0;
+        resolveBindHandles(currentData);
+        setPerFrameData(currentData);
+
+        prepareSharedResources(pContext, pVars.get(), pState.get());
+        updateVarsSignature(pVars.get());
+
+        // Commands recorded so far must execute before the chunks
+        pContext->flush();
+
+        if (mChunks.size() < chunkCount)
+        {
+            mChunks.resize(chunkCount);
+        }
+        for (uint32_t c = 0; c < chunkCount; c++)
+        {
+            prepareChunk(mChunks[c], pVars.get(), pState.get());
+        }
+
+        Threading::parallelFor((uint32_t)mDrawList.size(), chunkCount, [this, pCamera](uint32_t begin, uint32_t end, uint32_t chunkIndex)
+        {
+            recordChunk(mChunks[chunkIndex], pCamera, begin, end);
+        });
+
+        // Submit in chunk order
+        for (uint32_t c = 0; c < chunkCount; c++)
+        {
+            mChunks[c].pContext->flush();
+        }
+    }
+}
@@ -0,0 +1,121 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <unordered_map>
+#include "Graphics/Scene/SceneRenderer.h"
+#include "Graphics/GraphicsState.h"
+#include "Graphics/Program/ProgramVars.h"
+#include "API/RenderContext.h"
+
+namespace Falcor
+{
+    /** Scene renderer which records the draw calls on worker threads.
+        The calling thread traverses and culls the scene, resolves the program version of each draw and transitions the shared resources.
+        The resulting draw list is split into chunks. Each chunk is recorded on a worker thread into its own context, and the contexts are submitted in chunk order,
+        so the GPU executes the draws in the same order as SceneRenderer would.
+        Classes deriving from this one must make setPerModelData(), setPerModelInstanceData(), setPerMeshData(), setPerMeshInstanceData(), setPerMaterialData(), executeDraw() and postFlushDraw()
+        safe to call concurrently with different CurrentWorkingData objects.
+    */
+    class ParallelSceneRenderer : public SceneRenderer
+    {
+    public:
+        using SharedPtr = std::shared_ptr<ParallelSceneRenderer>;
+        using SharedConstPtr = std::shared_ptr<const ParallelSceneRenderer>;
+
+        /** Create a renderer instance
+            \param[in] pScene Scene this renderer is responsible for rendering
+        */
+        static SharedPtr create(const Scene::SharedPtr& pScene);
+
+        using SceneRenderer::renderScene;
+
+        /** Renders the full scene, overriding the internal camera.
+            Must be called from the thread which owns the context. Call update() before using this function otherwise model animation will not work
+        */
+        void renderScene(RenderContext* pContext, Camera* pCamera) override;
+
+        /** Set the maximal number of chunks the draw list is split into. Each chunk is recorded into a separate context.
+            \param[in] chunkCount The number of chunks. If 0, will use the number of worker threads plus one
+        */
+        void setMaxChunkCount(uint32_t chunkCount) { mMaxChunkCount = chunkCount; }
+
+        /** Set the minimal number of draw calls a chunk should contain. If the scene has less than twice this number of draws, it will be recorded on the calling thread
+        */
+        void setMinDrawsPerChunk(uint32_t drawCount) { mMinDrawsPerChunk = std::max(1u, drawCount); }
+
+        /** Get the number of chunks used to record the last frame. Returns 0 if the last frame was recorded on the calling thread
+        */
+        uint32_t getLastChunkCount() const { return mLastChunkCount; }
+
+    protected:
+        ParallelSceneRenderer(const Scene::SharedPtr& pScene);
+
+        /** A single draw call. The mesh instances of the draw are stored in mMeshInstances, starting at firstMeshInstance
+        */
+        struct DrawItem
+        {
+            const Model* pModel = nullptr;
+            const Scene::ModelInstance* pModelInstance = nullptr;
+            uint32_t modelInstanceID = 0;
+            const Mesh* pMesh = nullptr;
+            ProgramVersion::SharedConstPtr pProgramVersion;
+            uint32_t firstMeshInstance = 0;
+            uint32_t meshInstanceCount = 0;
+            uint32_t firstDrawID = 0;
+        };
+
+        /** The objects used to record a chunk
+        */
+        struct ChunkData
+        {
+            RenderContext::SharedPtr pContext;
+            GraphicsState::SharedPtr pState;
+            GraphicsVars::SharedPtr pVars;
+            const ParameterBlockReflection* pBlockReflection = nullptr;   // The reflection the constant buffers were created for
+            std::vector<std::pair<const char*, ConstantBuffer::SharedPtr>> constantBuffers;
+            std::vector<const void*> varsSignature;                         // The signature of the vars pVars was cloned from
+        };
+
+        bool buildDrawList(GraphicsProgram* pProgram, const Camera* pCamera);
+        ProgramVersion::SharedConstPtr resolveProgramVersion(GraphicsProgram* pProgram, const Mesh* pMesh);
+        void prepareSharedResources(RenderContext* pContext, GraphicsVars* pVars, const GraphicsState* pState);
+        void prepareChunk(ChunkData& chunk, const GraphicsVars* pVars, const GraphicsState* pState);
+        void updateVarsSignature(const GraphicsVars* pVars);
+        void recordChunk(ChunkData& chunk, const Camera* pCamera, uint32_t begin, uint32_t end);
+
+        std::vector<DrawItem> mDrawList;
+        std::vector<const Model::MeshInstance*> mMeshInstances;
+        std::unordered_map<const Mesh*, ProgramVersion::SharedConstPtr> mProgramVersions;
+        std::vector<ChunkData> mChunks;
+        std::vector<const void*> mVarsSignature;    // The vars object, its parameter-blocks and their descriptor-sets. Changes whenever a resource is bound to the vars
+
+        uint32_t mMaxChunkCount = 0;
+        uint32_t mMinDrawsPerChunk = 32;
+        uint32_t mLastChunkCount = 0;
+    };
+}
@@ -28,6 +28,8 @@
 #include "Framework.h"
 #include "Scene.h"
 #include "SceneImporter.h"
+#include "SceneChangeSet.h"
+#include "Utils/Platform/OS.h"
 #include "glm/gtx/euler_angles.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 
@@ -37,14 +39,40 @@ namespace Falcor
 
     const Scene::UserVariable Scene::kInvalidVar;
 
-    const char* Scene::kFileFormatString = "Scene files\0*.fscene\0\0";
+    const char* Scene::kFileFormatString = "Scene files\0*.fscene;*.fsceneb\0\0";
 
     Scene::SharedPtr Scene::loadFromFile(const std::string& filename, Model::LoadFlags modelLoadFlags, Scene::LoadFlags sceneLoadFlags)
     {
         Scene::SharedPtr pScene = create();
-        if (SceneImporter::loadScene(*pScene, filename, modelLoadFlags, sceneLoadFlags) == false)
+
+        // Keep the material history until the journal was replayed, it's needed to revert mesh material overrides
+        if (SceneImporter::loadScene(*pScene, filename, modelLoadFlags, sceneLoadFlags | Scene::LoadFlags::StoreMaterialHistory) == false)
+        {
+            return nullptr;
+        }
+
+        std::string fullpath;
+        pScene->mFilename = findFileInDataDirectories(filename, fullpath) ? fullpath : filename;
+
+        // Replay the edits which were saved as a journal since the scene file was last written
+        std::string journalFilename = SceneChangeSet::getJournalFilename(pScene->mFilename);
+        if (doesFileExist(journalFilename))
+        {
+            SceneChangeSet::SharedPtr pChangeSet = SceneChangeSet::loadJournal(journalFilename);
+            if (pChangeSet == nullptr || pChangeSet->apply(pScene.get()) == false)
+            {
+                // The scene can be partially patched. Edits appended to this journal would never be replayed, so move it out of the way and make the next save a full export
+                std::string failedFilename = journalFilename + ".failed";
+                std::remove(failedFilename.c_str());
+                bool moved = (std::rename(journalFilename.c_str(), failedFilename.c_str()) == 0);
+                logWarning("Scene::loadFromFile() - failed to apply the journal '" + journalFilename + "'. The scene might be missing some edits. " + (moved ? "The journal was moved to '" + failedFilename + "'" : "Can't move the journal"));
+                pScene->mNeedsFullExport = true;
+            }
+        }
+
+        if (is_set(sceneLoadFlags, Scene::LoadFlags::StoreMaterialHistory) == false)
         {
-            pScene = nullptr;
+            pScene->deleteMaterialHistory();
         }
         return pScene;
     }
@@ -61,50 +89,231 @@ namespace Falcor
         Model::resetGlobalIdCounter();
 
         mpMaterialHistory = MaterialHistory::create();
+        mpTransformHierarchy = TransformHierarchy::create();
+    }
+
+    Scene::~Scene()
+    {
+        // Instances can be shared with other scenes and outlive this one
+        untrackAllInstances();
+        removeAllInstanceNodes();
+    }
+
+    void Scene::trackInstance(const ModelInstance* pInstance)
+    {
+        if (mInstanceBounds.find(pInstance) != mInstanceBounds.end()) return;
+        InstanceBounds bounds;
+        bounds.slot = mBoundsTree.insert(pInstance->getBoundingBox());
+        bounds.moved = false;
+        mInstanceBounds[pInstance] = bounds;
+        pInstance->addTransformObserver(this);
+    }
+
+    void Scene::untrackInstance(const ModelInstance* pInstance)
+    {
+        auto it = mInstanceBounds.find(pInstance);
+        if (it == mInstanceBounds.end()) return;
+        mBoundsTree.remove(it->second.slot);
+        mInstanceBounds.erase(it);
+        pInstance->removeTransformObserver(this);
+    }
+
+    void Scene::untrackAllInstances()
+    {
+        for (const auto& it : mInstanceBounds) it.first->removeTransformObserver(this);
+        mInstanceBounds.clear();
+        mMovedInstances.clear();
+        mBoundsTree.clear();
+    }
+
+    void Scene::onInstanceTransformChanged(const ModelInstance* pInstance)
+    {
+        auto it = mInstanceBounds.find(pInstance);
+        if (it != mInstanceBounds.end() && it->second.moved == false)
+        {
+            it->second.moved = true;
+            mMovedInstances.push_back(pInstance);
+        }
+    }
+
+    bool Scene::hasModelInstance(const ModelInstance* pInstance) const
+    {
+        for (const auto& instances : mModels)
+        {
+            for (const auto& pOther : instances)
+            {
+                if (pOther.get() == pInstance) return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t Scene::getInstanceNode(ModelInstance* pInstance)
+    {
+        auto it = mInstanceNodes.find(pInstance);
+        if (it != mInstanceNodes.end()) return it->second;
+
+        uint32_t node;
+        if (mFreeNodes.size())
+        {
+            // Released nodes were already detached from their parent and children
+            node = mFreeNodes.back();
+            mFreeNodes.pop_back();
+            mpTransformHierarchy->setLocalMatrix(node, pInstance->getLocalTransformMatrix());
+            mNodeInstances[node] = pInstance;
+        }
+        else
+        {
+            node = mpTransformHierarchy->addNode(TransformHierarchy::kInvalidNode, pInstance->getLocalTransformMatrix());
+            mNodeInstances.push_back(pInstance);
+        }
+        mInstanceNodes[pInstance] = node;
+        return node;
+    }
+
+    void Scene::removeInstanceNode(const ModelInstance* pInstance)
+    {
+        auto it = mInstanceNodes.find(pInstance);
+        if (it == mInstanceNodes.end()) return;
+        uint32_t node = it->second;
+
+        // The children keep their own transforms and become root instances
+        for (uint32_t child = 0; child < (uint32_t)mNodeInstances.size(); child++)
+        {
+            if (mNodeInstances[child] && mpTransformHierarchy->getParent(child) == node)
+            {
+                mpTransformHierarchy->setParent(child, TransformHierarchy::kInvalidNode);
+                mNodeInstances[child]->setParentTransform(glm::mat4(), glm::mat4());
+            }
+        }
+
+        // The instance can still be used by another scene
+        mNodeInstances[node]->setParentTransform(glm::mat4(), glm::mat4());
+        mpTransformHierarchy->setParent(node, TransformHierarchy::kInvalidNode);
+        mNodeInstances[node] = nullptr;
+        mFreeNodes.push_back(node);
+        mInstanceNodes.erase(it);
     }
 
-    Scene::~Scene() = default;
+    void Scene::removeAllInstanceNodes()
+    {
+        for (ModelInstance* pInstance : mNodeInstances)
+        {
+            if (pInstance) pInstance->setParentTransform(glm::mat4(), glm::mat4());
+        }
+        mInstanceNodes.clear();
+        mNodeInstances.clear();
+        mFreeNodes.clear();
+        mpTransformHierarchy->clear();
+    }
+
+    bool Scene::updateInstanceHierarchy()
+    {
+        if (mInstanceNodes.empty()) return false;
+
+        for (uint32_t node = 0; node < (uint32_t)mNodeInstances.size(); node++)
+        {
+            const ModelInstance* pInstance = mNodeInstances[node];
+            if (pInstance && pInstance->getLocalTransformMatrix() != mpTransformHierarchy->getLocalMatrix(node))
+            {
+                mpTransformHierarchy->setLocalMatrix(node, pInstance->getLocalTransformMatrix());
+            }
+        }
+        mpTransformHierarchy->update();
+
+        // A node's world matrix already includes the instance's own transform, so an attached instance gets its parent's world matrix.
+        // The previous matrices are compared as well, they catch up one update after the parent stops moving
+        bool moved = false;
+        for (uint32_t node = 0; node < (uint32_t)mNodeInstances.size(); node++)
+        {
+            ModelInstance* pInstance = mNodeInstances[node];
+            uint32_t parent = mpTransformHierarchy->getParent(node);
+            if (pInstance == nullptr || parent == TransformHierarchy::kInvalidNode) continue;
+
+            const glm::mat4& world = mpTransformHierarchy->getWorldMatrix(parent);
+            const glm::mat4& prevWorld = mpTransformHierarchy->getPrevWorldMatrix(parent);
+            if (pInstance->getParentTransform() != world || pInstance->getPrevParentTransform() != prevWorld)
+            {
+                moved |= (pInstance->getParentTransform() != world);
+                pInstance->setParentTransform(world, prevWorld);
+            }
+        }
+        return moved;
+    }
+
+    bool Scene::setModelInstanceParent(const ModelInstance::SharedPtr& pInstance, const ModelInstance::SharedPtr& pParent)
+    {
+        if (pInstance == nullptr || hasModelInstance(pInstance.get()) == false || (pParent && hasModelInstance(pParent.get()) == false))
+        {
+            logError("Scene::setModelInstanceParent() - the instance isn't in the scene");
+            return false;
+        }
+
+        if (pParent == nullptr)
+        {
+            auto it = mInstanceNodes.find(pInstance.get());
+            if (it != mInstanceNodes.end() && mpTransformHierarchy->getParent(it->second) != TransformHierarchy::kInvalidNode)
+            {
+                mpTransformHierarchy->setParent(it->second, TransformHierarchy::kInvalidNode);
+                pInstance->setParentTransform(glm::mat4(), glm::mat4());
+            }
+            return true;
+        }
+
+        // setParent() rejects cycles, including an instance attached to itself
+        uint32_t node = getInstanceNode(pInstance.get());
+        uint32_t parentNode = getInstanceNode(pParent.get());
+        return mpTransformHierarchy->setParent(node, parentNode);
+    }
+
+    Scene::ModelInstance::SharedPtr Scene::getModelInstanceParent(const ModelInstance::SharedPtr& pInstance) const
+    {
+        auto it = mInstanceNodes.find(pInstance.get());
+        if (it == mInstanceNodes.end()) return nullptr;
+        uint32_t parent = mpTransformHierarchy->getParent(it->second);
+        return (parent == TransformHierarchy::kInvalidNode) ? nullptr : mNodeInstances[parent]->shared_from_this();
+    }
 
     void Scene::updateExtents()
     {
+        bool extentsChanged = mLightsDirty;
+
         if (mExtentsDirty)
         {
             mExtentsDirty = false;
-
-            mRadius = 0.f;
-            float k = 0.f;
-            mCenter = vec3(0, 0, 0);
-            for (uint32_t i = 0; i < getModelCount(); ++i)
+            untrackAllInstances();
+            for (const auto& instances : mModels)
             {
-                const auto& model = getModel(i);
-                const float r = model->getRadius();
-                const vec3 c = model->getCenter();
-                for (uint32_t j = 0; j < getModelInstanceCount(i); ++j)
-                {
-                    const auto& inst = getModelInstance(i, j);
-                    const vec3 instC = vec3(vec4(c, 1.f) * inst->getTransformMatrix());
-                    const vec3 scaling = inst->getScaling();
-                    const float instR = r * max(scaling.x, max(scaling.y, scaling.z));
-
-                    if (k == 0.f)
-                    {
-                        mCenter = instC;
-                        mRadius = instR;
-                    }
-                    else
-                    {
-                        vec3 dir = instC - mCenter;
-                        if (length(dir) > 1e-6f)
-                            dir = normalize(dir);
-                        vec3 a = mCenter - dir * mRadius;
-                        vec3 b = instC + dir * instR;
-
-                        mCenter = (a + b) * 0.5f;
-                        mRadius = length(a - b);
-                    }
-                    k++;
-                }
+                for (const auto& pInstance : instances) trackInstance(pInstance.get());
+            }
+            extentsChanged = true;
+        }
+        else
+        {
+            // Only refresh the boxes of the instances which reported a move. Deleted instances were already removed from mInstanceBounds
+            for (const ModelInstance* pInstance : mMovedInstances)
+            {
+                auto it = mInstanceBounds.find(pInstance);
+                if (it == mInstanceBounds.end() || it->second.moved == false) continue;
+                mBoundsTree.update(it->second.slot, pInstance->getBoundingBox());
+                it->second.moved = false;
             }
+            mMovedInstances.clear();
+        }
+
+        BoundingBox box = {};
+        mBoundsTree.getBounds(box);
+        if ((mBoundingBox == box) == false)
+        {
+            mBoundingBox = box;
+            extentsChanged = true;
+        }
+
+        if (extentsChanged)
+        {
+            mCenter = mBoundingBox.center;
+            mRadius = length(mBoundingBox.extent);
+            mLightsDirty = false;
 
             // Update light extents
             for (auto& light : mpLights)
@@ -112,7 +321,7 @@ namespace Falcor
                 if (light->getType() == LightDirectional)
                 {
                     auto pDirLight = std::dynamic_pointer_cast<DirectionalLight>(light);
-                    pDirLight->setWorldParams(getCenter(), getRadius());
+                    pDirLight->setWorldParams(mCenter, mRadius);
                 }
             }
         }
@@ -134,7 +343,8 @@ namespace Falcor
             mModels[i][0]->getObject()->animate(currentTime);
         }
 
-        mExtentsDirty = mExtentsDirty || changed;
+        // After the paths, so that attached instances follow a parent which moves along a path in the same frame
+        changed |= updateInstanceHierarchy();
 
         // Ignore the elapsed time we got from the user. This will allow camera movement in cases where the time is frozen
         if (cameraController)
@@ -154,16 +364,22 @@ namespace Falcor
             mpMaterialHistory->onModelRemoved(getModel(modelID).get());
         }
 
+        for (const auto& pInstance : mModels[modelID])
+        {
+            untrackInstance(pInstance.get());
+            removeInstanceNode(pInstance.get());
+        }
+
         // Delete entire vector of instances
         mModels.erase(mModels.begin() + modelID);
-
-        mExtentsDirty = true;
     }
 
     void Scene::deleteAllModels()
     {
+        // Untrack first, clearing the models can destroy the instances
+        untrackAllInstances();
+        removeAllInstanceNodes();
         mModels.clear();
-        mExtentsDirty = true;
     }
 
     uint32_t Scene::getModelInstanceCount(uint32_t modelID) const
@@ -175,7 +391,6 @@ namespace Falcor
     {
         ModelInstance::SharedPtr pInstance = ModelInstance::create(pModel, translation, yawPitchRoll, scaling, instanceName);
         addModelInstance(pInstance);
-        mExtentsDirty = true;
     }
 
     void Scene::addModelInstance(const ModelInstance::SharedPtr& pInstance)
@@ -187,6 +402,7 @@ namespace Falcor
             if (getModel(modelID) == pInstance->getObject())
             {
                 mModels[modelID].push_back(pInstance);
+                trackInstance(pInstance.get());
                 return;
             }
         }
@@ -194,7 +410,7 @@ namespace Falcor
         // If not found, add a new list
         mModels.emplace_back();
         mModels.back().push_back(pInstance);
-        mExtentsDirty = true;
+        trackInstance(pInstance.get());
     }
 
     void Scene::deleteModelInstance(uint32_t modelID, uint32_t instanceID)
@@ -212,11 +428,10 @@ namespace Falcor
         else
         {
             //  Erase the instance.
+            untrackInstance(instances[instanceID].get());
+            removeInstanceNode(instances[instanceID].get());
             instances.erase(instances.begin() + instanceID);
         }
-
-        //  Extents will be dirty in either case.
-        mExtentsDirty = true;
     }
 
     const Scene::UserVariable& Scene::getUserVariable(const std::string& name) const
@@ -253,14 +468,14 @@ namespace Falcor
     uint32_t Scene::addLight(const Light::SharedPtr& pLight)
     {
         mpLights.push_back(pLight);
-        mExtentsDirty = true;
+        mLightsDirty = true;
         return (uint32_t)mpLights.size() - 1;
     }
 
     void Scene::deleteLight(uint32_t lightID)
     {
         mpLights.erase(mpLights.begin() + lightID);
-        mExtentsDirty = true;
+        mLightsDirty = true;
     }
 
     void Scene::deleteMaterial(uint32_t materialID)
@@ -37,10 +37,13 @@
 #include "Graphics/Paths/ObjectPath.h"
 #include "Graphics/Model/ObjectInstance.h"
 #include "Graphics/Material/MaterialHistory.h"
+#include "Utils/BoundsTree.h"
+#include "Graphics/Scene/TransformHierarchy.h"
+#include <unordered_map>
 
 namespace Falcor
 {
-    class Scene : public std::enable_shared_from_this<Scene>
+    class Scene : public std::enable_shared_from_this<Scene>, private ObjectInstance<Model>::ITransformObserver
     {
     public:
         using SharedPtr = std::shared_ptr<Scene>;
@@ -107,6 +110,16 @@ namespace Falcor
 
         virtual ~Scene();
 
+        /** Get the file the scene was loaded from or last saved to. Empty if the scene was created in code
+        */
+        const std::string& getFilename() const { return mFilename; }
+        void setFilename(const std::string& filename) { mFilename = filename; }
+
+        /** Check if the scene has to be saved with a full export. This is the case when replaying its journal failed, so the scene file and the journal no longer describe it
+        */
+        bool needsFullExport() const { return mNeedsFullExport; }
+        void setNeedsFullExport(bool needsFullExport) { mNeedsFullExport = needsFullExport; }
+
         // Models
         uint32_t getModelCount() const { return (uint32_t)mModels.size(); }
         const Model::SharedPtr& getModel(uint32_t modelID) const { return mModels[modelID][0]->getObject(); };
@@ -121,6 +134,18 @@ namespace Falcor
         const ModelInstance::SharedPtr& getModelInstance(uint32_t modelID, uint32_t instanceID) const { return mModels[modelID][instanceID]; };
         void deleteModelInstance(uint32_t modelID, uint32_t instanceID);
 
+        /** Attach a model instance to another instance. The instance's own transform becomes relative to the parent's transform, and it follows the parent when it moves.
+            The world transforms are propagated in update(). Deleting an instance detaches its children.
+            \param[in] pInstance The instance to attach
+            \param[in] pParent The new parent, or nullptr to detach the instance
+            \return false if one of the instances isn't in the scene, or if pParent is attached below pInstance
+        */
+        bool setModelInstanceParent(const ModelInstance::SharedPtr& pInstance, const ModelInstance::SharedPtr& pParent);
+
+        /** Get the instance a model instance is attached to, or nullptr if it isn't attached
+        */
+        ModelInstance::SharedPtr getModelInstanceParent(const ModelInstance::SharedPtr& pInstance) const;
+
         // Light sources
         uint32_t addLight(const Light::SharedPtr& pLight);
         void deleteLight(uint32_t lightID);
@@ -183,10 +208,11 @@ namespace Falcor
         void merge(const Scene* pFrom);
 
         /**
-            Return scene extents
+            Return scene extents. Only the instances whose transform changed since the last call are re-evaluated
         */
         const vec3& getCenter() { updateExtents(); return mCenter; }
         const float getRadius() { updateExtents(); return mRadius; }
+        const BoundingBox& getBoundingBox() { updateExtents(); return mBoundingBox; }
 
         /**
             This routine creates area light(s) in the scene. All meshes that
@@ -213,6 +239,43 @@ namespace Falcor
             Update changed scene extents (radius and center).
         */
         void updateExtents();
+
+        /** Add an instance's bounding box to the bounds tree
+        */
+        void trackInstance(const ModelInstance* pInstance);
+
+        /** Remove an instance's bounding box from the bounds tree
+        */
+        void untrackInstance(const ModelInstance* pInstance);
+
+        /** Remove all the bounding boxes and stop observing the instances
+        */
+        void untrackAllInstances();
+
+        /** Queue an instance which moved, so that updateExtents() refreshes its box
+        */
+        void onInstanceTransformChanged(const ModelInstance* pInstance) override;
+
+        /** Check if the instance is in one of the model instance lists
+        */
+        bool hasModelInstance(const ModelInstance* pInstance) const;
+
+        /** Get the transform hierarchy node of an instance, adding one if the instance doesn't have a node yet
+        */
+        uint32_t getInstanceNode(ModelInstance* pInstance);
+
+        /** Detach an instance from its parent and its children, and release its node
+        */
+        void removeInstanceNode(const ModelInstance* pInstance);
+
+        /** Detach all the instances and clear the transform hierarchy
+        */
+        void removeAllInstanceNodes();
+
+        /** Copy the instances' own transforms into the hierarchy, update it and pass the parent transforms back to the attached instances
+            \return true if an attached instance moved
+        */
+        bool updateInstanceHierarchy();
         
         static uint32_t sSceneCounter;
 
@@ -231,11 +294,30 @@ namespace Falcor
         float mCameraSpeed = 1;
         float mLightingScale = 1.0f;
         uint32_t mVersion = 1;
+        std::string mFilename;
+        bool mNeedsFullExport = false;
 
         float mRadius = -1.f;
         vec3 mCenter = vec3(0, 0, 0);
 
-        bool mExtentsDirty = true;
+        bool mExtentsDirty = true;      // Rebuild the bounds tree from scratch
+        bool mLightsDirty = true;       // The light list changed, the directional lights need the scene extents
+
+        struct InstanceBounds
+        {
+            uint32_t slot;              // Slot in mBoundsTree
+            bool moved;                 // The instance is in mMovedInstances
+        };
+        BoundsTree mBoundsTree;
+        std::unordered_map<const ModelInstance*, InstanceBounds> mInstanceBounds;
+        std::vector<const ModelInstance*> mMovedInstances;  // Instances which reported a transform change since the last updateExtents()
+        BoundingBox mBoundingBox = {};
+
+        // Only instances which have a parent or children get a node. The local matrix of a node is the instance's own transform
+        TransformHierarchy::SharedPtr mpTransformHierarchy;
+        std::unordered_map<const ModelInstance*, uint32_t> mInstanceNodes;
+        std::vector<ModelInstance*> mNodeInstances;     // The instance of each node, nullptr for released nodes
+        std::vector<uint32_t> mFreeNodes;
 
         using string_uservar_map = std::map<const std::string, UserVariable>;
         string_uservar_map mUserVars;
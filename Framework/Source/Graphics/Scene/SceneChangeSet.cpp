@@ -0,0 +1,588 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "SceneChangeSet.h"
+#include "SceneExporter.h"
+#include "Utils/Platform/OS.h"
+#include <fstream>
+
+namespace Falcor
+{
+    const char* SceneChangeSet::kJournalExtension = ".journal";
+
+    namespace
+    {
+        const uint32_t kJournalMagic = 0x4a435346;  // 'FSCJ'
+        const uint32_t kJournalVersion = 1;
+
+        // Each record starts with its type and payload size. The first two payload words are the keys of the object the record refers to
+        struct RecordHeader
+        {
+            SceneChangeSet::Type type;
+            uint32_t payloadSize;
+            uint32_t key0;
+            uint32_t key1;
+        };
+
+        template<typename T>
+        void write(std::vector<uint8_t>& data, const T& value)
+        {
+            const uint8_t* pBytes = (const uint8_t*)&value;
+            data.insert(data.end(), pBytes, pBytes + sizeof(T));
+        }
+
+        void writeString(std::vector<uint8_t>& data, const std::string& str)
+        {
+            write(data, (uint32_t)str.size());
+            data.insert(data.end(), str.begin(), str.end());
+        }
+
+        class Reader
+        {
+        public:
+            Reader(const uint8_t* pData, size_t size) : mpData(pData), mpEnd(pData + size) {}
+
+            template<typename T>
+            T read()
+            {
+                T value = T();
+                if (mpData + sizeof(T) > mpEnd) { mOk = false; return value; }
+                memcpy(&value, mpData, sizeof(T));
+                mpData += sizeof(T);
+                return value;
+            }
+
+            std::string readString()
+            {
+                uint32_t size = read<uint32_t>();
+                if (mOk == false || mpData + size > mpEnd) { mOk = false; return ""; }
+                std::string str((const char*)mpData, size);
+                mpData += size;
+                return str;
+            }
+
+            bool isOk() const { return mOk; }
+        private:
+            const uint8_t* mpData;
+            const uint8_t* mpEnd;
+            bool mOk = true;
+        };
+
+        bool applyFailed(const std::string& msg)
+        {
+            logWarning("SceneChangeSet::apply() - " + msg + ". Skipping the remaining changes");
+            return false;
+        }
+    }
+
+    SceneChangeSet::SharedPtr SceneChangeSet::create()
+    {
+        return SharedPtr(new SceneChangeSet());
+    }
+
+    void SceneChangeSet::beginRecord(Type type, uint32_t key0, uint32_t key1)
+    {
+        // Merge with the previous record if it refers to the same object and is still in memory only
+        if (mLastRecordOffset != size_t(-1) && mLastRecordOffset >= mJournalOffset)
+        {
+            RecordHeader last;
+            memcpy(&last, mData.data() + mLastRecordOffset, sizeof(RecordHeader));
+            bool mergeable = (type == Type::InstanceTransform) || (type == Type::Light) || (type == Type::Material) || (type == Type::MaterialOverride) || (type == Type::InstanceVisibility);
+            if (mergeable && last.type == type && last.key0 == key0 && last.key1 == key1)
+            {
+                mData.resize(mLastRecordOffset);
+                mChangeCount--;
+            }
+        }
+
+        mCurrentRecordOffset = mData.size();
+        RecordHeader header = { type, 0, key0, key1 };
+        write(mData, header);
+    }
+
+    void SceneChangeSet::endRecord()
+    {
+        uint32_t payloadSize = (uint32_t)(mData.size() - mCurrentRecordOffset - offsetof(RecordHeader, key0));
+        memcpy(mData.data() + mCurrentRecordOffset + offsetof(RecordHeader, payloadSize), &payloadSize, sizeof(uint32_t));
+        mLastRecordOffset = mCurrentRecordOffset;
+        mChangeCount++;
+    }
+
+    void SceneChangeSet::recordInstanceTransform(const Scene* pScene, uint32_t modelID, uint32_t instanceID)
+    {
+        const auto& pInstance = pScene->getModelInstance(modelID, instanceID);
+        beginRecord(Type::InstanceTransform, modelID, instanceID);
+        writeString(mData, pInstance->getName());
+        write(mData, pInstance->getTranslation());
+        write(mData, pInstance->getTarget());
+        write(mData, pInstance->getUpVector());
+        write(mData, pInstance->getScaling());
+        endRecord();
+    }
+
+    void SceneChangeSet::recordAddInstance(const Scene* pScene, uint32_t modelID, uint32_t instanceID, Model::LoadFlags modelLoadFlags)
+    {
+        const auto& pInstance = pScene->getModelInstance(modelID, instanceID);
+        beginRecord(Type::AddInstance, modelID, instanceID);
+        writeString(mData, pInstance->getName());
+        write(mData, pInstance->getTranslation());
+        write(mData, pInstance->getTarget());
+        write(mData, pInstance->getUpVector());
+        write(mData, pInstance->getScaling());
+        writeString(mData, pScene->getModel(modelID)->getFilename());
+        write(mData, (uint32_t)modelLoadFlags);
+        endRecord();
+    }
+
+    void SceneChangeSet::recordRemoveInstance(const Scene* pScene, uint32_t modelID, uint32_t instanceID)
+    {
+        beginRecord(Type::RemoveInstance, modelID, instanceID);
+        writeString(mData, pScene->getModelInstance(modelID, instanceID)->getName());
+        endRecord();
+    }
+
+    static void writeLight(std::vector<uint8_t>& data, const Light* pLight)
+    {
+        const LightData& lightData = pLight->getData();
+        writeString(data, pLight->getName());
+        write(data, pLight->getType());
+        write(data, lightData.worldPos);
+        write(data, lightData.worldDir);
+        write(data, lightData.intensity);
+        write(data, lightData.openingAngle);
+        write(data, lightData.penumbraAngle);
+    }
+
+    void SceneChangeSet::recordLight(const Scene* pScene, uint32_t lightID)
+    {
+        beginRecord(Type::Light, lightID, 0);
+        writeLight(mData, pScene->getLight(lightID).get());
+        endRecord();
+    }
+
+    void SceneChangeSet::recordAddLight(const Scene* pScene, uint32_t lightID)
+    {
+        beginRecord(Type::AddLight, lightID, 0);
+        writeLight(mData, pScene->getLight(lightID).get());
+        endRecord();
+    }
+
+    void SceneChangeSet::recordRemoveLight(const Scene* pScene, uint32_t lightID)
+    {
+        beginRecord(Type::RemoveLight, lightID, 0);
+        writeString(mData, pScene->getLight(lightID)->getName());
+        endRecord();
+    }
+
+    void SceneChangeSet::recordMaterial(const Scene* pScene, uint32_t materialID)
+    {
+        const Material* pMaterial = pScene->getMaterial(materialID).get();
+        beginRecord(Type::Material, materialID, 0);
+        writeString(mData, pMaterial->getName());
+        write(mData, pMaterial->getNumLayers());
+        for (uint32_t i = 0; i < pMaterial->getNumLayers(); i++)
+        {
+            Material::Layer layer = pMaterial->getLayer(i);
+            write(mData, (uint32_t)layer.type);
+            write(mData, (uint32_t)layer.ndf);
+            write(mData, (uint32_t)layer.blend);
+            write(mData, layer.albedo);
+            write(mData, layer.roughness);
+            write(mData, layer.extraParam);
+        }
+        write(mData, pMaterial->getAlphaThreshold());
+        write(mData, pMaterial->getHeightModifiers());
+        write(mData, (uint32_t)(pMaterial->isDoubleSided() ? 1 : 0));
+        endRecord();
+    }
+
+    void SceneChangeSet::recordAddMaterial(const Scene* pScene, uint32_t materialID)
+    {
+        beginRecord(Type::AddMaterial, materialID, 0);
+        writeString(mData, pScene->getMaterial(materialID)->getName());
+        endRecord();
+    }
+
+    void SceneChangeSet::recordRemoveMaterial(const Scene* pScene, uint32_t materialID)
+    {
+        beginRecord(Type::RemoveMaterial, materialID, 0);
+        writeString(mData, pScene->getMaterial(materialID)->getName());
+        endRecord();
+    }
+
+    void SceneChangeSet::recordMaterialOverride(const Scene* pScene, uint32_t modelID, uint32_t meshID, uint32_t materialID)
+    {
+        beginRecord(Type::MaterialOverride, modelID, meshID);
+        writeString(mData, pScene->getModel(modelID)->getName());
+        write(mData, materialID);
+        writeString(mData, (materialID == uint32_t(-1)) ? std::string() : pScene->getMaterial(materialID)->getName());
+        endRecord();
+    }
+
+    void SceneChangeSet::recordInstanceVisibility(const Scene* pScene, uint32_t modelID, uint32_t instanceID)
+    {
+        const auto& pInstance = pScene->getModelInstance(modelID, instanceID);
+        beginRecord(Type::InstanceVisibility, modelID, instanceID);
+        writeString(mData, pInstance->getName());
+        write(mData, (uint32_t)(pInstance->isVisible() ? 1 : 0));
+        endRecord();
+    }
+
+    static bool applyLightParams(Reader& reader, Light* pLight)
+    {
+        vec3 worldPos = reader.read<vec3>();
+        vec3 worldDir = reader.read<vec3>();
+        vec3 intensity = reader.read<vec3>();
+        float openingAngle = reader.read<float>();
+        float penumbraAngle = reader.read<float>();
+        if (reader.isOk() == false) return false;
+
+        if (pLight->getType() == LightPoint)
+        {
+            PointLight* pPointLight = static_cast<PointLight*>(pLight);
+            pPointLight->setWorldPosition(worldPos);
+            pPointLight->setWorldDirection(worldDir);
+            pPointLight->setIntensity(intensity);
+            pPointLight->setOpeningAngle(openingAngle);
+            pPointLight->setPenumbraAngle(penumbraAngle);
+        }
+        else if (pLight->getType() == LightDirectional)
+        {
+            DirectionalLight* pDirLight = static_cast<DirectionalLight*>(pLight);
+            pDirLight->setWorldDirection(worldDir);
+            pDirLight->setIntensity(intensity);
+        }
+        return true;
+    }
+
+    bool SceneChangeSet::apply(Scene* pScene) const
+    {
+        size_t offset = 0;
+        while (offset < mData.size())
+        {
+            RecordHeader header;
+            memcpy(&header, mData.data() + offset, sizeof(RecordHeader));
+            size_t payloadOffset = offset + offsetof(RecordHeader, key0);
+            Reader reader(mData.data() + payloadOffset + 2 * sizeof(uint32_t), header.payloadSize - 2 * sizeof(uint32_t));
+            offset = payloadOffset + header.payloadSize;
+
+            switch (header.type)
+            {
+            case Type::InstanceTransform:
+            case Type::RemoveInstance:
+            case Type::InstanceVisibility:
+            {
+                std::string name = reader.readString();
+                if (header.key0 >= pScene->getModelCount() || header.key1 >= pScene->getModelInstanceCount(header.key0) || pScene->getModelInstance(header.key0, header.key1)->getName() != name)
+                {
+                    return applyFailed("can't find model instance '" + name + "'");
+                }
+
+                if (header.type == Type::RemoveInstance)
+                {
+                    pScene->deleteModelInstance(header.key0, header.key1);
+                    break;
+                }
+
+                const auto& pInstance = pScene->getModelInstance(header.key0, header.key1);
+                if (header.type == Type::InstanceVisibility)
+                {
+                    uint32_t visible = reader.read<uint32_t>();
+                    if (reader.isOk() == false) return applyFailed("corrupt record");
+                    pInstance->setVisible(visible != 0);
+                    break;
+                }
+
+                vec3 translation = reader.read<vec3>();
+                vec3 target = reader.read<vec3>();
+                vec3 up = reader.read<vec3>();
+                vec3 scale = reader.read<vec3>();
+                if (reader.isOk() == false) return applyFailed("corrupt record");
+                pInstance->setTranslation(translation, false);
+                pInstance->setTarget(target);
+                pInstance->setUpVector(up);
+                pInstance->setScaling(scale);
+                break;
+            }
+            case Type::AddInstance:
+            {
+                std::string name = reader.readString();
+                vec3 translation = reader.read<vec3>();
+                vec3 target = reader.read<vec3>();
+                vec3 up = reader.read<vec3>();
+                vec3 scale = reader.read<vec3>();
+                std::string modelFilename = reader.readString();
+                Model::LoadFlags loadFlags = (Model::LoadFlags)reader.read<uint32_t>();
+                if (reader.isOk() == false) return applyFailed("corrupt record");
+
+                // A model index past the end means the model was added to the scene by this change
+                Model::SharedPtr pModel;
+                if (header.key0 < pScene->getModelCount())
+                {
+                    pModel = pScene->getModel(header.key0);
+                }
+                else if (header.key0 == pScene->getModelCount())
+                {
+                    pModel = Model::createFromFile(modelFilename.c_str(), loadFlags);
+                }
+                if (pModel == nullptr) return applyFailed("can't find or load model '" + modelFilename + "'");
+
+                pScene->addModelInstance(Scene::ModelInstance::create(pModel, translation, target, up, scale, name));
+                if (header.key0 >= pScene->getModelCount() || pScene->getModelInstanceCount(header.key0) != header.key1 + 1)
+                {
+                    return applyFailed("instance '" + name + "' was added at a different index than the one recorded");
+                }
+                break;
+            }
+            case Type::Light:
+            case Type::RemoveLight:
+            {
+                std::string name = reader.readString();
+                if (header.key0 >= pScene->getLightCount() || pScene->getLight(header.key0)->getName() != name)
+                {
+                    return applyFailed("can't find light '" + name + "'");
+                }
+
+                if (header.type == Type::RemoveLight)
+                {
+                    pScene->deleteLight(header.key0);
+                    break;
+                }
+
+                Light* pLight = pScene->getLight(header.key0).get();
+                if (reader.read<uint32_t>() != pLight->getType() || applyLightParams(reader, pLight) == false)
+                {
+                    return applyFailed("light '" + name + "' doesn't match the recorded light");
+                }
+                break;
+            }
+            case Type::AddLight:
+            {
+                std::string name = reader.readString();
+                uint32_t lightType = reader.read<uint32_t>();
+                Light::SharedPtr pLight;
+                if (lightType == LightPoint) pLight = PointLight::create();
+                else if (lightType == LightDirectional) pLight = DirectionalLight::create();
+                if (pLight == nullptr || header.key0 != pScene->getLightCount()) return applyFailed("can't add light '" + name + "'");
+
+                pLight->setName(name);
+                if (applyLightParams(reader, pLight.get()) == false) return applyFailed("corrupt record");
+                pScene->addLight(pLight);
+                break;
+            }
+            case Type::Material:
+            {
+                std::string name = reader.readString();
+                uint32_t layerCount = reader.read<uint32_t>();
+                if (header.key0 >= pScene->getMaterialCount() || pScene->getMaterial(header.key0)->getName() != name || layerCount > MatMaxLayers)
+                {
+                    return applyFailed("can't find material '" + name + "'");
+                }
+
+                // The material editor can add and remove layers. Match the recorded layer count before setting the parameters
+                const auto& pMaterial = pScene->getMaterial(header.key0);
+                while (pMaterial->getNumLayers() > layerCount)
+                {
+                    pMaterial->removeLayer(pMaterial->getNumLayers() - 1);
+                }
+                while (pMaterial->getNumLayers() < layerCount)
+                {
+                    pMaterial->addLayer(Material::Layer());
+                }
+
+                for (uint32_t i = 0; i < layerCount; i++)
+                {
+                    pMaterial->setLayerType(i, (Material::Layer::Type)reader.read<uint32_t>());
+                    pMaterial->setLayerNdf(i, (Material::Layer::NDF)reader.read<uint32_t>());
+                    pMaterial->setLayerBlend(i, (Material::Layer::Blend)reader.read<uint32_t>());
+                    pMaterial->setLayerAlbedo(i, reader.read<vec4>());
+                    pMaterial->setLayerRoughness(i, reader.read<vec4>());
+                    pMaterial->setLayerUserParam(i, reader.read<vec4>());
+                }
+                pMaterial->setAlphaThreshold(reader.read<float>());
+                pMaterial->setHeightModifiers(reader.read<vec2>());
+                pMaterial->setDoubleSided(reader.read<uint32_t>() != 0);
+                if (reader.isOk() == false) return applyFailed("corrupt record");
+                break;
+            }
+            case Type::AddMaterial:
+            {
+                std::string name = reader.readString();
+                if (reader.isOk() == false || header.key0 != pScene->getMaterialCount()) return applyFailed("can't add material '" + name + "'");
+                pScene->addMaterial(Material::create(name));
+                break;
+            }
+            case Type::RemoveMaterial:
+            {
+                std::string name = reader.readString();
+                if (header.key0 >= pScene->getMaterialCount() || pScene->getMaterial(header.key0)->getName() != name)
+                {
+                    return applyFailed("can't find material '" + name + "'");
+                }
+                pScene->deleteMaterial(header.key0);
+                break;
+            }
+            case Type::MaterialOverride:
+            {
+                std::string modelName = reader.readString();
+                uint32_t materialID = reader.read<uint32_t>();
+                std::string materialName = reader.readString();
+                if (reader.isOk() == false) return applyFailed("corrupt record");
+                if (header.key0 >= pScene->getModelCount() || pScene->getModel(header.key0)->getName() != modelName || header.key1 >= pScene->getModel(header.key0)->getMeshCount())
+                {
+                    return applyFailed("can't find mesh " + std::to_string(header.key1) + " of model '" + modelName + "'");
+                }
+
+                Mesh* pMesh = pScene->getModel(header.key0)->getMesh(header.key1).get();
+                const auto& pMaterialHistory = pScene->getMaterialHistory();
+                if (materialID == uint32_t(-1))
+                {
+                    // Without the history the original material is unknown
+                    if (pMaterialHistory == nullptr) return applyFailed("can't revert the override of mesh " + std::to_string(header.key1) + " of model '" + modelName + "' without a material history");
+                    pMaterialHistory->revert(pMesh);
+                    break;
+                }
+
+                if (materialID >= pScene->getMaterialCount() || pScene->getMaterial(materialID)->getName() != materialName)
+                {
+                    return applyFailed("can't find material '" + materialName + "'");
+                }
+
+                if (pMaterialHistory)
+                {
+                    pMaterialHistory->replace(pMesh, pScene->getMaterial(materialID));
+                }
+                else
+                {
+                    pMesh->setMaterial(pScene->getMaterial(materialID));
+                }
+                break;
+            }
+            default:
+                return applyFailed("unknown change type");
+            }
+        }
+        return true;
+    }
+
+    bool SceneChangeSet::appendToJournal(const std::string& filename)
+    {
+        bool newFile = (doesFileExist(filename) == false);
+        std::ofstream stream(filename, std::ios::binary | std::ios::app);
+        if (stream.fail())
+        {
+            logError("SceneChangeSet::appendToJournal() - can't open '" + filename + "' for writing");
+            return false;
+        }
+
+        if (newFile)
+        {
+            std::vector<uint8_t> header;
+            write(header, kJournalMagic);
+            write(header, kJournalVersion);
+            stream.write((const char*)header.data(), header.size());
+        }
+
+        stream.write((const char*)mData.data() + mJournalOffset, mData.size() - mJournalOffset);
+        if (stream.fail())
+        {
+            logError("SceneChangeSet::appendToJournal() - failed writing to '" + filename + "'");
+            return false;
+        }
+        mJournalOffset = mData.size();
+        return true;
+    }
+
+    SceneChangeSet::SharedPtr SceneChangeSet::loadJournal(const std::string& filename)
+    {
+        std::ifstream stream(filename, std::ios::binary);
+        if (stream.fail())
+        {
+            logWarning("SceneChangeSet::loadJournal() - can't open '" + filename + "'");
+            return nullptr;
+        }
+        std::vector<uint8_t> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+        Reader reader(data.data(), data.size());
+        if (reader.read<uint32_t>() != kJournalMagic || reader.read<uint32_t>() != kJournalVersion)
+        {
+            logWarning("SceneChangeSet::loadJournal() - '" + filename + "' is not a scene journal or was created by a different version");
+            return nullptr;
+        }
+
+        SharedPtr pChangeSet = create();
+        pChangeSet->mData.assign(data.begin() + 2 * sizeof(uint32_t), data.end());
+
+        // Validate the record structure. A journal which was cut short by a crash keeps the complete records
+        size_t offset = 0;
+        const auto& records = pChangeSet->mData;
+        while (offset + sizeof(RecordHeader) <= records.size())
+        {
+            RecordHeader header;
+            memcpy(&header, records.data() + offset, sizeof(RecordHeader));
+            size_t next = offset + offsetof(RecordHeader, key0) + header.payloadSize;
+            if (header.payloadSize < 2 * sizeof(uint32_t) || next > records.size()) break;
+            pChangeSet->mLastRecordOffset = offset;
+            pChangeSet->mChangeCount++;
+            offset = next;
+        }
+        if (offset != records.size())
+        {
+            logWarning("SceneChangeSet::loadJournal() - '" + filename + "' is truncated. Only the first " + std::to_string(pChangeSet->mChangeCount) + " changes will be used");
+            pChangeSet->mData.resize(offset);
+
+            // Drop the partial record from the file as well, so that changes appended later start at a record boundary
+            stream.close();
+            std::ofstream trimmed(filename, std::ios::binary | std::ios::trunc);
+            trimmed.write((const char*)data.data(), 2 * sizeof(uint32_t) + offset);
+            if (trimmed.fail())
+            {
+                logWarning("SceneChangeSet::loadJournal() - can't remove the partial change from '" + filename + "'");
+            }
+        }
+        pChangeSet->mJournalOffset = pChangeSet->mData.size();
+        return pChangeSet;
+    }
+
+    bool SceneChangeSet::compact(const std::string& sceneFilename, const Scene::SharedPtr& pScene)
+    {
+        // Saving the scene also deletes its journal
+        if (SceneExporter::saveScene(sceneFilename, pScene) == false) return false;
+        clear();
+        return true;
+    }
+
+    void SceneChangeSet::clear()
+    {
+        mData.clear();
+        mChangeCount = 0;
+        mJournalOffset = 0;
+        mLastRecordOffset = size_t(-1);
+        mCurrentRecordOffset = 0;
+    }
+}
@@ -0,0 +1,135 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include "Graphics/Scene/Scene.h"
+
+namespace Falcor
+{
+    /** Records scene edits as compact binary deltas.
+        Each change captures the state of a single object (model instance, light, material or mesh material override) after the edit. Consecutive changes to the same object are merged into one record.
+        A change-set can be applied to a live scene, or appended to a journal file. Scene::loadFromFile() replays the journal which sits next to the scene file ("<scene>.journal"),
+        so saving an edit only costs the size of the delta. Use compact() to fold the journal back into a full scene save.
+        Objects are referenced by their index in the scene at the time of the edit, so a journal is only valid for the scene it was recorded against. Names are stored with each record and validated when applying.
+        Textures, cameras and paths are not recorded - material changes only cover the layer parameters and scalar values. Edits to those require a full scene save.
+    */
+    class SceneChangeSet
+    {
+    public:
+        using SharedPtr = std::shared_ptr<SceneChangeSet>;
+        using SharedConstPtr = std::shared_ptr<const SceneChangeSet>;
+
+        static const char* kJournalExtension;
+
+        /** Change types
+        */
+        enum class Type : uint32_t
+        {
+            InstanceTransform,      ///< A model instance's transform changed
+            AddInstance,            ///< A model instance was added. If the model is not part of the scene, it will be loaded from its file
+            RemoveInstance,         ///< A model instance was removed. Removing the last instance removes the model
+            Light,                  ///< A light's parameters changed
+            AddLight,               ///< A point or directional light was added
+            RemoveLight,            ///< A light was removed
+            Material,               ///< A scene material's parameters changed
+            AddMaterial,            ///< A default material was added
+            RemoveMaterial,         ///< A material was removed
+            MaterialOverride,       ///< A mesh's material was overridden with a scene material, or the override was reverted
+            InstanceVisibility,     ///< A model instance was shown or hidden
+        };
+
+        /** Create an empty change-set
+        */
+        static SharedPtr create();
+
+        /** Load a journal file. If the file was cut short, it's trimmed to its complete changes
+            \return A change-set containing the journal's changes, or nullptr if the file can't be read
+        */
+        static SharedPtr loadJournal(const std::string& filename);
+
+        /** Record changes. Call after the edit was applied to the scene, except for removals, which must be recorded before the object is removed.
+        */
+        void recordInstanceTransform(const Scene* pScene, uint32_t modelID, uint32_t instanceID);
+        void recordAddInstance(const Scene* pScene, uint32_t modelID, uint32_t instanceID, Model::LoadFlags modelLoadFlags = Model::LoadFlags::None);
+        void recordRemoveInstance(const Scene* pScene, uint32_t modelID, uint32_t instanceID);
+        void recordLight(const Scene* pScene, uint32_t lightID);
+        void recordAddLight(const Scene* pScene, uint32_t lightID);
+        void recordRemoveLight(const Scene* pScene, uint32_t lightID);
+        void recordMaterial(const Scene* pScene, uint32_t materialID);
+        void recordAddMaterial(const Scene* pScene, uint32_t materialID);
+        void recordRemoveMaterial(const Scene* pScene, uint32_t materialID);
+        void recordInstanceVisibility(const Scene* pScene, uint32_t modelID, uint32_t instanceID);
+
+        /** Record a mesh material override. meshID is the mesh's index in the model.
+            \param[in] materialID The scene material the mesh now uses, or -1 if the override was reverted
+        */
+        void recordMaterialOverride(const Scene* pScene, uint32_t modelID, uint32_t meshID, uint32_t materialID);
+
+        /** Apply all the changes to a scene, in the order they were recorded
+            \return false if a change doesn't match the scene. The changes following it are not applied
+        */
+        bool apply(Scene* pScene) const;
+
+        /** Append the changes which were not written yet to a journal file. Creates the file if it doesn't exist
+        */
+        bool appendToJournal(const std::string& filename);
+
+        /** Save the full scene and delete its journal. The change-set is cleared
+        */
+        bool compact(const std::string& sceneFilename, const Scene::SharedPtr& pScene);
+
+        /** Remove all the changes
+        */
+        void clear();
+
+        /** Get the number of changes
+        */
+        uint32_t getChangeCount() const { return mChangeCount; }
+
+        /** Get the size in bytes of the encoded changes
+        */
+        size_t getSize() const { return mData.size(); }
+
+        /** Get the journal filename for a scene file
+        */
+        static std::string getJournalFilename(const std::string& sceneFilename) { return sceneFilename + kJournalExtension; }
+
+    private:
+        SceneChangeSet() = default;
+
+        // Start a new record. If the last record has the same type and keys and wasn't written to the journal yet, it's replaced instead
+        void beginRecord(Type type, uint32_t key0, uint32_t key1);
+        void endRecord();
+
+        std::vector<uint8_t> mData;
+        uint32_t mChangeCount = 0;
+        size_t mJournalOffset = 0;              // Bytes already written to the journal
+        size_t mLastRecordOffset = size_t(-1);  // Offset of the last record, used to merge consecutive changes
+        size_t mCurrentRecordOffset = 0;
+    };
+}
@@ -32,8 +32,12 @@
 #include "Framework.h"
 #include "SceneExporter.h"
 #include <fstream>
+#include <cstdio>
 #include "Utils/Platform/OS.h"
 #include "Graphics/Scene/Editor/SceneEditor.h"
+#include "Graphics/Scene/SceneChangeSet.h"
+#include "Graphics/Scene/BinarySceneFile.h"
+#include "Utils/StringUtils.h"
 
 #include "SceneExportImportCommon.h"
 
@@ -118,22 +122,42 @@ namespace Falcor
         if (exportOptions & ExportPaths)             writePaths();
         if (exportOptions & ExportMaterials)         writeMaterials();
 
-        // Get the output string
-        rapidjson::StringBuffer buffer;
-        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
-        writer.SetIndent(' ', 4);
-        mJDoc.Accept(writer);
-        std::string str(buffer.GetString(), buffer.GetSize());
+        if (hasSuffix(mFilename, BinarySceneFile::kFileExtension, false))
+        {
+            if (BinarySceneFile::save(mJDoc, mFilename) == false)
+            {
+                logError("Can't write output scene file " + mFilename + ".\nExporting failed.");
+                return false;
+            }
+        }
+        else
+        {
+            // Get the output string
+            rapidjson::StringBuffer buffer;
+            rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+            writer.SetIndent(' ', 4);
+            mJDoc.Accept(writer);
+            std::string str(buffer.GetString(), buffer.GetSize());
+
+            // Output the file
+            std::ofstream outputStream(mFilename.c_str());
+            if (outputStream.fail())
+            {
+                logError("Can't open output scene file " + mFilename + ".\nExporting failed.");
+                return false;
+            }
+            outputStream << str;
+            outputStream.close();
+        }
 
-        // Output the file
-        std::ofstream outputStream(mFilename.c_str());
-        if (outputStream.fail())
+        // The journal holds edits to models, lights and materials. Once they are all part of the scene file, it is stale
+        const uint32_t journalOptions = ExportModels | ExportLights | ExportMaterials;
+        std::string journalFilename = SceneChangeSet::getJournalFilename(mFilename);
+        if ((exportOptions & journalOptions) == journalOptions)
         {
-            logError("Can't open output scene file " + mFilename + ".\nExporting failed.");
-            return false;
+            if (doesFileExist(journalFilename)) std::remove(journalFilename.c_str());
+            mpScene->setNeedsFullExport(false);
         }
-        outputStream << str;
-        outputStream.close();
 
         return true;
     }
@@ -106,8 +106,36 @@ namespace Falcor
         return importer.load(filename, modelLoadFlags, sceneLoadFlags);
     }
 
+    bool SceneImporter::createPackedModelInstances(const BinarySceneFile::InstanceRange& range, const Model::SharedPtr& pModel)
+    {
+        for(uint32_t i = range.first; i < range.first + range.count; i++)
+        {
+            std::string name(mpBinaryFile->getInstanceName(i));
+            if (isNameDuplicate(name, mInstanceMap, "model instances"))
+            {
+                return false;
+            }
+
+            glm::vec3 rotation = glm::radians(mpBinaryFile->getInstanceRotation(i));
+            auto pInstance = Scene::ModelInstance::create(pModel, mpBinaryFile->getInstanceTranslation(i), rotation, mpBinaryFile->getInstanceScaling(i), name);
+            mInstanceMap[pInstance->getName()] = pInstance;
+            mScene.addModelInstance(pInstance);
+        }
+        return true;
+    }
+
     bool SceneImporter::createModelInstances(const rapidjson::Value& jsonVal, const Model::SharedPtr& pModel)
     {
+        // Binary scene files store the instances in packed arrays. The document only holds the range index
+        if(mpBinaryFile && jsonVal.IsUint())
+        {
+            if(jsonVal.GetUint() >= mpBinaryFile->getInstanceRangeCount())
+            {
+                return error("Invalid model instance range");
+            }
+            return createPackedModelInstances(mpBinaryFile->getInstanceRange(jsonVal.GetUint()), pModel);
+        }
+
         if(jsonVal.IsArray() == false)
         {
             return error("Model instances should be an array of objects");
@@ -1174,25 +1202,37 @@ namespace Falcor
 
         if(findFileInDataDirectories(filename, fullpath))
         {
-            // Load the file
-            std::ifstream fileStream(fullpath);
-            std::stringstream strStream;
-            strStream << fileStream.rdbuf();
-            std::string jsonData = strStream.str();
-            rapidjson::StringStream JStream(jsonData.c_str());
-
             // Get the file directory
             auto last = fullpath.find_last_of("/\\");
             mDirectory = fullpath.substr(0, last);
 
-            // create the DOM
-            mJDoc.ParseStream(JStream);
-
-            if(mJDoc.HasParseError())
+            if(BinarySceneFile::isBinarySceneFile(fullpath))
             {
-                size_t line;
-                line = std::count(jsonData.begin(), jsonData.begin() + mJDoc.GetErrorOffset(), '\n');
-                return error(std::string("JSON Parse error in line ") + std::to_string(line) + ". " + rapidjson::GetParseError_En(mJDoc.GetParseError()));
+                // The binary file holds the same document. Skip the parsing and read the instances directly from the packed arrays
+                mpBinaryFile = BinarySceneFile::open(fullpath);
+                if(mpBinaryFile == nullptr || mpBinaryFile->createDocument(mJDoc, false) == false)
+                {
+                    return error("Invalid binary scene file.");
+                }
+            }
+            else
+            {
+                // Load the file
+                std::ifstream fileStream(fullpath);
+                std::stringstream strStream;
+                strStream << fileStream.rdbuf();
+                std::string jsonData = strStream.str();
+                rapidjson::StringStream JStream(jsonData.c_str());
+
+                // create the DOM
+                mJDoc.ParseStream(JStream);
+
+                if(mJDoc.HasParseError())
+                {
+                    size_t line;
+                    line = std::count(jsonData.begin(), jsonData.begin() + mJDoc.GetErrorOffset(), '\n');
+                    return error(std::string("JSON Parse error in line ") + std::to_string(line) + ". " + rapidjson::GetParseError_En(mJDoc.GetParseError()));
+                }
             }
 
             if(topLevelLoop() == false)
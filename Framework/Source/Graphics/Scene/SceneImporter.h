@@ -33,6 +33,7 @@
 #include "glm/vec3.hpp"
 #include "glm/vec4.hpp"
 #include "Scene.h"
+#include "BinarySceneFile.h"
 
 namespace Falcor
 {
@@ -67,6 +68,7 @@ namespace Falcor
         bool createModel(const rapidjson::Value& jsonModel);
         bool setMaterialOverrides(const rapidjson::Value& jsonVal, const Model::SharedPtr& pModel);
         bool createModelInstances(const rapidjson::Value& jsonVal, const Model::SharedPtr& pModel);
+        bool createPackedModelInstances(const BinarySceneFile::InstanceRange& range, const Model::SharedPtr& pModel);
         bool createPointLight(const rapidjson::Value& jsonLight);
         bool createDirLight(const rapidjson::Value& jsonLight);
         ObjectPath::SharedPtr createPath(const rapidjson::Value& jsonPath);
@@ -89,6 +91,7 @@ namespace Falcor
         bool getFloatVec(const rapidjson::Value& jsonVal, const std::string& desc, float vec[VecSize]);
         bool getFloatVecAnySize(const rapidjson::Value& jsonVal, const std::string& desc, std::vector<float>& vec);
         rapidjson::Document mJDoc;
+        BinarySceneFile::UniquePtr mpBinaryFile;    // Holds the strings referenced by mJDoc when loading a binary scene file
         Scene& mScene;
         std::string mFilename;
         std::string mDirectory;
@@ -49,6 +49,7 @@ namespace Falcor
     size_t SceneRenderer::sWorldInvTransposeMatOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sMeshIdOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sDrawIDOffset = ConstantBuffer::kInvalidOffset;
+    size_t SceneRenderer::sMaterialIndexOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sLightCountOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sLightArrayOffset = ConstantBuffer::kInvalidOffset;
     size_t SceneRenderer::sAmbientLightOffset = ConstantBuffer::kInvalidOffset;
@@ -110,11 +111,48 @@ namespace Falcor
                 sAmbientLightOffset = pAmbientOffset ? pAmbientOffset->getOffset() : ConstantBuffer::kInvalidOffset;
             }
         }
+
+        if (sMaterialIndexOffset == ConstantBuffer::kInvalidOffset)
+        {
+            const ReflectionVar* pVar = pBlock->getResource(kPerMaterialCbName).get();
+            if (pVar != nullptr)
+            {
+                const auto& pIndexOffset = pVar->getType()->findMember("gMaterialIndex");
+                sMaterialIndexOffset = pIndexOffset ? pIndexOffset->getOffset() : ConstantBuffer::kInvalidOffset;
+            }
+        }
+    }
+
+    void SceneRenderer::resolveBindHandles(CurrentWorkingData& currentData)
+    {
+        const ParameterBlock* pBlock = currentData.pVars->getDefaultBlock().get();
+        currentData.perFrameCb = pBlock->getBindHandle(kPerFrameCbName);
+        currentData.perMeshCb = pBlock->getBindHandle(kPerMeshCbName);
+        currentData.perMaterialCb = pBlock->getBindHandle(kPerMaterialCbName);
+        currentData.boneCb = pBlock->getBindHandle(kBoneCbName);
     }
 
     void SceneRenderer::setPerFrameData(const CurrentWorkingData& currentData)
     {
-        ConstantBuffer* pCB = currentData.pVars->getConstantBuffer(kPerFrameCbName).get();
+        // Bin the point and spot lights. If the program doesn't use the clusters, all the lights go into the light array
+        bool lightsClustered = false;
+        if (mpClusteredLights && currentData.pCamera)
+        {
+            // Passes which render the same frame from the same camera reuse the clusters
+            const glm::mat4& viewProj = currentData.pCamera->getViewProjMatrix();
+            if (mClusteredLightsDirty || mpClusteredLightsCamera != currentData.pCamera || mClusteredLightsViewProj != viewProj)
+            {
+                mpClusteredLights->update(mpScene.get(), currentData.pCamera);
+                mClusteredLightsDirty = false;
+                mpClusteredLightsCamera = currentData.pCamera;
+                mClusteredLightsViewProj = viewProj;
+            }
+            lightsClustered = mpClusteredLights->setIntoProgramVars(currentData.pVars);
+        }
+
+        mMaterialTableBound = mpMaterialTable && mpMaterialTable->setIntoProgramVars(currentData.pVars);
+
+        ConstantBuffer* pCB = currentData.pVars->getConstantBuffer(currentData.perFrameCb).get();
         if (pCB)
         {
             // Set camera
@@ -124,17 +162,28 @@ namespace Falcor
             }
 
             // Set lights
+            uint32_t lightCount = lightsClustered ? (uint32_t)mpClusteredLights->getUnclusteredLights().size() : mpScene->getLightCount();
+            if (lightCount > MAX_LIGHT_SOURCES)  // Max array size in the shader
+            {
+                if (mLightArrayOverflowReported == false)
+                {
+                    logWarning("SceneRenderer - " + std::to_string(lightCount) + " lights were submitted, but the light array holds only " + std::to_string(MAX_LIGHT_SOURCES) + ". The rest are ignored. Use clustered lights to render more lights.");
+                    mLightArrayOverflowReported = true;
+                }
+                lightCount = MAX_LIGHT_SOURCES;
+            }
+
             if (sLightArrayOffset != ConstantBuffer::kInvalidOffset)
             {
-                assert(mpScene->getLightCount() <= MAX_LIGHT_SOURCES);  // Max array size in the shader
-                for (uint_t i = 0; i < mpScene->getLightCount(); i++)
+                for (uint_t i = 0; i < lightCount; i++)
                 {
-                    mpScene->getLight(i)->setIntoConstantBuffer(pCB, i * Light::getShaderStructSize() + sLightArrayOffset);
+                    Light* pLight = lightsClustered ? mpClusteredLights->getUnclusteredLights()[i] : mpScene->getLight(i).get();
+                    pLight->setIntoConstantBuffer(pCB, i * Light::getShaderStructSize() + sLightArrayOffset);
                 }
             }
             if (sLightCountOffset != ConstantBuffer::kInvalidOffset)
             {
-                pCB->setVariable(sLightCountOffset, mpScene->getLightCount());
+                pCB->setVariable(sLightCountOffset, lightCount);
             }
             if (sAmbientLightOffset != ConstantBuffer::kInvalidOffset)
             {
@@ -150,7 +199,7 @@ namespace Falcor
         // Set bones
         if (pModel->hasBones())
         {
-            ConstantBuffer* pCB = currentData.pVars->getConstantBuffer(kBoneCbName).get();
+            ConstantBuffer* pCB = currentData.pVars->getConstantBuffer(currentData.boneCb).get();
             if (pCB != nullptr)
             {
                 if (sBonesOffset == ConstantBuffer::kInvalidOffset || sBonesInvTransposeOffset == ConstantBuffer::kInvalidOffset)
@@ -179,7 +228,7 @@ namespace Falcor
 
     bool SceneRenderer::setPerMeshInstanceData(const CurrentWorkingData& currentData, const Scene::ModelInstance* pModelInstance, const Model::MeshInstance* pMeshInstance, uint32_t drawInstanceID)
     {
-        ConstantBuffer* pCB = currentData.pVars->getConstantBuffer(kPerMeshCbName).get();
+        ConstantBuffer* pCB = currentData.pVars->getConstantBuffer(currentData.perMeshCb).get();
         if (pCB)
         {
             const Mesh* pMesh = pMeshInstance->getObject().get();
@@ -203,7 +252,7 @@ namespace Falcor
             pCB->setBlob(&prevWorldMat, sPrevWorldMatOffset + drawInstanceID * sizeof(glm::mat4), sizeof(glm::mat4));
 
             // Set mesh id
-            pCB->setVariable(sMeshIdOffset, pMesh->getId());
+            pCB->setVariableUnchecked(sMeshIdOffset, pMesh->getId());
         }
 
         return true;
@@ -211,8 +260,19 @@ namespace Falcor
 
     bool SceneRenderer::setPerMaterialData(const CurrentWorkingData& currentData, const Material* pMaterial)
     {
-        if (auto cb = currentData.pVars->getConstantBuffer(kPerMaterialCbName))
-            pMaterial->setIntoProgramVars(currentData.pVars, cb.get(), "gMaterial");
+        if (auto cb = currentData.pVars->getConstantBuffer(currentData.perMaterialCb))
+        {
+            // The table was bound with the per-frame data, so only the index changes
+            uint32_t tableIndex = mMaterialTableBound ? mpMaterialTable->getMaterialIndex(pMaterial) : MaterialTable::kInvalidIndex;
+            if (tableIndex != MaterialTable::kInvalidIndex && sMaterialIndexOffset != ConstantBuffer::kInvalidOffset)
+            {
+                cb->setVariableUnchecked(sMaterialIndexOffset, tableIndex);
+            }
+            else
+            {
+                pMaterial->setIntoProgramVars(currentData.pVars, cb.get(), "gMaterial");
+            }
+        }
         //currentData.pVars->setParameterBlock("gMaterial", pMaterial->getParameterBlock());
         return true;
     }
@@ -321,6 +381,8 @@ namespace Falcor
 
     bool SceneRenderer::update(double currentTime)
     {
+        // The lights might have moved
+        mClusteredLightsDirty = true;
         return mpScene->update(currentTime, mpCameraController.get());
     }
 
@@ -366,6 +428,7 @@ namespace Falcor
         currentData.pMaterial = nullptr;
         currentData.pModel = nullptr;
         currentData.drawID = 0;
+        resolveBindHandles(currentData);
         renderScene(currentData);
     }
 
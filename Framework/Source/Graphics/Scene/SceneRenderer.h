@@ -33,6 +33,8 @@
 #include "Utils/CpuTimer.h"
 #include "API/ConstantBuffer.h"
 #include "Utils/DebugDrawer.h"
+#include "Graphics/ClusteredLights.h"
+#include "Graphics/Material/MaterialTable.h"
 
 namespace Falcor
 {
@@ -96,6 +98,20 @@ namespace Falcor
 
         void toggleStaticMaterialCompilation(bool on) { mCompileMaterialWithProgram = on; }
 
+        /** Enable clustered light culling. Pass nullptr to disable it.
+            Programs which import the ClusteredLights shader module get the point and spot lights from the clusters, and only the other lights are written into the per-frame light array.
+            Programs which don't import the module keep getting all the scene lights in the light array.
+            The lights are binned by the first renderScene() call after update(), and again whenever the camera changes.
+        */
+        void setClusteredLights(const ClusteredLights::SharedPtr& pClusteredLights) { mpClusteredLights = pClusteredLights; mClusteredLightsDirty = true; }
+        const ClusteredLights::SharedPtr& getClusteredLights() const { return mpClusteredLights; }
+
+        /** Use a scene material table. Pass nullptr to disable it.
+            Programs which import the MaterialTable shader module get the table bound once per frame, and each draw only sets gMaterialIndex. Materials which are not in the table, and programs which don't import the module, keep getting gMaterial.
+        */
+        void setMaterialTable(const MaterialTable::SharedPtr& pMaterialTable) { mpMaterialTable = pMaterialTable; }
+        const MaterialTable::SharedPtr& getMaterialTable() const { return mpMaterialTable; }
+
     protected:
 
         struct CurrentWorkingData
@@ -108,6 +124,12 @@ namespace Falcor
             const Material* pMaterial = nullptr;
 
             uint32_t drawID; // Zero-based mesh instance draw order/ID. Resets at the beginning of renderScene, and increments per mesh instance drawn.
+
+            // Resolved by resolveBindHandles() once pVars is set, so that the draw loop doesn't look up the buffers by name
+            ParameterBlock::BindHandle perFrameCb;
+            ParameterBlock::BindHandle perMeshCb;
+            ParameterBlock::BindHandle perMaterialCb;
+            ParameterBlock::BindHandle boneCb;
         };
 
         SceneRenderer(const Scene::SharedPtr& pScene);
@@ -130,8 +152,10 @@ namespace Falcor
         static size_t sWorldInvTransposeMatOffset;
         static size_t sMeshIdOffset;
         static size_t sDrawIDOffset;
+        static size_t sMaterialIndexOffset;
 
         static void updateVariableOffsets(const ProgramReflection* pReflector);
+        static void resolveBindHandles(CurrentWorkingData& currentData);
 
         virtual void setPerFrameData(const CurrentWorkingData& currentData);
         virtual bool setPerModelData(const CurrentWorkingData& currentData);
@@ -155,5 +179,14 @@ namespace Falcor
         const Material* mpLastMaterial = nullptr;
         bool mCullEnabled = true;
         bool mCompileMaterialWithProgram = true;
+
+        ClusteredLights::SharedPtr mpClusteredLights;
+        bool mClusteredLightsDirty = true;              ///< Set by update(). The lights are only re-binned once per frame, or when the camera changes
+        const Camera* mpClusteredLightsCamera = nullptr;
+        glm::mat4 mClusteredLightsViewProj;
+        bool mLightArrayOverflowReported = false;
+
+        MaterialTable::SharedPtr mpMaterialTable;
+        bool mMaterialTableBound = false;   ///< Whether the current program uses the material table
     };
 }
@@ -0,0 +1,237 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TransformHierarchy.h"
+#include "Utils/Threading.h"
+#include <atomic>
+
+namespace Falcor
+{
+    // Levels with fewer nodes than this are updated on the calling thread. Dispatching them to the workers costs more than it saves.
+    static const uint32_t kParallelThreshold = 4096;
+
+    // Must be defined because it is passed by reference
+    const uint32_t TransformHierarchy::kInvalidNode;
+
+    TransformHierarchy::SharedPtr TransformHierarchy::create()
+    {
+        return SharedPtr(new TransformHierarchy());
+    }
+
+    uint32_t TransformHierarchy::addNode(uint32_t parent, const glm::mat4& localMatrix)
+    {
+        if (parent != kInvalidNode && parent >= getNodeCount())
+        {
+            logError("TransformHierarchy::addNode() - parent node " + std::to_string(parent) + " doesn't exist");
+            return kInvalidNode;
+        }
+
+        // Append the node. It will be moved into its level's range in the next update()
+        uint32_t node = getNodeCount();
+        uint32_t slot = (uint32_t)mSlotToNode.size();
+        mNodeParent.push_back(parent);
+        mNodeToSlot.push_back(slot);
+        mSlotParent.push_back(parent == kInvalidNode ? kInvalidNode : mNodeToSlot[parent]);
+        mSlotToNode.push_back(node);
+        mFlags.push_back(LocalDirty | NewNode);
+        mLocal.push_back(localMatrix);
+        mWorld.push_back(localMatrix);
+        mPrevWorld.push_back(localMatrix);
+
+        mOrderDirty = true;
+        mNeedsUpdate = true;
+        return node;
+    }
+
+    bool TransformHierarchy::setParent(uint32_t node, uint32_t parent)
+    {
+        if (node >= getNodeCount() || (parent != kInvalidNode && parent >= getNodeCount()))
+        {
+            logError("TransformHierarchy::setParent() - node doesn't exist");
+            return false;
+        }
+
+        for (uint32_t ancestor = parent; ancestor != kInvalidNode; ancestor = mNodeParent[ancestor])
+        {
+            if (ancestor == node)
+            {
+                logError("TransformHierarchy::setParent() - node " + std::to_string(parent) + " is a descendant of node " + std::to_string(node) + ". This would create a cycle");
+                return false;
+            }
+        }
+
+        uint32_t slot = mNodeToSlot[node];
+        mNodeParent[node] = parent;
+        mSlotParent[slot] = (parent == kInvalidNode) ? kInvalidNode : mNodeToSlot[parent];
+        mFlags[slot] |= LocalDirty;
+        mOrderDirty = true;
+        mNeedsUpdate = true;
+        return true;
+    }
+
+    void TransformHierarchy::setLocalMatrix(uint32_t node, const glm::mat4& localMatrix)
+    {
+        assert(node < getNodeCount());
+        uint32_t slot = mNodeToSlot[node];
+        mLocal[slot] = localMatrix;
+        mFlags[slot] |= LocalDirty;
+        mNeedsUpdate = true;
+    }
+
+    void TransformHierarchy::clear()
+    {
+        mNodeParent.clear();
+        mNodeToSlot.clear();
+        mSlotParent.clear();
+        mSlotToNode.clear();
+        mFlags.clear();
+        mLocal.clear();
+        mWorld.clear();
+        mPrevWorld.clear();
+        mLevelStart.clear();
+        mOrderDirty = false;
+        mNeedsUpdate = false;
+    }
+
+    void TransformHierarchy::rebuildOrder()
+    {
+        const uint32_t nodeCount = getNodeCount();
+
+        // Find the depth of each node. Walk up until we reach a node with a known depth, then assign the depths on the way back down
+        std::vector<uint32_t> level(nodeCount, kInvalidNode);
+        std::vector<uint32_t> chain;
+        uint32_t levelCount = 0;
+        for (uint32_t i = 0; i < nodeCount; i++)
+        {
+            uint32_t node = i;
+            while (node != kInvalidNode && level[node] == kInvalidNode)
+            {
+                chain.push_back(node);
+                node = mNodeParent[node];
+            }
+            uint32_t depth = (node == kInvalidNode) ? 0 : level[node] + 1;
+            while (chain.size())
+            {
+                level[chain.back()] = depth++;
+                chain.pop_back();
+            }
+            levelCount = std::max(levelCount, level[i] + 1);
+        }
+
+        // Counting sort by depth. Within a level, nodes stay in ID order
+        mLevelStart.assign(levelCount + 1, 0);
+        for (uint32_t i = 0; i < nodeCount; i++) mLevelStart[level[i] + 1]++;
+        for (uint32_t l = 0; l < levelCount; l++) mLevelStart[l + 1] += mLevelStart[l];
+
+        std::vector<uint32_t> nodeToSlot(nodeCount);
+        std::vector<uint32_t> next(mLevelStart.begin(), mLevelStart.end() - 1);
+        for (uint32_t i = 0; i < nodeCount; i++) nodeToSlot[i] = next[level[i]]++;
+
+        std::vector<uint32_t> slotParent(nodeCount);
+        std::vector<uint32_t> slotToNode(nodeCount);
+        std::vector<uint8_t> flags(nodeCount);
+        std::vector<glm::mat4> local(nodeCount);
+        std::vector<glm::mat4> world(nodeCount);
+        std::vector<glm::mat4> prevWorld(nodeCount);
+        for (uint32_t i = 0; i < nodeCount; i++)
+        {
+            uint32_t oldSlot = mNodeToSlot[i];
+            uint32_t slot = nodeToSlot[i];
+            uint32_t parent = mNodeParent[i];
+            slotParent[slot] = (parent == kInvalidNode) ? kInvalidNode : nodeToSlot[parent];
+            slotToNode[slot] = i;
+            flags[slot] = mFlags[oldSlot];
+            local[slot] = mLocal[oldSlot];
+            world[slot] = mWorld[oldSlot];
+            prevWorld[slot] = mPrevWorld[oldSlot];
+        }
+
+        mNodeToSlot.swap(nodeToSlot);
+        mSlotParent.swap(slotParent);
+        mSlotToNode.swap(slotToNode);
+        mFlags.swap(flags);
+        mLocal.swap(local);
+        mWorld.swap(world);
+        mPrevWorld.swap(prevWorld);
+        mOrderDirty = false;
+    }
+
+    uint32_t TransformHierarchy::updateRange(uint32_t begin, uint32_t end)
+    {
+        // The parents are in the previous levels, which were already updated in this call. Their WorldChanged flag refers to the current update.
+        uint32_t changed = 0;
+        for (uint32_t s = begin; s < end; s++)
+        {
+            uint8_t flags = mFlags[s];
+            uint32_t parent = mSlotParent[s];
+            bool dirty = (flags & (LocalDirty | NewNode)) || (parent != kInvalidNode && (mFlags[parent] & WorldChanged));
+            if (dirty)
+            {
+                glm::mat4 world = (parent == kInvalidNode) ? mLocal[s] : mWorld[parent] * mLocal[s];
+                mPrevWorld[s] = (flags & NewNode) ? world : mWorld[s];
+                mWorld[s] = world;
+                mFlags[s] = WorldChanged;
+                changed++;
+            }
+            else
+            {
+                // The node moved in the previous update but not in this one
+                if (flags & WorldChanged) mPrevWorld[s] = mWorld[s];
+                mFlags[s] = 0;
+            }
+        }
+        return changed;
+    }
+
+    uint32_t TransformHierarchy::update()
+    {
+        if (mOrderDirty) rebuildOrder();
+        if (mNeedsUpdate == false) return 0;
+
+        uint32_t changed = 0;
+        for (uint32_t l = 0; l < getLevelCount(); l++)
+        {
+            uint32_t begin = mLevelStart[l];
+            uint32_t count = mLevelStart[l + 1] - begin;
+            if (count < kParallelThreshold)
+            {
+                changed += updateRange(begin, begin + count);
+            }
+            else
+            {
+                std::atomic<uint32_t> levelChanged(0);
+                Threading::parallelFor(count, 0, [this, begin, &levelChanged](uint32_t b, uint32_t e, uint32_t) { levelChanged += updateRange(begin + b, begin + e); });
+                changed += levelChanged;
+            }
+        }
+
+        // Nodes which changed in this update need another pass to bring their previous matrix up to date
+        mNeedsUpdate = (changed > 0);
+        return changed;
+    }
+}
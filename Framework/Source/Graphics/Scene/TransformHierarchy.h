@@ -0,0 +1,121 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include "glm/mat4x4.hpp"
+
+namespace Falcor
+{
+    /** A hierarchy of transform nodes. Each node has a local matrix relative to its parent, and the world matrices are computed in update().
+        The matrices are stored as structure-of-arrays, sorted by depth in the hierarchy so that every parent precedes its children. update() processes one depth level at a time
+        and splits large levels across the worker threads. Only nodes whose local matrix or one of their ancestors changed are recomputed.
+        The world matrices from before the last update are kept, so that renderers can generate motion vectors.
+        Nodes are referenced by stable IDs, which are not affected by the internal reordering.
+    */
+    class TransformHierarchy
+    {
+    public:
+        using SharedPtr = std::shared_ptr<TransformHierarchy>;
+        using SharedConstPtr = std::shared_ptr<const TransformHierarchy>;
+
+        static const uint32_t kInvalidNode = uint32_t(-1);
+
+        /** Create a new object
+        */
+        static SharedPtr create();
+
+        /** Add a node
+            \param[in] parent The parent node, or kInvalidNode for a root node
+            \param[in] localMatrix The node's transform relative to its parent
+            \return The node ID, or kInvalidNode if the parent doesn't exist
+        */
+        uint32_t addNode(uint32_t parent, const glm::mat4& localMatrix = glm::mat4());
+
+        /** Change the parent of a node. The node keeps its local matrix.
+            \return false if one of the nodes doesn't exist or if the new parent is a descendant of the node
+        */
+        bool setParent(uint32_t node, uint32_t parent);
+
+        /** Set the local matrix of a node. The world matrices of the node and its descendants will be updated in the next call to update()
+        */
+        void setLocalMatrix(uint32_t node, const glm::mat4& localMatrix);
+
+        /** Remove all the nodes
+        */
+        void clear();
+
+        /** Propagate the local matrix changes into the world matrices. Call once per frame.
+            \return The number of nodes whose world matrix changed
+        */
+        uint32_t update();
+
+        uint32_t getNodeCount() const { return (uint32_t)mNodeParent.size(); }
+        uint32_t getParent(uint32_t node) const { return mNodeParent[node]; }
+        const glm::mat4& getLocalMatrix(uint32_t node) const { return mLocal[mNodeToSlot[node]]; }
+
+        /** Get the world matrix of a node, as of the last call to update()
+        */
+        const glm::mat4& getWorldMatrix(uint32_t node) const { return mWorld[mNodeToSlot[node]]; }
+
+        /** Get the world matrix of a node before the last call to update(). For nodes which didn't move, this is the same as the world matrix
+        */
+        const glm::mat4& getPrevWorldMatrix(uint32_t node) const { return mPrevWorld[mNodeToSlot[node]]; }
+
+        /** Get the number of depth levels in the hierarchy
+        */
+        uint32_t getLevelCount() const { return mLevelStart.size() ? (uint32_t)mLevelStart.size() - 1 : 0; }
+
+    private:
+        TransformHierarchy() = default;
+        void rebuildOrder();
+        uint32_t updateRange(uint32_t begin, uint32_t end);
+
+        enum Flags : uint8_t
+        {
+            LocalDirty = 0x1,       // The local matrix changed since the last update
+            WorldChanged = 0x2,     // The world matrix changed in the last update
+            NewNode = 0x4,          // The node was added since the last update and doesn't have a valid world matrix yet
+        };
+
+        // Per node ID
+        std::vector<uint32_t> mNodeParent;
+        std::vector<uint32_t> mNodeToSlot;
+
+        // Per slot. Slots are sorted by depth level, so parents always come before their children
+        std::vector<uint32_t> mSlotParent;      // Parent slot
+        std::vector<uint32_t> mSlotToNode;
+        std::vector<uint8_t> mFlags;
+        std::vector<glm::mat4> mLocal;
+        std::vector<glm::mat4> mWorld;
+        std::vector<glm::mat4> mPrevWorld;
+        std::vector<uint32_t> mLevelStart;      // First slot of each level, plus the total slot count
+
+        bool mOrderDirty = false;
+        bool mNeedsUpdate = false;
+    };
+}
@@ -36,6 +36,7 @@
 #include "VR/OpenVR/VRSystem.h"
 #include "Utils/Platform/ProgressBar.h"
 #include "Utils/StringUtils.h"
+#include "Utils/Threading.h"
 #include <sstream>
 #include <iomanip>
 
@@ -89,6 +90,12 @@ namespace Falcor
                 {
                     initVideoCapture();
                 }
+#if _PROFILING_ENABLED
+                else if (keyEvent.mods.isShiftDown && keyEvent.key == KeyboardEvent::Key::P)
+                {
+                    startProfilerCapture();
+                }
+#endif
                 else if (!keyEvent.mods.isAltDown && !keyEvent.mods.isCtrlDown && !keyEvent.mods.isShiftDown)
                 {
                     switch (keyEvent.key)
@@ -226,6 +233,7 @@ namespace Falcor
             initUI();
 
             mpPixelZoom = PixelZoom::create(mpDefaultFBO.get());
+            mpImageExporter = ImageExporter::create();
         }
         else
         {
@@ -255,6 +263,11 @@ namespace Falcor
         mpWindow->msgLoop();
 
         onShutdown();
+        // Completing a capture which is still running queues the file on the thread pool, so it must happen before the pool shuts down
+        Profiler::endCapture();
+        // Screenshots are encoded on the thread pool as well
+        mpImageExporter.reset();
+        Threading::shutdown();
         Logger::shutdown();
     }
 
@@ -293,7 +306,8 @@ namespace Falcor
             "  'Z'       - Zoom in on a pixel\n"
             "  'MouseWheel' - Change level of zoom\n"
 #if _PROFILING_ENABLED
-            "  'P'       - Enable profiling\n";
+            "  'P'       - Enable profiling\n"
+            "  'Shift+P' - Capture a profiler trace\n";
 #else
             ;
 #endif
@@ -337,6 +351,20 @@ namespace Falcor
             mpGui->endGroup();
         }
 
+        if (mpGui->beginGroup("Frame Statistics"))
+        {
+            TimingHistogram::Stats stats = mFrameRate.getStats();
+            char msg[512];
+            snprintf(msg, arraysize(msg), "Last %llu frames (ms)\nmean %.2f  p50 %.2f  p95 %.2f\np99 %.2f  max %.2f\nHitches (>%.1f ms): %llu",
+                (unsigned long long)stats.count, stats.mean, stats.p50, stats.p95, stats.p99, stats.max, mFrameRate.getHistogram().getHitchThreshold(), (unsigned long long)stats.hitchCount);
+            mpGui->addText(msg);
+            if (mpGui->addButton("Dump Statistics"))
+            {
+                dumpPerformanceStats();
+            }
+            mpGui->endGroup();
+        }
+
         onGuiRender();
         mpGui->popWindow();
         
@@ -390,6 +418,10 @@ namespace Falcor
 
         captureVideoFrame();
         printProfileData();
+        if (mpImageExporter)
+        {
+            mpImageExporter->update();
+        }
         if (mCaptureScreen)
         {
             captureScreen();
@@ -444,10 +476,19 @@ namespace Falcor
         std::string outputDirectory = explicitOutputDirectory != "" ? explicitOutputDirectory : getExecutableDirectory();
 
         std::string pngFile;
-        if (findAvailableFilename(filename, outputDirectory, "png", pngFile))
+        bool foundFilename = findAvailableFilename(filename, outputDirectory, "png", pngFile);
+        if (foundFilename && mpImageExporter->isExportPending(pngFile))
         {
+            // A capture from a previous frame didn't reach the disk yet and would be overwritten
+            mpImageExporter->flush();
+            foundFilename = findAvailableFilename(filename, outputDirectory, "png", pngFile);
+        }
+
+        if (foundFilename)
+        {
+            // The readback and the PNG encoding complete asynchronously. The file is guaranteed to be written once the sample exits
             Texture::SharedPtr pTexture = gpDevice->getSwapChainFbo()->getColorTexture(0);
-            pTexture->captureToFile(0, 0, pngFile);
+            mpImageExporter->exportTexture(mpRenderContext.get(), pTexture.get(), pngFile);
         }
         else
         {
@@ -476,11 +517,17 @@ namespace Falcor
 
             strstr << " descHeapAlloc: " << gEventCounter.numDescriptorHeapAllocations <<
                 " drawCalls: " << gEventCounter.numDrawCalls << " materialChanges: " << gEventCounter.numMaterialChanges
-                << " rootSigChanges: " << gEventCounter.numRootSignatureChanges << " numFlushes: " << gEventCounter.numFlushes
+                << " rootSigChanges: " << gEventCounter.numRootSignatureChanges << "/" << gEventCounter.numRootSignatureBinds << " numFlushes: " << gEventCounter.numFlushes
                 << " paramUpd: " << gEventCounter.numParamBlockUpdates
                 << " dscTbls: " << gEventCounter.numDescriptorTables << " dscs: " << gEventCounter.numDescriptors
                 << "\nSetGraphicsRootDescriptorTable calls: " << gEventCounter.numSetRootDescriptorTableCalls
-                << " chunkSwitch: " << gEventCounter.numDescriptorChunkSwitches << " outOfChunks: " << gEventCounter.numOutOfChunks;
+                << " chunkSwitch: " << gEventCounter.numDescriptorChunkSwitches << " outOfChunks: " << gEventCounter.numOutOfChunks
+                << " bufferUploads: " << gEventCounter.numBufferUploads << " (" << gEventCounter.numBufferUploadBytes << " bytes)";
+
+            int tableLookups = gEventCounter.numDescriptorTableCacheHits + gEventCounter.numDescriptorTableCacheMisses;
+            int hitRate = tableLookups ? (100 * gEventCounter.numDescriptorTableCacheHits) / tableLookups : 0;
+            strstr << "\nDescriptor-table cache hit rate: " << hitRate << "% (" << gEventCounter.numDescriptorTableCacheHits << "/" << tableLookups << ")"
+                << " cached tables: " << gEventCounter.numCachedDescriptorTables << " cached descriptors: " << gEventCounter.numCachedDescriptors;
         }
         return strstr.str();
     }
@@ -533,6 +580,34 @@ namespace Falcor
 #endif
     }
 
+    void Sample::dumpPerformanceStats()
+    {
+        std::string filename;
+        if (findAvailableFilename(getExecutableName() + ".Stats", getExecutableDirectory(), "json", filename) == false)
+        {
+            logError("Could not find available filename when dumping performance statistics");
+            return;
+        }
+        Profiler::dumpStats(filename, &mFrameRate.getHistogram());
+    }
+
+    void Sample::startProfilerCapture()
+    {
+        const uint32_t kCaptureFrameCount = 120;
+        std::string filename;
+        if (findAvailableFilename(getExecutableName(), getExecutableDirectory(), "json", filename) == false)
+        {
+            logError("Could not find available filename when capturing a profiler trace");
+            return;
+        }
+
+        if (Profiler::startCapture(filename, kCaptureFrameCount))
+        {
+            // The events are only collected while the profiler is enabled
+            gProfileEnabled = true;
+        }
+    }
+
     void Sample::initVideoCapture()
     {
         if (mVideoCapture.pUI == nullptr)
@@ -543,8 +618,9 @@ namespace Falcor
 
     void Sample::startVideoCapture()
     {
-        // Create the Capture Object and Framebuffer.
-        VideoEncoder::Desc desc;
+        // Create the Capture Object
+        VideoCapture::Desc captureDesc;
+        VideoEncoder::Desc& desc = captureDesc.encoderDesc;
         desc.flipY = false;
         desc.codec = mVideoCapture.pUI->getCodec();
         desc.filename = mVideoCapture.pUI->getFilename();
@@ -555,10 +631,9 @@ namespace Falcor
         desc.bitrateMbps = mVideoCapture.pUI->getBitrate();
         desc.gopSize = mVideoCapture.pUI->getGopSize();
 
-        mVideoCapture.pVideoCapture = VideoEncoder::create(desc);
+        mVideoCapture.pVideoCapture = VideoCapture::create(captureDesc);
 
         assert(mVideoCapture.pVideoCapture);
-        mVideoCapture.pFrame = new uint8_t[desc.width*desc.height * 4];
 
         mVideoCapture.sampleTimeDelta = mFixedTimeDelta;
         mFixedTimeDelta = 1.0f / (float)desc.fps;
@@ -583,10 +658,15 @@ namespace Falcor
         {
             mVideoCapture.pVideoCapture->endCapture();
             mShowUI = true;
+
+            VideoCapture::Stats stats = mVideoCapture.pVideoCapture->getStats();
+            std::string msg = "Video capture: " + std::to_string(stats.framesEncoded) + " frames encoded in " + std::to_string(stats.encodeTime) + " seconds. ";
+            msg += "The render thread waited " + std::to_string(stats.stallTime) + " seconds (" + std::to_string(stats.readbackStalls) + " readback stalls, " + std::to_string(stats.encoderStalls) + " encoder stalls). ";
+            msg += "Peak encoder queue depth " + std::to_string(stats.peakQueueDepth) + ".";
+            logInfo(msg);
         }
         mVideoCapture.pUI = nullptr;
         mVideoCapture.pVideoCapture = nullptr;
-        safe_delete_array(mVideoCapture.pFrame);
         mFixedTimeDelta = mVideoCapture.sampleTimeDelta;
     }
 
@@ -594,7 +674,7 @@ namespace Falcor
     {
         if (mVideoCapture.pVideoCapture)
         {
-            mVideoCapture.pVideoCapture->appendFrame(mpRenderContext->readTextureSubresource(mpDefaultFBO->getColorTexture(0).get(), 0).data());
+            mVideoCapture.pVideoCapture->captureFrame(mpRenderContext.get(), mpDefaultFBO->getColorTexture(0).get());
 
             if (mVideoCapture.pUI->useTimeRange())
             {
@@ -36,6 +36,8 @@
 #include "Utils/TextRenderer.h"
 #include "API/RenderContext.h"
 #include "Utils/Video/VideoEncoderUI.h"
+#include "Utils/Video/VideoCapture.h"
+#include "Utils/ImageExporter.h"
 #include "API/Device.h"
 #include "ArgList.h"
 #include "Utils/PixelZoom.h"
@@ -212,6 +214,8 @@ namespace Falcor
         // Private functions
         void initUI();
         void printProfileData();
+        void startProfilerCapture();
+        void dumpPerformanceStats();
         void calculateTime();
 
         void startVideoCapture();
@@ -227,12 +231,12 @@ namespace Falcor
         struct VideoCaptureData
         {
             VideoEncoderUI::UniquePtr pUI;
-            VideoEncoder::UniquePtr pVideoCapture;
-            uint8_t* pFrame = nullptr;
+            VideoCapture::UniquePtr pVideoCapture;
             float sampleTimeDelta; // Saves the sample's fixed time delta because video capture overwrites it while recording
         };
 
         VideoCaptureData mVideoCapture;
+        ImageExporter::UniquePtr mpImageExporter;
 
         FrameRate mFrameRate;
         
@@ -27,11 +27,17 @@
 ***************************************************************************/
 #include "Framework.h"
 #include "SampleTest.h"
+#include "Utils/Profiler.h"
 #include <algorithm>
 #include <fstream>
 
 namespace Falcor
 {
+    static const uint32_t kBenchmarkStartFrame = 1;
+    static const uint32_t kDefaultBenchmarkWarmupFrames = 60;
+    static const uint32_t kDefaultBenchmarkMeasuredFrames = 600;
+    static const float kDefaultBenchmarkTimeDelta = 1.0f / 60.0f;
+
     // Initialize the Testing.
     void SampleTest::initializeTesting()
     {
@@ -40,8 +46,10 @@ namespace Falcor
             // Initialize the Tests.
             initializeTests();
 
-            // Initialize Testing Callback.
+            // Initialize Testing Callback. This is where the testing samples load their content, so time it.
+            CpuTimer::TimePoint loadStart = CpuTimer::getCurrentTimePoint();
             onInitializeTesting();
+            mLoadTime = CpuTimer::calcDuration(loadStart, CpuTimer::getCurrentTimePoint());
         }
     }
 
@@ -235,6 +243,9 @@ namespace Falcor
         // Write the Performance Range Results.
         writePerformanceRangesResults(jsonTestResults);
 
+        // Write the Benchmark Results.
+        writeBenchmarkResults(jsonTestResults);
+
         // Write the Screen Capture Results.
         writeScreenCaptureResults(jsonTestResults);
     }
@@ -269,6 +280,12 @@ namespace Falcor
         {
             if (mFrameTasks[i]->mTaskType == TaskType::PerformanceCheckTask)
             {
+                std::shared_ptr<PerformanceCheckFrameTask> pcfTask = std::dynamic_pointer_cast<PerformanceCheckFrameTask>(mFrameTasks[i]);
+                if (pcfTask != nullptr)
+                {
+                    rapidjson::Value pcfCheck = getPerformanceCheckJson(pcfTask->mPerformanceCheckResults, jsonAllocator, (float)pcfTask->mStartFrame, (float)pcfTask->mEndFrame);
+                    pcfArray.PushBack(pcfCheck, jsonAllocator);
+                }
             }
         }
 
@@ -281,12 +298,119 @@ namespace Falcor
         {
             if (mTimeTasks[i]->mTaskType == TaskType::PerformanceCheckTask)
             {
+                std::shared_ptr<PerformanceCheckTimeTask> pctTask = std::dynamic_pointer_cast<PerformanceCheckTimeTask>(mTimeTasks[i]);
+                if (pctTask != nullptr)
+                {
+                    rapidjson::Value pctCheck = getPerformanceCheckJson(pctTask->mPerformanceCheckResults, jsonAllocator, pctTask->mStartTime, pctTask->mEndTime);
+                    pctArray.PushBack(pctCheck, jsonAllocator);
+                }
             }
         }
 
         jsonTestResults.AddMember("Performance Time Checks", pctArray, jsonAllocator);
     }
 
+    // Convert the statistics of a histogram to json.
+    static rapidjson::Value getHistogramJson(const TimingHistogram& histogram, rapidjson::Document::AllocatorType& jallocator)
+    {
+        TimingHistogram::Stats stats = histogram.getStats();
+        rapidjson::Value jstats;
+        jstats.SetObject();
+        jstats.AddMember("Count", stats.count, jallocator);
+        jstats.AddMember("Mean", stats.mean, jallocator);
+        jstats.AddMember("P50", stats.p50, jallocator);
+        jstats.AddMember("P95", stats.p95, jallocator);
+        jstats.AddMember("P99", stats.p99, jallocator);
+        jstats.AddMember("Max", stats.max, jallocator);
+        jstats.AddMember("Hitch Threshold", histogram.getHitchThreshold(), jallocator);
+        jstats.AddMember("Hitches", stats.hitchCount, jallocator);
+        return jstats;
+    }
+
+    // Write the statistics of a Performance Check Range.
+    rapidjson::Value SampleTest::getPerformanceCheckJson(const PerfCheck& perfCheck, rapidjson::Document::AllocatorType& jallocator, float start, float end)
+    {
+        rapidjson::Value jcheck;
+        jcheck.SetObject();
+        jcheck.AddMember("Start", start, jallocator);
+        jcheck.AddMember("End", end, jallocator);
+        rapidjson::Value jframeTimes = getHistogramJson(perfCheck.frameTimes, jallocator);
+        jcheck.AddMember("Frame Time", jframeTimes, jallocator);
+
+        rapidjson::Value jevents(rapidjson::kArrayType);
+        for (const auto& e : perfCheck.events)
+        {
+            rapidjson::Value jname;
+            jname.SetString(e.first.c_str(), (uint32_t)e.first.size(), jallocator);
+
+            rapidjson::Value jevent;
+            jevent.SetObject();
+            jevent.AddMember("Name", jname, jallocator);
+            rapidjson::Value jcpu = getHistogramJson(e.second.cpu, jallocator);
+            rapidjson::Value jgpu = getHistogramJson(e.second.gpu, jallocator);
+            jevent.AddMember("CPU Time", jcpu, jallocator);
+            jevent.AddMember("GPU Time", jgpu, jallocator);
+            jevents.PushBack(jevent, jallocator);
+        }
+        jcheck.AddMember("Profiler Events", jevents, jallocator);
+        return jcheck;
+    }
+
+    // Write the Benchmark Results.
+    void SampleTest::writeBenchmarkResults(rapidjson::Document & jsonTestResults)
+    {
+        if (mpBenchmarkTask == nullptr) return;
+
+        auto & jsonAllocator = jsonTestResults.GetAllocator();
+
+        // Only the runs which completed. The application might have been closed in the middle of the benchmark.
+        rapidjson::Value jruns(rapidjson::kArrayType);
+        for (uint32_t i = 0; i < mpBenchmarkTask->mCurrentRun; i++)
+        {
+            const BenchmarkFrameTask::Run& run = mpBenchmarkTask->mRuns[i];
+            rapidjson::Value jrun = getPerformanceCheckJson(run.perfCheck, jsonAllocator, (float)run.firstFrame, (float)run.lastFrame);
+            jrun.AddMember("Peak Process Memory", run.peakProcessMemory, jsonAllocator);
+            jruns.PushBack(jrun, jsonAllocator);
+        }
+
+        rapidjson::Value jbenchmark;
+        jbenchmark.SetObject();
+        jbenchmark.AddMember("Load Time", mLoadTime, jsonAllocator);
+        jbenchmark.AddMember("Fixed Time Delta", getFixedTimeDelta(), jsonAllocator);
+        jbenchmark.AddMember("Warmup Frames", mpBenchmarkTask->mWarmupFrames, jsonAllocator);
+        jbenchmark.AddMember("Measured Frames", mpBenchmarkTask->mMeasuredFrames, jsonAllocator);
+        jbenchmark.AddMember("Completed Runs", mpBenchmarkTask->mCurrentRun, jsonAllocator);
+        jbenchmark.AddMember("Runs", jruns, jsonAllocator);
+
+        float firstFrame = mpBenchmarkTask->mCurrentRun ? (float)mpBenchmarkTask->mRuns.front().firstFrame : 0;
+        float lastFrame = mpBenchmarkTask->mCurrentRun ? (float)mpBenchmarkTask->mRuns[mpBenchmarkTask->mCurrentRun - 1].lastFrame : 0;
+        rapidjson::Value jallRuns = getPerformanceCheckJson(mpBenchmarkTask->mAllRuns, jsonAllocator, firstFrame, lastFrame);
+        jbenchmark.AddMember("All Runs", jallRuns, jsonAllocator);
+
+#ifdef FALCOR_NULL
+        // The null backend counts the commands which were submitted since the benchmark started, warm-up frames included
+        const NullBackendStats stats = getNullBackendStats();
+        const double frameCount = (double)std::max<uint64_t>(stats.presents, 1);
+        rapidjson::Value jnull;
+        jnull.SetObject();
+        jnull.AddMember("Frames", stats.presents, jsonAllocator);
+        jnull.AddMember("Command Lists Per Frame", stats.commandListsExecuted / frameCount, jsonAllocator);
+        jnull.AddMember("Descriptor Writes Per Frame", stats.descriptorWrites / frameCount, jsonAllocator);
+        jnull.AddMember("Descriptor Sets Created Per Frame", stats.descriptorSetsCreated / frameCount, jsonAllocator);
+        jnull.AddMember("Pipeline States Created", stats.pipelineStatesCreated, jsonAllocator);
+        for (uint32_t i = 0; i < (uint32_t)NullCommand::Count; i++)
+        {
+            std::string name = std::string(to_string((NullCommand)i)) + " Per Frame";
+            rapidjson::Value jname(name.c_str(), jsonAllocator);
+            jnull.AddMember(jname, stats.commands[i] / frameCount, jsonAllocator);
+        }
+        jbenchmark.AddMember("Null Backend", jnull, jsonAllocator);
+#endif
+
+
+        jsonTestResults.AddMember("Benchmark", jbenchmark, jsonAllocator);
+    }
+
     // Write the Screen Capture Results.
     void SampleTest::writeScreenCaptureResults(rapidjson::Document & jsonTestResults)
     {
@@ -376,6 +500,15 @@ namespace Falcor
             }
         }
 
+        if (mArgList.argExists("hitchthreshold"))
+        {
+            std::vector<ArgList::Arg> htArgs = mArgList.getValues("hitchthreshold");
+            if (!htArgs.empty())
+            {
+                mHitchThreshold = htArgs[0].asFloat();
+            }
+        }
+
         if (mArgList.argExists("fixedtimedelta"))
         {
             std::vector<ArgList::Arg> ftdArgs = mArgList.getValues("fixedtimedelta");
@@ -427,6 +560,49 @@ namespace Falcor
             }
         }
 
+        // Check for Performance Frame Ranges.
+        if (mArgList.argExists("perfframes"))
+        {
+            std::vector<ArgList::Arg> perfFrameRanges = mArgList.getValues("perfframes");
+
+            if (perfFrameRanges.size() % 2 != 0)
+            {
+                logError("Please provide a start and end frame for each Performance Frame Range. The extra one will be discarded.");
+                perfFrameRanges.pop_back();
+            }
+
+            for (uint32_t i = 0; i < perfFrameRanges.size() / 2; i++)
+            {
+                std::shared_ptr<PerformanceCheckFrameTask> performanceCheckFrameTask = std::make_shared<PerformanceCheckFrameTask>(perfFrameRanges[2 * i].asUint(), perfFrameRanges[2 * i + 1].asUint(), mHitchThreshold);
+                mFrameTasks.push_back(performanceCheckFrameTask);
+            }
+        }
+
+        // Check for a Benchmark. The optional values are the number of warm-up frames, measured frames and runs.
+        if (mArgList.argExists("benchmark"))
+        {
+            std::vector<ArgList::Arg> benchmarkArgs = mArgList.getValues("benchmark");
+            uint32_t warmupFrames = benchmarkArgs.size() > 0 ? benchmarkArgs[0].asUint() : kDefaultBenchmarkWarmupFrames;
+            uint32_t measuredFrames = benchmarkArgs.size() > 1 ? std::max(benchmarkArgs[1].asUint(), 1u) : kDefaultBenchmarkMeasuredFrames;
+            uint32_t runCount = benchmarkArgs.size() > 2 ? std::max(benchmarkArgs[2].asUint(), 1u) : 1;
+
+            mpBenchmarkTask = std::make_shared<BenchmarkFrameTask>(kBenchmarkStartFrame, warmupFrames, measuredFrames, runCount, mHitchThreshold);
+            mFrameTasks.push_back(mpBenchmarkTask);
+
+            // The simulation must not depend on the frame rate, otherwise the runs are not comparable
+            if (getFixedTimeDelta() == 0)
+            {
+                setFixedTimeDelta(kDefaultBenchmarkTimeDelta);
+            }
+
+            // Only measure the sample's own work
+            toggleUI(false);
+            toggleText(false);
+#if _PROFILING_ENABLED
+            gProfileEnabled = true;
+#endif
+        }
+
         std::sort(mFrameTasks.begin(), mFrameTasks.end(), FrameTaskPtrCompare());
     }
 
@@ -473,7 +649,8 @@ namespace Falcor
 
             for (uint32_t i = 0; i < perfframeRanges.size() / 2; i++)
             {
-                std::shared_ptr<PerformanceCheckTimeTask> performanceCheckTimeTask = std::make_shared<PerformanceCheckTimeTask>(perfframeRanges[i].asFloat(), perfframeRanges[i + 1].asFloat());
+                std::shared_ptr<PerformanceCheckTimeTask> performanceCheckTimeTask = std::make_shared<PerformanceCheckTimeTask>(perfframeRanges[2 * i].asFloat(), perfframeRanges[2 * i + 1].asFloat(), mHitchThreshold);
+                mTimeTasks.push_back(performanceCheckTimeTask);
             }
         }
 
@@ -730,15 +907,121 @@ namespace Falcor
         }
     }
 
+    // PerfCheck
+
+    void SampleTest::PerfCheck::recordFrame(SampleTest* sampleTest)
+    {
+        frameTimes.record(sampleTest->frameRate().getLastFrameTime() * 1000);
+
+        // The profiler results are those of the previous frame, since the profiler is updated after the test frame ends
+        if (gProfileEnabled)
+        {
+            for (const Profiler::EventData* pEvent : Profiler::getEvents())
+            {
+                if (pEvent->lastFrame.callCount == 0) continue;
+                EventTimes& times = events[pEvent->name];
+                times.cpu.record(pEvent->lastFrame.cpuMs);
+                times.gpu.record(pEvent->lastFrame.gpuMs);
+            }
+        }
+    }
+
+    // PerformanceCheckFrameTask
+
+    bool SampleTest::PerformanceCheckFrameTask::isActive(SampleTest* sampleTest)
+    {
+        return sampleTest->getFrameID() >= mStartFrame && !mIsTaskComplete;
+    }
+
+    void SampleTest::PerformanceCheckFrameTask::onFrameEnd(SampleTest* sampleTest)
+    {
+        mPerformanceCheckResults.recordFrame(sampleTest);
+
+        if (sampleTest->getFrameID() >= mEndFrame)
+        {
+            // Task is Complete!
+            mIsTaskComplete = true;
+        }
+    }
+
+    // BenchmarkFrameTask
+
+    SampleTest::BenchmarkFrameTask::BenchmarkFrameTask(uint32_t startFrame, uint32_t warmupFrames, uint32_t measuredFrames, uint32_t runCount, float hitchThreshold)
+        : FrameTask(TaskType::BenchmarkTask, startFrame, startFrame + (warmupFrames + measuredFrames) * runCount - 1), mWarmupFrames(warmupFrames), mMeasuredFrames(measuredFrames), mRuns(runCount, Run(hitchThreshold)), mAllRuns(hitchThreshold)
+    {
+    }
+
+    bool SampleTest::BenchmarkFrameTask::isActive(SampleTest* sampleTest)
+    {
+        return sampleTest->getFrameID() >= mStartFrame && !mIsTaskComplete;
+    }
+
+    void SampleTest::BenchmarkFrameTask::onFrameBegin(SampleTest* sampleTest)
+    {
+        if (mRunFrame == 0)
+        {
+            // Restart the simulation, so that every run renders the same frames
+            sampleTest->mCurrentTime = 0;
+#ifdef FALCOR_NULL
+            if (mCurrentRun == 0) resetNullBackendStats();
+#endif
+        }
+    }
+
+    void SampleTest::BenchmarkFrameTask::onFrameEnd(SampleTest* sampleTest)
+    {
+        if (mRunFrame >= mWarmupFrames)
+        {
+            Run& run = mRuns[mCurrentRun];
+            uint32_t frameID = sampleTest->getFrameID();
+            if (mRunFrame == mWarmupFrames)
+            {
+                run.firstFrame = frameID;
+            }
+            run.lastFrame = frameID;
+
+            run.perfCheck.recordFrame(sampleTest);
+            mAllRuns.recordFrame(sampleTest);
+
+            MemoryCheck memoryCheck;
+            sampleTest->getMemoryStatistics(memoryCheck);
+            run.peakProcessMemory = std::max(run.peakProcessMemory, memoryCheck.currentlyUsedVirtualMemory);
+        }
+
+        mRunFrame++;
+        if (mRunFrame == mWarmupFrames + mMeasuredFrames)
+        {
+            mRunFrame = 0;
+            mCurrentRun++;
+            if (mCurrentRun == mRuns.size())
+            {
+                // Write the json Test Results and shutdown the App.
+                sampleTest->writeJsonTestResults();
+                sampleTest->shutdownApp();
+                sampleTest->onTestShutdown();
+
+                // Task is Complete!
+                mIsTaskComplete = true;
+            }
+        }
+    }
+
+    // PerformanceCheckTimeTask
+
     bool SampleTest::PerformanceCheckTimeTask::isActive(SampleTest* sampleTest)
     {
-        return sampleTest->mCurrentTime >= mStartTime && sampleTest->mCurrentTime <= mEndTime;
+        return sampleTest->mCurrentTime >= mStartTime && !mIsTaskComplete;
     }
 
     void SampleTest::PerformanceCheckTimeTask::onFrameEnd(SampleTest* sampleTest)
     {
-        // Task is Complete!
-        mIsTaskComplete = true;
+        mPerformanceCheckResults.recordFrame(sampleTest);
+
+        if (sampleTest->mCurrentTime >= mEndTime)
+        {
+            // Task is Complete!
+            mIsTaskComplete = true;
+        }
     }
 
     bool SampleTest::ScreenCaptureTimeTask::isActive(SampleTest* sampleTest)
@@ -31,6 +31,7 @@
 #include "Externals/RapidJson/include/rapidjson/prettywriter.h"
 //#include "Falcor.h"
 #include "Sample.h"
+#include <map>
 
 namespace Falcor
 {
@@ -69,6 +70,10 @@ namespace Falcor
         */
         virtual void onTestShutdown() {}
 
+        /** Check if the sample was started in benchmark mode. Samples should use it to attach their camera to a path, so that every benchmark run renders the same sequence of views
+        */
+        bool isBenchmarking() const { return mpBenchmarkTask != nullptr; }
+
     protected:
 
         /** Different ways test tasks can be triggered
@@ -89,6 +94,7 @@ namespace Falcor
             LoadTimeCheckTask,
             MemoryCheckTask,
             PerformanceCheckTask,
+            BenchmarkTask,
             ScreenCaptureTask,
             ShutdownTask
         };
@@ -105,10 +111,25 @@ namespace Falcor
             uint64_t currentlyUsedVirtualMemory = 0;
         };
 
+        /** The statistics collected over a performance check range.
+        */
         struct PerfCheck
         {
-            float time = 0.0;
-            uint64_t frameID = 0;
+            PerfCheck(float hitchThreshold) : frameTimes(0, hitchThreshold) {}
+
+            /** Record the frame time and the profiler events of the last frame
+            */
+            void recordFrame(SampleTest* sampleTest);
+
+            TimingHistogram frameTimes;
+
+            // Per-frame CPU and GPU time of each profiler event. Only recorded while profiling is enabled
+            struct EventTimes
+            {
+                TimingHistogram cpu;
+                TimingHistogram gpu;
+            };
+            std::map<std::string, EventTimes> events;
         };
 
         class FrameTask
@@ -165,6 +186,49 @@ namespace Falcor
             float mLoadTimeCheckResult = 0;
         };
 
+        class PerformanceCheckFrameTask : public FrameTask
+        {
+        public:
+            PerformanceCheckFrameTask(uint32_t startFrame, uint32_t endFrame, float hitchThreshold) : FrameTask(TaskType::PerformanceCheckTask, startFrame, endFrame), mPerformanceCheckResults(hitchThreshold) {};
+
+            virtual bool isActive(SampleTest* sampleTest);
+            virtual void onFrameBegin(SampleTest* sampleTest) {}
+            virtual void onFrameEnd(SampleTest* sampleTest);
+
+            PerfCheck mPerformanceCheckResults;
+        };
+
+        /** Deterministic benchmark. Executes a number of runs, each one made of warm-up frames which are excluded from the results followed by measured frames.
+            Simulation time is reset at the beginning of every run and advanced by the fixed time delta, so all the runs render the same sequence of frames.
+            The application writes the results and shuts down once the last run has completed.
+        */
+        class BenchmarkFrameTask : public FrameTask
+        {
+        public:
+            BenchmarkFrameTask(uint32_t startFrame, uint32_t warmupFrames, uint32_t measuredFrames, uint32_t runCount, float hitchThreshold);
+
+            virtual bool isActive(SampleTest* sampleTest);
+            virtual void onFrameBegin(SampleTest* sampleTest);
+            virtual void onFrameEnd(SampleTest* sampleTest);
+
+            struct Run
+            {
+                Run(float hitchThreshold) : perfCheck(hitchThreshold) {}
+                PerfCheck perfCheck;
+                uint32_t firstFrame = 0;
+                uint32_t lastFrame = 0;
+                uint64_t peakProcessMemory = 0;     // High-water mark of the process memory usage during the measured frames. Windows only
+            };
+
+            uint32_t mWarmupFrames;
+            uint32_t mMeasuredFrames;
+            std::vector<Run> mRuns;
+            PerfCheck mAllRuns;                     // Aggregated measured frames of all the runs
+
+            uint32_t mCurrentRun = 0;
+            uint32_t mRunFrame = 0;
+        };
+
         class ScreenCaptureFrameTask : public FrameTask
         {
         public:
@@ -250,13 +314,13 @@ namespace Falcor
         class PerformanceCheckTimeTask : public TimeTask
         {
         public:
-            PerformanceCheckTimeTask(float perfomanceCheckRangeBeginTime, float perfomanceCheckRangeBeginEnd) : TimeTask(TaskType::PerformanceCheckTask, perfomanceCheckRangeBeginTime, perfomanceCheckRangeBeginEnd) {};
+            PerformanceCheckTimeTask(float perfomanceCheckRangeBeginTime, float perfomanceCheckRangeBeginEnd, float hitchThreshold) : TimeTask(TaskType::PerformanceCheckTask, perfomanceCheckRangeBeginTime, perfomanceCheckRangeBeginEnd), mPerformanceCheckResults(hitchThreshold) {};
 
             virtual bool isActive(SampleTest* sampleTest);
             virtual void onFrameBegin(SampleTest* sampleTest) {}
             virtual void onFrameEnd(SampleTest* sampleTest);
 
-            float mPerformanceCheckResults = 0;
+            PerfCheck mPerformanceCheckResults;
         };
 
         class ScreenCaptureTimeTask : public TimeTask
@@ -288,6 +352,7 @@ namespace Falcor
         };
 
         std::shared_ptr<LoadTimeCheckTask> mLoadTimeCheckTask;
+        std::shared_ptr<BenchmarkFrameTask> mpBenchmarkTask;
 
         /*  Write JSON Literal.
         */
@@ -328,6 +393,14 @@ namespace Falcor
         */
         void writePerformanceRangesResults(rapidjson::Document & jsonTestResults);
 
+        /** Write the statistics of a Performance Check Range.
+        */
+        rapidjson::Value getPerformanceCheckJson(const PerfCheck& perfCheck, rapidjson::Document::AllocatorType& jallocator, float start, float end);
+
+        /** Write the Benchmark Results.
+        */
+        void writeBenchmarkResults(rapidjson::Document & jsonTestResults);
+
         /** Write the Screen Capture.
         */
         void writeScreenCaptureResults(rapidjson::Document & jsonTestResults);
@@ -350,6 +423,12 @@ namespace Falcor
         bool mHasSetFilename = false;
         std::string mTestOutputFilename = "";
 
+        // Frames longer than this (in ms) are counted as hitches by the performance checks.
+        float mHitchThreshold = FrameRate::kDefaultHitchThreshold;
+
+        // Time spent in onInitializeTesting(), which is where testing samples load their content (in ms).
+        float mLoadTime = 0;
+
         // The Memory Check Between Frames.
         struct MemoryCheckRange
         {
@@ -0,0 +1,109 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "AsyncFileWriter.h"
+
+namespace Falcor
+{
+    AsyncFileWriter::SharedPtr AsyncFileWriter::create(const std::string& filename, bool binary)
+    {
+        SharedPtr pWriter = SharedPtr(new AsyncFileWriter(filename));
+        pWriter->mStream.open(filename, binary ? std::ios::out | std::ios::binary : std::ios::out);
+        if (pWriter->mStream.fail())
+        {
+            logError("AsyncFileWriter: can't open file '" + filename + "' for writing");
+            return nullptr;
+        }
+        pWriter->mThread = std::thread(&AsyncFileWriter::writerLoop, pWriter.get());
+        return pWriter;
+    }
+
+    AsyncFileWriter::~AsyncFileWriter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+        mDataAvailable.notify_one();
+        if (mThread.joinable()) mThread.join();
+        mStream.close();
+    }
+
+    void AsyncFileWriter::write(std::string&& data)
+    {
+        if (data.empty()) return;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mPendingBytes += data.size();
+            mQueue.push_back(std::move(data));
+        }
+        mDataAvailable.notify_one();
+    }
+
+    void AsyncFileWriter::flush()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mQueueDrained.wait(lock, [this] { return mQueue.empty() && mWriting == false; });
+    }
+
+    size_t AsyncFileWriter::getPendingBytes() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mPendingBytes;
+    }
+
+    void AsyncFileWriter::writerLoop()
+    {
+        std::deque<std::string> batch;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mWriting = false;
+                mQueueDrained.notify_all();
+                mDataAvailable.wait(lock, [this] { return mStop || mQueue.size(); });
+                if (mQueue.empty()) return;
+                // Take all the queued data at once, so that the lock is held once per batch rather than once per write
+                batch.swap(mQueue);
+                mWriting = true;
+            }
+
+            size_t bytes = 0;
+            for (const std::string& data : batch)
+            {
+                mStream.write(data.data(), data.size());
+                bytes += data.size();
+            }
+            batch.clear();
+            mStream.flush();
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            mPendingBytes -= bytes;
+        }
+    }
+}
@@ -0,0 +1,88 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Falcor
+{
+    /** Appends data to a file from a background thread.
+        write() only moves the data into a queue, so callers on latency-sensitive threads never wait for the disk.
+    */
+    class AsyncFileWriter
+    {
+    public:
+        using SharedPtr = std::shared_ptr<AsyncFileWriter>;
+
+        /** Create a new object. The file is created (or truncated) immediately.
+            \param[in] filename The output file
+            \param[in] binary Whether to open the file in binary mode
+            \return A new object, or nullptr if the file could not be opened
+        */
+        static SharedPtr create(const std::string& filename, bool binary = false);
+
+        /** Flushes all the pending data and closes the file
+        */
+        ~AsyncFileWriter();
+
+        /** Queue data to be appended to the file
+        */
+        void write(std::string&& data);
+
+        /** Block until all the data which was queued so far has been written to the file and flushed
+        */
+        void flush();
+
+        /** Get the number of bytes which were queued but not written yet
+        */
+        size_t getPendingBytes() const;
+
+        const std::string& getFilename() const { return mFilename; }
+
+    private:
+        AsyncFileWriter(const std::string& filename) : mFilename(filename) {}
+        void writerLoop();
+
+        std::string mFilename;
+        std::ofstream mStream;
+        std::thread mThread;
+
+        mutable std::mutex mMutex;
+        std::condition_variable mDataAvailable;
+        std::condition_variable mQueueDrained;
+        std::deque<std::string> mQueue;
+        size_t mPendingBytes = 0;
+        bool mWriting = false;
+        bool mStop = false;
+    };
+}
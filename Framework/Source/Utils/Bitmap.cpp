@@ -30,6 +30,7 @@
 #include "FreeImage.h"
 #include "Utils/Platform/OS.h"
 #include "API/Device.h"
+#include "Utils/Threading.h"
 #include <cstring>
 
 namespace Falcor
@@ -186,18 +187,51 @@ namespace Falcor
         return FIT_BITMAP;
     }
 
-    void Bitmap::saveImage(const std::string& filename, uint32_t width, uint32_t height, FileFormat fileFormat, ExportFlags exportFlags, ResourceFormat resourceFormat, bool isTopDown, void* pData)
+    /** Convert 8-bit RGBA/BGRA texels into a 24- or 32-bit FreeImage bitmap. Rows are converted in parallel, which replaces the in-place channel swap and the extra FreeImage_ConvertTo24Bits() pass
+    */
+    static FIBITMAP* convert8BitImage(uint32_t width, uint32_t height, bool isRgba, bool exportAlpha, bool isTopDown, const uint8_t* pData)
+    {
+        FIBITMAP* pImage = FreeImage_Allocate(width, height, exportAlpha ? 32 : 24, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK);
+        if (pImage == nullptr) return nullptr;
+
+        // FreeImage stores 8-bit images as BGRA in memory. RGBA formats are swapped and were always exported as opaque.
+        const uint32_t redIndex = isRgba ? 0 : 2;
+        const uint32_t blueIndex = isRgba ? 2 : 0;
+        const uint32_t dstBpp = exportAlpha ? 4 : 3;
+
+        auto convertRows = [=](uint32_t begin, uint32_t end, uint32_t)
+        {
+            for (uint32_t y = begin; y < end; y++)
+            {
+                const uint8_t* pSrc = pData + (size_t)y * width * 4;
+                BYTE* pDst = FreeImage_GetScanLine(pImage, isTopDown ? height - y - 1 : y);
+                for (uint32_t x = 0; x < width; x++)
+                {
+                    pDst[FI_RGBA_RED] = pSrc[redIndex];
+                    pDst[FI_RGBA_GREEN] = pSrc[1];
+                    pDst[FI_RGBA_BLUE] = pSrc[blueIndex];
+                    if (exportAlpha) pDst[FI_RGBA_ALPHA] = isRgba ? 0xff : pSrc[3];
+                    pSrc += 4;
+                    pDst += dstBpp;
+                }
+            }
+        };
+        Threading::parallelFor(height, 0, convertRows);
+        return pImage;
+    }
+
+    bool Bitmap::saveImage(const std::string& filename, uint32_t width, uint32_t height, FileFormat fileFormat, ExportFlags exportFlags, ResourceFormat resourceFormat, bool isTopDown, void* pData)
     {
         if(pData == nullptr)
         {
             logError("Bitmap::saveImage provided no data to save.");
-            return;
+            return false;
         }
         
         if(is_set(exportFlags, ExportFlags::Uncompressed) && is_set(exportFlags, ExportFlags::Lossy))
         {
             logError("Bitmap::saveImage incompatible flags: lossy cannot be combined with uncompressed.");
-            return;
+            return false;
         }
 
         int flags = 0;
@@ -206,25 +240,28 @@ namespace Falcor
 
         //TODO replace this code for swapping channels. Can't use freeimage masks b/c they only care about 16 bpp images
         //issue #74 in gitlab
-        if (resourceFormat == ResourceFormat::RGBA8Uint || resourceFormat == ResourceFormat::RGBA8Snorm || resourceFormat == ResourceFormat::RGBA8UnormSrgb)
+        const bool isRgba = (resourceFormat == ResourceFormat::RGBA8Uint || resourceFormat == ResourceFormat::RGBA8Snorm || resourceFormat == ResourceFormat::RGBA8UnormSrgb);
+        if (fileFormat == Bitmap::FileFormat::PngFile)
         {
-            for (uint32_t a = 0; a < width*height; a++)
+            if(is_set(exportFlags, ExportFlags::Lossy))
             {
-                uint32_t* pPixel = (uint32_t*)pData;
-                pPixel += a;
-                uint8_t* ch = (uint8_t*)pPixel;
-                std::swap(ch[0], ch[2]);
-                ch[3] = 0xff;
+                logError("Bitmap::saveImage: PNG does not support lossy compression mode.");
+                return false;
             }
-        }
-        if (fileFormat == Bitmap::FileFormat::PngFile)
-        {
-            pImage = FreeImage_ConvertFromRawBits((BYTE*)pData, width, height, bytesPerPixel * width, bytesPerPixel * 8, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, isTopDown);
-            if(is_set(exportFlags, ExportFlags::ExportAlpha) == false)
+
+            if (bytesPerPixel == 4)
             {
-                auto pTemp = pImage;
-                pImage = FreeImage_ConvertTo24Bits(pImage);
-                FreeImage_Unload(pTemp);
+                pImage = convert8BitImage(width, height, isRgba, is_set(exportFlags, ExportFlags::ExportAlpha), isTopDown, (const uint8_t*)pData);
+            }
+            else
+            {
+                pImage = FreeImage_ConvertFromRawBits((BYTE*)pData, width, height, bytesPerPixel * width, bytesPerPixel * 8, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, isTopDown);
+                if(is_set(exportFlags, ExportFlags::ExportAlpha) == false)
+                {
+                    auto pTemp = pImage;
+                    pImage = FreeImage_ConvertTo24Bits(pImage);
+                    FreeImage_Unload(pTemp);
+                }
             }
             flags = PNG_Z_BEST_COMPRESSION;
 
@@ -232,27 +269,28 @@ namespace Falcor
             {
                 flags = PNG_Z_NO_COMPRESSION;
             }
-
-            if(is_set(exportFlags, ExportFlags::Lossy))
-            {
-                logError("Bitmap::saveImage: PNG does not support lossy compression mode.");
-                return;
-            }
         }
         else if (fileFormat == Bitmap::FileFormat::JpegFile)
         {
-            FIBITMAP* pTemp = FreeImage_ConvertFromRawBits((BYTE*)pData, width, height, bytesPerPixel * width, bytesPerPixel * 8, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, isTopDown);
-            pImage = FreeImage_ConvertTo24Bits(pTemp);
-            FreeImage_Unload(pTemp);
-            if(is_set(exportFlags, ExportFlags::Lossy) == false || is_set(exportFlags, ExportFlags::Uncompressed))
+            if(is_set(exportFlags, ExportFlags::ExportAlpha))
             {
-                flags = JPEG_QUALITYSUPERB | JPEG_SUBSAMPLING_444;
+                logError("Bitmap::saveImage: JPEG does not support alpha channel.");
+                return false;
             }
 
-            if(is_set(exportFlags, ExportFlags::ExportAlpha))
+            if (bytesPerPixel == 4)
             {
-                logError("Bitmap::saveImage: JPEG does not support alpha channel.");
-                return;
+                pImage = convert8BitImage(width, height, isRgba, false, isTopDown, (const uint8_t*)pData);
+            }
+            else
+            {
+                FIBITMAP* pTemp = FreeImage_ConvertFromRawBits((BYTE*)pData, width, height, bytesPerPixel * width, bytesPerPixel * 8, FI_RGBA_RED_MASK, FI_RGBA_GREEN_MASK, FI_RGBA_BLUE_MASK, isTopDown);
+                pImage = FreeImage_ConvertTo24Bits(pTemp);
+                FreeImage_Unload(pTemp);
+            }
+            if(is_set(exportFlags, ExportFlags::Lossy) == false || is_set(exportFlags, ExportFlags::Uncompressed))
+            {
+                flags = JPEG_QUALITYSUPERB | JPEG_SUBSAMPLING_444;
             }
         }
         else if (fileFormat == Bitmap::FileFormat::PfmFile || fileFormat == Bitmap::FileFormat::ExrFile)
@@ -260,7 +298,7 @@ namespace Falcor
             if(bytesPerPixel != 16 && bytesPerPixel != 12)
             {
                 logError("Bitmap::saveImage supports only 32-bit/channel RGB/RGBA images as PFM/EXR files.");
-                return;
+                return false;
             }
 
             const bool exportAlpha = is_set(exportFlags, ExportFlags::ExportAlpha);
@@ -270,45 +308,48 @@ namespace Falcor
                 if (is_set(exportFlags, ExportFlags::Lossy))
                 {
                     logError("Bitmap::saveImage: PFM does not support lossy compression mode.");
-                    return;
+                    return false;
                 }
                 if (exportAlpha)
                 {
                     logError("Bitmap::saveImage: PFM does not support alpha channel.");
-                    return;
+                    return false;
                 }
             }
 
             if (exportAlpha && bytesPerPixel != 16)
             {
                 logError("Bitmap::saveImage requesting to export alpha-channel to EXR file, but the resource doesn't have an alpha-channel");
-                return;
+                return false;
             }
 
             // Upload the image manually and flip it vertically
             bool scanlineCopy = exportAlpha ? bytesPerPixel == 16 : bytesPerPixel == 12;
 
             pImage = FreeImage_AllocateT(exportAlpha ? FIT_RGBAF : FIT_RGBF, width, height);
-            BYTE* head = (BYTE*)pData;
-            for(unsigned y = 0; y < height; y++) 
+            auto copyRows = [=](uint32_t begin, uint32_t end, uint32_t)
             {
-                float* dstBits = (float*)FreeImage_GetScanLine(pImage, height - y - 1);
-                if(scanlineCopy)
-                {
-                    std::memcpy(dstBits, head, bytesPerPixel * width);
-                }
-                else
+                for (uint32_t y = begin; y < end; y++)
                 {
-                    assert(exportAlpha == false);
-                    for(unsigned x = 0; x < width; x++) 
+                    const BYTE* head = (const BYTE*)pData + (size_t)bytesPerPixel * width * y;
+                    float* dstBits = (float*)FreeImage_GetScanLine(pImage, height - y - 1);
+                    if (scanlineCopy)
+                    {
+                        std::memcpy(dstBits, head, bytesPerPixel * width);
+                    }
+                    else
                     {
-                        dstBits[x*3 + 0] = (((float*)head)[x*4 + 0]);
-                        dstBits[x*3 + 1] = (((float*)head)[x*4 + 1]);
-                        dstBits[x*3 + 2] = (((float*)head)[x*4 + 2]);
+                        assert(exportAlpha == false);
+                        for (unsigned x = 0; x < width; x++)
+                        {
+                            dstBits[x*3 + 0] = (((const float*)head)[x*4 + 0]);
+                            dstBits[x*3 + 1] = (((const float*)head)[x*4 + 1]);
+                            dstBits[x*3 + 2] = (((const float*)head)[x*4 + 2]);
+                        }
                     }
                 }
-                head += bytesPerPixel * width;
-            }
+            };
+            Threading::parallelFor(height, 0, copyRows);
 
             if(fileFormat == Bitmap::FileFormat::ExrFile)
             {
@@ -324,7 +365,18 @@ namespace Falcor
             }
         }
 
-        FreeImage_Save(toFreeImageFormat(fileFormat), pImage, filename.c_str(), flags);
+        if (pImage == nullptr)
+        {
+            logError("Bitmap::saveImage failed to allocate the image for " + filename);
+            return false;
+        }
+
+        bool saved = FreeImage_Save(toFreeImageFormat(fileFormat), pImage, filename.c_str(), flags) != FALSE;
         FreeImage_Unload(pImage);
+        if (saved == false)
+        {
+            logError("Bitmap::saveImage failed to write " + filename);
+        }
+        return saved;
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,149 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "BoundsTree.h"
+#include <algorithm>
+#include <cfloat>
+
+namespace Falcor
+{
+    // Must be defined because it is passed by reference
+    const uint32_t BoundsTree::kInvalidSlot;
+
+    static const uint32_t kMinCapacity = 16;
+
+    uint32_t BoundsTree::insert(const BoundingBox& box)
+    {
+        uint32_t slot;
+        if (mFreeSlots.size())
+        {
+            slot = mFreeSlots.back();
+            mFreeSlots.pop_back();
+        }
+        else
+        {
+            if (mUsedSlots == mCapacity) grow();
+            slot = mUsedSlots++;
+        }
+
+        mCount++;
+        update(slot, box);
+        return slot;
+    }
+
+    void BoundsTree::update(uint32_t slot, const BoundingBox& box)
+    {
+        assert(slot < mUsedSlots);
+        Node& leaf = mNodes[mCapacity + slot];
+        leaf.min = box.getMinPos();
+        leaf.max = box.getMaxPos();
+        markDirty(slot);
+    }
+
+    void BoundsTree::remove(uint32_t slot)
+    {
+        assert(slot < mUsedSlots && mCount > 0);
+        Node& leaf = mNodes[mCapacity + slot];
+        leaf.min = glm::vec3(FLT_MAX);
+        leaf.max = glm::vec3(-FLT_MAX);
+        markDirty(slot);
+        mFreeSlots.push_back(slot);
+        mCount--;
+    }
+
+    void BoundsTree::clear()
+    {
+        mNodes.clear();
+        mNodeDirty.clear();
+        mDirtyLeaves.clear();
+        mFreeSlots.clear();
+        mCapacity = 0;
+        mUsedSlots = 0;
+        mCount = 0;
+    }
+
+    void BoundsTree::markDirty(uint32_t slot)
+    {
+        uint32_t node = mCapacity + slot;
+        if (mNodeDirty[node] == 0)
+        {
+            mNodeDirty[node] = 1;
+            mDirtyLeaves.push_back(node);
+        }
+    }
+
+    void BoundsTree::grow()
+    {
+        // Copy the leaves into a tree twice the size and rebuild the internal nodes. The cost is amortized over the inserts
+        uint32_t capacity = std::max(kMinCapacity, mCapacity * 2);
+        std::vector<Node> nodes(capacity * 2, Node{ glm::vec3(FLT_MAX), glm::vec3(-FLT_MAX) });
+        std::copy(mNodes.begin() + mCapacity, mNodes.end(), nodes.begin() + capacity);
+        for (uint32_t i = capacity - 1; i > 0; i--)
+        {
+            nodes[i].min = glm::min(nodes[2 * i].min, nodes[2 * i + 1].min);
+            nodes[i].max = glm::max(nodes[2 * i].max, nodes[2 * i + 1].max);
+        }
+
+        mNodes.swap(nodes);
+        mNodeDirty.assign(capacity * 2, 0);
+        mDirtyLeaves.clear();
+        mCapacity = capacity;
+    }
+
+    bool BoundsTree::getBounds(BoundingBox& box)
+    {
+        if (mDirtyLeaves.size())
+        {
+            // Collect the ancestors of the dirty leaves. Paths which merge are only walked once
+            std::vector<uint32_t> dirtyNodes;
+            for (uint32_t leaf : mDirtyLeaves)
+            {
+                mNodeDirty[leaf] = 0;
+                for (uint32_t node = leaf >> 1; node > 0 && mNodeDirty[node] == 0; node >>= 1)
+                {
+                    mNodeDirty[node] = 1;
+                    dirtyNodes.push_back(node);
+                }
+            }
+            mDirtyLeaves.clear();
+
+            // Children have higher indices than their parents, so processing in descending order merges bottom-up
+            std::sort(dirtyNodes.begin(), dirtyNodes.end(), std::greater<uint32_t>());
+            for (uint32_t node : dirtyNodes)
+            {
+                mNodes[node].min = glm::min(mNodes[2 * node].min, mNodes[2 * node + 1].min);
+                mNodes[node].max = glm::max(mNodes[2 * node].max, mNodes[2 * node + 1].max);
+                mNodeDirty[node] = 0;
+            }
+        }
+
+        if (mCount == 0) return false;
+        box = BoundingBox::fromMinMax(mNodes[1].min, mNodes[1].max);
+        return true;
+    }
+}
@@ -0,0 +1,88 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include "Utils/AABB.h"
+
+namespace Falcor
+{
+    /** Maintains the union of a set of bounding boxes which change over time.
+        The boxes are stored in the leaves of a complete binary tree, and each internal node holds the union of its children. Inserting, updating or removing a box
+        only marks its leaf as dirty. The affected paths to the root are merged lazily in getBounds(), so the cost of a query is proportional to the number of boxes which changed since the previous one.
+    */
+    class BoundsTree
+    {
+    public:
+        static const uint32_t kInvalidSlot = uint32_t(-1);
+
+        /** Add a box
+            \return The slot of the box. Use it to update or remove the box
+        */
+        uint32_t insert(const BoundingBox& box);
+
+        /** Replace the box in a slot
+        */
+        void update(uint32_t slot, const BoundingBox& box);
+
+        /** Remove the box in a slot. The slot may be reused by a later insert()
+        */
+        void remove(uint32_t slot);
+
+        /** Remove all the boxes
+        */
+        void clear();
+
+        /** Get the number of boxes
+        */
+        uint32_t getCount() const { return mCount; }
+
+        /** Get the union of all the boxes
+            \param[out] box The union. Only valid if the function returned true
+            \return false if there are no boxes
+        */
+        bool getBounds(BoundingBox& box);
+
+    private:
+        struct Node
+        {
+            glm::vec3 min;
+            glm::vec3 max;
+        };
+
+        void grow();
+        void markDirty(uint32_t slot);
+
+        std::vector<Node> mNodes;               // Internal nodes in [1, mCapacity), leaves in [mCapacity, 2 * mCapacity). Node 0 is unused
+        std::vector<uint8_t> mNodeDirty;
+        std::vector<uint32_t> mDirtyLeaves;
+        std::vector<uint32_t> mFreeSlots;
+        uint32_t mCapacity = 0;
+        uint32_t mUsedSlots = 0;                // All slots at or above this were never allocated
+        uint32_t mCount = 0;
+    };
+}
@@ -29,15 +29,20 @@
 #include <chrono>
 #include <vector>
 #include "CpuTimer.h"
+#include "TimingHistogram.h"
 
 namespace Falcor
 {
     /** Framerate calculator
+        Besides the average, frame times are accumulated into a histogram which reports percentiles and hitches over a window of recent frames.
     */
     class FrameRate
     {
     public:
-        FrameRate()
+        static const uint32_t kDefaultHistogramWindow = 1000;     ///< Number of frames covered by the histogram by default
+        static constexpr float kDefaultHitchThreshold = 1000.0f / 30.0f;    ///< Frames longer than this (in ms) are counted as hitches by default
+
+        FrameRate() : mHistogram(kDefaultHistogramWindow, kDefaultHitchThreshold)
         {
             mFrameTimes.resize(sFrameWindow);
             resetClock();
@@ -50,6 +55,7 @@ namespace Falcor
         {
             newFrame();
             mFrameCount = 0;
+            mHistogram.reset();
         }
 
         /** Tick the timer.
@@ -60,6 +66,7 @@ namespace Falcor
             mFrameCount++;
             mTimer.update();
             mFrameTimes[mFrameCount % sFrameWindow] = mTimer.getElapsedTime();
+            mHistogram.record(mTimer.getElapsedTime() * 1000);
         }
 
         /** Get the time in ms it took to render a frame
@@ -90,11 +97,40 @@ namespace Falcor
         {
             return mFrameCount;
         }
+
+        /** Get the frame-time statistics (in ms) over the histogram window
+        */
+        TimingHistogram::Stats getStats() const
+        {
+            return mHistogram.getStats();
+        }
+
+        /** Get the frame-time histogram
+        */
+        const TimingHistogram& getHistogram() const
+        {
+            return mHistogram;
+        }
+
+        /** Set the number of recent frames covered by the histogram. If 0, the histogram covers all the frames since the last resetClock() call. Resets the histogram.
+        */
+        void setHistogramWindow(uint32_t frames)
+        {
+            mHistogram.setWindowSize(frames);
+        }
+
+        /** Set the frame time (in ms) above which a frame is counted as a hitch. Resets the histogram.
+        */
+        void setHitchThreshold(float ms)
+        {
+            mHistogram.setHitchThreshold(ms);
+        }
     private:
 
         CpuTimer mTimer;
         std::vector<float> mFrameTimes;
         uint32_t mFrameCount;
+        TimingHistogram mHistogram;
         static const uint32_t sFrameWindow = 60;
     };
 }
\ No newline at end of file
@@ -0,0 +1,141 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "ImageExporter.h"
+#include "API/Texture.h"
+#include "Utils/Threading.h"
+#include <algorithm>
+#include <chrono>
+
+namespace Falcor
+{
+    static bool isReady(const std::shared_future<bool>& result)
+    {
+        return result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }
+
+    ImageExporter::UniquePtr ImageExporter::create(uint32_t maxPendingReadbacks)
+    {
+        return UniquePtr(new ImageExporter(std::max(maxPendingReadbacks, 1u)));
+    }
+
+    ImageExporter::~ImageExporter()
+    {
+        flush();
+    }
+
+    std::shared_future<bool> ImageExporter::exportTexture(CopyContext* pCtx, const Texture* pTexture, const std::string& filename, Bitmap::FileFormat fileFormat, Bitmap::ExportFlags exportFlags, uint32_t mipLevel, uint32_t arraySlice)
+    {
+        // Make room for the new readback. This only blocks if the GPU is far behind.
+        update();
+        while (mReadbacks.size() >= mMaxPendingReadbacks)
+        {
+            dispatch(mReadbacks.front());
+            mReadbacks.pop_front();
+        }
+
+        std::shared_ptr<Buffer> pStaging;
+        if (mFreeStagingBuffers.size())
+        {
+            pStaging = mFreeStagingBuffers.back();
+            mFreeStagingBuffers.pop_back();
+        }
+
+        Request request;
+        request.pReadback = CopyContext::ReadTextureTask::create(pCtx, pTexture, pTexture->getSubresourceIndex(arraySlice, mipLevel), pStaging);
+        request.filename = filename;
+        request.fileFormat = fileFormat;
+        request.exportFlags = exportFlags;
+        request.resourceFormat = pTexture->getFormat();
+        request.width = pTexture->getWidth(mipLevel);
+        request.height = pTexture->getHeight(mipLevel);
+        std::shared_future<bool> result = request.promise.get_future().share();
+        mEncoding.push_back({ filename, result });
+        mReadbacks.push_back(std::move(request));
+        return result;
+    }
+
+    void ImageExporter::dispatch(Request& request)
+    {
+        // Copying the data out lets the readback buffer be recycled immediately, and gives the worker a buffer it can own
+        auto pData = std::make_shared<std::vector<uint8>>(request.pReadback->getData());
+        mFreeStagingBuffers.push_back(request.pReadback->getBuffer());
+        request.pReadback = nullptr;
+
+        auto pPromise = std::make_shared<std::promise<bool>>(std::move(request.promise));
+        std::string filename = request.filename;
+        Bitmap::FileFormat fileFormat = request.fileFormat;
+        Bitmap::ExportFlags exportFlags = request.exportFlags;
+        ResourceFormat resourceFormat = request.resourceFormat;
+        uint32_t width = request.width;
+        uint32_t height = request.height;
+
+        Threading::dispatchTask([=]()
+        {
+            bool saved = Bitmap::saveImage(filename, width, height, fileFormat, exportFlags, resourceFormat, true, pData->data());
+            pPromise->set_value(saved);
+        });
+    }
+
+    void ImageExporter::update()
+    {
+        while (mReadbacks.size() && mReadbacks.front().pReadback->isComplete())
+        {
+            dispatch(mReadbacks.front());
+            mReadbacks.pop_front();
+        }
+
+        mEncoding.erase(std::remove_if(mEncoding.begin(), mEncoding.end(), [](const Encoding& e) { return isReady(e.result); }), mEncoding.end());
+    }
+
+    void ImageExporter::flush()
+    {
+        while (mReadbacks.size())
+        {
+            dispatch(mReadbacks.front());
+            mReadbacks.pop_front();
+        }
+
+        for (auto& e : mEncoding) e.result.wait();
+        mEncoding.clear();
+    }
+
+    uint32_t ImageExporter::getPendingCount() const
+    {
+        return (uint32_t)std::count_if(mEncoding.begin(), mEncoding.end(), [](const Encoding& e) { return isReady(e.result) == false; });
+    }
+
+    bool ImageExporter::isExportPending(const std::string& filename) const
+    {
+        for (const auto& e : mEncoding)
+        {
+            if (e.filename == filename && isReady(e.result) == false) return true;
+        }
+        return false;
+    }
+}
@@ -0,0 +1,114 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <deque>
+#include <future>
+#include <string>
+#include <vector>
+#include "API/CopyContext.h"
+#include "Utils/Bitmap.h"
+
+namespace Falcor
+{
+    class Texture;
+
+    /** Saves textures to image files without stalling the render thread.
+        exportTexture() only records the readback. update() hands the readbacks which the GPU completed to the thread pool, where the format conversion and the file encoding happen.
+        Completion of each export is reported through a future.
+    */
+    class ImageExporter
+    {
+    public:
+        using UniquePtr = std::unique_ptr<ImageExporter>;
+
+        /** Create a new object
+            \param[in] maxPendingReadbacks Maximum number of readbacks in flight. When exceeded, exportTexture() waits for the oldest one
+        */
+        static UniquePtr create(uint32_t maxPendingReadbacks = 4);
+
+        /** Waits for all the pending exports
+        */
+        ~ImageExporter();
+
+        /** Queue a texture for export
+            \param[in] pCtx The context to record the readback into
+            \param[in] pTexture The texture to export
+            \param[in] filename Output filename
+            \param[in] fileFormat Destination image file format
+            \param[in] exportFlags Save flags, see Bitmap::ExportFlags
+            \param[in] mipLevel Requested mip-level
+            \param[in] arraySlice Requested array-slice
+            \return A future which becomes ready once the file was written. Its value is false if the export failed
+        */
+        std::shared_future<bool> exportTexture(CopyContext* pCtx, const Texture* pTexture, const std::string& filename, Bitmap::FileFormat fileFormat = Bitmap::FileFormat::PngFile, Bitmap::ExportFlags exportFlags = Bitmap::ExportFlags::None, uint32_t mipLevel = 0, uint32_t arraySlice = 0);
+
+        /** Dispatch the readbacks which the GPU completed to the worker threads. Call once per frame from the render thread
+        */
+        void update();
+
+        /** Block until all the exports queued so far were written
+        */
+        void flush();
+
+        /** Get the number of exports which were queued but not written yet
+        */
+        uint32_t getPendingCount() const;
+
+        /** Check if an export to a file was queued but not written yet
+        */
+        bool isExportPending(const std::string& filename) const;
+
+    private:
+        ImageExporter(uint32_t maxPendingReadbacks) : mMaxPendingReadbacks(maxPendingReadbacks) {}
+
+        struct Request
+        {
+            CopyContext::ReadTextureTask::SharedPtr pReadback;
+            std::string filename;
+            Bitmap::FileFormat fileFormat;
+            Bitmap::ExportFlags exportFlags;
+            ResourceFormat resourceFormat;
+            uint32_t width;
+            uint32_t height;
+            std::promise<bool> promise;
+        };
+
+        struct Encoding
+        {
+            std::string filename;
+            std::shared_future<bool> result;
+        };
+
+        void dispatch(Request& request);
+
+        uint32_t mMaxPendingReadbacks;
+        std::deque<Request> mReadbacks;
+        std::vector<Encoding> mEncoding;
+        std::vector<std::shared_ptr<Buffer>> mFreeStagingBuffers;
+    };
+}
@@ -28,7 +28,14 @@
 #include "Framework.h"
 #include "Logger.h"
 #include "Utils/Platform/OS.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
 #include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
 
 namespace Falcor
 {
@@ -38,10 +45,139 @@ namespace Falcor
     bool Logger::sShowErrorBox = false;
 #endif
 
-    bool Logger::sInit = false;
-    FILE* Logger::sLogFile = nullptr;
+    std::atomic<bool> Logger::sInit{false};
     Logger::Level Logger::sVerbosity = Logger::Level::Warning;
 
+    const char* getLogLevelString(Logger::Level L);
+
+    namespace
+    {
+        struct LogRecord
+        {
+            LogRecord(Logger::Level level, const std::string& msg) : level(level), msg(msg) {}
+            Logger::Level level;
+            std::string msg;
+            LogRecord* pNext = nullptr;
+        };
+
+        struct LoggerData
+        {
+            FILE* pFile = nullptr;
+            std::atomic<LogRecord*> pHead{ nullptr };   // The most recent record. Producers push with a CAS, consumers take the entire list at once
+            std::mutex drainMutex;                      // Serializes the consumers - the writer thread and the threads which flush
+            std::atomic_flag draining = ATOMIC_FLAG_INIT;   // Set while the records are written. Unlike the mutex, the crash handler can test it from any thread
+            std::thread writer;
+            std::mutex wakeMutex;
+            std::condition_variable wake;
+            bool stop = false;
+            std::atomic<uint64_t> messageCount{ 0 };
+            std::atomic<uint64_t> callTime{ 0 };        // In nanoseconds
+        };
+
+        LoggerData gLoggerData;
+
+        // How long messages can stay in the queue before the writer thread writes them
+        const std::chrono::milliseconds kWriteInterval(20);
+
+        void pushRecord(LogRecord* pRecord)
+        {
+            LogRecord* pHead = gLoggerData.pHead.load(std::memory_order_relaxed);
+            do
+            {
+                pRecord->pNext = pHead;
+            } while (gLoggerData.pHead.compare_exchange_weak(pHead, pRecord, std::memory_order_release, std::memory_order_relaxed) == false);
+        }
+
+        // Must be called with drainMutex held, except from the crash handler. Returns false if there was nothing to write, or if another drain is in progress
+        bool drainRecords()
+        {
+            if (gLoggerData.pFile == nullptr) return false;
+            // Only the crash handler can get here while the flag is set. The crash interrupted a drain, possibly on this thread
+            if (gLoggerData.draining.test_and_set(std::memory_order_acquire)) return false;
+
+            LogRecord* pRecord = gLoggerData.pHead.exchange(nullptr, std::memory_order_acquire);
+            if (pRecord == nullptr)
+            {
+                gLoggerData.draining.clear(std::memory_order_release);
+                return false;
+            }
+
+            // The list is ordered newest-first. Reverse it so that the messages are written in the order they were logged
+            LogRecord* pOrdered = nullptr;
+            while (pRecord)
+            {
+                LogRecord* pNext = pRecord->pNext;
+                pRecord->pNext = pOrdered;
+                pOrdered = pRecord;
+                pRecord = pNext;
+            }
+
+            std::string batch;
+            while (pOrdered)
+            {
+                batch += getLogLevelString(pOrdered->level);
+                batch += '\t';
+                batch += pOrdered->msg;
+                batch += '\n';
+                LogRecord* pNext = pOrdered->pNext;
+                delete pOrdered;
+                pOrdered = pNext;
+            }
+
+            std::fwrite(batch.data(), 1, batch.size(), gLoggerData.pFile);
+            if (isDebuggerPresent())
+            {
+                printToDebugWindow(batch);
+            }
+            gLoggerData.draining.clear(std::memory_order_release);
+            return true;
+        }
+
+        void writerLoop()
+        {
+            while (true)
+            {
+                bool stop;
+                {
+                    std::unique_lock<std::mutex> lock(gLoggerData.wakeMutex);
+                    stop = gLoggerData.wake.wait_for(lock, kWriteInterval, [] { return gLoggerData.stop; });
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(gLoggerData.drainMutex);
+                    // Flushing once per batch is what makes the data survive a crash, and it happens off the logging threads
+                    if (drainRecords()) std::fflush(gLoggerData.pFile);
+                }
+                if (stop) return;
+            }
+        }
+
+        // The handlers which were installed before the logger's, restored and re-raised by crashHandler()
+        struct PrevHandler
+        {
+            int sig;
+            void (*handler)(int);
+        };
+        PrevHandler gPrevHandlers[] = { { SIGABRT, SIG_DFL }, { SIGSEGV, SIG_DFL }, { SIGFPE, SIG_DFL }, { SIGILL, SIG_DFL } };
+
+        void crashHandler(int sig)
+        {
+            // Best effort only. Draining the queue allocates and writes through stdio, neither of which is async-signal-safe.
+            // The mutex isn't used, since the crash might have happened on the thread which holds it. If the crash interrupted a drain, the queued messages are lost.
+            // A crash inside the allocator or stdio can still deadlock or fault here.
+            if (drainRecords()) std::fflush(gLoggerData.pFile);
+
+            // Chain to the previous handler
+            void (*prevHandler)(int) = SIG_DFL;
+            for (const auto& prev : gPrevHandlers)
+            {
+                if (prev.sig == sig) prevHandler = prev.handler;
+            }
+            std::signal(sig, prevHandler);
+            std::raise(sig);
+        }
+    }
+
     static FILE* openLogFile()
     {
         FILE* pFile = nullptr;
@@ -72,9 +208,28 @@ namespace Falcor
 #if _LOG_ENABLED
         if(sInit == false)
         {
-            sLogFile = openLogFile();
-            sInit = sLogFile != nullptr;
+            gLoggerData.pFile = openLogFile();
+            sInit = gLoggerData.pFile != nullptr;
             assert(sInit);
+            if (sInit == false) return;
+
+            gLoggerData.stop = false;
+            gLoggerData.messageCount = 0;
+            gLoggerData.callTime = 0;
+            gLoggerData.writer = std::thread(writerLoop);
+
+            // logErrorAndExit() and crashes skip shutdown(). The writer thread must be joined before the static data is destroyed.
+            static bool sHandlersInstalled = false;
+            if (sHandlersInstalled == false)
+            {
+                std::atexit(Logger::shutdown);
+                for (auto& prev : gPrevHandlers)
+                {
+                    void (*handler)(int) = std::signal(prev.sig, crashHandler);
+                    if (handler != SIG_ERR) prev.handler = handler;
+                }
+                sHandlersInstalled = true;
+            }
         }
 #endif
     }
@@ -82,15 +237,53 @@ namespace Falcor
     void Logger::shutdown()
     {
 #if _LOG_ENABLED
-        if(sLogFile)
+        if(gLoggerData.pFile)
         {
-            fclose(sLogFile);
-            sLogFile = nullptr;
+            // Stop accepting new messages before the writer stops. The final drain below writes the ones which were pushed meanwhile
             sInit = false;
+            {
+                std::lock_guard<std::mutex> lock(gLoggerData.wakeMutex);
+                gLoggerData.stop = true;
+            }
+            gLoggerData.wake.notify_all();
+            if (gLoggerData.writer.joinable()) gLoggerData.writer.join();
+
+            // Messages which were pushed after the writer's last batch
+            std::lock_guard<std::mutex> lock(gLoggerData.drainMutex);
+            drainRecords();
+            fclose(gLoggerData.pFile);
+            gLoggerData.pFile = nullptr;
         }
 #endif
     }
 
+    void Logger::flush()
+    {
+#if _LOG_ENABLED
+        if (sInit)
+        {
+            std::lock_guard<std::mutex> lock(gLoggerData.drainMutex);
+            // shutdown() might have closed the file since sInit was checked
+            if (gLoggerData.pFile)
+            {
+                drainRecords();
+                std::fflush(gLoggerData.pFile);
+            }
+        }
+#endif
+    }
+
+    Logger::Stats Logger::getStats()
+    {
+        Stats stats;
+        stats.messageCount = gLoggerData.messageCount;
+        if (stats.messageCount)
+        {
+            stats.averageCallTime = double(gLoggerData.callTime) / double(stats.messageCount) * 1e-3;
+        }
+        return stats;
+    }
+
     const char* getLogLevelString(Logger::Level L)
     {
         const char* c = nullptr;
@@ -114,13 +307,16 @@ namespace Falcor
         {
             if(L >= sVerbosity)
             {
-                std::string s = getLogLevelString(L) + std::string("\t") + msg + "\n";
-                std::fprintf(sLogFile, "%s", s.c_str());
-                fflush(sLogFile);   // Slows down execution, but ensures that the message will be printed in case of a crash
-                if (isDebuggerPresent())
+                auto start = std::chrono::high_resolution_clock::now();
+                pushRecord(new LogRecord(L, msg));
+                if (L >= Level::Error)
                 {
-                    printToDebugWindow(s);
+                    // Errors are rare and often precede a crash, so they are written synchronously
+                    flush();
                 }
+                auto end = std::chrono::high_resolution_clock::now();
+                gLoggerData.callTime += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+                gLoggerData.messageCount++;
             }
         }
 #endif
@@ -140,4 +336,4 @@ namespace Falcor
             msgBox(msg);
         }
     }
-}
\ No newline at end of file
+}
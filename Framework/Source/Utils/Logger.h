@@ -27,6 +27,7 @@
 ***************************************************************************/
 #pragma once
 #include <string>
+#include <atomic>
 #include "FalcorConfig.h"
 
 namespace Falcor
@@ -34,6 +35,8 @@ namespace Falcor
     /** Container class for logging messages. 
     *   To enable log messages, make sure _LOG_ENABLED is set to true in FalcorConfig.h.
     *   Messages are printed to a log file in the application directory. Using Logger#ShowBoxOnError() you can control if a message box will be shown as well.
+    *   Logging is thread-safe. Messages are pushed into a lock-free queue and written in batches by a background thread. Error messages and exit flush the queue.
+    *   Crashes (SIGABRT, SIGSEGV, SIGFPE, SIGILL) flush it on a best-effort basis before chaining to the previously installed signal handlers.
     */
     class Logger
     {
@@ -57,6 +60,20 @@ namespace Falcor
         */
         static void shutdown();
 
+        /** Write all the queued messages to the log file. Blocks until the data was handed to the OS, so it survives an application crash. It might not have reached the disk yet.
+        */
+        static void flush();
+
+        struct Stats
+        {
+            uint64_t messageCount = 0;      ///< Number of messages which passed the verbosity filter
+            double averageCallTime = 0;     ///< Average time in microseconds spent in the logging call. Includes the synchronous flush of error messages
+        };
+
+        /** Get the logging statistics since init() was called
+        */
+        static Stats getStats();
+
         /** Controls weather or not to show message box on log messages.
             \param[in] showBox true to show a message box, false to disable it.
         */
@@ -85,8 +102,7 @@ namespace Falcor
 
         Logger() = delete;
         static bool sShowErrorBox;
-        static FILE* sLogFile;
-        static bool sInit;
+        static std::atomic<bool> sInit;     // Read by the logging threads without a lock
         static Level sVerbosity;
     };
 
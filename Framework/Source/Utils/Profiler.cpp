@@ -28,28 +28,339 @@
 #include "Framework.h"
 #include "Profiler.h"
 #include "API/GpuTimer.h"
+#include "API/Device.h"
 #include "API/LowLevel/FencedPool.h"
+#include "Utils/AsyncFileWriter.h"
+#include "Utils/Threading.h"
 
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <cstdarg>
 #include <cstdio>
+#include <mutex>
 
 namespace Falcor
 {
     bool gProfileEnabled = false;
     EventCounter gEventCounter;
     std::map<size_t, Profiler::EventData*> Profiler::sProfilerEvents;
-    uint32_t Profiler::sCurrentLevel = 0;
     uint32_t Profiler::sGpuTimerIndex = 0;
     std::vector<Profiler::EventData*> Profiler::sProfilerVector;
     
     std::hash<std::string> HashedString::hashFunc;
 
+    namespace
+    {
+        std::recursive_mutex gEventsMutex;      // Protects the event registration and the buffer list. Not used when recording events
+        thread_local uint32_t tCurrentLevel = 0;
+        thread_local bool tIsFrameThread = false;
+        uint32_t gHistogramWindow = 1000;       // Protected by gEventsMutex
+
+        void appendEscapedJson(std::string& out, const std::string& str)
+        {
+            for (char c : str)
+            {
+                if (c == '"' || c == '\\') out += '\\';
+                if ((unsigned char)c < 0x20) continue;
+                out += c;
+            }
+        }
+
+        std::string escapeJson(const std::string& str)
+        {
+            std::string escaped;
+            appendEscapedJson(escaped, str);
+            return escaped;
+        }
+
+        /** Formats the events of a timeline capture. Events are accumulated per frame and handed to the file writer by endFrame().
+        */
+        struct TraceCapture
+        {
+            static const uint32_t kCpuProcessId = 1;
+            static const uint32_t kGpuProcessId = 2;
+
+            AsyncFileWriter::SharedPtr pWriter;
+            uint32_t framesLeft = 0;            // 0 means the capture runs until endCapture()
+            uint64_t frameId = 0;
+            uint32_t frameThreadId = 0;
+            CpuTimer::TimePoint::rep cpuBase;
+            double gpuBase = 0;                 // GPU timestamps are in a different clock domain. The GPU track is rebased so that its first range starts at the beginning of the capture
+            bool hasGpuBase = false;
+            bool firstEvent = true;
+            std::string chunk;
+
+            /** Start a new event. The name is written directly into the chunk, so it's never truncated
+            */
+            void beginEvent(const std::string& name)
+            {
+                if (firstEvent == false) chunk += ",\n";
+                firstEvent = false;
+                chunk += "{\"name\":\"";
+                appendEscapedJson(chunk, name);
+                chunk += '"';
+            }
+
+            /** Append the rest of the event. Only used for numbers and constant strings, so the length is bounded
+            */
+            void appendFields(const char* format, ...)
+            {
+                char fields[512];
+                va_list args;
+                va_start(args, format);
+                vsnprintf(fields, arraysize(fields), format, args);
+                va_end(args);
+                chunk += fields;
+            }
+
+            void addCpuEvent(const std::string& name, uint32_t threadId, CpuTimer::TimePoint::rep begin, CpuTimer::TimePoint::rep end)
+            {
+                // Scopes which were already open when the capture started are clipped to the beginning of the capture
+                begin = std::max(begin, cpuBase);
+                end = std::max(end, begin);
+                double ts = std::chrono::duration<double, std::micro>(CpuTimer::TimePoint::duration(begin - cpuBase)).count();
+                double dur = std::chrono::duration<double, std::micro>(CpuTimer::TimePoint::duration(end - begin)).count();
+                beginEvent(name);
+                appendFields(",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu}}",
+                    kCpuProcessId, threadId, ts, dur, (unsigned long long)frameId);
+            }
+
+            void addGpuEvent(const std::string& name, double startMs, double durationMs)
+            {
+                if (hasGpuBase == false)
+                {
+                    gpuBase = startMs;
+                    hasGpuBase = true;
+                }
+
+                // The ranges aren't reported in time order. Ranges which started before the first one are clipped to the beginning of the capture
+                if (startMs < gpuBase)
+                {
+                    durationMs = std::max(0.0, durationMs - (gpuBase - startMs));
+                    startMs = gpuBase;
+                }
+
+                // GPU results are read back one frame late
+                beginEvent(name);
+                appendFields(",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":%u,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"frame\":%llu}}",
+                    kGpuProcessId, (startMs - gpuBase) * 1000.0, durationMs * 1000.0, (unsigned long long)(frameId ? frameId - 1 : 0));
+            }
+
+            void addFrameMarker()
+            {
+                double ts = std::chrono::duration<double, std::micro>(CpuTimer::TimePoint::duration(CpuTimer::getCurrentTimePoint().time_since_epoch().count() - cpuBase)).count();
+                beginEvent("End of frame " + std::to_string(frameId));
+                appendFields(",\"ph\":\"i\",\"s\":\"g\",\"pid\":%u,\"tid\":%u,\"ts\":%.3f}", kCpuProcessId, frameThreadId, ts);
+            }
+
+            void addName(const char* type, uint32_t processId, uint32_t threadId, const std::string& name)
+            {
+                beginEvent(type);
+                appendFields(",\"ph\":\"M\",\"pid\":%u,\"tid\":%u,\"args\":{\"name\":\"", processId, threadId);
+                appendEscapedJson(chunk, name);
+                chunk += "\"}}";
+            }
+
+            void submitFrame()
+            {
+                pWriter->write(std::move(chunk));
+                chunk.clear();
+            }
+        };
+
+        std::unique_ptr<TraceCapture> gpCapture;    // Protected by gEventsMutex
+
+        /** A single-producer/single-consumer ring buffer of begin/end records.
+            The owning thread is the only producer. endFrame() is the only consumer.
+        */
+        struct ThreadBuffer
+        {
+            static const uint64_t kCapacity = 16 * 1024;   // Must be a power of 2
+
+            struct Record
+            {
+                Profiler::EventData* pEvent;
+                CpuTimer::TimePoint::rep time;
+                bool isBegin;
+            };
+
+            Record records[kCapacity];
+            std::atomic<uint64_t> writeIndex{0};
+            std::atomic<uint64_t> readIndex{0};
+            std::atomic<uint64_t> droppedCount{0};
+
+            // Producer-side. Number of recorded scopes which haven't ended yet. Space is reserved for their end records, so a scope which began is always closed
+            uint64_t openScopes = 0;
+            // Producer-side. Number of open scopes which were dropped. Once a scope is dropped, the scopes nested in it are dropped too, so that every end record matches a begin record
+            uint32_t droppedDepth = 0;
+            // Set by the owning thread when it exits. endFrame() releases the buffer once it's drained
+            std::atomic<bool> threadExited{false};
+
+            // Consumer-side. The begin records which haven't been matched with an end record yet
+            std::vector<Record> pendingBegins;
+            uint32_t threadId;
+            std::string threadName;
+
+            bool push(Profiler::EventData* pEvent, bool isBegin)
+            {
+                if (droppedDepth)
+                {
+                    if (isBegin)
+                    {
+                        droppedDepth++;
+                        droppedCount.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    else
+                    {
+                        droppedDepth--;
+                    }
+                    return false;
+                }
+
+                uint64_t write = writeIndex.load(std::memory_order_relaxed);
+                if (isBegin)
+                {
+                    uint64_t used = write - readIndex.load(std::memory_order_acquire);
+                    if (used + openScopes + 2 > kCapacity)
+                    {
+                        droppedDepth = 1;
+                        droppedCount.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    }
+                    openScopes++;
+                }
+                else
+                {
+                    assert(openScopes > 0);
+                    openScopes--;
+                }
+
+                Record& r = records[write & (kCapacity - 1)];
+                r.pEvent = pEvent;
+                r.time = CpuTimer::getCurrentTimePoint().time_since_epoch().count();
+                r.isBegin = isBegin;
+                writeIndex.store(write + 1, std::memory_order_release);
+                return true;
+            }
+
+            void drain(TraceCapture* pCapture)
+            {
+                uint64_t read = readIndex.load(std::memory_order_relaxed);
+                uint64_t write = writeIndex.load(std::memory_order_acquire);
+                for (; read < write; read++)
+                {
+                    const Record& r = records[read & (kCapacity - 1)];
+                    if (r.isBegin)
+                    {
+                        pendingBegins.push_back(r);
+                    }
+                    else if (pendingBegins.size())
+                    {
+                        const Record& begin = pendingBegins.back();
+                        assert(begin.pEvent == r.pEvent);
+                        CpuTimer::TimePoint::duration delta(r.time - begin.time);
+                        r.pEvent->cpuTotal += (float)std::chrono::duration_cast<std::chrono::nanoseconds>(delta).count() * 1.0e-6f;
+                        r.pEvent->callCount++;
+                        if (pCapture) pCapture->addCpuEvent(r.pEvent->name, threadId, begin.time, r.time);
+                        pendingBegins.pop_back();
+                    }
+                }
+                readIndex.store(write, std::memory_order_release);
+            }
+        };
+
+        std::vector<std::unique_ptr<ThreadBuffer>> gThreadBuffers;    // Protected by gEventsMutex
+        uint32_t gNextThreadId = 0;                                   // Protected by gEventsMutex
+        uint64_t gReleasedDroppedCount = 0;                           // Records dropped by the buffers which were already released. Protected by gEventsMutex
+        thread_local ThreadBuffer* tpThreadBuffer = nullptr;
+
+        /** Marks the thread's buffer when the thread exits. The buffer is released by endFrame(), after its records were drained
+        */
+        struct ThreadExitNotifier
+        {
+            ThreadBuffer* pBuffer = nullptr;
+            ~ThreadExitNotifier()
+            {
+                tpThreadBuffer = nullptr;
+                if (pBuffer) pBuffer->threadExited.store(true, std::memory_order_release);
+            }
+        };
+
+        ThreadBuffer* getThreadBuffer()
+        {
+            if (tpThreadBuffer == nullptr)
+            {
+                std::lock_guard<std::recursive_mutex> lock(gEventsMutex);
+                gThreadBuffers.push_back(std::make_unique<ThreadBuffer>());
+                tpThreadBuffer = gThreadBuffers.back().get();
+                tpThreadBuffer->threadId = gNextThreadId++;
+                uint32_t workerIndex = Threading::getCurrentThreadIndex();
+                tpThreadBuffer->threadName = (workerIndex == Threading::kInvalidThreadIndex) ? "Thread " + std::to_string(tpThreadBuffer->threadId) : "Worker " + std::to_string(workerIndex);
+
+                thread_local ThreadExitNotifier tExitNotifier;
+                tExitNotifier.pBuffer = tpThreadBuffer;
+            }
+            return tpThreadBuffer;
+        }
+
+        std::string getThreadDisplayName(const ThreadBuffer* pBuffer, const TraceCapture* pCapture)
+        {
+            return (pBuffer->threadId == pCapture->frameThreadId) ? "Frame thread" : pBuffer->threadName;
+        }
+
+        /** Drain the records of all the threads. Releases the buffers of the threads which exited
+        */
+        void drainThreadBuffers(TraceCapture* pCapture)
+        {
+            for (size_t i = 0; i < gThreadBuffers.size();)
+            {
+                ThreadBuffer* pBuffer = gThreadBuffers[i].get();
+                // Check the flag before draining. The thread's last records are visible once the flag is
+                bool exited = pBuffer->threadExited.load(std::memory_order_acquire);
+                pBuffer->drain(pCapture);
+                if (exited)
+                {
+                    // The capture names the threads when it ends, name this one while it's still known
+                    if (pCapture) pCapture->addName("thread_name", TraceCapture::kCpuProcessId, pBuffer->threadId, getThreadDisplayName(pBuffer, pCapture));
+                    gReleasedDroppedCount += pBuffer->droppedCount.load(std::memory_order_relaxed);
+                    gThreadBuffers.erase(gThreadBuffers.begin() + i);
+                }
+                else
+                {
+                    i++;
+                }
+            }
+        }
+
+        void finishCapture()
+        {
+            TraceCapture* pCapture = gpCapture.get();
+            pCapture->addName("process_name", TraceCapture::kCpuProcessId, 0, "CPU");
+            pCapture->addName("process_name", TraceCapture::kGpuProcessId, 0, "GPU");
+            pCapture->addName("thread_name", TraceCapture::kGpuProcessId, 0, "Render queue");
+            for (auto& pBuffer : gThreadBuffers)
+            {
+                pCapture->addName("thread_name", TraceCapture::kCpuProcessId, pBuffer->threadId, getThreadDisplayName(pBuffer.get(), pCapture));
+            }
+            pCapture->chunk += "\n],\"displayTimeUnit\":\"ms\"}\n";
+            pCapture->submitFrame();
+            logInfo("Profiler capture written to '" + pCapture->pWriter->getFilename() + "'");
+
+            // Destroying the writer waits for the pending data, so release it on a worker thread
+            AsyncFileWriter::SharedPtr pWriter = pCapture->pWriter;
+            gpCapture = nullptr;
+            Threading::dispatchTask([pWriter]() mutable { pWriter = nullptr; });
+        }
+    }
+
 	void Profiler::initNewEvent(EventData *pEvent, const HashedString& name)
     {
 	    pEvent->name = name.str;
-        pEvent->level = sCurrentLevel;
+        pEvent->level = tCurrentLevel;
+        std::lock_guard<std::recursive_mutex> lock(gEventsMutex);
+        pEvent->cpuHistogram.setWindowSize(gHistogramWindow);
+        pEvent->gpuHistogram.setWindowSize(gHistogramWindow);
 		sProfilerEvents[name.hash] = pEvent;
         sProfilerVector.push_back(pEvent);
 	}
@@ -63,6 +374,7 @@ namespace Falcor
 
     Profiler::EventData* Profiler::isEventRegistered(const HashedString& name)
 	{
+        std::lock_guard<std::recursive_mutex> lock(gEventsMutex);
         auto event = sProfilerEvents.find(name.hash);
         if(event == sProfilerEvents.end())
 		{
@@ -76,6 +388,8 @@ namespace Falcor
 
     Profiler::EventData* Profiler::getEvent(const HashedString& name)
     {
+        // Hold the lock across the lookup and the creation, so that threads registering the same name concurrently get the same event
+        std::lock_guard<std::recursive_mutex> lock(gEventsMutex);
         auto event = isEventRegistered(name);
         if(event)
 		{
@@ -87,50 +401,84 @@ namespace Falcor
         }
     }
 
-    void Profiler::startEvent(const HashedString& name, EventData* pData)
+    void Profiler::startEvent(EventData* pData)
     {
-        pData->cpuStart = CpuTimer::getCurrentTimePoint();
-        EventData::FrameData& frame = pData->frameData[sGpuTimerIndex];
-        if (frame.currentTimer >= frame.pTimers.size())
+        if (getThreadBuffer()->push(pData, true) == false) return;
+
+        if (tIsFrameThread)
         {
-            frame.pTimers.push_back(GpuTimer::create());
+            EventData::FrameData& frame = pData->frameData[sGpuTimerIndex];
+            if (frame.currentTimer >= frame.pTimers.size())
+            {
+                frame.pTimers.push_back(GpuTimer::create());
+            }
+            frame.pTimers[frame.currentTimer]->begin();
+            pData->callStack.push(frame.currentTimer);
+            frame.currentTimer++;
         }
-        frame.pTimers[frame.currentTimer]->begin();
-        pData->callStack.push(frame.currentTimer);
-        frame.currentTimer++;
-        sCurrentLevel++;
+        tCurrentLevel++;
     }
 
-	void Profiler::endEvent(const HashedString& name, EventData* pData)
+	void Profiler::endEvent(EventData* pData)
     {
-        pData->cpuEnd = CpuTimer::getCurrentTimePoint();
-        pData->cpuTotal += CpuTimer::calcDuration(pData->cpuStart, pData->cpuEnd);
+        ThreadBuffer* pBuffer = getThreadBuffer();
+        if (pBuffer->droppedDepth)
+        {
+            // The matching startEvent() was dropped
+            pBuffer->push(pData, false);
+            return;
+        }
 
-        pData->frameData[sGpuTimerIndex].pTimers[pData->callStack.top()]->end();
-        pData->callStack.pop();
+        if (tIsFrameThread)
+        {
+            pData->frameData[sGpuTimerIndex].pTimers[pData->callStack.top()]->end();
+            pData->callStack.pop();
+        }
+        tCurrentLevel--;
 
-        sCurrentLevel--;
+        pBuffer->push(pData, false);
     }
 
     void Profiler::endFrame(std::string& profileResults)
     {
-        profileResults = "Name\t\t\tCPU time(ms)\t\t\tGPU time(ms)\n";
+        profileResults = "Name\t\t\tCPU time(ms)\t\t\tGPU time(ms)\t\tCPU p99(ms)\tGPU p99(ms)\n";
+
+        // A scope which is open when the frame thread is first marked has no GPU timer. Only start recording GPU timers from the next top-level scope
+        if (tIsFrameThread == false && tCurrentLevel == 0 && gpDevice)
+        {
+            tIsFrameThread = true;
+        }
+
+        std::lock_guard<std::recursive_mutex> lock(gEventsMutex);
+        TraceCapture* pCapture = gpCapture.get();
+        if (pCapture)
+        {
+            pCapture->frameThreadId = getThreadBuffer()->threadId;
+            pCapture->addFrameMarker();
+        }
+
+        drainThreadBuffers(pCapture);
 
 		for (EventData* pData : sProfilerVector)
 		{
             double gpuTime = 0;
             for(size_t i = 0 ; i < pData->frameData[1 - sGpuTimerIndex].currentTimer ; i++)
             {
-                gpuTime += pData->frameData[1 - sGpuTimerIndex].pTimers[i]->getElapsedTime();
+                const GpuTimer::SharedPtr& pTimer = pData->frameData[1 - sGpuTimerIndex].pTimers[i];
+                double elapsed = pTimer->getElapsedTime();
+                gpuTime += elapsed;
+                if (pCapture) pCapture->addGpuEvent(pData->name, pTimer->getStartTime(), elapsed);
             }
 
+            if (pData->callCount) pData->cpuHistogram.record(pData->cpuTotal);
+            if (pData->frameData[1 - sGpuTimerIndex].currentTimer) pData->gpuHistogram.record((float)gpuTime);
             pData->frameData[1 - sGpuTimerIndex].currentTimer = 0;
             assert(pData->callStack.empty());
 
 			char event[1000];
 			uint32_t nameIndent = pData->level * 2 + 1;
 			uint32_t cpuIndent = 32 - (nameIndent + (uint32_t)pData->name.size());
-			std::snprintf(event, 1000, "%*s%s %*.3f %36.3f\n", nameIndent, " ", pData->name.c_str(), cpuIndent, pData->cpuTotal, gpuTime);
+			std::snprintf(event, 1000, "%*s%s %*.3f %36.3f %20.3f %15.3f\n", nameIndent, " ", pData->name.c_str(), cpuIndent, pData->cpuTotal, gpuTime, pData->cpuHistogram.getPercentile(99), pData->gpuHistogram.getPercentile(99));
 #if _PROFILING_LOG == 1
 			pData->cpuMs[pData->stepNr] = pData->cpuTotal;
 			pData->gpuMs[pData->stepNr] = gpuTime;
@@ -149,12 +497,29 @@ namespace Falcor
 				pData->stepNr = 0;
 			}
 #endif
+            pData->lastFrame.cpuMs = pData->cpuTotal;
+            pData->lastFrame.gpuMs = (float)gpuTime;
+            pData->lastFrame.callCount = pData->callCount;
             pData->cpuTotal = 0;
 			pData->gpuTotal = 0;
+            pData->callCount = 0;
             profileResults += event;
         }
 
         sGpuTimerIndex = 1 - sGpuTimerIndex;
+
+        if (pCapture)
+        {
+            pCapture->frameId++;
+            if (pCapture->framesLeft && --pCapture->framesLeft == 0)
+            {
+                finishCapture();
+            }
+            else
+            {
+                pCapture->submitFrame();
+            }
+        }
     }
 
 #if _PROFILING_LOG == 1
@@ -175,15 +540,129 @@ namespace Falcor
 	}
 #endif
 
+    std::vector<Profiler::EventData*> Profiler::getEvents()
+    {
+        std::lock_guard<std::recursive_mutex> lock(gEventsMutex);
+        return sProfilerVector;
+    }
+
     void Profiler::clearEvents()
     {
+        std::lock_guard<std::recursive_mutex> lock(gEventsMutex);
+        for (auto& pBuffer : gThreadBuffers)
+        {
+            pBuffer->drain(gpCapture.get());
+        }
+
         for (EventData* pData : sProfilerVector)
         {
-            delete pData;
+            for (auto& frame : pData->frameData)
+            {
+                frame.currentTimer = 0;
+            }
+            pData->cpuTotal = 0;
+            pData->gpuTotal = 0;
+            pData->callCount = 0;
+            pData->lastFrame = EventData::FrameResults();
+            pData->cpuHistogram.reset();
+            pData->gpuHistogram.reset();
         }
-        sProfilerEvents.clear();
-        sProfilerVector.clear();
-        sCurrentLevel = 0;
         sGpuTimerIndex = 0;
     }
+
+    uint64_t Profiler::getDroppedRecordCount()
+    {
+        std::lock_guard<std::recursive_mutex> lock(gEventsMutex);
+        uint64_t count = gReleasedDroppedCount;
+        for (auto& pBuffer : gThreadBuffers)
+        {
+            count += pBuffer->droppedCount.load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    void Profiler::setHistogramWindow(uint32_t frames)
+    {
+        std::lock_guard<std::recursive_mutex> lock(gEventsMutex);
+        gHistogramWindow = frames;
+        for (EventData* pData : sProfilerVector)
+        {
+            pData->cpuHistogram.setWindowSize(frames);
+            pData->gpuHistogram.setWindowSize(frames);
+        }
+    }
+
+    static std::string statsToJson(const TimingHistogram& histogram)
+    {
+        TimingHistogram::Stats stats = histogram.getStats();
+        char json[512];
+        std::snprintf(json, arraysize(json), "{\"count\":%llu,\"mean\":%.4f,\"p50\":%.4f,\"p95\":%.4f,\"p99\":%.4f,\"max\":%.4f,\"hitchThreshold\":%.4f,\"hitches\":%llu}",
+            (unsigned long long)stats.count, stats.mean, stats.p50, stats.p95, stats.p99, stats.max, histogram.getHitchThreshold(), (unsigned long long)stats.hitchCount);
+        return json;
+    }
+
+    bool Profiler::dumpStats(const std::string& filename, const TimingHistogram* pFrameTimes)
+    {
+        std::ofstream out(filename);
+        if (out.fail())
+        {
+            logError("Profiler::dumpStats() - can't open file '" + filename + "' for writing");
+            return false;
+        }
+
+        out << "{\n";
+        if (pFrameTimes)
+        {
+            out << "\"frameTime\":" << statsToJson(*pFrameTimes) << ",\n";
+        }
+        out << "\"events\":[";
+
+        std::lock_guard<std::recursive_mutex> lock(gEventsMutex);
+        for (size_t i = 0; i < sProfilerVector.size(); i++)
+        {
+            const EventData* pData = sProfilerVector[i];
+            out << (i ? ",\n" : "\n") << "{\"name\":\"" << escapeJson(pData->name) << "\",\"level\":" << pData->level;
+            out << ",\"cpu\":" << statsToJson(pData->cpuHistogram) << ",\"gpu\":" << statsToJson(pData->gpuHistogram) << "}";
+        }
+        out << "\n]}\n";
+        return true;
+    }
+
+    bool Profiler::startCapture(const std::string& filename, uint32_t frameCount)
+    {
+        std::lock_guard<std::recursive_mutex> lock(gEventsMutex);
+        if (gpCapture)
+        {
+            logWarning("Profiler::startCapture() - a capture is already in progress");
+            return false;
+        }
+
+        AsyncFileWriter::SharedPtr pWriter = AsyncFileWriter::create(filename);
+        if (pWriter == nullptr) return false;
+
+        // Records which were made before the capture started are not part of it
+        for (auto& pBuffer : gThreadBuffers)
+        {
+            pBuffer->drain(nullptr);
+        }
+
+        gpCapture = std::make_unique<TraceCapture>();
+        gpCapture->pWriter = pWriter;
+        gpCapture->framesLeft = frameCount;
+        gpCapture->cpuBase = CpuTimer::getCurrentTimePoint().time_since_epoch().count();
+        gpCapture->chunk = "{\"traceEvents\":[\n";
+        return true;
+    }
+
+    void Profiler::endCapture()
+    {
+        std::lock_guard<std::recursive_mutex> lock(gEventsMutex);
+        if (gpCapture) finishCapture();
+    }
+
+    bool Profiler::isCapturing()
+    {
+        std::lock_guard<std::recursive_mutex> lock(gEventsMutex);
+        return gpCapture != nullptr;
+    }
 }
\ No newline at end of file
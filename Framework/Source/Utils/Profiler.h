@@ -32,8 +32,10 @@
 #include <vector>
 #include "API/GpuTimer.h"
 #include "Utils/CpuTimer.h"
+#include "Utils/TimingHistogram.h"
 #include "FalcorConfig.h"
 #include <stack>
+#include <atomic>
 
 namespace Falcor
 {
@@ -53,20 +55,32 @@ namespace Falcor
         const size_t hash;
     };
 
+    /** Per-frame API event counters.
+        The counters are atomic, since they are updated by contexts recording on worker threads.
+    */
     struct EventCounter
     {
-        int numRootSignatureChanges = 0;
-        int numFlushes = 0;
-        int numDescriptorHeapAllocations = 0;
-        int numDrawCalls = 0;
-        int numMaterialChanges = 0;
-        int numParamBlockUpdates = 0;
-        int numDescriptors = 0, numDescriptorTables = 0;
-        int numSetRootDescriptorTableCalls = 0;
-        int numDescriptorChunkSwitches = 0;
-        int numOutOfChunks = 0;
+        std::atomic<int> numRootSignatureBinds{0};        ///< Number of graphics root signature bind requests, including redundant ones
+        std::atomic<int> numRootSignatureChanges{0};      ///< Number of graphics root signature changes actually recorded into command lists
+        std::atomic<int> numFlushes{0};
+        std::atomic<int> numDescriptorHeapAllocations{0};
+        std::atomic<int> numDrawCalls{0};
+        std::atomic<int> numMaterialChanges{0};
+        std::atomic<int> numParamBlockUpdates{0};
+        std::atomic<int> numDescriptors{0}, numDescriptorTables{0};
+        std::atomic<int> numSetRootDescriptorTableCalls{0};
+        std::atomic<int> numDescriptorChunkSwitches{0};
+        std::atomic<int> numOutOfChunks{0};
+        std::atomic<int> numDescriptorTableCacheHits{0};
+        std::atomic<int> numDescriptorTableCacheMisses{0};
+        std::atomic<int> numBufferUploads{0};             ///< Number of VariablesBuffer uploads which found modified data
+        std::atomic<int> numBufferUploadBytes{0};         ///< Number of bytes copied by those uploads
+        // The following counters track the current state of the descriptor-table cache and are not reset by Clear()
+        std::atomic<int> numCachedDescriptorTables{0};
+        std::atomic<int> numCachedDescriptors{0};
         void Clear()
         {
+            numRootSignatureBinds = 0;
             numRootSignatureChanges = 0;
             numDescriptorHeapAllocations = 0;
             numDrawCalls = 0;
@@ -77,6 +91,10 @@ namespace Falcor
             numSetRootDescriptorTableCalls = 0;
             numDescriptorChunkSwitches = 0;
             numOutOfChunks = 0;
+            numDescriptorTableCacheHits = 0;
+            numDescriptorTableCacheMisses = 0;
+            numBufferUploads = 0;
+            numBufferUploadBytes = 0;
         }
     };
 
@@ -85,6 +103,8 @@ namespace Falcor
     /** Container class for CPU/GPU profiling.
         This class uses the most accurately available CPU and GPU timers to profile given events. It automatically creates event hierarchies based on the order of the calls made.
         This class uses a double-buffering scheme for GPU profiling to avoid GPU stalls.
+        CPU events can be recorded from any thread. Each thread writes fixed-size begin/end records into its own ring buffer without taking locks, and the records are aggregated by endFrame().
+        GPU timers are only recorded on the thread which calls endFrame().
         CProfilerEvent is a wrapper class which together with scoping can simplify event profiling.
     */
     class Profiler
@@ -107,11 +127,25 @@ namespace Falcor
             FrameData frameData[2]; // Double-buffering, to avoid GPU flushes
 
             std::stack<size_t> callStack;
-            CpuTimer::TimePoint cpuStart;
-            CpuTimer::TimePoint cpuEnd;
             float cpuTotal = 0;
             float gpuTotal = 0;
+            uint32_t callCount = 0;
             uint32_t level;
+
+            /** The results of the last frame processed by endFrame()
+            */
+            struct FrameResults
+            {
+                float cpuMs = 0;        ///< CPU time, summed over all the threads which recorded the event
+                float gpuMs = 0;
+                uint32_t callCount = 0;
+            } lastFrame;
+
+            /** Per-frame CPU and GPU times of the event, over the window set with setHistogramWindow(). Frames in which the event wasn't recorded are skipped.
+                Hitches are not counted by default. Set a threshold on the histogram to count them.
+            */
+            TimingHistogram cpuHistogram;
+            TimingHistogram gpuHistogram;
 #if _PROFILING_LOG == 1
             int stepNr = 0;
             int filesWritten = 0;
@@ -123,29 +157,40 @@ namespace Falcor
         /** Start profiling a new event and update the events hierarchies.
             \param[in] name The event name.
         */
-        inline static void startEvent(const HashedString& name) { startEvent(name, getEvent(name)); }
+        inline static void startEvent(const HashedString& name) { startEvent(getEvent(name)); }
 
         /** Start profiling a new event and update the events hierarchies.
             \param[in] name The event name.
             \param[in] event The event if previously looked up.
             \note This version supports dropping the event-lookup if the event is already available.
         */
-        static void startEvent(const HashedString& name, EventData *pEvent);
+        inline static void startEvent(const HashedString& name, EventData *pEvent) { startEvent(pEvent); }
+
+        /** Start profiling a previously looked-up event. This is the version used by the PROFILE() macro. It doesn't lock and doesn't perform any lookups.
+            If the thread's record buffer is full, the event and the events nested in it are dropped (see getDroppedRecordCount()). endEvent() must still be called for it.
+            \param[in] pEvent The event.
+        */
+        static void startEvent(EventData* pEvent);
 
         /** Finish profiling a new event and update the events hierarchies.
             \param[in] name The event name.
         */
-        inline static void endEvent(const HashedString& name) { endEvent(name, getEvent(name)); }
+        inline static void endEvent(const HashedString& name) { endEvent(getEvent(name)); }
 
         /** Finish profiling a new event and update the events hierarchies.
             \param[in] name The event name.
             \param[in] event The event if previously looked up.
             \note This version supports dropping the event-lookup if the event is already available.
         */
-        static void endEvent(const HashedString& name, EventData *pEvent);
+        inline static void endEvent(const HashedString& name, EventData *pEvent) { endEvent(pEvent); }
+
+        /** Finish profiling a previously looked-up event.
+            \param[in] pEvent The event.
+        */
+        static void endEvent(EventData* pEvent);
 
         /** Finish profiling for the entire frame.
-            Due to the double-buffering nature of the profiler, the results returned are for the previous frame.
+            Collects the CPU records from all the threads. Due to the double-buffering nature of the profiler, the GPU results returned are for the previous frame.
             \param[out] profileResults A string containing the the profiling results.
         */
         static void endFrame(std::string& profileResults);
@@ -164,6 +209,7 @@ namespace Falcor
 
         /** Get the event, or create a new one if the event does not yet exist.
             This is a public interface to facilitate more complicated construction of event names and finegrained control over the profiled region.
+            The returned pointer stays valid until the application exits, so it can be cached by the caller.
         */
         static EventData* getEvent(const HashedString& name);
 
@@ -172,15 +218,50 @@ namespace Falcor
         */
         static EventData* isEventRegistered(const HashedString& name);
 
-        /** Clears all the events. 
-            Useful if you want to start profiling a different technique with different events.
+        /** Get all the registered events
+        */
+        static std::vector<EventData*> getEvents();
+
+        /** Clears the data of all the events. 
+            Useful if you want to start profiling a different technique. The events themselves are not destroyed, since PROFILE() scopes cache them.
         */
         static void clearEvents();
 
+        /** Get the number of events which were dropped because a thread's record buffer was full. The buffers are drained by endFrame().
+        */
+        static uint64_t getDroppedRecordCount();
+
+        /** Set the number of frames covered by the events' histograms. Resets the histograms.
+            \param[in] frames Number of recent frames. If 0, the histograms cover all the frames since they were last reset
+        */
+        static void setHistogramWindow(uint32_t frames);
+
+        /** Write the statistics of all the events to a JSON file.
+            \param[in] filename The output file
+            \param[in] pFrameTimes Optional frame-time histogram to write along with the events
+            \return false if the file can't be written
+        */
+        static bool dumpStats(const std::string& filename, const TimingHistogram* pFrameTimes = nullptr);
+
+        /** Start capturing a timeline of the individual events into a file in the Chrome Trace Event JSON format, which can be opened in chrome://tracing or https://ui.perfetto.dev.
+            CPU scopes are written per thread and GPU ranges on a separate track. Each event is tagged with its frame ID. The file is written on a background thread.
+            \param[in] filename The output file
+            \param[in] frameCount Number of frames to capture. The capture ends after this many calls to endFrame(). If 0, the capture continues until endCapture() is called
+            \return false if a capture is already in progress or the file can't be created
+        */
+        static bool startCapture(const std::string& filename, uint32_t frameCount);
+
+        /** End the current capture. The file is completed on a background thread.
+        */
+        static void endCapture();
+
+        /** Check if a capture is in progress
+        */
+        static bool isCapturing();
+
     private:
         static std::map<size_t, EventData*> sProfilerEvents;
         static std::vector<EventData*> sProfilerVector;
-        static uint32_t sCurrentLevel;
         static uint32_t sGpuTimerIndex;
     };
 
@@ -193,17 +274,23 @@ namespace Falcor
     public:
         /** C'tor
         */
-        ProfilerEvent(const HashedString& name) : mName(name) { if(gProfileEnabled) { Profiler::startEvent(name); } }
+        ProfilerEvent(const HashedString& name) : ProfilerEvent(gProfileEnabled ? Profiler::getEvent(name) : nullptr) {}
+
+        /** C'tor. Used by the PROFILE macro, which looks up the event once.
+        */
+        ProfilerEvent(Profiler::EventData* pEvent) : mpEvent(pEvent), mActive(gProfileEnabled && pEvent) { if(mActive) { Profiler::startEvent(mpEvent); } }
+
         /** D'tor
         */
-        ~ProfilerEvent() { if(gProfileEnabled) {Profiler::endEvent(mName); }}
+        ~ProfilerEvent() { if(mActive) { Profiler::endEvent(mpEvent); } }
 
     private:
-        const HashedString mName;
+        Profiler::EventData* mpEvent;
+        bool mActive;
     };
 
 #if _PROFILING_ENABLED
-#define PROFILE(_name) static const Falcor::HashedString hashed ## _name(#_name); Falcor::ProfilerEvent _profileEvent(hashed ## _name);
+#define PROFILE(_name) static Falcor::Profiler::EventData* const pProfileEvent ## _name = Falcor::Profiler::getEvent(Falcor::HashedString(#_name)); Falcor::ProfilerEvent _profileEvent(pProfileEvent ## _name);
 #else
 #define PROFILE(_name)
 #endif
@@ -31,6 +31,7 @@
 #if FALCOR_USE_PYTHON
 
 #include "Python.h"
+#include "Framework.h"
 #include "PythonEmbedding.h"
 #include <ctime>
 #include <chrono>
@@ -620,4 +621,183 @@ void PythonEmbedding::stopRedirectingOutputs(bool getOutputs)
     PyErr_Clear();
 }
 
-#endif
\ No newline at end of file
+namespace
+{
+    using ReadTextureTask = Falcor::CopyContext::ReadTextureTask;
+
+    // Keeps a readback buffer mapped for as long as NumPy arrays reference it
+    struct MappedReadback
+    {
+        MappedReadback(const ReadTextureTask::SharedPtr& pReadback) : pReadback(pReadback), pData(pReadback->map()) {}
+        ~MappedReadback() { pReadback->unmap(); }
+        ReadTextureTask::SharedPtr pReadback;
+        const uint8_t* pData;
+    };
+
+    // Returns the buffer-protocol format of a single channel, or nullptr if the format can't be expressed as a NumPy array
+    const char* getNumpyFormat(Falcor::ResourceFormat format, uint32_t& channelSize)
+    {
+        using namespace Falcor;
+        switch (format)
+        {
+        // Packed formats. The channels don't start on byte boundaries, or are padded
+        case ResourceFormat::R24UnormX8:
+        case ResourceFormat::RGB5A1Unorm:
+        case ResourceFormat::RGB10A2Unorm:
+        case ResourceFormat::RGB10A2Uint:
+        case ResourceFormat::R32FloatX32:
+        case ResourceFormat::R11G11B10Float:
+        case ResourceFormat::RGB9E5Float:
+        case ResourceFormat::R5G6B5Unorm:
+        case ResourceFormat::D32FloatS8X24:
+        case ResourceFormat::D24UnormS8:
+            return nullptr;
+        default:
+            break;
+        }
+
+        uint32_t channelCount = getFormatChannelCount(format);
+        uint32_t bytesPerBlock = getFormatBytesPerBlock(format);
+        if (getFormatPixelsPerBlock(format) != 1 || channelCount == 0 || (bytesPerBlock % channelCount) != 0) return nullptr;
+
+        channelSize = bytesPerBlock / channelCount;
+        switch (getFormatType(format))
+        {
+        case FormatType::Float:
+            return channelSize == 2 ? "e" : (channelSize == 4 ? "f" : nullptr);
+        case FormatType::Unorm:
+        case FormatType::UnormSrgb:
+        case FormatType::Uint:
+            return channelSize == 1 ? "B" : (channelSize == 2 ? "H" : (channelSize == 4 ? "I" : nullptr));
+        case FormatType::Snorm:
+        case FormatType::Sint:
+            return channelSize == 1 ? "b" : (channelSize == 2 ? "h" : (channelSize == 4 ? "i" : nullptr));
+        default:
+            return nullptr;
+        }
+    }
+
+    // Wraps memory in a NumPy array without copying it. 'owner' keeps the memory alive for the lifetime of the array.
+    py::object makeArray(const void* pData, Falcor::ResourceFormat format, uint32_t width, uint32_t height, uint32_t depth, size_t rowPitch, const py::capsule& owner)
+    {
+        uint32_t channelSize = 0;
+        const char* pyFormat = getNumpyFormat(format, channelSize);
+        if (pyFormat == nullptr)
+        {
+            Falcor::logWarning("PythonEmbedding: format " + Falcor::to_string(format) + " can't be exchanged with NumPy");
+            return py::none();
+        }
+
+        py::ssize_t channelCount = Falcor::getFormatChannelCount(format);
+        std::vector<py::ssize_t> shape = { py::ssize_t(height), py::ssize_t(width), channelCount };
+        std::vector<py::ssize_t> strides = { py::ssize_t(rowPitch), py::ssize_t(channelCount * channelSize), py::ssize_t(channelSize) };
+        if (depth > 1)
+        {
+            shape.insert(shape.begin(), py::ssize_t(depth));
+            strides.insert(strides.begin(), py::ssize_t(rowPitch * height));
+        }
+
+        // Passing a base object is what makes pybind11 reference the memory instead of copying it
+        py::array array(py::dtype(pyFormat), shape, strides, pData, owner);
+
+        // The memory is a const Bitmap or a readback buffer. pybind11 marks arrays with a base object as writable, so clear the flag
+        py::detail::array_proxy(array.ptr())->flags &= ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+        return std::move(array);
+    }
+
+    py::object makeReadbackArray(const std::shared_ptr<MappedReadback>& pMapping, Falcor::ResourceFormat format)
+    {
+        const ReadTextureTask* pReadback = pMapping->pReadback.get();
+        uint32_t width = pReadback->getRowSize() / Falcor::getFormatBytesPerBlock(format);
+        py::capsule owner(new std::shared_ptr<MappedReadback>(pMapping), [](void* pHolder) { delete reinterpret_cast<std::shared_ptr<MappedReadback>*>(pHolder); });
+        return makeArray(pMapping->pData, format, width, pReadback->getRowCount(), pReadback->getDepth(), pReadback->getRowPitch(), owner);
+    }
+}
+
+py::object PythonEmbedding::toNumpy(Falcor::Bitmap::UniqueConstPtr pBitmap)
+{
+    if (pBitmap == nullptr) return py::none();
+
+    // The capsule takes ownership of the bitmap, so it is released together with the last array referencing it
+    const Falcor::Bitmap* pRaw = pBitmap.get();
+    py::capsule owner(pBitmap.release(), [](void* pData) { delete reinterpret_cast<const Falcor::Bitmap*>(pData); });
+    size_t rowPitch = size_t(pRaw->getWidth()) * Falcor::getFormatBytesPerBlock(pRaw->getFormat());
+    return makeArray(pRaw->getData(), pRaw->getFormat(), pRaw->getWidth(), pRaw->getHeight(), 1, rowPitch, owner);
+}
+
+py::object PythonEmbedding::toNumpy(const ReadTextureTask::SharedPtr& pReadback, Falcor::ResourceFormat format)
+{
+    if (pReadback == nullptr) return py::none();
+
+    // Waits for the GPU, then maps the buffer. It is unmapped once Python released the array.
+    return makeReadbackArray(std::make_shared<MappedReadback>(pReadback), format);
+}
+
+bool PythonEmbedding::uploadToTexture(Falcor::CopyContext* pCtx, const Falcor::Texture* pTexture, const py::array& data, uint32_t mipLevel, uint32_t arraySlice)
+{
+    // Only copies if the array isn't laid out the way the texture expects
+    py::array contiguous = py::array::ensure(data, py::array::c_style);
+    if (!contiguous)
+    {
+        Falcor::logWarning("PythonEmbedding::uploadToTexture() - the data is not a valid array");
+        return false;
+    }
+
+    Falcor::ResourceFormat format = pTexture->getFormat();
+    size_t expectedSize = size_t(pTexture->getWidth(mipLevel)) * pTexture->getHeight(mipLevel) * pTexture->getDepth(mipLevel) * Falcor::getFormatBytesPerBlock(format) / Falcor::getFormatPixelsPerBlock(format);
+    size_t size = size_t(contiguous.nbytes());
+    if (size != expectedSize)
+    {
+        Falcor::logWarning("PythonEmbedding::uploadToTexture() - array size (" + std::to_string(size) + " bytes) doesn't match the texture subresource (" + std::to_string(expectedSize) + " bytes)");
+        return false;
+    }
+
+    pCtx->updateTextureSubresource(pTexture, pTexture->getSubresourceIndex(arraySlice, mipLevel), contiguous.data());
+    return true;
+}
+
+PythonEmbedding::TextureReadback::SharedPtr PythonEmbedding::TextureReadback::create(uint32_t bufferCount)
+{
+    return SharedPtr(new TextureReadback(std::max(bufferCount, 1u)));
+}
+
+void PythonEmbedding::TextureReadback::readback(Falcor::CopyContext* pCtx, const Falcor::Texture* pTexture, uint32_t mipLevel, uint32_t arraySlice)
+{
+    Slot& slot = mSlots[mNextSlot];
+    mNextSlot = (mNextSlot + 1) % (uint32_t)mSlots.size();
+
+    // Recycle the slot's buffer, unless Python still references its data. In that case the buffer stays alive with the arrays and a new one is created
+    std::shared_ptr<Falcor::Buffer> pStaging;
+    if (slot.pReadback && slot.pMapping.expired())
+    {
+        pStaging = slot.pReadback->getBuffer();
+    }
+
+    slot.pReadback = ReadTextureTask::create(pCtx, pTexture, pTexture->getSubresourceIndex(arraySlice, mipLevel), pStaging);
+    slot.pMapping.reset();
+    slot.format = pTexture->getFormat();
+    slot.id = mNextId++;
+}
+
+py::object PythonEmbedding::TextureReadback::getLatest(bool wait)
+{
+    Slot* pLatest = nullptr;
+    for (auto& slot : mSlots)
+    {
+        if (slot.pReadback == nullptr) continue;
+        if (wait == false && slot.pReadback->isComplete() == false) continue;
+        if (pLatest == nullptr || slot.id > pLatest->id) pLatest = &slot;
+    }
+    if (pLatest == nullptr) return py::none();
+
+    // A buffer can only be mapped once, so arrays of the same readback share the mapping
+    std::shared_ptr<MappedReadback> pMapping = std::static_pointer_cast<MappedReadback>(pLatest->pMapping.lock());
+    if (pMapping == nullptr)
+    {
+        pMapping = std::make_shared<MappedReadback>(pLatest->pReadback);
+        pLatest->pMapping = pMapping;
+    }
+    return makeReadbackArray(pMapping, pLatest->format);
+}
+
+#endif
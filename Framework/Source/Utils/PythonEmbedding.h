@@ -48,6 +48,11 @@
 #include "pybind11/pybind11.h"
 #include "pybind11/embed.h"
 #include "pybind11/eval.h"
+#include "pybind11/numpy.h"
+
+#include "API/CopyContext.h"
+#include "API/Texture.h"
+#include "Utils/Bitmap.h"
 
 /** If PYTHON_USE_SIMPLE_SHARING is defined, use a simplistic and fragile approach that
         allows usage of multiple PythonEmbedding class instantiations simultaneously (but
@@ -178,6 +183,64 @@ public:
     */
     double lastExecutionTime( bool totalTime = true );
 
+    /** Methods to exchange image data with NumPy without copying it
+          -> The returned arrays reference Falcor's memory directly through the buffer protocol.  The memory is kept
+             alive (and readback buffers stay mapped) until the last Python object referencing it is released.
+          -> The arrays are read-only.  Use numpy.array() to get a writable copy.
+          -> Arrays have the shape (height, width, channels), or (depth, height, width, channels) for 3D readbacks.
+             Row padding of readback buffers is expressed with strides, so it is never copied out.
+          -> Element types follow the resource format:  8/16/32-bit unorm and uint formats map to uint8/uint16/uint32,
+             snorm and sint formats to the signed types, and float formats to float16/float32.
+          -> Packed, compressed and depth-stencil formats can't be expressed as NumPy arrays.  The methods return None.
+    */
+    static pybind11::object toNumpy(Falcor::Bitmap::UniqueConstPtr pBitmap);
+    static pybind11::object toNumpy(const Falcor::CopyContext::ReadTextureTask::SharedPtr& pReadback, Falcor::ResourceFormat format);
+
+    /** Upload a NumPy array into a texture subresource.  The array's memory is handed directly to the copy context,
+        without intermediate vectors.  Arrays which are not C-contiguous are made contiguous first (that one copy is
+        unavoidable).  Returns false if the array size doesn't match the subresource.
+    */
+    static bool uploadToTexture(Falcor::CopyContext* pCtx, const Falcor::Texture* pTexture, const pybind11::array& data, uint32_t mipLevel = 0, uint32_t arraySlice = 0);
+
+    /** Multi-buffered texture readback for Python.  Call readback() once per frame, and getLatest() to get the newest
+        result which the GPU already finished.  Python never waits for the frame which is still in flight.
+          -> Readback buffers are recycled once Python released all the arrays referencing them.
+    */
+    class TextureReadback
+    {
+    public:
+        using SharedPtr = std::shared_ptr<TextureReadback>;
+
+        /** Create a new object
+              -> bufferCount is the number of readbacks in flight.  The default double-buffers the data.
+        */
+        static SharedPtr create(uint32_t bufferCount = 2);
+
+        /** Record a readback of a texture subresource.  Never blocks.
+        */
+        void readback(Falcor::CopyContext* pCtx, const Falcor::Texture* pTexture, uint32_t mipLevel = 0, uint32_t arraySlice = 0);
+
+        /** Get the newest completed readback as a NumPy array (see toNumpy()).
+              -> If wait is true, waits for the newest readback, even if the GPU didn't finish it yet.
+              -> Returns None if no readback was completed yet.
+        */
+        pybind11::object getLatest(bool wait = false);
+
+    private:
+        TextureReadback(uint32_t bufferCount) : mSlots(bufferCount) {}
+
+        struct Slot
+        {
+            Falcor::CopyContext::ReadTextureTask::SharedPtr pReadback;
+            std::weak_ptr<void> pMapping;     // Alive while Python references the slot's data. Lets repeated getLatest() calls share the mapping
+            Falcor::ResourceFormat format = Falcor::ResourceFormat::Unknown;
+            uint64_t id = 0;
+        };
+        std::vector<Slot> mSlots;
+        uint32_t mNextSlot = 0;
+        uint64_t mNextId = 1;
+    };
+
 private:
     // Internal member variables
 
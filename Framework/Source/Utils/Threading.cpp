@@ -0,0 +1,198 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "Threading.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace Falcor
+{
+    namespace
+    {
+        struct ThreadingData
+        {
+            std::vector<std::thread> threads;
+            std::deque<Threading::TaskFunc> queue;
+            std::mutex mutex;
+            std::condition_variable workAvailable;
+            std::condition_variable queueDrained;
+            uint32_t activeTasks = 0;
+            bool stop = false;
+        };
+
+        ThreadingData gThreadingData;
+        thread_local uint32_t tThreadIndex = Threading::kInvalidThreadIndex;
+
+        void workerLoop(uint32_t threadIndex)
+        {
+            tThreadIndex = threadIndex;
+            while (true)
+            {
+                Threading::TaskFunc task;
+                {
+                    std::unique_lock<std::mutex> lock(gThreadingData.mutex);
+                    gThreadingData.workAvailable.wait(lock, [] { return gThreadingData.stop || gThreadingData.queue.size(); });
+                    if (gThreadingData.queue.empty()) return;
+                    task = std::move(gThreadingData.queue.front());
+                    gThreadingData.queue.pop_front();
+                    gThreadingData.activeTasks++;
+                }
+
+                task();
+
+                {
+                    std::lock_guard<std::mutex> lock(gThreadingData.mutex);
+                    gThreadingData.activeTasks--;
+                    if (gThreadingData.activeTasks == 0 && gThreadingData.queue.empty())
+                    {
+                        gThreadingData.queueDrained.notify_all();
+                    }
+                }
+            }
+        }
+    }
+
+    void Threading::start(uint32_t threadCount)
+    {
+        std::lock_guard<std::mutex> lock(gThreadingData.mutex);
+        if (gThreadingData.threads.size()) return;
+
+        if (threadCount == 0)
+        {
+            uint32_t cores = std::thread::hardware_concurrency();
+            threadCount = cores > 1 ? cores - 1 : 1;
+        }
+
+        gThreadingData.stop = false;
+        for (uint32_t i = 0; i < threadCount; i++)
+        {
+            gThreadingData.threads.emplace_back(workerLoop, i);
+        }
+    }
+
+    void Threading::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(gThreadingData.mutex);
+            gThreadingData.stop = true;
+        }
+        gThreadingData.workAvailable.notify_all();
+
+        for (auto& t : gThreadingData.threads)
+        {
+            if (t.joinable()) t.join();
+        }
+        gThreadingData.threads.clear();
+    }
+
+    uint32_t Threading::getThreadCount()
+    {
+        start();
+        return (uint32_t)gThreadingData.threads.size();
+    }
+
+    uint32_t Threading::getCurrentThreadIndex()
+    {
+        return tThreadIndex;
+    }
+
+    void Threading::enqueue(TaskFunc func)
+    {
+        start();
+        {
+            std::lock_guard<std::mutex> lock(gThreadingData.mutex);
+            gThreadingData.queue.push_back(std::move(func));
+        }
+        gThreadingData.workAvailable.notify_one();
+    }
+
+    void Threading::finish()
+    {
+        std::unique_lock<std::mutex> lock(gThreadingData.mutex);
+        gThreadingData.queueDrained.wait(lock, [] { return gThreadingData.activeTasks == 0 && gThreadingData.queue.empty(); });
+    }
+
+    void Threading::parallelFor(uint32_t count, uint32_t chunkCount, const RangeFunc& func)
+    {
+        if (count == 0) return;
+        if (chunkCount == 0) chunkCount = getThreadCount() + 1;
+        chunkCount = std::min(chunkCount, count);
+
+        // The state is shared with the helper tasks. Helpers that start after all the chunks were consumed only touch the state, so it must outlive this call.
+        struct RangeState
+        {
+            RangeFunc func;
+            uint32_t count;
+            uint32_t chunkCount;
+            std::atomic<uint32_t> nextChunk{0};
+            std::atomic<uint32_t> completedChunks{0};
+            std::mutex mutex;
+            std::condition_variable done;
+        };
+        auto pState = std::make_shared<RangeState>();
+        pState->func = func;
+        pState->count = count;
+        pState->chunkCount = chunkCount;
+
+        auto processChunks = [](RangeState* pState)
+        {
+            while (true)
+            {
+                uint32_t chunk = pState->nextChunk.fetch_add(1);
+                if (chunk >= pState->chunkCount) return;
+
+                // Distribute the remainder over the first chunks, so that chunk sizes differ by at most one element
+                uint32_t base = pState->count / pState->chunkCount;
+                uint32_t extra = pState->count % pState->chunkCount;
+                uint32_t begin = chunk * base + std::min(chunk, extra);
+                uint32_t end = begin + base + (chunk < extra ? 1 : 0);
+                pState->func(begin, end, chunk);
+
+                if (pState->completedChunks.fetch_add(1) + 1 == pState->chunkCount)
+                {
+                    std::lock_guard<std::mutex> lock(pState->mutex);
+                    pState->done.notify_all();
+                }
+            }
+        };
+
+        uint32_t helperCount = std::min(chunkCount - 1, getThreadCount());
+        for (uint32_t i = 0; i < helperCount; i++)
+        {
+            enqueue([pState, processChunks]() { processChunks(pState.get()); });
+        }
+
+        processChunks(pState.get());
+
+        std::unique_lock<std::mutex> lock(pState->mutex);
+        pState->done.wait(lock, [&pState] { return pState->completedChunks == pState->chunkCount; });
+    }
+}
@@ -0,0 +1,99 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+
+namespace Falcor
+{
+    /** A persistent pool of worker threads.
+        Work can be submitted as independent tasks using dispatchTask(), or as an index range using parallelFor().
+        The pool is started lazily on first use. Call shutdown() before the application exits to join the workers.
+    */
+    class Threading
+    {
+    public:
+        using TaskFunc = std::function<void(void)>;
+
+        /** Callback used by parallelFor().
+            \param[in] begin First index of the chunk
+            \param[in] end One past the last index of the chunk
+            \param[in] chunkIndex Index of the chunk. Chunk indices are stable - the same range always maps to the same chunk, regardless of which thread executes it
+        */
+        using RangeFunc = std::function<void(uint32_t begin, uint32_t end, uint32_t chunkIndex)>;
+
+        static const uint32_t kInvalidThreadIndex = uint32_t(-1);
+
+        /** Start the worker threads. Does nothing if the pool is already running.
+            \param[in] threadCount Number of worker threads. If 0, will use the number of logical cores minus one (the calling thread participates in parallelFor())
+        */
+        static void start(uint32_t threadCount = 0);
+
+        /** Wait for all outstanding work to complete and join the worker threads
+        */
+        static void shutdown();
+
+        /** Get the number of worker threads
+        */
+        static uint32_t getThreadCount();
+
+        /** Get the index of the current worker thread, or kInvalidThreadIndex if called from a thread which is not part of the pool
+        */
+        static uint32_t getCurrentThreadIndex();
+
+        /** Queue a task for execution on one of the worker threads.
+            \return A future which will hold the return value of the function once the task has completed
+        */
+        template<typename FuncType>
+        static auto dispatchTask(FuncType&& func) -> std::future<decltype(func())>
+        {
+            using ResultType = decltype(func());
+            auto pTask = std::make_shared<std::packaged_task<ResultType()>>(std::forward<FuncType>(func));
+            std::future<ResultType> result = pTask->get_future();
+            enqueue([pTask]() { (*pTask)(); });
+            return result;
+        }
+
+        /** Split the range [0, count) into chunkCount chunks and execute them in parallel. The calling thread participates in the work.
+            The function returns once all the chunks have been processed.
+            \param[in] count Number of elements
+            \param[in] chunkCount Number of chunks to split the range into. If 0, will use the number of worker threads plus one
+            \param[in] func The function to execute for each chunk
+        */
+        static void parallelFor(uint32_t count, uint32_t chunkCount, const RangeFunc& func);
+
+        /** Block until all the tasks which were queued so far have completed
+        */
+        static void finish();
+
+    private:
+        static void enqueue(TaskFunc func);
+    };
+}
@@ -0,0 +1,175 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "TimingHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Falcor
+{
+    // Samples are stored as integers in nanoseconds. The buckets cover values up to 2^kMaxValueBits ns (about 73 minutes)
+    static const uint32_t kMaxValueBits = 42;
+    static const uint32_t kBucketCount = TimingHistogram::kSubBucketCount * (kMaxValueBits - TimingHistogram::kSubBucketBits + 1);
+
+    static uint64_t msToValue(float ms)
+    {
+        double ns = (double)ms * 1000000.0;
+        if (ns <= 0) return 0;
+        return std::min((uint64_t)ns, (uint64_t(1) << kMaxValueBits) - 1);
+    }
+
+    static float valueToMs(uint64_t value)
+    {
+        return (float)((double)value / 1000000.0);
+    }
+
+    static uint32_t findMsb(uint64_t value)
+    {
+        uint32_t msb = 0;
+        while (value >>= 1) msb++;
+        return msb;
+    }
+
+    TimingHistogram::TimingHistogram(uint32_t windowSize, float hitchThreshold) : mWindowSize(windowSize), mHitchThreshold(hitchThreshold)
+    {
+        reset();
+    }
+
+    uint32_t TimingHistogram::getBucketIndex(uint64_t value)
+    {
+        // Values below kSubBucketCount map to their own bucket. Above that, each power of two is split into kSubBucketCount buckets
+        if (value < kSubBucketCount) return (uint32_t)value;
+        uint32_t shift = findMsb(value) - kSubBucketBits;
+        uint32_t subBucket = (uint32_t)(value >> shift) - kSubBucketCount;
+        return kSubBucketCount + shift * kSubBucketCount + subBucket;
+    }
+
+    uint64_t TimingHistogram::getBucketUpperValue(uint32_t index)
+    {
+        if (index < kSubBucketCount) return index;
+        uint32_t shift = (index - kSubBucketCount) / kSubBucketCount;
+        uint64_t subBucket = (index - kSubBucketCount) % kSubBucketCount;
+        return ((kSubBucketCount + subBucket + 1) << shift) - 1;
+    }
+
+    void TimingHistogram::add(uint64_t value, int32_t delta)
+    {
+        mBuckets[getBucketIndex(value)] += delta;
+        mCount += delta;
+        mSum += delta * (int64_t)value;
+        if (mHitchThreshold > 0 && value > mHitchThresholdValue) mHitchCount += delta;
+    }
+
+    void TimingHistogram::record(float ms)
+    {
+        uint64_t value = msToValue(ms);
+        if (mWindowSize)
+        {
+            if (mWindow.size() < mWindowSize)
+            {
+                mWindow.push_back(value);
+            }
+            else
+            {
+                add(mWindow[mWindowNext], -1);
+                mWindow[mWindowNext] = value;
+            }
+            mWindowNext = (mWindowNext + 1) % mWindowSize;
+        }
+        else
+        {
+            mMax = std::max(mMax, value);
+        }
+        add(value, 1);
+    }
+
+    void TimingHistogram::reset()
+    {
+        mBuckets.assign(kBucketCount, 0);
+        mWindow.clear();
+        mWindow.reserve(mWindowSize);
+        mWindowNext = 0;
+        mHitchThresholdValue = msToValue(mHitchThreshold);
+        mCount = 0;
+        mSum = 0;
+        mMax = 0;
+        mHitchCount = 0;
+    }
+
+    float TimingHistogram::getPercentile(float percentile) const
+    {
+        if (mCount == 0) return 0;
+        // The rank of the sample at the percentile, rounded up, so that the 100th percentile is the largest sample
+        uint64_t rank = (uint64_t)std::ceil((double)percentile / 100.0 * mCount);
+        rank = std::max(rank, uint64_t(1));
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < kBucketCount; i++)
+        {
+            seen += mBuckets[i];
+            if (seen >= rank)
+            {
+                return valueToMs(getBucketUpperValue(i));
+            }
+        }
+        return valueToMs(getBucketUpperValue(kBucketCount - 1));
+    }
+
+    TimingHistogram::Stats TimingHistogram::getStats() const
+    {
+        Stats stats;
+        stats.count = mCount;
+        if (mCount == 0) return stats;
+
+        stats.mean = valueToMs(mSum / mCount);
+        stats.p50 = getPercentile(50);
+        stats.p95 = getPercentile(95);
+        stats.p99 = getPercentile(99);
+        stats.hitchCount = mHitchCount;
+
+        // The exact maximum can't be maintained when samples leave the window, so it's found by scanning the window
+        uint64_t max = mMax;
+        if (mWindowSize)
+        {
+            for (uint64_t value : mWindow) max = std::max(max, value);
+        }
+        stats.max = valueToMs(max);
+        return stats;
+    }
+
+    void TimingHistogram::setWindowSize(uint32_t windowSize)
+    {
+        mWindowSize = windowSize;
+        reset();
+    }
+
+    void TimingHistogram::setHitchThreshold(float ms)
+    {
+        mHitchThreshold = ms;
+        reset();
+    }
+}
@@ -0,0 +1,106 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include <vector>
+#include <cstdint>
+
+namespace Falcor
+{
+    /** Accumulates timing samples into a log-linear histogram, in the style of HdrHistogram.
+        Each power-of-two range of values is split into kSubBucketCount linear buckets, so percentiles are accurate to within 1/kSubBucketCount of the value, regardless of its magnitude. Recording a sample is O(1).
+        The histogram can cover all the samples since the last reset(), or a sliding window of the most recent samples.
+    */
+    class TimingHistogram
+    {
+    public:
+        static const uint32_t kSubBucketBits = 6;
+        static const uint32_t kSubBucketCount = 1 << kSubBucketBits;
+
+        struct Stats
+        {
+            uint64_t count = 0;
+            float mean = 0;
+            float p50 = 0;
+            float p95 = 0;
+            float p99 = 0;
+            float max = 0;
+            uint64_t hitchCount = 0;    ///< Number of samples above the hitch threshold
+        };
+
+        /** Constructor
+            \param[in] windowSize Number of most recent samples covered by the histogram. If 0, the histogram covers all the samples since the last reset()
+            \param[in] hitchThreshold Samples above this value are counted as hitches. If 0, hitches are not counted
+        */
+        TimingHistogram(uint32_t windowSize = 0, float hitchThreshold = 0);
+
+        /** Add a sample, in milliseconds. Negative values are clamped to 0
+        */
+        void record(float ms);
+
+        /** Remove all the samples
+        */
+        void reset();
+
+        /** Get the value below which the given fraction of the samples fall.
+            \param[in] percentile The percentile, in the range [0, 100]
+        */
+        float getPercentile(float percentile) const;
+
+        /** Get the statistics of the samples in the window
+        */
+        Stats getStats() const;
+
+        /** Set the number of most recent samples covered by the histogram. This resets the histogram.
+        */
+        void setWindowSize(uint32_t windowSize);
+        uint32_t getWindowSize() const { return mWindowSize; }
+
+        /** Set the value above which samples are counted as hitches. This resets the histogram.
+        */
+        void setHitchThreshold(float ms);
+        float getHitchThreshold() const { return mHitchThreshold; }
+
+        uint64_t getCount() const { return mCount; }
+
+    private:
+        static uint32_t getBucketIndex(uint64_t value);
+        static uint64_t getBucketUpperValue(uint32_t index);
+        void add(uint64_t value, int32_t delta);
+
+        std::vector<uint32_t> mBuckets;
+        std::vector<uint64_t> mWindow;  // Ring buffer of the samples in the window. Only used when the window size is not 0
+        uint32_t mWindowSize;
+        uint32_t mWindowNext = 0;
+        float mHitchThreshold;
+        uint64_t mHitchThresholdValue;
+        uint64_t mCount = 0;
+        uint64_t mSum = 0;
+        uint64_t mMax = 0;              // Only tracked when the window size is 0
+        uint64_t mHitchCount = 0;
+    };
+}
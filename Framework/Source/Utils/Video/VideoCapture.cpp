@@ -0,0 +1,200 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "Framework.h"
+#include "VideoCapture.h"
+#include "API/Texture.h"
+#include "Utils/CpuTimer.h"
+
+namespace Falcor
+{
+    VideoCapture::UniquePtr VideoCapture::create(const Desc& desc)
+    {
+        UniquePtr pCapture = UniquePtr(new VideoCapture(desc));
+        pCapture->mpEncoder = VideoEncoder::create(desc.encoderDesc);
+        if (pCapture->mpEncoder == nullptr) return nullptr;
+
+        uint32_t slotCount = std::max(desc.readbackCount, 1u) + std::max(desc.queueSize, 1u);
+        pCapture->mDesc.readbackCount = std::max(desc.readbackCount, 1u);
+        pCapture->mSlots.resize(slotCount);
+        for (uint32_t i = 0; i < slotCount; i++)
+        {
+            pCapture->mFreeSlots.push_back(slotCount - 1 - i);
+        }
+
+        pCapture->mThread = std::thread(&VideoCapture::encoderLoop, pCapture.get());
+        return pCapture;
+    }
+
+    VideoCapture::~VideoCapture()
+    {
+        endCapture();
+    }
+
+    void VideoCapture::retireReadbacks(bool wait)
+    {
+        // Readbacks complete in submission order, so we can stop at the first one which is still executing
+        while (mReadbacks.size())
+        {
+            Slot& slot = mSlots[mReadbacks.front()];
+            if (wait == false && slot.pTask->isComplete() == false) break;
+
+            EncodeRequest request;
+            request.slot = mReadbacks.front();
+            request.pData = slot.pTask->map();
+            request.rowPitch = slot.pTask->getRowPitch();
+            slot.mapped = true;
+            mReadbacks.pop_front();
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mQueue.push_back(request);
+                mStats.peakQueueDepth = std::max(mStats.peakQueueDepth, (uint32_t)mQueue.size());
+            }
+            mWorkAvailable.notify_one();
+        }
+    }
+
+    uint32_t VideoCapture::acquireSlot()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (mFreeSlots.empty() && mReleasedSlots.empty())
+        {
+            // All the buffers are either queued or being encoded. The readback limit guarantees that at least one of them is queued
+            mStats.encoderStalls++;
+            CpuTimer timer;
+            timer.update();
+            mSlotReleased.wait(lock, [this]() { return mReleasedSlots.size() != 0; });
+            timer.update();
+            mStats.stallTime += timer.getElapsedTime();
+        }
+
+        for (uint32_t i : mReleasedSlots)
+        {
+            mFreeSlots.push_back(i);
+        }
+        mReleasedSlots.clear();
+        lock.unlock();
+
+        uint32_t index = mFreeSlots.back();
+        mFreeSlots.pop_back();
+
+        Slot& slot = mSlots[index];
+        if (slot.mapped)
+        {
+            slot.pTask->unmap();
+            slot.mapped = false;
+        }
+        return index;
+    }
+
+    void VideoCapture::captureFrame(CopyContext* pCtx, const Texture* pTexture)
+    {
+        if (mpEncoder == nullptr) return;
+
+        retireReadbacks(false);
+        if (mReadbacks.size() >= mDesc.readbackCount)
+        {
+            // The GPU is behind. Wait for the oldest copy
+            CpuTimer timer;
+            timer.update();
+            mSlots[mReadbacks.front()].pTask->wait();
+            timer.update();
+
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStats.readbackStalls++;
+            mStats.stallTime += timer.getElapsedTime();
+        }
+        retireReadbacks(false);
+
+        uint32_t index = acquireSlot();
+        Slot& slot = mSlots[index];
+        Buffer::SharedPtr pStaging = slot.pTask ? slot.pTask->getBuffer() : nullptr;
+        slot.pTask = CopyContext::ReadTextureTask::create(pCtx, pTexture, 0, pStaging);
+        mReadbacks.push_back(index);
+
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStats.framesCaptured++;
+    }
+
+    void VideoCapture::encoderLoop()
+    {
+        while (true)
+        {
+            EncodeRequest request;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mWorkAvailable.wait(lock, [this]() { return mStop || mQueue.size(); });
+                if (mQueue.empty()) return;
+                request = mQueue.front();
+                mQueue.pop_front();
+            }
+
+            CpuTimer timer;
+            timer.update();
+            mpEncoder->appendFrame(request.pData, request.rowPitch);
+            timer.update();
+
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                mReleasedSlots.push_back(request.slot);
+                mStats.framesEncoded++;
+                mStats.encodeTime += timer.getElapsedTime();
+            }
+            mSlotReleased.notify_one();
+        }
+    }
+
+    void VideoCapture::endCapture()
+    {
+        if (mpEncoder == nullptr) return;
+
+        // Hand the remaining frames to the encoder, and let it drain the queue before stopping
+        retireReadbacks(true);
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+        mWorkAvailable.notify_one();
+        if (mThread.joinable()) mThread.join();
+
+        mpEncoder->endCapture();
+        mpEncoder = nullptr;
+
+        for (Slot& slot : mSlots)
+        {
+            if (slot.mapped) slot.pTask->unmap();
+        }
+        mSlots.clear();
+    }
+
+    VideoCapture::Stats VideoCapture::getStats() const
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        return mStats;
+    }
+}
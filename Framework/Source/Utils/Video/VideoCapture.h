@@ -0,0 +1,125 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#pragma once
+#include "VideoEncoder.h"
+#include "API/CopyContext.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace Falcor
+{
+    class Texture;
+
+    /** Captures rendered frames into a video file without stalling the render thread.
+        Each frame is copied into a readback buffer and the copy is submitted without waiting for the GPU. Once the copy has completed, the buffer is handed to an encoder thread which converts and encodes it.
+        The number of buffers is bounded. If the GPU or the encoder fall behind, captureFrame() blocks until a buffer becomes available, and the stall is recorded in the statistics.
+    */
+    class VideoCapture
+    {
+    public:
+        using UniquePtr = std::unique_ptr<VideoCapture>;
+
+        struct Desc
+        {
+            VideoEncoder::Desc encoderDesc;
+            uint32_t readbackCount = 3;     ///< The maximum number of frames whose copy might still be executing on the GPU
+            uint32_t queueSize = 4;         ///< The maximum number of frames waiting for the encoder
+        };
+
+        struct Stats
+        {
+            uint64_t framesCaptured = 0;
+            uint64_t framesEncoded = 0;
+            uint32_t peakQueueDepth = 0;    ///< The largest number of frames which were waiting for the encoder at the same time
+            uint64_t readbackStalls = 0;    ///< The number of times captureFrame() waited for the GPU to finish a copy
+            uint64_t encoderStalls = 0;     ///< The number of times captureFrame() waited for the encoder to release a buffer
+            double stallTime = 0;           ///< The total time in seconds captureFrame() spent waiting
+            double encodeTime = 0;          ///< The total time in seconds the encoder thread spent encoding
+        };
+
+        /** Create a new object. Starts the encoder thread
+            \return A new object, or nullptr if the encoder could not be created
+        */
+        static UniquePtr create(const Desc& desc);
+
+        /** Waits for all the captured frames to be encoded
+        */
+        ~VideoCapture();
+
+        /** Capture a frame. The texture must match the dimensions and format of the encoder desc
+            \param[in] pCtx The context to record the copy into
+            \param[in] pTexture The texture to capture
+        */
+        void captureFrame(CopyContext* pCtx, const Texture* pTexture);
+
+        /** Encode all the pending frames, stop the encoder thread and finalize the file
+        */
+        void endCapture();
+
+        /** Get the pipeline statistics
+        */
+        Stats getStats() const;
+
+    private:
+        VideoCapture(const Desc& desc) : mDesc(desc) {}
+
+        struct Slot
+        {
+            CopyContext::ReadTextureTask::SharedPtr pTask;
+            bool mapped = false;
+        };
+
+        struct EncodeRequest
+        {
+            uint32_t slot;
+            const uint8_t* pData;
+            uint32_t rowPitch;
+        };
+
+        void retireReadbacks(bool wait);
+        uint32_t acquireSlot();
+        void encoderLoop();
+
+        Desc mDesc;
+        VideoEncoder::UniquePtr mpEncoder;
+        std::vector<Slot> mSlots;
+        std::deque<uint32_t> mReadbacks;            // Slots whose copy was submitted, in capture order. Only accessed by the render thread
+        std::vector<uint32_t> mFreeSlots;           // Only accessed by the render thread
+
+        std::thread mThread;
+        mutable std::mutex mMutex;
+        std::condition_variable mWorkAvailable;
+        std::condition_variable mSlotReleased;
+        std::deque<EncodeRequest> mQueue;
+        std::vector<uint32_t> mReleasedSlots;       // Slots the encoder is done with. Returned to the free list by the render thread, which also unmaps them
+        bool mStop = false;
+        Stats mStats;
+    };
+}
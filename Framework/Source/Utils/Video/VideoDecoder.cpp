@@ -25,11 +25,10 @@
 # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 ***************************************************************************/
-#if 0
 #include "Framework.h"
 #include "VideoDecoder.h"
-#include "Utils/Platform/OS.h"
-#include "Utils/BinaryFileStream.h"
+#include "API/Device.h"
+#include "API/RenderContext.h"
 extern "C"
 {
 #include "libavcodec/avcodec.h"
@@ -37,19 +36,27 @@ extern "C"
 #include "libswscale/swscale.h"
 }
 
-#include <cstdio>
-
 namespace Falcor
 {
-    float VideoDecoder::rationalToFloat(const AVRational& r)
+    static const uint32_t kInvalidSlot = uint32_t(-1);
+
+    static bool error(const std::string& filename, const std::string& msg)
     {
-        return ((float)r.num / (float)r.den);
+        logError("Error when opening video file " + filename + ".\n" + msg);
+        return false;
+    }
+
+    static std::string getErrorString(int error)
+    {
+        char str[AV_ERROR_MAX_STRING_SIZE] = {};
+        av_strerror(error, str, arraysize(str));
+        return str;
     }
 
     VideoDecoder::UniquePtr VideoDecoder::create(const std::string& filename, uint32_t bufferedFrames, bool async)
     {
         auto pVideo = UniquePtr(new VideoDecoder());
-        if(pVideo->load(filename, bufferedFrames, async) == false)
+        if(pVideo->open(filename, bufferedFrames, async) == false)
         {
             pVideo = nullptr;
         }
@@ -57,282 +64,325 @@ namespace Falcor
         return pVideo;
     }
 
-    VideoDecoder::VideoDecoder()
+    VideoDecoder::~VideoDecoder()
     {
+        close();
     }
 
-    bool VideoDecoder::load(const std::string& filename, uint32_t bufferedFrames, bool async)
+    bool VideoDecoder::open(const std::string& filename, uint32_t bufferedFrames, bool async)
     {
         mFilename = filename;
-        mVidBufferCount = bufferedFrames;
-
-        if(async)
-        {
-            mAsyncDecoding = std::make_shared<std::future<void>>(std::async(std::launch::async, &VideoDecoder::bufferFrames, this));
-        }
-        else
-            bufferFrames();
 
-        return true;
-    }
+        // Register the codecs
+        av_register_all();
 
-    VideoDecoder::~VideoDecoder()
-    {
-        // Flush the async operation
-        if(mAsyncDecoding)
+        if(avformat_open_input(&mpFormatCtx, mFilename.c_str(), nullptr, nullptr) != 0)
         {
-            mAsyncDecoding->get();
+            return error(mFilename, "Can't open file.");
         }
 
-        av_free(mpFrame);
-
-        // Close the codec
-        avcodec_close(mpCodecCtx);
-        // Close the video file
-        avformat_close_input(&mpFormatCtx);
-
-        for(auto& tex : (*mFrameTextures))
-            if(tex) tex->evict(nullptr);
-    }
-
-    void FlipRGBFrame(AVFrame* pFrame, int H)
-    {
-        uint8_t* templine = new uint8_t[pFrame->linesize[0]];
-
-        int hby2 = H / 2;
-
-        for(int line = 0; line < hby2; line++)
+        if(avformat_find_stream_info(mpFormatCtx, nullptr) < 0)
         {
-            auto* line1 = pFrame->data[0] + (line)* pFrame->linesize[0];
-            auto* line2 = pFrame->data[0] + (H - 1 - line) * pFrame->linesize[0];
-
-            memcpy(templine, line1, pFrame->linesize[0]);
-            memcpy(line1, line2, pFrame->linesize[0]);
-            memcpy(line2, templine, pFrame->linesize[0]);
+            return error(mFilename, "Can't find stream information.");
         }
 
-        delete[] templine;
-    }
-
-    void VideoDecoder::bufferFrames()
-    {
-        if(mAsyncDecoding)
+        AVCodec* pCodec = nullptr;
+        mVideoStream = av_find_best_stream(mpFormatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, &pCodec, 0);
+        if(mVideoStream < 0 || pCodec == nullptr)
         {
-            setThreadPriority(getCurrentThread(), ThreadPriorityType::Low);
-            setThreadAffinity(getCurrentThread(), (1<<5)|(1<<6)|(1<<7)|(1<<8));
+            return error(mFilename, "Can't find a video stream with a supported codec.");
         }
+        AVStream* pStream = mpFormatCtx->streams[mVideoStream];
 
-        if(mpFrame)
+        mpCodecCtx = avcodec_alloc_context3(pCodec);
+        if(avcodec_parameters_to_context(mpCodecCtx, pStream->codecpar) < 0 || avcodec_open2(mpCodecCtx, pCodec, nullptr) < 0)
         {
-            av_free(mpFrame);
-            mpFrame = nullptr;
+            return error(mFilename, "Can't open video codec.");
         }
 
-        // Close the codec
-        if(mpCodecCtx)
+        mFPS = (float)av_q2d(pStream->avg_frame_rate);
+        if(mFPS <= 0) mFPS = (float)av_q2d(pStream->r_frame_rate);
+        if(mFPS <= 0) mFPS = 30;
+        mFrameCount = std::max<int64_t>(pStream->nb_frames, 0);
+        mWidth = mpCodecCtx->width;
+        mHeight = mpCodecCtx->height;
+
+        mpSwsCtx = sws_getContext(mWidth, mHeight, mpCodecCtx->pix_fmt, mWidth, mHeight, AV_PIX_FMT_RGBA, SWS_BILINEAR, nullptr, nullptr, nullptr);
+        mpFrame = av_frame_alloc();
+        mpPacket = av_packet_alloc();
+        if(mpSwsCtx == nullptr || mpFrame == nullptr || mpPacket == nullptr)
         {
-            avcodec_close(mpCodecCtx);
-            mpCodecCtx = nullptr;
+            return error(mFilename, "Can't allocate the decoder objects.");
         }
-        // Close the video file
-        if(mpFormatCtx)
+
+        // The ring is the only place decoded frames are stored
+        mRing.resize(std::max(bufferedFrames, 2u));
+        for(uint32_t i = 0; i < mRing.size(); i++)
         {
-            avformat_close_input(&mpFormatCtx);
-            mpFormatCtx = nullptr;
+            mRing[i].data.resize((size_t)mWidth * mHeight * 4);
+            mFree.push_back(i);
         }
+        mpTexture = Texture::create2D(mWidth, mHeight, ResourceFormat::RGBA8UnormSrgb, 1, 1, nullptr, Texture::BindFlags::ShaderResource);
 
-        // Register the codecs
-        avcodec_register_all();
-        av_register_all();
-
-        if(avformat_open_input(&mpFormatCtx, mFilename.c_str(), NULL, NULL) != 0)
+        mAsync = async;
+        if(mAsync)
         {
-            printf("Cannot open file\n");
-            return;
+            mThread = std::thread(&VideoDecoder::decoderLoop, this);
         }
+        return true;
+    }
 
-        if(avformat_find_stream_info(mpFormatCtx, NULL) < 0)
+    void VideoDecoder::close()
+    {
         {
-            printf("Couldn't find stream information.\n");
-            return;
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
         }
+        mFrameReleased.notify_all();
+        if(mThread.joinable()) mThread.join();
+
+        sws_freeContext(mpSwsCtx);
+        mpSwsCtx = nullptr;
+        av_packet_free(&mpPacket);
+        av_frame_free(&mpFrame);
+        avcodec_free_context(&mpCodecCtx);
+        avformat_close_input(&mpFormatCtx);
+    }
 
-        for(uint32_t i = 0; i < mpFormatCtx->nb_streams; i++)
+    int VideoDecoder::receiveFrame()
+    {
+        while(true)
         {
-            auto& stream = mpFormatCtx->streams[i];
-            if(stream->codec->codec_type == AVMEDIA_TYPE_VIDEO)
+            int r = avcodec_receive_frame(mpCodecCtx, mpFrame);
+            if(r != AVERROR(EAGAIN)) return r;  // A frame, the end of the stream or a decoding error
+
+            // The decoder needs more data
+            r = av_read_frame(mpFormatCtx, mpPacket);
+            if(r == AVERROR_EOF)
             {
-                mVideoStream = i;
-                break;
+                // No more packets. Enter draining mode, the decoder will return the frames it still holds
+                avcodec_send_packet(mpCodecCtx, nullptr);
+                continue;
             }
-        }
+            if(r < 0) return r;
 
-        if(mVideoStream == -1)
-        {
-            return;
+            if(mpPacket->stream_index == mVideoStream)
+            {
+                // A corrupted packet only affects the frames which depend on it. Skip it and keep decoding
+                r = avcodec_send_packet(mpCodecCtx, mpPacket);
+                if(r < 0) logWarning("Skipping a corrupted packet in video file " + mFilename + ". " + getErrorString(r));
+            }
+            av_packet_unref(mpPacket);
         }
+    }
 
-        auto& stream = mpFormatCtx->streams[mVideoStream];
-
-        // Get a pointer to the codec context for the video stream
-        mpCodecCtxOrig = stream->codec;
+    void VideoDecoder::seek(int64_t frameIndex)
+    {
+        AVStream* pStream = mpFormatCtx->streams[mVideoStream];
+        int64_t startTime = (pStream->start_time == AV_NOPTS_VALUE) ? 0 : pStream->start_time;
+        int64_t timestamp = startTime + (int64_t)((double)frameIndex / mFPS / av_q2d(pStream->time_base));
+
+        // Seek to the key-frame before the target and decode forward from there
+        av_seek_frame(mpFormatCtx, mVideoStream, timestamp, AVSEEK_FLAG_BACKWARD);
+        avcodec_flush_buffers(mpCodecCtx);
+        mSkipUntil = frameIndex;
+        mLastIndex = frameIndex - 1;
+    }
 
-        mFPS = rationalToFloat(stream->avg_frame_rate);
+    int64_t VideoDecoder::getFrameIndex() const
+    {
+        int64_t pts = mpFrame->best_effort_timestamp;
+        if(pts == AV_NOPTS_VALUE) return mLastIndex + 1;
 
-        // Find the decoder for the video stream
-        mpCodec = avcodec_find_decoder(mpCodecCtxOrig->codec_id);
+        AVStream* pStream = mpFormatCtx->streams[mVideoStream];
+        int64_t startTime = (pStream->start_time == AV_NOPTS_VALUE) ? 0 : pStream->start_time;
+        return llround((double)(pts - startTime) * av_q2d(pStream->time_base) * mFPS);
+    }
 
-        if(mpCodec == NULL)
+    bool VideoDecoder::decodeFrame(Frame& frame)
+    {
+        bool restarted = false;
+        while(true)
         {
-            printf("Unsupported codec!\n");
-            return; // Codec not found
-        }
+            int r = receiveFrame();
+            if(r < 0 && r != AVERROR_EOF)
+            {
+                logError("Error when decoding video file " + mFilename + ". " + getErrorString(r));
+                return false;
+            }
 
-        // Copy context
-        mpCodecCtx = avcodec_alloc_context3(mpCodec);
-        if(avcodec_copy_context(mpCodecCtx, mpCodecCtxOrig) != 0)
-        {
-            printf("Couldn't copy codec context\n");
-            return; // Error copying codec context
+            if(r == AVERROR_EOF)
+            {
+                // Reached the end of the file. Restart from the beginning, unless the file has no frames we can decode
+                if(restarted)
+                {
+                    logError("Video file " + mFilename + " doesn't contain any frame which can be decoded");
+                    return false;
+                }
+                if(mEndIndex == 0) mEndIndex = mLastIndex + 1;
+                seek(0);
+                restarted = true;
+                continue;
+            }
+            restarted = false;
+
+            int64_t index = getFrameIndex();
+            mLastIndex = index;
+            if(index < mSkipUntil) continue;
+
+            // Convert the image from its native format to RGBA. The destination is walked bottom->top, which flips the image
+            uint32_t rowPitch = mWidth * 4;
+            uint8_t* dst[AV_NUM_DATA_POINTERS] = { frame.data.data() + (size_t)(mHeight - 1) * rowPitch };
+            int32_t dstPitch[AV_NUM_DATA_POINTERS] = { -(int32_t)rowPitch };
+            sws_scale(mpSwsCtx, mpFrame->data, mpFrame->linesize, 0, mHeight, dst, dstPitch);
+            frame.index = index;
+            return true;
         }
+    }
 
-        // Open codec
-        if(avcodec_open2(mpCodecCtx, mpCodec, nullptr) < 0)
+    void VideoDecoder::decodeNext(std::unique_lock<std::mutex>& lock)
+    {
+        if(mSeekTarget >= 0)
         {
-            return; // Could not open codec
+            int64_t target = mSeekTarget;
+            mSeekTarget = -1;
+            lock.unlock();
+            seek(target);
+            lock.lock();
+            return;
         }
 
-        // Allocate video frame
-        mpFrame = av_frame_alloc();
-
-
-        mFrames.clear();
-        mFrames.reserve(mVidBufferCount);
-
-        const bool async = mAsyncDecoding != nullptr;
+        assert(mFree.size());
+        uint32_t slot = mFree.back();
+        mFree.pop_back();
 
-        //printf("Buffering frames...\n");
-        uint32_t frameIdx = 0;
+        lock.unlock();
+        bool decoded = decodeFrame(mRing[slot]);
+        lock.lock();
 
-        SwsContext *sws_ctx = sws_getContext(
-            mpCodecCtx->width, mpCodecCtx->height, mpCodecCtx->pix_fmt,
-            mpCodecCtx->width, mpCodecCtx->height, PIX_FMT_RGBA, SWS_BILINEAR, NULL, NULL, NULL);
+        if(mFrameCount == 0 && mEndIndex > 0) mFrameCount = mEndIndex;
 
-        AVPacket packet;
-        while(av_read_frame(mpFormatCtx, &packet) >= 0 && (frameIdx < mVidBufferCount))
+        if(decoded == false)
         {
-            if(packet.stream_index == mVideoStream)
-            {
-                int32_t isFrameDone;
-                avcodec_decode_video2(mpCodecCtx, mpFrame, &isFrameDone, &packet);
-                if(isFrameDone)
-                {
-                    // Create either a single frame, or all frames one-by-one on CPU
-                    if(async || mFrames.empty())
-                    {
-                        // Inplace construction to avoid releasing of arrays
-                        mFrames.push_back(Frame());
-                        new(&mFrames.back()) Frame(mpCodecCtx);
-                    }
-                    Frame& frame = mFrames.back();
-
-                    // Convert the image from its native format to RGB
-                    sws_scale(sws_ctx, (uint8_t const * const *)mpFrame->data, mpFrame->linesize, 0, mpCodecCtx->height, frame.mpFrameRGB->data, frame.mpFrameRGB->linesize);
-                    FlipRGBFrame(frame.mpFrameRGB, mpCodecCtx->height);
-                    if(!async)
-                        uploadToGPU(frameIdx);
-
-                    frameIdx++;
-                }
-            }
-            av_free_packet(&packet);
+            // decodeFrame() logged the error
+            mError = true;
+            mFree.push_back(slot);
         }
-        //printf("Done reading %d frames\n", frameIdx);
-
-        mRealFrameCount = frameIdx;
-    }
-
-    void VideoDecoder::uploadToGPU(int frameStart)
-    {
-        if(!mFrameTextures)
-            mFrameTextures = std::make_shared<TexturePool>();
-        for(size_t i=0;i<mFrames.size();++i)
+        else if(mSeekTarget >= 0)
         {
-            auto& frame = mFrames[i];
-            if(frameStart + i >= mFrameTextures->size())
-            {
-                mFrameTextures->push_back(Texture::create2D(mpCodecCtx->width, mpCodecCtx->height, ResourceFormat::RGBA8UnormSrgb, 1, 1, frame.mpFrameRGB->data[0]));
-                mFrameTextures->back()->makeResident(nullptr);
-            }
-            else
-            {
-                (*mFrameTextures)[frameStart + i]->uploadSubresourceData(frame.mpFrameRGB->data[0], frame.mFrameSize);
-            }
+            // A seek was requested while we were decoding, the frame is no longer needed
+            mFree.push_back(slot);
         }
-        mFrames.clear();
+        else
+        {
+            mReady.push_back(slot);
+            mNextIndex = mRing[slot].index + 1;
+            if(mFrameCount > 0) mNextIndex %= mFrameCount;
+        }
+        mFrameReady.notify_all();
     }
 
-    Texture::SharedPtr VideoDecoder::getTextureForNextFrame(float curTime)
+    void VideoDecoder::decoderLoop()
     {
-        // Flush the async operation, upload everything to video memory
-        if(mAsyncDecoding)
+        std::unique_lock<std::mutex> lock(mMutex);
+        while(true)
         {
-            mAsyncDecoding->get();
-            mAsyncDecoding.reset();
-            uploadToGPU();
+            mFrameReleased.wait(lock, [this]() { return mStop || mSeekTarget >= 0 || (mFree.size() && mError == false); });
+            if(mStop) return;
+            decodeNext(lock);
         }
-        int curFrame = ((int)floor(curTime * mFPS)) % mRealFrameCount;
-        //SetBufferToTexture(m_VidBuffers[curFrame]);
-        //printf("time, frame: %f, %d\n", curTime, curFrame);
-        return (*mFrameTextures)[curFrame];
     }
 
-    float VideoDecoder::getDuration()
+    int64_t VideoDecoder::getDistance(int64_t from, int64_t to) const
     {
-        // Flush the async operation, upload everything to video memory
-        if(mAsyncDecoding)
+        // The number of frames to decode to get from one frame to the other. Negative if the frame count isn't known yet and we need to go backwards
+        int64_t d = to - from;
+        if(mFrameCount > 0)
         {
-            mAsyncDecoding->get();
-            mAsyncDecoding.reset();
-            uploadToGPU();
+            d %= mFrameCount;
+            if(d < 0) d += mFrameCount;
         }
-
-        return ((float)mRealFrameCount) / mFPS;
+        return d;
     }
 
-    VideoDecoder::TexturePoolPtr VideoDecoder::getTexturePool()
+    uint32_t VideoDecoder::acquireFrame(int64_t frameIndex, std::unique_lock<std::mutex>& lock)
     {
-        return mFrameTextures;
-    }
+        // Decoding forward is cheaper than seeking, as long as the target is close
+        const int64_t maxSkip = std::max<int64_t>((int64_t)mRing.size() * 2, (int64_t)mFPS);
+        auto isClose = [maxSkip](int64_t d) { return d >= 0 && d <= maxSkip; };
 
-    void VideoDecoder::setTexturePool(TexturePoolPtr& texturePool)
-    {
-        mFrameTextures = texturePool;
-    }
+        while(true)
+        {
+            if(mError) return kInvalidSlot;
 
-    VideoDecoder::Frame::Frame(AVCodecContext* codec)
-    {
-        mFrameSize = avpicture_get_size(PIX_FMT_RGBA, codec->width, codec->height);
+            while(mReady.size())
+            {
+                uint32_t slot = mReady.front();
+                int64_t index = mRing[slot].index;
+                if(index == frameIndex || isClose(getDistance(frameIndex, index)))
+                {
+                    // Either the frame we want, or the frame which follows it if the target wasn't in the stream
+                    mReady.pop_front();
+                    return slot;
+                }
+                if(isClose(getDistance(index, frameIndex)) == false) break;
 
-        // Allocate an AVFrame structure
-        mpFrameRGB = av_frame_alloc();
-        if(mpFrameRGB == NULL)
-        {
-            printf("Cannot allocate frame. Possibly out of CPU memory!\n");
-            return;
+                // The frame is older than the target
+                mReady.pop_front();
+                mFree.push_back(slot);
+                mFrameReleased.notify_one();
+            }
+
+            if(mReady.empty() && (isClose(getDistance(mNextIndex, frameIndex)) || isClose(getDistance(frameIndex, mNextIndex))))
+            {
+                // The decoder will reach the target soon
+                if(mAsync) mFrameReady.wait(lock);
+                else decodeNext(lock);
+                continue;
+            }
+
+            // Seek. The buffered frames are useless
+            for(uint32_t slot : mReady) mFree.push_back(slot);
+            mReady.clear();
+            mSeekTarget = frameIndex;
+            mNextIndex = frameIndex;
+            if(mAsync)
+            {
+                mFrameReleased.notify_one();
+                mFrameReady.wait(lock);
+            }
+            else
+            {
+                decodeNext(lock);
+            }
         }
-        mCpuVidBuffer = (uint8_t*)av_malloc(mFrameSize*sizeof(uint8_t));
+    }
 
-        avpicture_fill((AVPicture *)mpFrameRGB, mCpuVidBuffer, PIX_FMT_RGBA, codec->width, codec->height);
-        //printf("frame size is %d Mbytes\n", mFrameSize / (1024 * 1024));
+    Texture::SharedPtr VideoDecoder::getTextureForNextFrame(float curTime)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        int64_t frameIndex = std::max<int64_t>((int64_t)floor(curTime * mFPS), 0);
+        if(mFrameCount > 0) frameIndex %= mFrameCount;
+        if(frameIndex == mTextureFrame) return mpTexture;
+
+        uint32_t slot = acquireFrame(frameIndex, lock);
+        if(slot == kInvalidSlot) return mpTexture;
+
+        // The decoder doesn't touch frames which are not in the free list, so we can upload without holding the lock
+        lock.unlock();
+        gpDevice->getRenderContext()->updateTexture(mpTexture.get(), mRing[slot].data.data());
+        lock.lock();
+
+        mTextureFrame = frameIndex;
+        mFree.push_back(slot);
+        mFrameReleased.notify_one();
+        return mpTexture;
     }
 
-    VideoDecoder::Frame::~Frame()
+    float VideoDecoder::getDuration() const
     {
-        if(mCpuVidBuffer)
-            av_free(mCpuVidBuffer);
-        if(mpFrameRGB)
-            av_free(mpFrameRGB);
+        std::lock_guard<std::mutex> lock(mMutex);
+        if(mFrameCount > 0) return (float)mFrameCount / mFPS;
+        return (float)mpFormatCtx->duration / (float)AV_TIME_BASE;
     }
 }
-#endif
\ No newline at end of file
@@ -27,23 +27,23 @@
 ***************************************************************************/
 #pragma once
 #include <string>
-#include <future>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 #include "API/Texture.h"
 
 struct AVFormatContext;
-struct AVStream;
 struct AVFrame;
-struct AVPicture;
+struct AVPacket;
 struct SwsContext;
 struct AVCodecContext;
-struct AVCodec;
-struct AVRational;
 
 namespace Falcor
 {        
-    /** Simple video decoder for high-framerate and high-resolution
-        playback of rendered videos. Currently decodes the first N frames
-        as textures before playing.
+    /** Streaming video decoder for high-framerate and high-resolution playback of rendered videos.
+        Frames are decoded ahead into a small ring of CPU buffers, so memory usage doesn't depend on the length of the clip.
+        Playback loops. Jumping backwards, or too far ahead, seeks to the nearest key-frame and decodes forward from there.
     */
     class VideoDecoder
     {
@@ -51,83 +51,85 @@ namespace Falcor
         using UniquePtr = std::unique_ptr<VideoDecoder>;
         using UniqueConstPtr = std::unique_ptr<const VideoDecoder>;
 
-        typedef std::vector<Texture::SharedPtr> TexturePool;
-        typedef std::shared_ptr<TexturePool> TexturePoolPtr;
-
         /** Create a new VideoDecoder object
             \param[in] filename Input video file (with path)
-            \param[in] bufferFrames The maximum number of input frames to buffer as Texture objects. Default is 300.
-            \param[in] async Whether load operation should happen asynchronously
+            \param[in] bufferedFrames The number of decoded frames to keep in the ring. Default is 8.
+            \param[in] async Whether to decode ahead on a worker thread. If false, frames are decoded on demand by getTextureForNextFrame()
         */
-        static UniquePtr create(const std::string& filename, uint32_t bufferedFrames = 300, bool async = false);
+        static UniquePtr create(const std::string& filename, uint32_t bufferedFrames = 8, bool async = true);
         ~VideoDecoder();
 
-        /** Get a texture object for the frame at current time
+        /** Get a texture object for the frame at current time. The same texture is returned for every frame, only its content changes
             \param[in] curTime Time for which frame is sought
             \return Texture pointer to texture object
         */
         Texture::SharedPtr getTextureForNextFrame(float curTime);
 
-        /** Return duration of video loaded (in seconds).
-            This uses the actual number of frames. Only makes sense
-            for videos shorter than the requested frame count.
-            \return Duration of video loaded in seconds.
-        */
-        float getDuration();
-
-        /** Returns reusable shared texture pool
+        /** Return duration of the video (in seconds)
         */
-        TexturePoolPtr getTexturePool();
+        float getDuration() const;
 
-        /** Sets reusable shared texture pool
-        */
-        void setTexturePool(TexturePoolPtr& texturePool);
-
-        /** Opens a file
-            \param[in] filename Input video file (with path)
-            \param[in] bufferFrames The maximum number of input frames to buffer as Texture objects. Default is 300.
-            \param[in] async Whether load operation should happen asynchronously
+        /** Get the number of frames per second
         */
-        bool load(const std::string& filename, uint32_t bufferedFrames, bool async);
+        float getFrameRate() const { return mFPS; }
 
     private:
-        /** Holds a single video frame on CPU
+        /** A decoded frame. The rows are stored bottom->top
         */
         struct Frame
         {
-            Frame() {}
-            Frame(AVCodecContext* codec);
-            ~Frame();
-            AVFrame*    mpFrameRGB = nullptr;
-            uint8_t*    mCpuVidBuffer = nullptr;
-            int         mFrameSize = 0;
+            int64_t index = -1;
+            std::vector<uint8_t> data;
         };
 
-        VideoDecoder();
+        VideoDecoder() = default;
+        bool open(const std::string& filename, uint32_t bufferedFrames, bool async);
+        void close();
 
-        void uploadToGPU(int frameStart = 0);
+        // Decoder state. Only accessed by the thread which decodes
+        bool decodeFrame(Frame& frame);
+        int receiveFrame();     // Returns 0 if a frame was decoded, AVERROR_EOF at the end of the file, or a negative FFmpeg error code
+        void seek(int64_t frameIndex);
+        int64_t getFrameIndex() const;
 
-        std::string mFilename;
-
-        AVFormatContext*                        mpFormatCtx       = nullptr;
-        AVCodecContext*                         mpCodecCtxOrig    = nullptr;
-        AVCodecContext*                         mpCodecCtx        = nullptr;
-        AVCodec*                                mpCodec           = nullptr;
-        AVFrame*                                mpFrame           = nullptr;
-        std::vector<Frame>                      mFrames;
-
-        float                                   mFPS              = 30;
-        bool                                    mFlipY            = true;
-        unsigned                                mVideoStream      = -1;
-        uint32_t                                mVidBufferCount   = 300;
-        uint32_t                                mRealFrameCount = 0;
+        // Ring management. Must be called with the mutex locked
+        void decodeNext(std::unique_lock<std::mutex>& lock);
+        int64_t getDistance(int64_t from, int64_t to) const;
+        uint32_t acquireFrame(int64_t frameIndex, std::unique_lock<std::mutex>& lock);
+        void decoderLoop();
 
-        std::shared_ptr<std::future<void>>        mAsyncDecoding = nullptr;
-
-        TexturePoolPtr                          mFrameTextures;
+        std::string mFilename;
 
-        // helper routines
-        void  bufferFrames();
-        float rationalToFloat(const AVRational& r);
+        AVFormatContext*    mpFormatCtx = nullptr;
+        AVCodecContext*     mpCodecCtx = nullptr;
+        AVFrame*            mpFrame = nullptr;
+        AVPacket*           mpPacket = nullptr;
+        SwsContext*         mpSwsCtx = nullptr;
+
+        int                 mVideoStream = -1;
+        float               mFPS = 30;
+        uint32_t            mWidth = 0;
+        uint32_t            mHeight = 0;
+        int64_t             mLastIndex = -1;        // The index of the last decoded frame
+        int64_t             mSkipUntil = 0;         // Frames before this index are dropped without being converted. Used after seeking
+        int64_t             mEndIndex = 0;          // The number of frames in the file, once the decoder reached the end
+
+        std::vector<Frame>  mRing;
+        std::deque<uint32_t> mReady;                // Decoded frames, in decode order
+        std::vector<uint32_t> mFree;
+        int64_t             mFrameCount = 0;        // 0 until known. Read from the stream header, or discovered when reaching the end of the file
+        int64_t             mNextIndex = 0;         // The index of the next frame which will be decoded
+        int64_t             mSeekTarget = -1;
+        bool                mError = false;
+
+        bool                mAsync = true;
+        bool                mStop = false;
+        std::thread         mThread;
+        mutable std::mutex  mMutex;
+        std::condition_variable mFrameReady;
+        std::condition_variable mFrameReleased;
+
+        Texture::SharedPtr  mpTexture;
+        int64_t             mTextureFrame = -1;
     };
-}
\ No newline at end of file
+}
@@ -28,16 +28,21 @@
 #include "Framework.h"
 #include "VideoEncoder.h"
 #include "Utils/BinaryFileStream.h"
+#include "Utils/Threading.h"
 
 extern "C"
 {
 #include "libavcodec/avcodec.h"
 #include "libavformat/avformat.h"
+#include "libavutil/pixdesc.h"
 #include "libswscale/swscale.h"
 }
 
 namespace Falcor
 {
+    // Smaller bands don't have enough work to amortize the dispatch
+    static const uint32_t kMinConversionBandHeight = 64;
+
     AVPixelFormat getPictureFormatFromCodec(AVCodecID codec)
     {
         switch(codec)
@@ -284,16 +289,26 @@ namespace Falcor
 
         mFormat = desc.format;
         mRowPitch = getFormatBytesPerBlock(desc.format) * desc.width;
-        if(desc.flipY)
-        {
-            mpFlippedImage = new uint8_t[desc.height * mRowPitch];
-        }
+        mFlipY = desc.flipY;
+
+        // The conversion doesn't scale, so the image can be split into bands which are converted independently. Bands must start on a chroma row
+        const AVPixFmtDescriptor* pPixDesc = av_pix_fmt_desc_get(mpCodecContext->pix_fmt);
+        mChromaShiftY = pPixDesc ? pPixDesc->log2_chroma_h : 0;
+        uint32_t bandCount = std::max(1u, std::min(desc.height / kMinConversionBandHeight, Threading::getThreadCount() + 1));
+        uint32_t rowsPerBand = align_to(1u << mChromaShiftY, (desc.height + bandCount - 1) / bandCount);
 
-        mpSwsContext = sws_getContext(desc.width, desc.height, getPictureFormatFromFalcorFormat(desc.format), desc.width, desc.height, mpCodecContext->pix_fmt, SWS_POINT, nullptr, nullptr, nullptr);
-        if(mpSwsContext == nullptr)
+        for(uint32_t y = 0; y < desc.height; y += rowsPerBand)
         {
-            return error(mFilename, "Failed to allocate SWScale context");
+            uint32_t bandHeight = std::min(rowsPerBand, desc.height - y);
+            SwsContext* pSwsContext = sws_getContext(desc.width, bandHeight, getPictureFormatFromFalcorFormat(desc.format), desc.width, bandHeight, mpCodecContext->pix_fmt, SWS_POINT, nullptr, nullptr, nullptr);
+            if(pSwsContext == nullptr)
+            {
+                return error(mFilename, "Failed to allocate SWScale context");
+            }
+            mSwsContexts.push_back(pSwsContext);
+            mBandStart.push_back(y);
         }
+        mBandStart.push_back(desc.height);
         return true;
     }
 
@@ -343,36 +358,69 @@ namespace Falcor
             avio_closep(&mpOutputContext->pb);
             avcodec_free_context(&mpCodecContext);
             av_frame_free(&mpFrame);
-            sws_freeContext(mpSwsContext);
             avformat_free_context(mpOutputContext);
             mpOutputContext = nullptr;
             mpOutputStream = nullptr;
         }
-        safe_delete(mpFlippedImage)
+
+        for(SwsContext* pSwsContext : mSwsContexts)
+        {
+            sws_freeContext(pSwsContext);
+        }
+        mSwsContexts.clear();
+        mBandStart.clear();
     }
 
-    void VideoEncoder::appendFrame(const void* pData)
+    void VideoEncoder::convertBand(uint32_t band, const uint8_t* pData, uint32_t rowPitch)
     {
-        if(mpFlippedImage)
+        uint32_t firstRow = mBandStart[band];
+        uint32_t rowCount = mBandStart[band + 1] - firstRow;
+
+        const uint8_t* src[AV_NUM_DATA_POINTERS] = {0};
+        int32_t srcPitch[AV_NUM_DATA_POINTERS] = {0};
+        if(mFlipY)
         {
-            // Flip the image
-            for(int32_t h = 0; h < mpCodecContext->height; h++)
-            {
-                const uint8_t* pSrc = (uint8_t*)pData + h * mRowPitch;
-                uint8_t* pDst = mpFlippedImage + (mpCodecContext->height - 1 - h) * mRowPitch;
-                memcpy(pDst, pSrc, mRowPitch);
-            }
+            // Walk the source bottom->top
+            src[0] = pData + (size_t)(mpCodecContext->height - 1 - firstRow) * rowPitch;
+            srcPitch[0] = -(int32_t)rowPitch;
+        }
+        else
+        {
+            src[0] = pData + (size_t)firstRow * rowPitch;
+            srcPitch[0] = (int32_t)rowPitch;
+        }
 
-            pData = mpFlippedImage;
+        uint8_t* dst[AV_NUM_DATA_POINTERS] = {0};
+        for(uint32_t p = 0; p < AV_NUM_DATA_POINTERS && mpFrame->data[p]; p++)
+        {
+            // Planes 1 and 2 are the chroma planes, which might be vertically subsampled
+            uint32_t planeRow = (p == 1 || p == 2) ? (firstRow >> mChromaShiftY) : firstRow;
+            dst[p] = mpFrame->data[p] + (size_t)planeRow * mpFrame->linesize[p];
         }
 
-        uint8_t* src[AV_NUM_DATA_POINTERS] = {0};
-        int32_t rowPitch[AV_NUM_DATA_POINTERS] = {0};
-        src[0] = (uint8_t*)pData;
-        rowPitch[0] = (int32_t)mRowPitch;
+        sws_scale(mSwsContexts[band], src, srcPitch, 0, rowCount, dst, mpFrame->linesize);
+    }
 
-        // Scale and convert the image
-        sws_scale(mpSwsContext, src, rowPitch, 0, mpCodecContext->height, mpFrame->data, mpFrame->linesize);
+    void VideoEncoder::appendFrame(const void* pData, uint32_t rowPitch)
+    {
+        if(rowPitch == 0) rowPitch = mRowPitch;
+
+        // The codec might still reference the previous frame's buffers
+        if(av_frame_make_writable(mpFrame) < 0)
+        {
+            error(mFilename, "Can't make the video frame writable");
+            return;
+        }
+
+        // Convert the image
+        uint32_t bandCount = (uint32_t)mSwsContexts.size();
+        Threading::parallelFor(bandCount, bandCount, [this, pData, rowPitch](uint32_t begin, uint32_t end, uint32_t chunkIndex)
+        {
+            for(uint32_t band = begin; band < end; band++)
+            {
+                convertBand(band, (const uint8_t*)pData, rowPitch);
+            }
+        });
 
         // Encode the frame
         int r = avcodec_send_frame(mpCodecContext, mpFrame);
@@ -27,6 +27,7 @@
 ***************************************************************************/
 #pragma once
 #include <string>
+#include <vector>
 
 struct AVFormatContext;
 struct AVStream;
@@ -67,7 +68,12 @@ namespace Falcor
         ~VideoEncoder();
 
         static UniquePtr create(const Desc& desc);
-        void appendFrame(const void* pData);
+
+        /** Convert and encode a frame. The color conversion is split into horizontal bands which are processed in parallel
+            \param[in] pData The image data, in the format specified in the Desc
+            \param[in] rowPitch The distance in bytes between rows. If 0, the rows are assumed to be tightly packed
+        */
+        void appendFrame(const void* pData, uint32_t rowPitch = 0);
         void endCapture();
 
         static const std::string getSupportedContainerForCodec(CodecID codec);
@@ -75,15 +81,20 @@ namespace Falcor
         VideoEncoder(const std::string& filename);
         bool init(const Desc& desc);
 
+        void convertBand(uint32_t band, const uint8_t* pData, uint32_t rowPitch);
+
         AVFormatContext* mpOutputContext = nullptr;
         AVStream*        mpOutputStream  = nullptr;
         AVFrame*         mpFrame         = nullptr;
-        SwsContext*      mpSwsContext    = nullptr;
         AVCodecContext*  mpCodecContext = nullptr;
 
+        std::vector<SwsContext*> mSwsContexts;  // One context per band
+        std::vector<uint32_t> mBandStart;       // The first row of each band. Has an extra element which holds the image height
+
         const std::string mFilename;
         ResourceFormat mFormat;
         uint32_t mRowPitch = 0;
-        uint8_t* mpFlippedImage = nullptr; // Used in case the image memory layout if bottom->top
+        uint32_t mChromaShiftY = 0;
+        bool mFlipY = false;                    // The image memory layout is bottom->top. The flip is done by the conversion, using a negative source pitch
     };
 }
\ No newline at end of file
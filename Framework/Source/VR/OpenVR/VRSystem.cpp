@@ -74,6 +74,8 @@ namespace Falcor
     {
         return vr::TextureType_Vulkan;
     }
+#elif defined FALCOR_NULL
+    // There is no API resource to hand to the compositor, submit() always fails
 #else
 #error VRSystem doesnt support the selected API backend
 #endif
@@ -407,7 +409,9 @@ namespace Falcor
     bool VRSystem::submit(VRDisplay::Eye whichEye, const Texture::SharedConstPtr& pDisplayTex, RenderContext* pRenderCtx)
     {
         if (!mpCompositor) return false;
-
+#ifdef FALCOR_NULL
+        return false;
+#else
         auto submitTex = prepareSubmitData(pDisplayTex, pRenderCtx);
         vr::Texture_t subTex;
         subTex.eType = getVrTextureType();
@@ -416,6 +420,7 @@ namespace Falcor
 
         mpCompositor->Submit((whichEye == VRDisplay::Eye::Right) ? vr::Eye_Right : vr::Eye_Left, &subTex, NULL);
         return true;
+#endif
     }
 
 
@@ -118,8 +118,8 @@ void LiveTrainRenderer::doPythonInit()
 
 void LiveTrainRenderer::doPythonTrain( Texture::SharedPtr fromTex )
 {
-    // Extract a our image data from the DX context.
-    std::vector<uint8> textureData = gpDevice->getRenderContext()->readTextureSubresource(fromTex.get(), fromTex->getSubresourceIndex(0, 0));
+    // Read back our image data.  Python references the readback buffer directly, without copying it into a vector first.
+    auto pReadback = gpDevice->getRenderContext()->asyncReadTextureSubresource(fromTex.get(), fromTex->getSubresourceIndex(0, 0));
 
     // Get our scene's light direction
     Light* pLight = mpScene->getScene()->getLight(0).get();
@@ -131,9 +131,7 @@ void LiveTrainRenderer::doPythonTrain( Texture::SharedPtr fromTex )
     // Pass Python information about our rendered image (used as the target/output for this training run on the network)
     mGlobals["imgW"] = 512;
     mGlobals["imgH"] = 512;
-    mGlobals["imgData"] = py::array_t<unsigned char>( { 512, 512, 4 },                                                                       // Shape of the array
-                                                      { 512 * 4 * sizeof(unsigned char), 4 * sizeof(unsigned char), sizeof(unsigned char) }, // data stride
-                                                      textureData.data());  // raw buffer data (w*h*4 array of uchars)
+    mGlobals["imgData"] = PythonEmbedding::toNumpy(pReadback, fromTex->getFormat());  // A (h, w, 4) array of uchars
 
     // If Python successfully transforms the input data into the NumPy arrays needed for the model training....
     mLastTrainTime = executeStringAndSetFlags( mPythonTrain );
@@ -156,12 +154,9 @@ void LiveTrainRenderer::doPythonInference()
     mLastInferenceTime = executeStringAndSetFlags(mPythonInfer);
     if (mLastInferenceTime >= 0.0f)
     {
-        // Readback the data.  Cast our Python output to an uchar array
-        auto arr = mGlobals["infResult"].cast< py::array_t<unsigned char> >();
-        py::buffer_info arr_info = arr.request();
-
         // Upload the Python uchar array into our texture (so we can render the result)
-        gpDevice->getRenderContext()->updateTextureSubresource(mPythonReturnTexture.get(), mPythonReturnTexture->getSubresourceIndex(0, 0), arr_info.ptr);
+        auto arr = mGlobals["infResult"].cast< py::array_t<unsigned char> >();
+        PythonEmbedding::uploadToTexture(gpDevice->getRenderContext().get(), mPythonReturnTexture.get(), arr);
     }
 
     mDoInference = false;
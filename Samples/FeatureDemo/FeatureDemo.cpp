@@ -582,6 +582,13 @@ void FeatureDemo::onInitializeTesting()
     {
         mpSceneRenderer->getScene()->getActiveCamera()->setTarget(glm::vec3(cameraTarget[0].asFloat(), cameraTarget[1].asFloat(), cameraTarget[2].asFloat()));
     }
+
+    if (isBenchmarking() && mpSceneRenderer)
+    {
+        // Follow the scene's camera path, so that every benchmark run renders the same views
+        mUseCameraPath = true;
+        applyCameraPathState();
+    }
 }
 
 #ifdef _WIN32
@@ -0,0 +1,354 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "BinarySceneFileTest.h"
+#include "Externals/RapidJson/include/rapidjson/stringbuffer.h"
+#include "Externals/RapidJson/include/rapidjson/writer.h"
+#include "Externals/RapidJson/include/rapidjson/prettywriter.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+void BinarySceneFileTest::addTests()
+{
+    addTestToList<TestRoundTrip>();
+    addTestToList<TestPackedInstances>();
+    addTestToList<TestCorruptFile>();
+    addTestToList<TestCorruptTree>();
+    addTestToList<TestLoadBenchmark>();
+}
+
+// The first model's instances can be packed. The second one has a value which isn't representable as a float, so it must be stored as a regular array
+static const char* kTestScene = R"({
+    "version": 2,
+    "camera_speed": 1.5,
+    "models": [
+        {
+            "file": "Arcade/Arcade.fbx",
+            "name": "Arcade",
+            "instances": [
+                { "name": "Arcade 0", "translation": [0, 1, -2], "scaling": [1, 1, 1], "rotation": [0.5, 90, 0] },
+                { "rotation": [0, 0, 0], "name": "Arcade 1", "translation": [0.25, 0.30000001192092896, 3], "scaling": [2.0, 2, 2] }
+            ]
+        },
+        {
+            "file": "Other.obj",
+            "instances": [ { "name": "Hand written", "translation": [0.3, 0, 0], "scaling": [1, 1, 1], "rotation": [0, 0, 0] } ]
+        }
+    ],
+    "lights": [ { "name": "Sun", "type": "dir_light", "intensity": [1.0, 0.5, 0.25], "direction": [0, -1, 0] } ],
+    "user_defined": { "flag": true, "nothing": null, "big": 18446744073709551615, "negative": -12345678901, "small": 268435456, "empty": "", "nested": [[], {}, [1, [2, 3]]] }
+})";
+
+static std::string getTestFilename(const std::string& extension)
+{
+    return getExecutableDirectory() + "/BinarySceneFileTest" + extension;
+}
+
+static std::string toString(const rapidjson::Value& value)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    value.Accept(writer);
+    return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+static std::string readTextFile(const std::string& filename)
+{
+    std::ifstream stream(filename);
+    std::stringstream strStream;
+    strStream << stream.rdbuf();
+    return strStream.str();
+}
+
+testing_func(BinarySceneFileTest, TestRoundTrip)
+{
+    rapidjson::Document source;
+    source.Parse<rapidjson::kParseFullPrecisionFlag>(kTestScene);
+    if (source.HasParseError())
+    {
+        return test_fail("Can't parse the test scene");
+    }
+
+    std::string filename = getTestFilename(BinarySceneFile::kFileExtension);
+    if (BinarySceneFile::save(source, filename) == false || BinarySceneFile::isBinarySceneFile(filename) == false)
+    {
+        return test_fail("Can't save the binary scene file");
+    }
+
+    BinarySceneFile::UniquePtr pFile = BinarySceneFile::open(filename);
+    rapidjson::Document decoded;
+    if (pFile == nullptr || pFile->createDocument(decoded, true) == false)
+    {
+        return test_fail("Can't read the binary scene file");
+    }
+    std::remove(filename.c_str());
+
+    // Serializing the documents compares the key order and the number types as well as the values
+    if (toString(source) != toString(decoded))
+    {
+        return test_fail("The decoded document doesn't match the source document");
+    }
+    return test_pass();
+}
+
+testing_func(BinarySceneFileTest, TestPackedInstances)
+{
+    rapidjson::Document source;
+    source.Parse<rapidjson::kParseFullPrecisionFlag>(kTestScene);
+    std::string filename = getTestFilename(BinarySceneFile::kFileExtension);
+    BinarySceneFile::save(source, filename);
+    BinarySceneFile::UniquePtr pFile = BinarySceneFile::open(filename);
+    std::remove(filename.c_str());
+
+    rapidjson::Document document;
+    if (pFile == nullptr || pFile->createDocument(document, false) == false)
+    {
+        return test_fail("Can't read the binary scene file");
+    }
+
+    const rapidjson::Value& models = document["models"];
+    if (models[0]["instances"].IsUint() == false || models[1]["instances"].IsArray() == false || pFile->getInstanceRangeCount() != 1)
+    {
+        return test_fail("Wrong instance packing");
+    }
+
+    const auto& range = pFile->getInstanceRange(models[0]["instances"].GetUint());
+    if (range.count != 2 || std::string(pFile->getInstanceName(range.first + 1)) != "Arcade 1")
+    {
+        return test_fail("Wrong instance range");
+    }
+    if (pFile->getInstanceRotation(range.first).y != 90 || pFile->getInstanceTranslation(range.first + 1).y != 0.3f || pFile->getInstanceScaling(range.first + 1).x != 2)
+    {
+        return test_fail("Wrong instance values");
+    }
+    return test_pass();
+}
+
+testing_func(BinarySceneFileTest, TestCorruptFile)
+{
+    rapidjson::Document source;
+    source.Parse<rapidjson::kParseFullPrecisionFlag>(kTestScene);
+    std::string filename = getTestFilename(BinarySceneFile::kFileExtension);
+    BinarySceneFile::save(source, filename);
+
+    std::ifstream inStream(filename, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(inStream)), std::istreambuf_iterator<char>());
+    inStream.close();
+
+    // A truncated file must be rejected
+    std::ofstream(filename, std::ios::binary).write(data.data(), data.size() / 2);
+    bool truncatedRejected = (BinarySceneFile::open(filename) == nullptr);
+
+    // So must a JSON file
+    data[0] = '{';
+    std::ofstream(filename, std::ios::binary).write(data.data(), data.size());
+    bool jsonRejected = (BinarySceneFile::isBinarySceneFile(filename) == false) && (BinarySceneFile::open(filename) == nullptr);
+    std::remove(filename.c_str());
+
+    if (truncatedRejected == false || jsonRejected == false)
+    {
+        return test_fail("Invalid file was accepted");
+    }
+    return test_pass();
+}
+
+static rapidjson::Value createNestedArray(uint32_t depth, rapidjson::Document::AllocatorType& allocator)
+{
+    rapidjson::Value value(rapidjson::kArrayType);
+    for (uint32_t i = 1; i < depth; i++)
+    {
+        rapidjson::Value parent(rapidjson::kArrayType);
+        parent.PushBack(value, allocator);
+        value = parent;
+    }
+    return value;
+}
+
+testing_func(BinarySceneFileTest, TestCorruptTree)
+{
+    std::string filename = getTestFilename(BinarySceneFile::kFileExtension);
+
+    // Nesting is limited, so that decoding can't overflow the stack
+    rapidjson::Document deep;
+    createNestedArray(100, deep.GetAllocator()).Swap(deep);
+    rapidjson::Document decoded;
+    BinarySceneFile::UniquePtr pFile = BinarySceneFile::save(deep, filename) ? BinarySceneFile::open(filename) : nullptr;
+    if (pFile == nullptr || pFile->createDocument(decoded, true) == false || toString(deep) != toString(decoded))
+    {
+        std::remove(filename.c_str());
+        return test_fail("A nested document didn't round-trip");
+    }
+    createNestedArray(1000, deep.GetAllocator()).Swap(deep);
+    if (BinarySceneFile::save(deep, filename))
+    {
+        std::remove(filename.c_str());
+        return test_fail("A document nested too deeply was saved");
+    }
+
+    // The tree of '[0]' is an array node with a count of 1 followed by a small uint node with a value of 0. Replace the count with the largest one the node can hold
+    rapidjson::Document source;
+    source.Parse("[0]");
+    BinarySceneFile::save(source, filename);
+    std::ifstream inStream(filename, std::ios::binary);
+    std::vector<char> data((std::istreambuf_iterator<char>(inStream)), std::istreambuf_iterator<char>());
+    inStream.close();
+
+    const uint32_t arrayNode = 0x18;
+    const uint32_t zeroNode = 0x3;
+    bool patched = false;
+    for (size_t offset = 0; offset + 2 * sizeof(uint32_t) <= data.size(); offset += sizeof(uint32_t))
+    {
+        uint32_t words[2];
+        memcpy(words, data.data() + offset, sizeof(words));
+        if (words[0] == arrayNode && words[1] == zeroNode)
+        {
+            uint32_t corruptNode = 0xfffffff8;
+            memcpy(data.data() + offset, &corruptNode, sizeof(corruptNode));
+            patched = true;
+            break;
+        }
+    }
+    std::ofstream(filename, std::ios::binary).write(data.data(), data.size());
+
+    // The element count exceeds the words left in the tree, so decoding must fail before reserving space for the elements
+    pFile = BinarySceneFile::open(filename);
+    std::remove(filename.c_str());
+    if (patched == false || pFile == nullptr)
+    {
+        return test_fail("Can't find the array node in the tree");
+    }
+    if (pFile->createDocument(decoded, true))
+    {
+        return test_fail("A tree with an invalid element count was accepted");
+    }
+    return test_pass();
+}
+
+testing_func(BinarySceneFileTest, TestLoadBenchmark)
+{
+    // The instances reference a single triangle
+    std::string modelFilename = getTestFilename(".obj");
+    std::ofstream(modelFilename) << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+
+    // A scene with 100k instances of a single model, written the way the exporter writes it
+    const uint32_t instanceCount = 100000;
+    rapidjson::Document scene(rapidjson::kObjectType);
+    auto& allocator = scene.GetAllocator();
+    rapidjson::Value instances(rapidjson::kArrayType);
+    for (uint32_t i = 0; i < instanceCount; i++)
+    {
+        rapidjson::Value instance(rapidjson::kObjectType);
+        std::string name = "Instance " + std::to_string(i);
+        instance.AddMember("name", rapidjson::Value(name.c_str(), allocator), allocator);
+        float values[] = { (float)i * 0.5f, 1.0f / (float)(i + 1), -(float)i };
+        const char* keys[] = { "translation", "scaling", "rotation" };
+        for (const char* key : keys)
+        {
+            rapidjson::Value vec(rapidjson::kArrayType);
+            for (float v : values) vec.PushBack((double)v, allocator);
+            instance.AddMember(rapidjson::StringRef(key), vec, allocator);
+        }
+        instances.PushBack(instance, allocator);
+    }
+    rapidjson::Value model(rapidjson::kObjectType);
+    std::string modelFile = modelFilename.substr(modelFilename.find_last_of("/\\") + 1);
+    model.AddMember("file", rapidjson::Value(modelFile.c_str(), allocator), allocator);
+    model.AddMember("instances", instances, allocator);
+    rapidjson::Value models(rapidjson::kArrayType);
+    models.PushBack(model, allocator);
+    scene.AddMember("version", 2, allocator);
+    scene.AddMember("models", models, allocator);
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    writer.SetIndent(' ', 4);
+    scene.Accept(writer);
+
+    std::string jsonFilename = getTestFilename(".fscene");
+    std::string binaryFilename = getTestFilename(BinarySceneFile::kFileExtension);
+    std::string roundTripFilename = getTestFilename("RoundTrip.fscene");
+    std::ofstream(jsonFilename).write(buffer.GetString(), buffer.GetSize());
+    if (BinarySceneFile::convertToBinary(jsonFilename, binaryFilename) == false || BinarySceneFile::convertToJson(binaryFilename, roundTripFilename) == false)
+    {
+        return test_fail("Conversion failed");
+    }
+    bool roundTripMatches = (readTextFile(jsonFilename) == readTextFile(roundTripFilename));
+
+    // Load both files with the scene importer. The JSON file is parsed, the binary file's instances are created from the packed arrays
+    auto start = CpuTimer::getCurrentTimePoint();
+    Scene::SharedPtr pJsonScene = Scene::loadFromFile(jsonFilename);
+    double jsonMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    start = CpuTimer::getCurrentTimePoint();
+    Scene::SharedPtr pBinaryScene = Scene::loadFromFile(binaryFilename);
+    double binaryMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    logInfo("100k instances: JSON " + std::to_string(jsonMs) + " ms, binary " + std::to_string(binaryMs) + " ms");
+
+    std::remove(modelFilename.c_str());
+    std::remove(jsonFilename.c_str());
+    std::remove(binaryFilename.c_str());
+    std::remove(roundTripFilename.c_str());
+
+    if (roundTripMatches == false)
+    {
+        return test_fail("Converting to binary and back changed the JSON file");
+    }
+    if (pJsonScene == nullptr || pBinaryScene == nullptr)
+    {
+        return test_fail("Can't load the scene files");
+    }
+    if (pJsonScene->getModelCount() != 1 || pBinaryScene->getModelCount() != 1 || pJsonScene->getModelInstanceCount(0) != instanceCount || pBinaryScene->getModelInstanceCount(0) != instanceCount)
+    {
+        return test_fail("The scenes don't contain all the instances");
+    }
+
+    // Both paths convert the same float values, so the instances must match exactly
+    for (uint32_t i = 0; i < instanceCount; i++)
+    {
+        const auto& pJsonInstance = pJsonScene->getModelInstance(0, i);
+        const auto& pBinaryInstance = pBinaryScene->getModelInstance(0, i);
+        if (pJsonInstance->getName() != pBinaryInstance->getName() ||
+            pJsonInstance->getTranslation() != pBinaryInstance->getTranslation() ||
+            pJsonInstance->getScaling() != pBinaryInstance->getScaling() ||
+            pJsonInstance->getRotation() != pBinaryInstance->getRotation())
+        {
+            return test_fail("The binary scene holds different instance values");
+        }
+    }
+    return test_pass();
+}
+
+int main()
+{
+    BinarySceneFileTest bsft;
+    bsft.init(true);
+    bsft.run();
+    return 0;
+}
@@ -0,0 +1,124 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "BoundsTreeTest.h"
+#include <random>
+
+void BoundsTreeTest::addTests()
+{
+    addTestToList<TestRandomUpdates>();
+    addTestToList<TestEmpty>();
+}
+
+static bool isEqual(const BoundingBox& a, const BoundingBox& b)
+{
+    // BoundingBox stores center and extent, so converting to min/max and back isn't exact
+    const float epsilon = 1e-3f;
+    return glm::all(glm::lessThan(glm::abs(a.getMinPos() - b.getMinPos()), glm::vec3(epsilon))) && glm::all(glm::lessThan(glm::abs(a.getMaxPos() - b.getMaxPos()), glm::vec3(epsilon)));
+}
+
+testing_func(BoundsTreeTest, TestRandomUpdates)
+{
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> size(0.0f, 10.0f);
+    auto randomBox = [&]() { return BoundingBox::fromMinMax(glm::vec3(position(rng)), glm::vec3(position(rng)) + glm::vec3(200.0f) + size(rng)); };
+
+    BoundsTree tree;
+    std::vector<BoundingBox> boxes;
+    std::vector<uint32_t> slots;
+
+    // Mix inserts, updates and removals, and compare against a brute-force union after each batch
+    for (uint32_t batch = 0; batch < 100; batch++)
+    {
+        for (uint32_t op = 0; op < 20; op++)
+        {
+            uint32_t action = rng() % 3;
+            if (action == 0 || boxes.empty())
+            {
+                boxes.push_back(randomBox());
+                slots.push_back(tree.insert(boxes.back()));
+            }
+            else if (action == 1)
+            {
+                uint32_t i = rng() % boxes.size();
+                boxes[i] = randomBox();
+                tree.update(slots[i], boxes[i]);
+            }
+            else
+            {
+                uint32_t i = rng() % boxes.size();
+                tree.remove(slots[i]);
+                boxes.erase(boxes.begin() + i);
+                slots.erase(slots.begin() + i);
+            }
+        }
+
+        if (tree.getCount() != boxes.size())
+        {
+            return test_fail("Wrong box count");
+        }
+        if (boxes.empty()) continue;
+
+        BoundingBox expected = boxes[0];
+        for (const auto& b : boxes) expected = BoundingBox::fromUnion(expected, b);
+        BoundingBox result;
+        if (tree.getBounds(result) == false || isEqual(result, expected) == false)
+        {
+            return test_fail("Tree bounds don't match the union of the boxes");
+        }
+    }
+
+    return test_pass();
+}
+
+testing_func(BoundsTreeTest, TestEmpty)
+{
+    BoundsTree tree;
+    BoundingBox box;
+    if (tree.getBounds(box))
+    {
+        return test_fail("Empty tree returned bounds");
+    }
+
+    uint32_t slot = tree.insert(BoundingBox::fromMinMax(glm::vec3(0), glm::vec3(1)));
+    tree.remove(slot);
+    if (tree.getBounds(box) || tree.getCount() != 0)
+    {
+        return test_fail("Tree isn't empty after removing the last box");
+    }
+
+    return test_pass();
+}
+
+int main()
+{
+    BoundsTreeTest btt;
+    btt.init(false);
+    btt.run();
+    return 0;
+}
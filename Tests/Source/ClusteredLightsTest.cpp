@@ -0,0 +1,400 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "ClusteredLightsTest.h"
+#include <algorithm>
+#include <cfloat>
+#include <random>
+
+void ClusteredLightsTest::addTests()
+{
+    addTestToList<TestRandomLights>();
+    addTestToList<TestBoundaryLights>();
+    addTestToList<TestKnownClusters>();
+}
+
+// Scalar reference of the ClusteredLights binning. It evaluates one light and one cluster at a time, but repeats the floating-point operations of the SSE2 code in the same order, so the results must match exactly
+namespace
+{
+    const float kNearZ = 0.1f;
+    const float kFarZ = 100.0f;
+
+    struct RefBounds
+    {
+        glm::vec3 center;
+        float radius;
+        glm::vec3 axis;
+        float cosAngle;
+        float sinAngle;
+        bool isSpot;
+        int32_t begin[3];
+        int32_t end[3];
+    };
+
+    float planeDistance(const glm::vec4& plane, const glm::vec3& p)
+    {
+        return glm::dot(glm::vec3(plane), p) + plane.w;
+    }
+
+    glm::vec4 ndcPlane(const glm::mat4& proj, uint32_t row, float ndc)
+    {
+        glm::vec4 r(proj[0][row], proj[1][row], proj[2][row], proj[3][row]);
+        glm::vec4 w(proj[0][3], proj[1][3], proj[2][3], proj[3][3]);
+        glm::vec4 plane = r - ndc * w;
+        return plane / glm::length(glm::vec3(plane));
+    }
+
+    glm::vec3 unproject(const glm::mat4& proj, float ndcX, float ndcY, float depth)
+    {
+        float viewZ = -depth;
+        float w = proj[2][3] * viewZ + proj[3][3];
+        float x = (ndcX * w - proj[2][0] * viewZ - proj[3][0]) / proj[0][0];
+        float y = (ndcY * w - proj[2][1] * viewZ - proj[3][1]) / proj[1][1];
+        return glm::vec3(x, y, viewZ);
+    }
+
+    // Returns the light indices of every cluster
+    std::vector<std::vector<uint32_t>> binReference(const ClusteredLights::Desc& desc, const Scene* pScene, const Camera* pCamera)
+    {
+        const int32_t sizeX = (int32_t)desc.gridSizeX;
+        const int32_t sizeY = (int32_t)desc.gridSizeY;
+        const int32_t sizeZ = (int32_t)desc.gridSizeZ;
+        const glm::mat4 proj = pCamera->getProjMatrix();
+        const glm::mat4 view = pCamera->getViewMatrix();
+
+        std::vector<glm::vec4> planesX(sizeX + 1);
+        for (int32_t x = 0; x <= sizeX; x++) planesX[x] = ndcPlane(proj, 0, -1.0f + 2.0f * float(x) / float(sizeX));
+        std::vector<glm::vec4> planesY(sizeY + 1);
+        for (int32_t y = 0; y <= sizeY; y++) planesY[y] = ndcPlane(proj, 1, 1.0f - 2.0f * float(y) / float(sizeY));
+
+        const float nearZ = std::max(pCamera->getNearPlane(), 1e-4f);
+        const float farZ = std::max(pCamera->getFarPlane(), nearZ * 1.001f);
+        std::vector<float> sliceDepth(sizeZ + 1);
+        for (int32_t z = 0; z <= sizeZ; z++) sliceDepth[z] = nearZ * std::pow(farZ / nearZ, float(z) / float(sizeZ));
+        const float sliceScale = float(sizeZ) / std::log(farZ / nearZ);
+        const float sliceBias = -std::log(nearZ) * sliceScale;
+        auto getSlice = [&](float depth)
+        {
+            if (depth <= sliceDepth.front()) return 0;
+            int32_t z = (int32_t)(std::log(depth) * sliceScale + sliceBias);
+            return glm::clamp(z, 0, sizeZ - 1);
+        };
+
+        std::vector<RefBounds> lights;
+        for (const auto& pLight : pScene->getLights())
+        {
+            if (pLight->getType() != LightPoint) continue;
+            const LightData& light = pLight->getData();
+            lights.emplace_back();
+            RefBounds& b = lights.back();
+            float maxIntensity = std::max(light.intensity.x, std::max(light.intensity.y, light.intensity.z));
+            b.radius = std::sqrt(std::max(maxIntensity, 0.0f) / desc.intensityCutoff);
+            b.center = glm::vec3(view * glm::vec4(light.worldPos, 1));
+            b.axis = glm::normalize(glm::vec3(view * glm::vec4(light.worldDir, 0)));
+            b.isSpot = light.openingAngle < glm::radians(90.0f);
+            b.cosAngle = std::cos(light.openingAngle);
+            b.sinAngle = std::sin(light.openingAngle);
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                b.begin[j] = 0;
+                b.end[j] = -1;
+            }
+
+            const float r = b.radius;
+            const float depth = -b.center.z;
+            if (depth + r < sliceDepth.front() || depth - r > sliceDepth.back()) continue;
+            if (planeDistance(planesX[0], b.center) < -r || planeDistance(planesX[sizeX], b.center) > r) continue;
+            if (planeDistance(planesY[0], b.center) > r || planeDistance(planesY[sizeY], b.center) < -r) continue;
+
+            b.begin[0] = 0;
+            while (b.begin[0] < sizeX - 1 && planeDistance(planesX[b.begin[0] + 1], b.center) > r) b.begin[0]++;
+            b.end[0] = sizeX - 1;
+            while (b.end[0] > b.begin[0] && planeDistance(planesX[b.end[0]], b.center) < -r) b.end[0]--;
+            b.begin[1] = 0;
+            while (b.begin[1] < sizeY - 1 && planeDistance(planesY[b.begin[1] + 1], b.center) < -r) b.begin[1]++;
+            b.end[1] = sizeY - 1;
+            while (b.end[1] > b.begin[1] && planeDistance(planesY[b.end[1]], b.center) > r) b.end[1]--;
+            b.begin[2] = getSlice(depth - r);
+            b.end[2] = getSlice(depth + r);
+        }
+
+        std::vector<std::vector<uint32_t>> clusters(sizeX * sizeY * sizeZ);
+        for (int32_t z = 0; z < sizeZ; z++)
+        {
+            for (int32_t y = 0; y < sizeY; y++)
+            {
+                const float ndcTop = 1.0f - 2.0f * float(y) / float(sizeY);
+                const float ndcBottom = 1.0f - 2.0f * float(y + 1) / float(sizeY);
+                for (int32_t x = 0; x < sizeX; x++)
+                {
+                    const float ndcLeft = -1.0f + 2.0f * float(x) / float(sizeX);
+                    const float ndcRight = -1.0f + 2.0f * float(x + 1) / float(sizeX);
+
+                    glm::vec3 minCorner(FLT_MAX);
+                    glm::vec3 maxCorner(-FLT_MAX);
+                    for (uint32_t c = 0; c < 8; c++)
+                    {
+                        glm::vec3 p = unproject(proj, (c & 1) ? ndcRight : ndcLeft, (c & 2) ? ndcBottom : ndcTop, (c & 4) ? sliceDepth[z + 1] : sliceDepth[z]);
+                        minCorner = glm::min(minCorner, p);
+                        maxCorner = glm::max(maxCorner, p);
+                    }
+                    const glm::vec3 clusterCenter = (minCorner + maxCorner) * 0.5f;
+                    const float clusterRadius = glm::length(maxCorner - minCorner) * 0.5f;
+
+                    std::vector<uint32_t>& indices = clusters[(z * sizeY + y) * sizeX + x];
+                    for (uint32_t i = 0; i < (uint32_t)lights.size(); i++)
+                    {
+                        const RefBounds& b = lights[i];
+                        if (z < b.begin[2] || z > b.end[2]) continue;
+                        if (x < b.begin[0] || x > b.end[0] || y < b.begin[1] || y > b.end[1]) continue;
+
+                        float dx = std::max(std::max(minCorner.x - b.center.x, b.center.x - maxCorner.x), 0.0f);
+                        float dy = std::max(std::max(minCorner.y - b.center.y, b.center.y - maxCorner.y), 0.0f);
+                        float dz = std::max(std::max(minCorner.z - b.center.z, b.center.z - maxCorner.z), 0.0f);
+                        float distSq = (dx * dx + dy * dy) + dz * dz;
+                        if ((distSq <= b.radius * b.radius) == false) continue;
+
+                        if (b.isSpot)
+                        {
+                            glm::vec3 v = clusterCenter - b.center;
+                            float lenSq = (v.x * v.x + v.y * v.y) + v.z * v.z;
+                            float v1 = (v.x * b.axis.x + v.y * b.axis.y) + v.z * b.axis.z;
+                            float perpendicular = std::sqrt(std::max(lenSq - v1 * v1, 0.0f));
+                            float coneDist = b.cosAngle * perpendicular - v1 * b.sinAngle;
+                            if (coneDist > clusterRadius || v1 < -clusterRadius) continue;
+                        }
+                        indices.push_back(i);
+                    }
+                }
+            }
+        }
+        return clusters;
+    }
+
+    Camera::SharedPtr createCamera()
+    {
+        Camera::SharedPtr pCamera = Camera::create();
+        pCamera->setPosition(glm::vec3(0, 0, 0));
+        pCamera->setTarget(glm::vec3(0, 0, -1));
+        pCamera->setUpVector(glm::vec3(0, 1, 0));
+        pCamera->setDepthRange(kNearZ, kFarZ);
+        pCamera->setAspectRatio(16.0f / 9.0f);
+        return pCamera;
+    }
+
+    PointLight::SharedPtr createLight(const glm::vec3& pos, float radius, const glm::vec3& dir, float openingAngle, const ClusteredLights::Desc& desc)
+    {
+        PointLight::SharedPtr pLight = PointLight::create();
+        pLight->setWorldPosition(pos);
+        pLight->setWorldDirection(dir);
+        pLight->setOpeningAngle(openingAngle);
+        // ClusteredLights derives the radius from the intensity
+        pLight->setIntensity(glm::vec3(radius * radius * desc.intensityCutoff));
+        return pLight;
+    }
+
+    uint32_t getClusterIndex(const ClusteredLights::Desc& desc, uint32_t x, uint32_t y, uint32_t z)
+    {
+        return (z * desc.gridSizeY + y) * desc.gridSizeX + x;
+    }
+
+    float getSliceDepth(const ClusteredLights::Desc& desc, uint32_t z)
+    {
+        return kNearZ * std::pow(kFarZ / kNearZ, float(z) / float(desc.gridSizeZ));
+    }
+
+    // The clusters which contain a light, in increasing order
+    std::vector<uint32_t> getLightClusters(const ClusteredLights* pClusters, uint32_t lightIndex)
+    {
+        std::vector<uint32_t> clusters;
+        const auto& ranges = pClusters->getClusterRanges();
+        const auto& indices = pClusters->getClusterIndices();
+        for (uint32_t c = 0; c < (uint32_t)ranges.size(); c++)
+        {
+            auto begin = indices.begin() + ranges[c].x;
+            if (std::find(begin, begin + ranges[c].y, lightIndex) != begin + ranges[c].y) clusters.push_back(c);
+        }
+        return clusters;
+    }
+
+    std::string toString(const std::vector<uint32_t>& clusters)
+    {
+        std::string str;
+        for (uint32_t c : clusters) str += (str.size() ? ", " : "") + std::to_string(c);
+        return "{" + str + "}";
+    }
+
+    // Compare the SSE2 binning with the reference, cluster by cluster
+    std::string compareWithReference(const ClusteredLights::Desc& desc, const Scene* pScene, const Camera* pCamera)
+    {
+        ClusteredLights::SharedPtr pClusters = ClusteredLights::create(desc);
+        pClusters->update(pScene, pCamera);
+        std::vector<std::vector<uint32_t>> reference = binReference(desc, pScene, pCamera);
+
+        const auto& ranges = pClusters->getClusterRanges();
+        const auto& indices = pClusters->getClusterIndices();
+        if (ranges.size() != reference.size())
+        {
+            return "Wrong number of clusters";
+        }
+        if (pClusters->getStats().overflowCount != 0)
+        {
+            return "A cluster overflowed, the test needs a higher maxLightsPerCluster";
+        }
+
+        size_t referenceCount = 0;
+        for (size_t c = 0; c < ranges.size(); c++)
+        {
+            const std::vector<uint32_t>& expected = reference[c];
+            referenceCount += expected.size();
+            if (ranges[c].y != expected.size() || std::equal(expected.begin(), expected.end(), indices.begin() + ranges[c].x) == false)
+            {
+                return "Cluster " + std::to_string(c) + " doesn't match the reference. It has " + std::to_string(ranges[c].y) + " lights, the reference has " + std::to_string(expected.size());
+            }
+        }
+        if (referenceCount == 0)
+        {
+            return "No light was binned, the test scene is broken";
+        }
+        return "";
+    }
+}
+
+testing_func(ClusteredLightsTest, TestRandomLights)
+{
+    ClusteredLights::Desc desc;
+    desc.maxLightsPerCluster = 4096;
+    Camera::SharedPtr pCamera = createCamera();
+
+    // Lights inside and around the frustum, half of them spot lights. Cones wider than 90 degrees are binned as spheres
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    Scene::SharedPtr pScene = Scene::create();
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        float depth = kNearZ * 0.5f + unit(rng) * kFarZ * 1.1f;
+        glm::vec3 pos((unit(rng) * 2.0f - 1.0f) * depth * 1.2f, (unit(rng) * 2.0f - 1.0f) * depth * 0.7f, -depth);
+        glm::vec3 dir = glm::normalize(glm::vec3(unit(rng) - 0.5f, unit(rng) - 0.5f, unit(rng) - 0.5f) + glm::vec3(0, 0, 1e-3f));
+        float openingAngle = (i & 1) ? glm::radians(5.0f + unit(rng) * 115.0f) : glm::radians(180.0f);
+        pScene->addLight(createLight(pos, 0.05f + unit(rng) * 8.0f, dir, openingAngle, desc));
+    }
+
+    std::string error = compareWithReference(desc, pScene.get(), pCamera.get());
+    return error.empty() ? test_pass() : test_fail(error);
+}
+
+testing_func(ClusteredLightsTest, TestBoundaryLights)
+{
+    ClusteredLights::Desc desc;
+    desc.maxLightsPerCluster = 4096;
+    Camera::SharedPtr pCamera = createCamera();
+    const glm::mat4 proj = pCamera->getProjMatrix();
+
+    // Lights centered on the cluster corners, where the AABB and range tests are decided by ties. A zero radius only touches the clusters which share the corner
+    Scene::SharedPtr pScene = Scene::create();
+    const float radii[] = { 0.0f, 0.01f, 0.25f };
+    for (uint32_t z = 0; z <= desc.gridSizeZ; z += 3)
+    {
+        float depth = kNearZ * std::pow(kFarZ / kNearZ, float(z) / float(desc.gridSizeZ));
+        for (uint32_t y = 0; y <= desc.gridSizeY; y += 2)
+        {
+            for (uint32_t x = 0; x <= desc.gridSizeX; x += 3)
+            {
+                float ndcX = -1.0f + 2.0f * float(x) / float(desc.gridSizeX);
+                float ndcY = 1.0f - 2.0f * float(y) / float(desc.gridSizeY);
+                glm::vec3 pos = unproject(proj, ndcX, ndcY, depth);
+                float radius = radii[(x + y + z) % arraysize(radii)];
+                // Alternate between point lights and spot lights looking along an axis, so the cone test sees boundary values too
+                float openingAngle = ((x + y) & 1) ? glm::radians(45.0f) : glm::radians(180.0f);
+                pScene->addLight(createLight(pos, radius, glm::vec3(0, 0, -1), openingAngle, desc));
+            }
+        }
+    }
+
+    std::string error = compareWithReference(desc, pScene.get(), pCamera.get());
+    return error.empty() ? test_pass() : test_fail(error);
+}
+
+testing_func(ClusteredLightsTest, TestKnownClusters)
+{
+    // The default grid is 16x9x24. The margins below assume the default camera, with a vertical FOV of 59 degrees
+    ClusteredLights::Desc desc;
+    Camera::SharedPtr pCamera = createCamera();
+    const glm::mat4 proj = pCamera->getProjMatrix();
+
+    // Cluster (7, 4) spans NDC X [-0.125, 0] and NDC Y [-1/9, 1/9]. Its center is about 0.2 units away from the neighboring clusters at these depths
+    const uint32_t x = 7;
+    const uint32_t y = 4;
+    const float ndcX = -0.0625f;
+    const float ndcY = 0;
+
+    // A small light in the middle of slice 12 only touches one cluster
+    float midDepth = (getSliceDepth(desc, 12) + getSliceDepth(desc, 13)) * 0.5f;
+    Scene::SharedPtr pScene = Scene::create();
+    pScene->addLight(createLight(unproject(proj, ndcX, ndcY, midDepth), 0.01f, glm::vec3(0, 0, -1), glm::radians(180.0f), desc));
+
+    // A light centered on the boundary between slices 11 and 12 touches both
+    pScene->addLight(createLight(unproject(proj, ndcX, ndcY, getSliceDepth(desc, 12)), 0.05f, glm::vec3(0, 0, -1), glm::radians(180.0f), desc));
+
+    // A light behind the camera touches none, even with a radius which reaches past the camera position
+    pScene->addLight(createLight(glm::vec3(0, 0, 5), 1, glm::vec3(0, 0, -1), glm::radians(180.0f), desc));
+
+    ClusteredLights::SharedPtr pClusters = ClusteredLights::create(desc);
+    pClusters->update(pScene.get(), pCamera.get());
+
+    const std::vector<uint32_t> expected[] =
+    {
+        { getClusterIndex(desc, x, y, 12) },
+        { getClusterIndex(desc, x, y, 11), getClusterIndex(desc, x, y, 12) },
+        {},
+    };
+    const char* names[] = { "inside a cluster", "on a slice boundary", "behind the camera" };
+    for (uint32_t i = 0; i < arraysize(expected); i++)
+    {
+        std::vector<uint32_t> clusters = getLightClusters(pClusters.get(), i);
+        if (clusters != expected[i])
+        {
+            return test_fail(std::string("The light ") + names[i] + " is in clusters " + toString(clusters) + ", expected " + toString(expected[i]));
+        }
+    }
+
+    const ClusteredLights::Stats& stats = pClusters->getStats();
+    if (stats.clusteredLightCount != 3 || stats.visibleLightCount != 2 || stats.indexCount != 3)
+    {
+        return test_fail("The statistics don't match the binned lights");
+    }
+
+    return test_pass();
+}
+
+int main()
+{
+    ClusteredLightsTest clt;
+    clt.init(false);
+    clt.run();
+    return 0;
+}
@@ -0,0 +1,166 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "FencedPoolTest.h"
+
+//Simulates a GPU fence, so that the pool can be tested without a device
+class TestFence
+{
+public:
+    uint64_t getCpuValue() const { return mCpuValue; }
+    uint64_t getGpuValue() const { return mGpuValue; }
+    void syncCpu() { mGpuValue = mCpuValue; mSyncCount++; }
+
+    //Equivalent to GpuFence::gpuSignal()
+    void signal() { mCpuValue++; }
+    //Simulate the GPU completing the work up to a value
+    void complete(uint64_t value) { mGpuValue = std::min(value, mCpuValue); }
+
+    uint32_t mSyncCount = 0;
+private:
+    uint64_t mCpuValue = 1;
+    uint64_t mGpuValue = 0;
+};
+
+using TestPool = FencedPool<uint32_t, TestFence>;
+
+static uint32_t sObjectCounter = 0;
+static uint32_t newTestObject(void*)
+{
+    return sObjectCounter++;
+}
+
+void FencedPoolTest::addTests()
+{
+    addTestToList<TestQueueBatches>();
+    addTestToList<TestRecycle>();
+    addTestToList<TestMaxObjects>();
+}
+
+testing_func(FencedPoolTest, TestQueueBatches)
+{
+    FencedQueue<uint32_t> queue;
+    queue.push(0, 1);
+    queue.push(1, 1);
+    queue.push(2, 2);
+    //Smaller values are added to the last batch
+    queue.push(3, 1);
+    if (queue.size() != 4)
+    {
+        return test_fail("Queue size doesn't match the number of pushed objects");
+    }
+
+    if (queue.retire(0) != 0)
+    {
+        return test_fail("Objects were retired before the fence reached their value");
+    }
+
+    std::vector<uint32_t> retired;
+    queue.retire(1, [&retired](uint32_t& o) { retired.push_back(o); });
+    if (retired != std::vector<uint32_t>({ 0, 1 }))
+    {
+        return test_fail("Retiring the first batch returned the wrong objects");
+    }
+
+    if (queue.retire(2) != 2 || queue.empty() == false)
+    {
+        return test_fail("Retiring the last batch didn't empty the queue");
+    }
+
+    return test_pass();
+}
+
+testing_func(FencedPoolTest, TestRecycle)
+{
+    sObjectCounter = 0;
+    auto pFence = std::make_shared<TestFence>();
+    TestPool::SharedPtr pPool = TestPool::create(pFence, newTestObject, nullptr, 16);
+
+    //The GPU doesn't make progress, so every call should create a new object
+    std::vector<uint32_t> objects;
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        objects.push_back(pPool->newObject());
+        pFence->signal();
+    }
+    if (pPool->getStats().allocationCount != 5 || pPool->getStats().reuseCount != 0)
+    {
+        return test_fail("Objects were reused while the GPU was still using them");
+    }
+
+    //Complete the work which used the first 2 objects, they should be recycled in one batch
+    pFence->complete(2);
+    uint32_t recycled = pPool->newObject();
+    TestPool::Stats stats = pPool->getStats();
+    if (stats.reuseCount != 1 || stats.freeCount != 1 || recycled >= 2)
+    {
+        return test_fail("Completed objects weren't recycled");
+    }
+
+    if (stats.objectCount != stats.inFlightCount + stats.freeCount + 1)
+    {
+        return test_fail("Pool occupancy doesn't add up");
+    }
+
+    return test_pass();
+}
+
+testing_func(FencedPoolTest, TestMaxObjects)
+{
+    sObjectCounter = 0;
+    const size_t maxObjects = 4;
+    auto pFence = std::make_shared<TestFence>();
+    TestPool::SharedPtr pPool = TestPool::create(pFence, newTestObject, nullptr, maxObjects);
+
+    //Bursty use with a GPU which never catches up on its own. The pool should stall instead of growing
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        pPool->newObject();
+        pFence->signal();
+    }
+
+    TestPool::Stats stats = pPool->getStats();
+    if (stats.objectCount > maxObjects || sObjectCounter > maxObjects)
+    {
+        return test_fail("Pool grew past its maximum size");
+    }
+
+    if (stats.stallCount == 0 || stats.stallCount != pFence->mSyncCount)
+    {
+        return test_fail("Pool didn't wait for the GPU when it was full");
+    }
+
+    return test_pass();
+}
+
+int main()
+{
+    FencedPoolTest fpt;
+    fpt.init(false);
+    fpt.run();
+    return 0;
+}
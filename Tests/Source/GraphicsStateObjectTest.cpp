@@ -30,6 +30,19 @@
 void GraphicsStateObjectTest::addTests()
 {
     addTestToList<TestCreate>();
+    addTestToList<TestCache>();
+    addTestToList<TestCacheLookupLatency>();
+}
+
+static GraphicsStateObject::Desc createCacheTestDesc()
+{
+    GraphicsStateObject::Desc desc;
+    GraphicsProgram::SharedPtr program = GraphicsProgram::createFromFile("", "Simple.ps.hlsl");
+    desc.setProgramVersion(program->getActiveVersion());
+    desc.setRootSignature(RootSignature::create(program->getActiveVersion()->getReflector().get()));
+    desc.setFboFormats(Fbo::Desc());
+    desc.setPrimitiveType(GraphicsStateObject::PrimitiveType::Triangle);
+    return desc;
 }
 
 testing_func(GraphicsStateObjectTest, TestCreate)
@@ -108,6 +121,104 @@ testing_func(GraphicsStateObjectTest, TestCreate)
     return test_pass();
 }
 
+testing_func(GraphicsStateObjectTest, TestCache)
+{
+    GraphicsStateObject::Desc desc = createCacheTestDesc();
+    GsoCache::SharedPtr pCache = GsoCache::create(64);
+
+    //Same desc should return the same object
+    GraphicsStateObject::SharedPtr pGso = pCache->getGso(desc);
+    if (pGso == nullptr || pCache->getGso(desc) != pGso)
+    {
+        return test_fail("Cache didn't return the same GSO for the same desc");
+    }
+
+    //A desc using the default states is equal to a desc without states, so it should hit the same object
+    GraphicsStateObject::Desc defaultDesc = desc;
+    defaultDesc.setBlendState(pGso->getDesc().getBlendState());
+    defaultDesc.setRasterizerState(pGso->getDesc().getRasterizerState());
+    defaultDesc.setDepthStencilState(pGso->getDesc().getDepthStencilState());
+    if (GraphicsStateObject::DescHash()(defaultDesc) != GraphicsStateObject::DescHash()(desc) || pCache->getGso(defaultDesc) != pGso)
+    {
+        return test_fail("Desc with default states didn't match desc without states");
+    }
+
+    //Different desc should return a different object
+    desc.setSampleMask(0xf);
+    if (pCache->getGso(desc) == pGso)
+    {
+        return test_fail("Cache returned the same GSO for different descs");
+    }
+
+    GsoCache::Stats stats = pCache->getStats();
+    if (stats.hits != 2 || stats.misses != 2 || stats.size != 2)
+    {
+        return test_fail("Unexpected cache statistics");
+    }
+
+    //Fill the cache past its capacity, the least-recently-used objects should be evicted
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        desc.setSampleMask(0x100 + i);
+        pCache->getGso(desc);
+    }
+    stats = pCache->getStats();
+    if (stats.size > pCache->getCapacity() || stats.evictions == 0)
+    {
+        return test_fail("Cache exceeded its capacity");
+    }
+
+    pCache->setCapacity(8);
+    if (pCache->getStats().size > 8)
+    {
+        return test_fail("Cache didn't shrink after setCapacity()");
+    }
+
+    pCache->clear();
+    if (pCache->getStats().size != 0)
+    {
+        return test_fail("Cache isn't empty after clear()");
+    }
+
+    return test_pass();
+}
+
+testing_func(GraphicsStateObjectTest, TestCacheLookupLatency)
+{
+    GraphicsStateObject::Desc desc = createCacheTestDesc();
+    const uint32_t stateCounts[] = { 16, 128, 1024 };
+    const uint32_t lookupCount = 100000;
+
+    for (uint32_t stateCount : stateCounts)
+    {
+        GsoCache::SharedPtr pCache = GsoCache::create();
+        std::vector<GraphicsStateObject::Desc> descs(stateCount, desc);
+        for (uint32_t i = 0; i < stateCount; i++)
+        {
+            descs[i].setSampleMask(i + 1);
+            pCache->getGso(descs[i]);
+        }
+
+        //Look the states up in a pseudo-random order, so that consecutive lookups don't hit the same state
+        CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+        for (uint32_t i = 0; i < lookupCount; i++)
+        {
+            pCache->getGso(descs[(i * 7919) % stateCount]);
+        }
+        CpuTimer::TimePoint end = CpuTimer::getCurrentTimePoint();
+
+        double nsPerLookup = CpuTimer::calcDuration(start, end) * 1000000.0 / lookupCount;
+        logInfo("GSO cache lookup with " + std::to_string(stateCount) + " states: " + std::to_string(nsPerLookup) + "ns");
+
+        if (pCache->getStats().misses != stateCount)
+        {
+            return test_fail("Lookups of cached states created new objects");
+        }
+    }
+
+    return test_pass();
+}
+
 int main()
 {
     GraphicsStateObjectTest gsot;
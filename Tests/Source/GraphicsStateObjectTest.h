@@ -34,4 +34,6 @@ private:
     void addTests() override;
     void onInit() override {};
     register_testing_func(TestCreate)
+    register_testing_func(TestCache)
+    register_testing_func(TestCacheLookupLatency)
 };
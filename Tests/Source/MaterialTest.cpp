@@ -0,0 +1,248 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "MaterialTest.h"
+#include <cstring>
+#include <set>
+
+void MaterialTest::addTests()
+{
+    addTestToList<TestDescInterning>();
+    addTestToList<TestImportBenchmark>();
+    addTestToList<TestTableDeduplication>();
+    addTestToList<TestTablePacking>();
+}
+
+// Gives every index below 45^3 a unique desc, by encoding it in the type, NDF and blend mode of the 3 layers
+static Material::SharedPtr createSyntheticMaterial(uint32_t descIndex)
+{
+    static const Material::Layer::Type kTypes[] = { Material::Layer::Type::Lambert, Material::Layer::Type::Conductor, Material::Layer::Type::Dielectric, Material::Layer::Type::Emissive, Material::Layer::Type::User };
+    static const Material::Layer::NDF kNdfs[] = { Material::Layer::NDF::Beckmann, Material::Layer::NDF::GGX, Material::Layer::NDF::User };
+    static const Material::Layer::Blend kBlends[] = { Material::Layer::Blend::Fresnel, Material::Layer::Blend::Additive, Material::Layer::Blend::Constant };
+
+    Material::SharedPtr pMaterial = Material::create("Synthetic");
+    for (uint32_t layer = 0; layer < MatMaxLayers; layer++)
+    {
+        uint32_t digit = descIndex % 45;
+        descIndex /= 45;
+        pMaterial->setLayerType(layer, kTypes[digit % 5]);
+        pMaterial->setLayerNdf(layer, kNdfs[(digit / 5) % 3]);
+        pMaterial->setLayerBlend(layer, kBlends[digit / 15]);
+        pMaterial->setLayerAlbedo(layer, glm::vec4(0.2f));
+    }
+    return pMaterial;
+}
+
+testing_func(MaterialTest, TestDescInterning)
+{
+    Material::SharedPtr pA = createSyntheticMaterial(1);
+    Material::SharedPtr pB = createSyntheticMaterial(1);
+    Material::SharedPtr pC = createSyntheticMaterial(2);
+
+    if (pA->getDescIdentifier() != pB->getDescIdentifier())
+    {
+        return test_fail("Materials with the same desc have different identifiers");
+    }
+    if (pA->getDescIdentifier() == pC->getDescIdentifier())
+    {
+        return test_fail("Materials with different descs share an identifier");
+    }
+
+    // Changing a value doesn't change the desc
+    uint64_t id = pA->getDescIdentifier();
+    pA->setLayerAlbedo(0, glm::vec4(0.1f));
+    pA->setLayerType(0, Material::Layer::Type::Conductor);
+    pB.reset();
+    if (pA->getDescIdentifier() != id)
+    {
+        return test_fail("The identifier changed although the desc didn't");
+    }
+
+    // Changing the desc moves the material to the other identifier
+    pA->setLayerType(0, Material::Layer::Type::Dielectric);
+    if (pA->getDescIdentifier() != pC->getDescIdentifier())
+    {
+        return test_fail("Changing the desc didn't pick up the existing identifier");
+    }
+
+    return test_pass();
+}
+
+testing_func(MaterialTest, TestImportBenchmark)
+{
+    // Half of the materials share a desc with another material, similar to what scenes with many copies of the same shader look like
+    const uint32_t materialCounts[] = { 10000, 100000 };
+    for (uint32_t count : materialCounts)
+    {
+        const uint32_t descCount = count / 2;
+        std::vector<Material::SharedPtr> materials;
+        materials.reserve(count);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            materials.push_back(createSyntheticMaterial(i % descCount));
+        }
+
+        // Finalizing the material interns its desc
+        std::set<uint64_t> identifiers;
+        CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+        for (const auto& pMaterial : materials)
+        {
+            identifiers.insert(pMaterial->getDescIdentifier());
+        }
+        float totalMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+        logInfo("Material import: " + std::to_string(count) + " materials with " + std::to_string(descCount) + " unique descs finalized in " + std::to_string(totalMs) + "ms (" + std::to_string(totalMs * 1000.0f / count) + "us per material)");
+
+        if (identifiers.size() != descCount)
+        {
+            return test_fail("Wrong number of unique desc identifiers");
+        }
+    }
+
+    return test_pass();
+}
+
+testing_func(MaterialTest, TestTableDeduplication)
+{
+    // Materials get unique IDs, which the table doesn't compare
+    Material::SharedPtr pA = createSyntheticMaterial(7);
+    Material::SharedPtr pB = createSyntheticMaterial(7);
+    Material::SharedPtr pC = createSyntheticMaterial(7);
+    pC->setLayerAlbedo(0, glm::vec4(0.5f));
+    Material::SharedPtr pD = createSyntheticMaterial(8);
+
+    MaterialTable::SharedPtr pTable = MaterialTable::create();
+    uint32_t indexA = pTable->addMaterial(pA);
+    uint32_t indexB = pTable->addMaterial(pB);
+    uint32_t indexC = pTable->addMaterial(pC);
+    uint32_t indexD = pTable->addMaterial(pD);
+
+    if (indexA != indexB || pTable->getMaterialIndex(pB.get()) != indexA)
+    {
+        return test_fail("Equal materials didn't share an entry");
+    }
+    if (*pA == *pB || pA->equalsData(*pB) == false)
+    {
+        return test_fail("operator== should compare the material ID, equalsData() shouldn't");
+    }
+    if (indexC == indexA || indexD == indexA || indexC == indexD)
+    {
+        return test_fail("Different materials share an entry");
+    }
+    if (pTable->getEntryCount() != 3 || pTable->addMaterial(pA) != indexA)
+    {
+        return test_fail("Wrong number of entries");
+    }
+
+    Material::SharedPtr pOther = createSyntheticMaterial(7);
+    if (pTable->getMaterialIndex(pOther.get()) != MaterialTable::kInvalidIndex)
+    {
+        return test_fail("A material which wasn't added has an entry");
+    }
+
+    // Editing a deduplicated material moves it to its own entry
+    pB->setLayerAlbedo(0, glm::vec4(0.75f));
+    pTable->invalidate();
+    indexA = pTable->getMaterialIndex(pA.get());
+    indexB = pTable->getMaterialIndex(pB.get());
+    if (indexA == indexB || pTable->getEntryCount() != 4)
+    {
+        return test_fail("An edited material still shares its entry");
+    }
+    if (pTable->getEntries()[indexB].values.layers[0].albedo != glm::vec4(0.75f) || pTable->getEntries()[indexA].values.layers[0].albedo != glm::vec4(0.2f))
+    {
+        return test_fail("The edit wasn't packed into the right entry");
+    }
+
+    // Reverting the edit merges the entries again
+    pB->setLayerAlbedo(0, glm::vec4(0.2f));
+    pTable->invalidate();
+    if (pTable->getMaterialIndex(pA.get()) != pTable->getMaterialIndex(pB.get()) || pTable->getEntryCount() != 3)
+    {
+        return test_fail("Equal materials weren't merged after invalidate()");
+    }
+
+    return test_pass();
+}
+
+testing_func(MaterialTest, TestTablePacking)
+{
+    MaterialTable::SharedPtr pTable = MaterialTable::create();
+    std::vector<Material::SharedPtr> materials;
+    for (uint32_t i = 0; i < 100; i++)
+    {
+        materials.push_back(createSyntheticMaterial(i % 10));
+        pTable->addMaterial(materials.back());
+    }
+
+    const auto& entries = pTable->getEntries();
+    if (entries.size() != 10)
+    {
+        return test_fail("Wrong number of packed entries");
+    }
+
+    for (const auto& pMaterial : materials)
+    {
+        const MaterialTableEntry& entry = entries[pTable->getMaterialIndex(pMaterial.get())];
+        const MaterialData& data = pMaterial->getData();
+        if (std::memcmp(&entry.desc, &data.desc, sizeof(MaterialDesc)) != 0 || std::memcmp(&entry.values.layers, &data.values.layers, sizeof(data.values.layers)) != 0)
+        {
+            return test_fail("Packed entry doesn't match the material data");
+        }
+        if (entry.layerTextures[0] != MatInvalidIndex || entry.normalMap != MatInvalidIndex || entry.alphaMap != MatInvalidIndex)
+        {
+            return test_fail("Material without textures has texture indices");
+        }
+        if (entry.samplerIndex != 0)
+        {
+            return test_fail("Materials with the same sampler use different sampler slots");
+        }
+    }
+    if (pTable->getTextures().size() != 0 || pTable->getSamplers().size() != 1)
+    {
+        return test_fail("Wrong number of textures or samplers");
+    }
+
+    // Changes are picked up after invalidate()
+    materials[3]->setLayerAlbedo(1, glm::vec4(0.05f));
+    pTable->invalidate();
+    const MaterialTableEntry& entry = pTable->getEntries()[pTable->getMaterialIndex(materials[3].get())];
+    if (entry.values.layers[1].albedo != glm::vec4(0.05f))
+    {
+        return test_fail("Table wasn't repacked after invalidate()");
+    }
+
+    return test_pass();
+}
+
+int main()
+{
+    MaterialTest mt;
+    // No device. Materials create their parameter block on first use by a renderer, so creating, finalizing and packing them is CPU-only
+    mt.init(false);
+    mt.run();
+    return 0;
+}
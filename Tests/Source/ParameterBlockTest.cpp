@@ -0,0 +1,222 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "ParameterBlockTest.h"
+
+void ParameterBlockTest::addTests()
+{
+    addTestToList<TestBindHandles>();
+    addTestToList<TestBindingBenchmark>();
+    addTestToList<TestFlatReflection>();
+}
+
+static GraphicsProgram::SharedPtr createProgram()
+{
+    return GraphicsProgram::createFromFile("", "BindingTest.ps.hlsl");
+}
+
+static Texture::SharedPtr createTexture()
+{
+    const uint32_t texel = 0xFFFFFFFF;
+    return Texture::create2D(1, 1, ResourceFormat::RGBA8Unorm, 1, 1, &texel);
+}
+
+testing_func(ParameterBlockTest, TestBindHandles)
+{
+    GraphicsProgram::SharedPtr pProgram = createProgram();
+    GraphicsVars::SharedPtr pVars = GraphicsVars::create(pProgram->getActiveVersion()->getReflector());
+    ParameterBlock* pBlock = pVars->getDefaultBlock().get();
+    Texture::SharedPtr pTexture = createTexture();
+    Sampler::SharedPtr pSampler = Sampler::create(Sampler::Desc());
+
+    ParameterBlock::BindHandle albedo = pBlock->getBindHandle("gAlbedo");
+    ParameterBlock::BindHandle layer = pBlock->getBindHandle("gLayers[2]");
+    ParameterBlock::BindHandle data = pBlock->getBindHandle("gData");
+    ParameterBlock::BindHandle sampler = pBlock->getBindHandle("gSampler");
+    ParameterBlock::BindHandle cb = pBlock->getBindHandle("PerDrawCB");
+    if (!albedo.isValid() || !layer.isValid() || !data.isValid() || !sampler.isValid() || !cb.isValid())
+    {
+        return test_fail("Failed to resolve a handle");
+    }
+    if (pBlock->getBindHandle("gMissing").isValid())
+    {
+        return test_fail("Resolved a handle for a variable which doesn't exist");
+    }
+
+    // The handles carry the descriptor type, which is what the setters validate against
+    if (albedo.type != DescriptorSet::Type::TextureSrv || data.type != DescriptorSet::Type::StructuredBufferSrv || sampler.type != DescriptorSet::Type::Sampler || cb.type != DescriptorSet::Type::Cbv)
+    {
+        return test_fail("Handle has the wrong descriptor type");
+    }
+
+    if (pBlock->setTexture(albedo, pTexture) == false || pBlock->getTexture("gAlbedo") != pTexture)
+    {
+        return test_fail("Texture bound through a handle doesn't match the one bound by name");
+    }
+    if (pBlock->setTexture(layer, pTexture) == false || layer.arrayIndex != 2 || pBlock->getSrv(layer.bindLocation, 2) != pTexture->getSRV())
+    {
+        return test_fail("Handle points to the wrong array element");
+    }
+    if (pBlock->setSampler(sampler, pSampler) == false || pBlock->getSampler("gSampler") != pSampler)
+    {
+        return test_fail("Sampler bound through a handle doesn't match the one bound by name");
+    }
+    if (pBlock->getConstantBuffer(cb) == nullptr || pBlock->getConstantBuffer(cb) != pBlock->getConstantBuffer("PerDrawCB"))
+    {
+        return test_fail("Constant buffer fetched through a handle doesn't match the one fetched by name");
+    }
+
+    StructuredBuffer::SharedPtr pBuffer = StructuredBuffer::create(pProgram, "gData", 4);
+    if (pBlock->setStructuredBuffer(data, pBuffer) == false || pBlock->getStructuredBuffer("gData") != pBuffer)
+    {
+        return test_fail("Structured buffer bound through a handle doesn't match the one bound by name");
+    }
+
+    // Setters ignore invalid handles
+    if (pBlock->setTexture(ParameterBlock::BindHandle(), pTexture) || pBlock->getConstantBuffer(ParameterBlock::BindHandle()) != nullptr)
+    {
+        return test_fail("Invalid handle wasn't ignored");
+    }
+
+    return test_pass();
+}
+
+testing_func(ParameterBlockTest, TestBindingBenchmark)
+{
+    GraphicsProgram::SharedPtr pProgram = createProgram();
+    GraphicsVars::SharedPtr pVars = GraphicsVars::create(pProgram->getActiveVersion()->getReflector());
+    ParameterBlock* pBlock = pVars->getDefaultBlock().get();
+    Texture::SharedPtr pTextures[] = { createTexture(), createTexture() };
+    Sampler::SharedPtr pSampler = Sampler::create(Sampler::Desc());
+
+    // Each iteration binds what a typical draw binds: a few textures, a sampler and a constant buffer
+    const uint32_t iterationCount = 100000;
+    const uint32_t bindingsPerIteration = 5;
+
+    CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+    for (uint32_t i = 0; i < iterationCount; i++)
+    {
+        const Texture::SharedPtr& pTexture = pTextures[i & 1];
+        pBlock->setTexture("gAlbedo", pTexture);
+        pBlock->setTexture("gNormal", pTexture);
+        pBlock->setTexture("gLayers[1]", pTexture);
+        pBlock->setSampler("gSampler", pSampler);
+        pBlock->getConstantBuffer("PerDrawCB");
+    }
+    double stringMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    ParameterBlock::BindHandle albedo = pBlock->getBindHandle("gAlbedo");
+    ParameterBlock::BindHandle normal = pBlock->getBindHandle("gNormal");
+    ParameterBlock::BindHandle layer = pBlock->getBindHandle("gLayers[1]");
+    ParameterBlock::BindHandle sampler = pBlock->getBindHandle("gSampler");
+    ParameterBlock::BindHandle cb = pBlock->getBindHandle("PerDrawCB");
+
+    start = CpuTimer::getCurrentTimePoint();
+    for (uint32_t i = 0; i < iterationCount; i++)
+    {
+        const Texture::SharedPtr& pTexture = pTextures[i & 1];
+        pBlock->setTexture(albedo, pTexture);
+        pBlock->setTexture(normal, pTexture);
+        pBlock->setTexture(layer, pTexture);
+        pBlock->setSampler(sampler, pSampler);
+        pBlock->getConstantBuffer(cb);
+    }
+    double handleMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+
+    const double bindingCount = double(iterationCount * bindingsPerIteration);
+    logInfo("Binding rate: " + std::to_string(bindingCount / stringMs) + " string-keyed, " + std::to_string(bindingCount / handleMs) + " handle-keyed bindings per ms");
+
+    // Both loops end with the same texture bound
+    if (pBlock->getTexture("gAlbedo") != pTextures[(iterationCount - 1) & 1])
+    {
+        return test_fail("Handle-keyed binding didn't update the block");
+    }
+
+    return test_pass();
+}
+
+testing_func(ParameterBlockTest, TestFlatReflection)
+{
+    GraphicsProgram::SharedPtr pProgram = createProgram();
+    ProgramReflection::SharedConstPtr pReflector = pProgram->getActiveVersion()->getReflector();
+    const FlatReflection* pFlat = pReflector->getFlatReflection().get();
+    if (pFlat == nullptr)
+    {
+        return test_fail("Reflector doesn't have a flattened copy");
+    }
+
+    // The flattened data should contain the same resources as the reflector
+    uint32_t blockIndex = pFlat->findBlock("");
+    if (blockIndex == FlatReflection::kInvalidIndex || pFlat->getBlock(blockIndex).resourceCount != pReflector->getDefaultParameterBlock()->getResourceVec().size())
+    {
+        return test_fail("Default block doesn't match the reflector");
+    }
+    uint32_t cbIndex = pFlat->findResource(blockIndex, "PerDrawCB");
+    if (cbIndex == FlatReflection::kInvalidIndex)
+    {
+        return test_fail("Can't find the constant buffer");
+    }
+    const FlatReflection::TypeNode& cbType = pFlat->getType(pFlat->getResource(cbIndex).type);
+    uint32_t colorIndex = cbType.child == FlatReflection::kInvalidIndex ? FlatReflection::kInvalidIndex : pFlat->findMember(cbType.child, "gColor");
+    if (colorIndex == FlatReflection::kInvalidIndex || pFlat->getVar(colorIndex).offset != pReflector->getResource("PerDrawCB")->getType()->findMember("gColor")->getOffset())
+    {
+        return test_fail("Constant buffer member doesn't match the reflector");
+    }
+
+    // Serialization round-trip
+    FlatReflection::SharedPtr pCopy = FlatReflection::create(pFlat->getData(), pFlat->getSize());
+    if (pCopy == nullptr || *pCopy != *pFlat || FlatReflection::Hash()(*pCopy) != FlatReflection::Hash()(*pFlat))
+    {
+        return test_fail("Deserialized reflection doesn't match the original");
+    }
+
+    std::vector<uint8_t> corrupt(pFlat->getData(), pFlat->getData() + pFlat->getSize());
+    corrupt.back() ^= 0xFF;
+    if (FlatReflection::create(corrupt.data(), corrupt.size()) != nullptr)
+    {
+        return test_fail("Corrupt data was accepted");
+    }
+
+    // A define which doesn't change the layout should produce a version which shares the reflector
+    Program::DefineList defines;
+    defines.add("_UNUSED_DEFINE");
+    GraphicsProgram::SharedPtr pOther = GraphicsProgram::createFromFile("", "BindingTest.ps.hlsl", defines);
+    if (pOther->getActiveVersion()->getReflector() != pReflector)
+    {
+        return test_fail("Program versions with identical layouts don't share the reflector");
+    }
+
+    return test_pass();
+}
+
+int main()
+{
+    ParameterBlockTest pbt;
+    pbt.init(true);
+    pbt.run();
+    return 0;
+}
@@ -0,0 +1,303 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "ProfilerTest.h"
+#include <fstream>
+#include <thread>
+
+void ProfilerTest::addTests()
+{
+    addTestToList<TestScopeOverhead>();
+    addTestToList<TestMultithreaded>();
+    addTestToList<TestThreadExit>();
+    addTestToList<TestBufferOverflow>();
+    addTestToList<TestTraceCapture>();
+    addTestToList<TestCaptureLongName>();
+}
+
+static void profiledScope()
+{
+    PROFILE(profilerTestScope);
+}
+
+static Profiler::EventData* getTestEvent()
+{
+    return Profiler::getEvent(HashedString("profilerTestScope"));
+}
+
+testing_func(ProfilerTest, TestScopeOverhead)
+{
+    const uint32_t scopesPerFrame = 4096;
+    const uint32_t frameCount = 64;
+    std::string results;
+    Profiler::clearEvents();
+
+    // Measure with the profiler disabled and enabled. The frame size keeps the records within the thread's buffer
+    double nsPerScope[2];
+    for (uint32_t enabled = 0; enabled < 2; enabled++)
+    {
+        gProfileEnabled = (enabled == 1);
+        double totalMs = 0;
+        for (uint32_t frame = 0; frame < frameCount; frame++)
+        {
+            CpuTimer::TimePoint start = CpuTimer::getCurrentTimePoint();
+            for (uint32_t i = 0; i < scopesPerFrame; i++)
+            {
+                profiledScope();
+            }
+            totalMs += CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint());
+            Profiler::endFrame(results);
+        }
+        nsPerScope[enabled] = totalMs * 1000000.0 / (scopesPerFrame * frameCount);
+    }
+    gProfileEnabled = false;
+
+    logInfo("Profiler scope overhead: " + std::to_string(nsPerScope[1]) + "ns enabled, " + std::to_string(nsPerScope[0]) + "ns disabled");
+
+    // A recorded scope reads the clock twice and writes two records. It shouldn't get anywhere near a microsecond, even on a loaded machine
+    const double maxNsPerScope = 1000;
+    if (nsPerScope[1] > maxNsPerScope)
+    {
+        return test_fail("Profiler scope overhead is " + std::to_string(nsPerScope[1]) + "ns, expected less than " + std::to_string(maxNsPerScope) + "ns");
+    }
+
+    if (getTestEvent()->lastFrame.callCount != scopesPerFrame)
+    {
+        return test_fail("Profiler didn't record all the scopes of the last frame");
+    }
+
+    if (Profiler::getDroppedRecordCount() != 0)
+    {
+        return test_fail("Profiler dropped records while the buffer wasn't full");
+    }
+
+    return test_pass();
+}
+
+testing_func(ProfilerTest, TestMultithreaded)
+{
+    const uint32_t scopeCount = 64 * 1024;
+    std::string results;
+    Profiler::clearEvents();
+    uint64_t droppedBefore = Profiler::getDroppedRecordCount();
+
+    gProfileEnabled = true;
+    Threading::parallelFor(scopeCount, 0, [](uint32_t begin, uint32_t end, uint32_t chunkIndex)
+    {
+        for (uint32_t i = begin; i < end; i++)
+        {
+            profiledScope();
+        }
+    });
+    Profiler::endFrame(results);
+    gProfileEnabled = false;
+
+    // Every scope is either recorded or dropped as a whole
+    uint64_t dropped = Profiler::getDroppedRecordCount() - droppedBefore;
+    if (getTestEvent()->lastFrame.callCount + dropped != scopeCount)
+    {
+        return test_fail("Recorded and dropped scopes don't add up to the number of scopes");
+    }
+
+    return test_pass();
+}
+
+testing_func(ProfilerTest, TestThreadExit)
+{
+    const uint32_t scopeCount = 256;
+    std::string results;
+    Profiler::clearEvents();
+
+    // The buffer of a thread which exited is released by endFrame(), after its records were collected
+    gProfileEnabled = true;
+    std::thread thread([]()
+    {
+        for (uint32_t i = 0; i < scopeCount; i++)
+        {
+            profiledScope();
+        }
+    });
+    thread.join();
+    Profiler::endFrame(results);
+    gProfileEnabled = false;
+
+    if (getTestEvent()->lastFrame.callCount != scopeCount)
+    {
+        return test_fail("The scopes recorded by a thread which exited were lost");
+    }
+
+    return test_pass();
+}
+
+testing_func(ProfilerTest, TestBufferOverflow)
+{
+    const uint32_t scopeCount = 64 * 1024;
+    std::string results;
+    Profiler::clearEvents();
+    uint64_t droppedBefore = Profiler::getDroppedRecordCount();
+
+    // Record more scopes than a thread's buffer can hold without calling endFrame()
+    gProfileEnabled = true;
+    {
+        PROFILE(profilerTestOuterScope);
+        for (uint32_t i = 0; i < scopeCount; i++)
+        {
+            profiledScope();
+        }
+    }
+    Profiler::endFrame(results);
+    gProfileEnabled = false;
+
+    uint64_t dropped = Profiler::getDroppedRecordCount() - droppedBefore;
+    if (dropped == 0)
+    {
+        return test_fail("Overflowing the buffer didn't drop any records");
+    }
+
+    // The outer scope began first, so space for its end record was reserved
+    if (Profiler::getEvent(HashedString("profilerTestOuterScope"))->lastFrame.callCount != 1)
+    {
+        return test_fail("An open scope wasn't closed after the buffer overflowed");
+    }
+
+    if (getTestEvent()->lastFrame.callCount + dropped != scopeCount)
+    {
+        return test_fail("Recorded and dropped scopes don't add up to the number of scopes");
+    }
+
+    return test_pass();
+}
+
+testing_func(ProfilerTest, TestTraceCapture)
+{
+    const uint32_t frameCount = 4;
+    const uint32_t scopesPerFrame = 16;
+    const std::string filename = "ProfilerTestTrace.json";
+    std::string results;
+    Profiler::clearEvents();
+
+    gProfileEnabled = true;
+    if (Profiler::startCapture(filename, frameCount) == false)
+    {
+        return test_fail("Failed to start a capture");
+    }
+
+    // Run an extra frame to make sure the capture stops on its own
+    for (uint32_t frame = 0; frame < frameCount + 1; frame++)
+    {
+        Threading::parallelFor(scopesPerFrame, 0, [](uint32_t begin, uint32_t end, uint32_t chunkIndex)
+        {
+            for (uint32_t i = begin; i < end; i++)
+            {
+                profiledScope();
+            }
+        });
+        Profiler::endFrame(results);
+    }
+    gProfileEnabled = false;
+
+    if (Profiler::isCapturing())
+    {
+        return test_fail("Capture didn't end after the requested number of frames");
+    }
+
+    // The file is completed on the thread pool
+    Threading::finish();
+    std::ifstream file(filename);
+    std::string trace((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::remove(filename.c_str());
+
+    const std::string cpuEvent = "\"name\":\"profilerTestScope\",\"cat\":\"cpu\"";
+    size_t eventCount = 0;
+    for (size_t pos = trace.find(cpuEvent); pos != std::string::npos; pos = trace.find(cpuEvent, pos + 1))
+    {
+        eventCount++;
+    }
+
+    if (trace.find("{\"traceEvents\":[") != 0 || trace.find("\"displayTimeUnit\"") == std::string::npos)
+    {
+        return test_fail("Trace file is incomplete");
+    }
+
+    if (eventCount != frameCount * scopesPerFrame)
+    {
+        return test_fail("Trace file doesn't contain all the captured scopes");
+    }
+
+    return test_pass();
+}
+
+testing_func(ProfilerTest, TestCaptureLongName)
+{
+    const std::string filename = "ProfilerTestLongName.json";
+    std::string results;
+    Profiler::clearEvents();
+
+    // Longer than any fixed-size format buffer, with characters which must be escaped
+    std::string name(2000, 'a');
+    name += "\"end\\";
+    Profiler::EventData* pEvent = Profiler::getEvent(HashedString(name));
+
+    // The scope is open when the capture starts, so it begins before the capture
+    gProfileEnabled = true;
+    Profiler::startEvent(pEvent);
+    if (Profiler::startCapture(filename, 1) == false)
+    {
+        gProfileEnabled = false;
+        return test_fail("Failed to start a capture");
+    }
+    Profiler::endEvent(pEvent);
+    Profiler::endFrame(results);
+    gProfileEnabled = false;
+
+    Threading::finish();
+    std::ifstream file(filename);
+    std::string trace((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+    std::remove(filename.c_str());
+
+    if (trace.find("\"name\":\"" + std::string(2000, 'a') + "\\\"end\\\\\",\"cat\":\"cpu\"") == std::string::npos)
+    {
+        return test_fail("The event name wasn't written in full");
+    }
+
+    if (trace.find("\"ts\":-") != std::string::npos)
+    {
+        return test_fail("A scope which began before the capture has a negative timestamp");
+    }
+
+    return test_pass();
+}
+
+int main()
+{
+    ProfilerTest pt;
+    pt.init(false);
+    pt.run();
+    return 0;
+}
@@ -0,0 +1,290 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "SceneChangeSetTest.h"
+#include "Graphics/Scene/SceneChangeSet.h"
+#include "Graphics/Scene/SceneExporter.h"
+#include <cstdio>
+#include <fstream>
+
+void SceneChangeSetTest::addTests()
+{
+    addTestToList<TestMergeRecords>();
+    addTestToList<TestNoMergeAfterJournal>();
+    addTestToList<TestTruncatedJournal>();
+    addTestToList<TestApplyMismatch>();
+    addTestToList<TestFailedReplay>();
+}
+
+static std::string getJournalFilename()
+{
+    return getExecutableDirectory() + "/SceneChangeSetTest" + SceneChangeSet::kJournalExtension;
+}
+
+// A scene with two point lights and one material. Doesn't need a device
+static Scene::SharedPtr createTestScene(const std::string& firstLightName = "Light0")
+{
+    Scene::SharedPtr pScene = Scene::create();
+    PointLight::SharedPtr pLight0 = PointLight::create();
+    pLight0->setName(firstLightName);
+    pScene->addLight(pLight0);
+    PointLight::SharedPtr pLight1 = PointLight::create();
+    pLight1->setName("Light1");
+    pScene->addLight(pLight1);
+    pScene->addMaterial(Material::create("Material0"));
+    return pScene;
+}
+
+static void setIntensity(const Scene::SharedPtr& pScene, uint32_t lightID, const glm::vec3& intensity)
+{
+    std::static_pointer_cast<PointLight>(pScene->getLight(lightID))->setIntensity(intensity);
+}
+
+testing_func(SceneChangeSetTest, TestMergeRecords)
+{
+    Scene::SharedPtr pScene = createTestScene();
+    SceneChangeSet::SharedPtr pChangeSet = SceneChangeSet::create();
+
+    // Consecutive changes to the same light keep a single record holding the last state
+    setIntensity(pScene, 0, glm::vec3(1));
+    pChangeSet->recordLight(pScene.get(), 0);
+    size_t singleRecordSize = pChangeSet->getSize();
+    setIntensity(pScene, 0, glm::vec3(2));
+    pChangeSet->recordLight(pScene.get(), 0);
+    if (pChangeSet->getChangeCount() != 1 || pChangeSet->getSize() != singleRecordSize)
+    {
+        return test_fail("Consecutive changes to the same light were not merged");
+    }
+
+    // A different object, or the same one after another change, starts a new record
+    pChangeSet->recordLight(pScene.get(), 1);
+    pChangeSet->recordLight(pScene.get(), 0);
+    if (pChangeSet->getChangeCount() != 3)
+    {
+        return test_fail("Changes to different lights were merged");
+    }
+
+    // Additions are never merged
+    pChangeSet->recordAddMaterial(pScene.get(), 0);
+    pChangeSet->recordAddMaterial(pScene.get(), 0);
+    if (pChangeSet->getChangeCount() != 5)
+    {
+        return test_fail("Material additions were merged");
+    }
+
+    Scene::SharedPtr pTarget = createTestScene();
+    SceneChangeSet::SharedPtr pMergeOnly = SceneChangeSet::create();
+    pMergeOnly->recordLight(pScene.get(), 0);
+    if (pMergeOnly->apply(pTarget.get()) == false || pTarget->getLight(0)->getData().intensity != glm::vec3(2))
+    {
+        return test_fail("The merged record doesn't hold the last state");
+    }
+    return test_pass();
+}
+
+testing_func(SceneChangeSetTest, TestNoMergeAfterJournal)
+{
+    std::string filename = getJournalFilename();
+    std::remove(filename.c_str());
+
+    Scene::SharedPtr pScene = createTestScene();
+    SceneChangeSet::SharedPtr pChangeSet = SceneChangeSet::create();
+    setIntensity(pScene, 0, glm::vec3(1));
+    pChangeSet->recordLight(pScene.get(), 0);
+    if (pChangeSet->appendToJournal(filename) == false)
+    {
+        return test_fail("Can't write the journal");
+    }
+
+    // The first record is already in the file, so the next change to the same light must not replace it
+    setIntensity(pScene, 0, glm::vec3(3));
+    pChangeSet->recordLight(pScene.get(), 0);
+    if (pChangeSet->getChangeCount() != 2)
+    {
+        return test_fail("A change was merged with a record which was already written to the journal");
+    }
+    pChangeSet->appendToJournal(filename);
+
+    SceneChangeSet::SharedPtr pJournal = SceneChangeSet::loadJournal(filename);
+    std::remove(filename.c_str());
+    if (pJournal == nullptr || pJournal->getChangeCount() != 2 || pJournal->getSize() != pChangeSet->getSize())
+    {
+        return test_fail("The journal doesn't contain both changes");
+    }
+
+    Scene::SharedPtr pTarget = createTestScene();
+    if (pJournal->apply(pTarget.get()) == false || pTarget->getLight(0)->getData().intensity != glm::vec3(3))
+    {
+        return test_fail("Replaying the journal didn't restore the last state");
+    }
+    return test_pass();
+}
+
+testing_func(SceneChangeSetTest, TestTruncatedJournal)
+{
+    std::string filename = getJournalFilename();
+    std::remove(filename.c_str());
+
+    Scene::SharedPtr pScene = createTestScene();
+    SceneChangeSet::SharedPtr pChangeSet = SceneChangeSet::create();
+    setIntensity(pScene, 0, glm::vec3(4));
+    pChangeSet->recordLight(pScene.get(), 0);
+    setIntensity(pScene, 1, glm::vec3(5));
+    pChangeSet->recordLight(pScene.get(), 1);
+    pChangeSet->appendToJournal(filename);
+
+    // Cut the last record short, as a crash while writing the journal would
+    std::vector<char> data;
+    {
+        std::ifstream stream(filename, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+        stream.write(data.data(), data.size() - 3);
+    }
+
+    SceneChangeSet::SharedPtr pJournal = SceneChangeSet::loadJournal(filename);
+    if (pJournal == nullptr || pJournal->getChangeCount() != 1)
+    {
+        std::remove(filename.c_str());
+        return test_fail("The complete records of a truncated journal were not recovered");
+    }
+
+    Scene::SharedPtr pTarget = createTestScene();
+    if (pJournal->apply(pTarget.get()) == false || pTarget->getLight(0)->getData().intensity != glm::vec3(4) || pTarget->getLight(1)->getData().intensity == glm::vec3(5))
+    {
+        std::remove(filename.c_str());
+        return test_fail("Replaying a truncated journal didn't apply exactly the complete records");
+    }
+
+    // New changes are appended after the recovered records
+    setIntensity(pScene, 1, glm::vec3(6));
+    pJournal->recordLight(pScene.get(), 1);
+    pJournal->appendToJournal(filename);
+    pJournal = SceneChangeSet::loadJournal(filename);
+    std::remove(filename.c_str());
+    if (pJournal == nullptr || pJournal->getChangeCount() != 2)
+    {
+        return test_fail("Can't append to a truncated journal");
+    }
+    return test_pass();
+}
+
+testing_func(SceneChangeSetTest, TestApplyMismatch)
+{
+    Scene::SharedPtr pScene = createTestScene();
+    SceneChangeSet::SharedPtr pChangeSet = SceneChangeSet::create();
+    setIntensity(pScene, 0, glm::vec3(7));
+    pChangeSet->recordLight(pScene.get(), 0);
+    setIntensity(pScene, 1, glm::vec3(8));
+    pChangeSet->recordLight(pScene.get(), 1);
+
+    // The first light has a different name, so applying stops at the first change and the second one is dropped
+    Scene::SharedPtr pRenamed = createTestScene("Renamed");
+    if (pChangeSet->apply(pRenamed.get()) || pRenamed->getLight(0)->getData().intensity == glm::vec3(7) || pRenamed->getLight(1)->getData().intensity == glm::vec3(8))
+    {
+        return test_fail("Applying didn't stop on a name mismatch");
+    }
+
+    // The recorded index doesn't exist in a scene with fewer lights
+    Scene::SharedPtr pSmaller = Scene::create();
+    PointLight::SharedPtr pLight = PointLight::create();
+    pLight->setName("Light0");
+    pSmaller->addLight(pLight);
+    SceneChangeSet::SharedPtr pSecondOnly = SceneChangeSet::create();
+    pSecondOnly->recordLight(pScene.get(), 1);
+    pSecondOnly->recordLight(pScene.get(), 0);
+    if (pSecondOnly->apply(pSmaller.get()) || pSmaller->getLight(0)->getData().intensity == glm::vec3(7))
+    {
+        return test_fail("Applying didn't stop on an index mismatch");
+    }
+
+    // An addition must land at the recorded index
+    pScene->addMaterial(Material::create("Material1"));
+    SceneChangeSet::SharedPtr pAddition = SceneChangeSet::create();
+    pAddition->recordAddMaterial(pScene.get(), 1);
+    Scene::SharedPtr pNoMaterials = Scene::create();
+    if (pAddition->apply(pNoMaterials.get()) || pNoMaterials->getMaterialCount() != 0)
+    {
+        return test_fail("A material was added at a different index than the one recorded");
+    }
+
+    // The unmodified scene accepts all the changes
+    Scene::SharedPtr pTarget = createTestScene();
+    if (pChangeSet->apply(pTarget.get()) == false || pTarget->getLight(1)->getData().intensity != glm::vec3(8))
+    {
+        return test_fail("Can't apply the changes to a matching scene");
+    }
+    return test_pass();
+}
+
+testing_func(SceneChangeSetTest, TestFailedReplay)
+{
+    std::string sceneFilename = getExecutableDirectory() + "/SceneChangeSetTest.fscene";
+    std::string journalFilename = SceneChangeSet::getJournalFilename(sceneFilename);
+    std::string failedFilename = journalFilename + ".failed";
+    if (SceneExporter::saveScene(sceneFilename, createTestScene("Renamed")) == false)
+    {
+        return test_fail("Can't save the test scene");
+    }
+
+    // The journal was recorded on a scene with a different light name, so it can't be replayed on the saved file
+    Scene::SharedPtr pRecorded = createTestScene();
+    SceneChangeSet::SharedPtr pChangeSet = SceneChangeSet::create();
+    setIntensity(pRecorded, 0, glm::vec3(2));
+    pChangeSet->recordLight(pRecorded.get(), 0);
+    std::remove(failedFilename.c_str());
+    pChangeSet->appendToJournal(journalFilename);
+
+    Scene::SharedPtr pScene = Scene::loadFromFile(sceneFilename);
+    if (pScene == nullptr || pScene->needsFullExport() == false)
+    {
+        return test_fail("A failed replay didn't require a full export");
+    }
+    if (doesFileExist(journalFilename) || doesFileExist(failedFilename) == false)
+    {
+        return test_fail("The journal which failed to replay wasn't moved out of the way");
+    }
+
+    // A full export brings the scene file up to date again
+    if (SceneExporter::saveScene(sceneFilename, pScene) == false || pScene->needsFullExport())
+    {
+        return test_fail("A full export didn't clear the flag");
+    }
+    std::remove(sceneFilename.c_str());
+    std::remove(failedFilename.c_str());
+    return test_pass();
+}
+
+int main()
+{
+    SceneChangeSetTest scst;
+    scst.init(false);
+    scst.run();
+    return 0;
+}
@@ -0,0 +1,189 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "SceneRendererTest.h"
+#include <set>
+
+void SceneRendererTest::addTests()
+{
+    addTestToList<TestParallelMatchesSerial>();
+}
+
+struct RenderResult
+{
+    int drawCalls = 0;
+    int materialChanges = 0;
+    std::vector<uint8_t> pixels;
+};
+
+static Model::SharedPtr createTriangleModel()
+{
+    // Position, normal, texcoord
+    static const float kVertices[] =
+    {
+        -1, -1, 0,   0, 0, 1,   0, 0,
+         1, -1, 0,   0, 0, 1,   1, 0,
+         0,  1, 0,   0, 0, 1,   0.5f, 1,
+    };
+    static const uint32_t kIndices[] = { 0, 1, 2 };
+
+    SimpleModelImporter::VertexFormat vertLayout;
+    vertLayout.attribs.push_back({ SimpleModelImporter::AttribType::Position, 3, AttribFormat::AttribFormat_F32 });
+    vertLayout.attribs.push_back({ SimpleModelImporter::AttribType::Normal, 3, AttribFormat::AttribFormat_F32 });
+    vertLayout.attribs.push_back({ SimpleModelImporter::AttribType::TexCoord, 2, AttribFormat::AttribFormat_F32 });
+    return SimpleModelImporter::create(vertLayout, sizeof(kVertices), kVertices, sizeof(kIndices), kIndices);
+}
+
+static RenderResult renderScene(SceneRenderer* pRenderer, const GraphicsState::SharedPtr& pState)
+{
+    RenderContext* pContext = gpDevice->getRenderContext().get();
+    GraphicsVars::SharedPtr pVars = GraphicsVars::create(pState->getProgram()->getActiveVersion()->getReflector());
+    pContext->clearFbo(pState->getFbo().get(), glm::vec4(0), 1, 0);
+    pContext->pushGraphicsState(pState);
+    pContext->pushGraphicsVars(pVars);
+
+    gEventCounter.Clear();
+    pRenderer->renderScene(pContext);
+    RenderResult result;
+    result.drawCalls = gEventCounter.numDrawCalls;
+    result.materialChanges = gEventCounter.numMaterialChanges;
+
+    pContext->popGraphicsVars();
+    pContext->popGraphicsState();
+    result.pixels = pContext->readTextureSubresource(pState->getFbo()->getColorTexture(0).get(), 0);
+    return result;
+}
+
+// Count the distinct colors other than the black background
+static size_t countColors(const std::vector<uint8_t>& pixels)
+{
+    std::set<uint32_t> colors;
+    for (size_t i = 0; i + 4 <= pixels.size(); i += 4)
+    {
+        uint32_t color = *(const uint32_t*)&pixels[i];
+        if (color != 0) colors.insert(color);
+    }
+    return colors.size();
+}
+
+testing_func(SceneRendererTest, TestParallelMatchesSerial)
+{
+    const uint32_t kModelCount = 8;
+    const uint32_t kInstancesPerModel = 16;
+
+    // Every model has a single mesh with a single mesh instance, so each visible model instance is one draw and one material change in both renderers.
+    // The instances don't overlap and the camera sees all of them
+    Scene::SharedPtr pScene = Scene::create();
+    Camera::SharedPtr pCamera = Camera::create();
+    pCamera->setPosition(glm::vec3(3.5f, 7.5f, 16));
+    pCamera->setTarget(glm::vec3(3.5f, 7.5f, 0));
+    pCamera->setAspectRatio(1);
+    pCamera->setDepthRange(1, 100);
+    pScene->addCamera(pCamera);
+    for (uint32_t m = 0; m < kModelCount; m++)
+    {
+        // Each model has its own color, so a chunk which binds the wrong material changes the image
+        Model::SharedPtr pModel = createTriangleModel();
+        Material::SharedPtr pMaterial = Material::create("Material" + std::to_string(m));
+        Material::Layer layer;
+        layer.type = Material::Layer::Type::Lambert;
+        layer.albedo = glm::vec4(float(m + 1) / kModelCount, 1 - float(m) / kModelCount, 0.5f, 1);
+        pMaterial->addLayer(layer);
+        pModel->getMesh(0)->setMaterial(pMaterial);
+
+        for (uint32_t i = 0; i < kInstancesPerModel; i++)
+        {
+            glm::vec3 translation(float(m), float(i), 0);
+            pScene->addModelInstance(pModel, "Instance" + std::to_string(i), translation, glm::vec3(0), glm::vec3(0.4f));
+        }
+        // Hidden instances must be skipped by both renderers
+        pScene->getModelInstance(m, m % kInstancesPerModel)->setVisible(false);
+    }
+    const int expectedDraws = int(kModelCount * (kInstancesPerModel - 1));
+
+    Fbo::Desc fboDesc;
+    fboDesc.setColorTarget(0, ResourceFormat::RGBA8Unorm).setDepthStencilTarget(ResourceFormat::D32Float);
+    GraphicsState::SharedPtr pState = GraphicsState::create();
+    pState->setProgram(GraphicsProgram::createFromFile("", "SceneRendererTest.ps.slang"));
+    pState->setFbo(FboHelper::create2D(256, 256, fboDesc));
+
+    SceneRenderer::SharedPtr pSerial = SceneRenderer::create(pScene);
+    pSerial->setObjectCullState(false);
+    RenderResult serial = renderScene(pSerial.get(), pState);
+
+    ParallelSceneRenderer::SharedPtr pParallel = ParallelSceneRenderer::create(pScene);
+    pParallel->setObjectCullState(false);
+    pParallel->setMaxChunkCount(4);
+    pParallel->setMinDrawsPerChunk(1);
+    RenderResult parallel = renderScene(pParallel.get(), pState);
+
+    if (pParallel->getLastChunkCount() < 2)
+    {
+        return test_fail("The parallel renderer fell back to recording on the calling thread");
+    }
+    if (serial.drawCalls != expectedDraws)
+    {
+        return test_fail("SceneRenderer issued " + std::to_string(serial.drawCalls) + " draws, expected " + std::to_string(expectedDraws));
+    }
+    if (parallel.drawCalls != serial.drawCalls)
+    {
+        return test_fail("ParallelSceneRenderer issued " + std::to_string(parallel.drawCalls) + " draws, SceneRenderer issued " + std::to_string(serial.drawCalls));
+    }
+    if (parallel.materialChanges != serial.materialChanges)
+    {
+        return test_fail("The renderers counted a different number of material changes");
+    }
+    if (countColors(serial.pixels) != kModelCount)
+    {
+        return test_fail("SceneRenderer didn't render every model's color");
+    }
+    if (parallel.pixels != serial.pixels)
+    {
+        return test_fail("ParallelSceneRenderer rendered a different image than SceneRenderer");
+    }
+
+    // A second frame reuses the chunk contexts and vars
+    parallel = renderScene(pParallel.get(), pState);
+    if (parallel.drawCalls != serial.drawCalls || parallel.materialChanges != serial.materialChanges)
+    {
+        return test_fail("The counts changed when the chunks were reused");
+    }
+    if (parallel.pixels != serial.pixels)
+    {
+        return test_fail("The image changed when the chunks were reused");
+    }
+
+    return test_pass();
+}
+
+int main()
+{
+    SceneRendererTest srt;
+    srt.init(true);
+    srt.run();
+    return 0;
+}
@@ -0,0 +1,220 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "SceneTest.h"
+
+void SceneTest::addTests()
+{
+    addTestToList<TestDeleteAndReAdd>();
+    addTestToList<TestMerge>();
+    addTestToList<TestSceneDestroyedFirst>();
+    addTestToList<TestInstanceParenting>();
+}
+
+static Model::SharedPtr createTriangleModel()
+{
+    static const float kVertices[] =
+    {
+        -1, -1, 0,
+         1, -1, 0,
+         0,  1, 0,
+    };
+    static const uint32_t kIndices[] = { 0, 1, 2 };
+
+    SimpleModelImporter::VertexFormat vertLayout;
+    vertLayout.attribs.push_back({ SimpleModelImporter::AttribType::Position, 3, AttribFormat::AttribFormat_F32 });
+    return SimpleModelImporter::create(vertLayout, sizeof(kVertices), kVertices, sizeof(kIndices), kIndices);
+}
+
+// The scene's extents must follow a moved instance. This only works if the scene is registered as the instance's observer
+static bool followsInstance(const Scene::SharedPtr& pScene, const Scene::ModelInstance::SharedPtr& pInstance, const glm::vec3& translation)
+{
+    pInstance->setTranslation(translation, false);
+    return glm::length(pScene->getBoundingBox().center - pInstance->getBoundingBox().center) < 1e-4f;
+}
+
+testing_func(SceneTest, TestDeleteAndReAdd)
+{
+    Model::SharedPtr pModel = createTriangleModel();
+    Scene::SharedPtr pScene = Scene::create();
+    pScene->addModelInstance(pModel, "Instance0");
+    pScene->addModelInstance(pModel, "Instance1");
+    Scene::ModelInstance::SharedPtr pInstance0 = pScene->getModelInstance(0, 0);
+    Scene::ModelInstance::SharedPtr pInstance1 = pScene->getModelInstance(0, 1);
+    pScene->getBoundingBox();
+
+    pScene->deleteModelInstance(0, 1);
+    if (pInstance0->getTransformObserverCount() != 1 || pInstance1->getTransformObserverCount() != 0)
+    {
+        return test_fail("Deleting an instance didn't remove only its observer");
+    }
+
+    // The scene holds the last reference to the remaining instance, so deleting the models destroys it
+    pInstance0 = nullptr;
+    pScene->deleteAllModels();
+    if (pScene->getModelCount() != 0 || pInstance1->getTransformObserverCount() != 0)
+    {
+        return test_fail("Deleting all the models left observers behind");
+    }
+
+    pScene->addModelInstance(pInstance1);
+    if (pInstance1->getTransformObserverCount() != 1)
+    {
+        return test_fail("Adding an instance again didn't register the scene");
+    }
+    if (followsInstance(pScene, pInstance1, glm::vec3(5, 0, 0)) == false)
+    {
+        return test_fail("The extents didn't follow an instance which was added again");
+    }
+
+    pScene->deleteModel(0);
+    if (pInstance1->getTransformObserverCount() != 0)
+    {
+        return test_fail("Deleting a model left an observer behind");
+    }
+    return test_pass();
+}
+
+testing_func(SceneTest, TestMerge)
+{
+    Model::SharedPtr pModel = createTriangleModel();
+    Scene::SharedPtr pSource = Scene::create();
+    pSource->addModelInstance(pModel, "Instance0");
+    Scene::ModelInstance::SharedPtr pInstance = pSource->getModelInstance(0, 0);
+
+    // Both scenes hold the instance, and both extents follow it
+    Scene::SharedPtr pTarget = Scene::create();
+    pTarget->merge(pSource.get());
+    pTarget->getBoundingBox();
+    if (pInstance->getTransformObserverCount() != 2)
+    {
+        return test_fail("The merged scene didn't register as an observer");
+    }
+    if (followsInstance(pSource, pInstance, glm::vec3(0, 3, 0)) == false || followsInstance(pTarget, pInstance, glm::vec3(0, -2, 0)) == false)
+    {
+        return test_fail("The extents didn't follow an instance shared by two scenes");
+    }
+
+    // Rebuilding the extents after another merge must not register the scene twice
+    pTarget->merge(Scene::create().get());
+    pTarget->getBoundingBox();
+    if (pInstance->getTransformObserverCount() != 2)
+    {
+        return test_fail("Rebuilding the extents registered the scene twice");
+    }
+    return test_pass();
+}
+
+testing_func(SceneTest, TestSceneDestroyedFirst)
+{
+    Model::SharedPtr pModel = createTriangleModel();
+    Scene::SharedPtr pScene = Scene::create();
+    pScene->addModelInstance(pModel, "Instance0");
+    Scene::ModelInstance::SharedPtr pInstance = pScene->getModelInstance(0, 0);
+    Scene::SharedPtr pOther = Scene::create();
+    pOther->addModelInstance(pInstance);
+
+    // The instance outlives the scene. Moving it afterwards must only notify the remaining scene
+    pScene = nullptr;
+    if (pInstance->getTransformObserverCount() != 1)
+    {
+        return test_fail("A destroyed scene is still registered as an observer");
+    }
+    if (followsInstance(pOther, pInstance, glm::vec3(1, 2, 3)) == false)
+    {
+        return test_fail("The remaining scene's extents didn't follow the instance");
+    }
+    pOther = nullptr;
+    if (pInstance->getTransformObserverCount() != 0)
+    {
+        return test_fail("A destroyed scene is still registered as an observer");
+    }
+    pInstance->setTranslation(glm::vec3(0), false);
+    return test_pass();
+}
+
+static bool isAt(const glm::mat4& transform, const glm::vec3& translation)
+{
+    return glm::length(glm::vec3(transform[3]) - translation) < 1e-4f;
+}
+
+testing_func(SceneTest, TestInstanceParenting)
+{
+    Model::SharedPtr pModel = createTriangleModel();
+    Scene::SharedPtr pScene = Scene::create();
+    pScene->addModelInstance(pModel, "Parent", glm::vec3(1, 0, 0));
+    pScene->addModelInstance(pModel, "Child", glm::vec3(0, 2, 0));
+    Scene::ModelInstance::SharedPtr pParent = pScene->getModelInstance(0, 0);
+    Scene::ModelInstance::SharedPtr pChild = pScene->getModelInstance(0, 1);
+
+    if (pScene->setModelInstanceParent(pChild, pParent) == false || pScene->getModelInstanceParent(pChild) != pParent)
+    {
+        return test_fail("Can't attach an instance");
+    }
+    if (pScene->setModelInstanceParent(pParent, pChild))
+    {
+        return test_fail("Attaching an instance to its own child should fail");
+    }
+    pScene->update(0);
+    if (isAt(pChild->getTransformMatrix(), glm::vec3(1, 2, 0)) == false || isAt(pChild->getLocalTransformMatrix(), glm::vec3(0, 2, 0)) == false)
+    {
+        return test_fail("The child doesn't include the parent's transform");
+    }
+
+    // The child follows the parent, and keeps last frame's position as its previous transform until the parent stops
+    pParent->setTranslation(glm::vec3(3, 0, 0), true);
+    if (pScene->update(0) == false || isAt(pChild->getTransformMatrix(), glm::vec3(3, 2, 0)) == false || isAt(pChild->getPrevTransformMatrix(), glm::vec3(1, 2, 0)) == false)
+    {
+        return test_fail("The child didn't follow the parent");
+    }
+    pScene->update(0);
+    if (isAt(pChild->getPrevTransformMatrix(), glm::vec3(3, 2, 0)) == false)
+    {
+        return test_fail("The child's previous transform didn't catch up");
+    }
+    if (glm::length(pScene->getBoundingBox().center - (pParent->getBoundingBox().center + pChild->getBoundingBox().center) * 0.5f) > 1e-4f)
+    {
+        return test_fail("The extents didn't follow the child");
+    }
+
+    // Deleting the parent detaches the child, which falls back to its own transform
+    pScene->deleteModelInstance(0, 0);
+    if (pScene->getModelInstanceParent(pChild) != nullptr || isAt(pChild->getTransformMatrix(), glm::vec3(0, 2, 0)) == false)
+    {
+        return test_fail("Deleting the parent didn't detach the child");
+    }
+    return test_pass();
+}
+
+int main()
+{
+    SceneTest st;
+    // Models create their vertex buffers on the device
+    st.init(true);
+    st.run();
+    return 0;
+}
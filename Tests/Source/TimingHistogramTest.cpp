@@ -0,0 +1,134 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "TimingHistogramTest.h"
+#include <algorithm>
+#include <random>
+
+void TimingHistogramTest::addTests()
+{
+    addTestToList<TestPercentiles>();
+    addTestToList<TestWindow>();
+    addTestToList<TestHitches>();
+}
+
+static bool isWithinPrecision(float value, float expected)
+{
+    // Each bucket covers 1/kSubBucketCount of its power-of-two range
+    return std::abs(value - expected) <= expected * 2.0f / TimingHistogram::kSubBucketCount;
+}
+
+static float getExactPercentile(std::vector<float> samples, float percentile)
+{
+    std::sort(samples.begin(), samples.end());
+    size_t rank = (size_t)std::ceil(percentile / 100.0 * samples.size());
+    return samples[std::max(rank, size_t(1)) - 1];
+}
+
+testing_func(TimingHistogramTest, TestPercentiles)
+{
+    // Frame-time like distribution, with a long tail
+    std::mt19937 rng(1);
+    std::lognormal_distribution<float> distribution(2.5f, 0.4f);
+    std::vector<float> samples(100000);
+    TimingHistogram histogram;
+    for (float& s : samples)
+    {
+        s = distribution(rng);
+        histogram.record(s);
+    }
+
+    TimingHistogram::Stats stats = histogram.getStats();
+    if (stats.count != samples.size())
+    {
+        return test_fail("Histogram count doesn't match the number of samples");
+    }
+
+    if (!isWithinPrecision(stats.p50, getExactPercentile(samples, 50)) || !isWithinPrecision(stats.p95, getExactPercentile(samples, 95)) || !isWithinPrecision(stats.p99, getExactPercentile(samples, 99)))
+    {
+        return test_fail("Histogram percentiles are not within the expected precision");
+    }
+
+    if (stats.max != *std::max_element(samples.begin(), samples.end()))
+    {
+        return test_fail("Histogram max doesn't match the largest sample");
+    }
+
+    return test_pass();
+}
+
+testing_func(TimingHistogramTest, TestWindow)
+{
+    const uint32_t windowSize = 100;
+    TimingHistogram histogram(windowSize);
+
+    // A slow period followed by a fast one. Once the window moves past the slow period, it should no longer affect the results
+    for (uint32_t i = 0; i < windowSize; i++) histogram.record(50.0f);
+    for (uint32_t i = 0; i < windowSize; i++) histogram.record(10.0f);
+
+    TimingHistogram::Stats stats = histogram.getStats();
+    if (stats.count != windowSize)
+    {
+        return test_fail("Window contains the wrong number of samples");
+    }
+
+    if (!isWithinPrecision(stats.p99, 10.0f) || !isWithinPrecision(stats.max, 10.0f))
+    {
+        return test_fail("Samples which left the window still affect the results");
+    }
+
+    return test_pass();
+}
+
+testing_func(TimingHistogramTest, TestHitches)
+{
+    TimingHistogram histogram(10, 33.3f);
+    const float frameTimes[] = { 16.6f, 16.7f, 50.0f, 16.6f, 100.0f, 16.6f };
+    for (float t : frameTimes) histogram.record(t);
+
+    if (histogram.getStats().hitchCount != 2)
+    {
+        return test_fail("Wrong number of hitches");
+    }
+
+    // Push the hitches out of the window
+    for (uint32_t i = 0; i < 10; i++) histogram.record(16.6f);
+    if (histogram.getStats().hitchCount != 0)
+    {
+        return test_fail("Hitches which left the window are still counted");
+    }
+
+    return test_pass();
+}
+
+int main()
+{
+    TimingHistogramTest tht;
+    tht.init(false);
+    tht.run();
+    return 0;
+}
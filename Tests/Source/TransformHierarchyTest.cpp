@@ -0,0 +1,193 @@
+/***************************************************************************
+# Copyright (c) 2017, NVIDIA CORPORATION. All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#  * Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+#  * Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in the
+#    documentation and/or other materials provided with the distribution.
+#  * Neither the name of NVIDIA CORPORATION nor the names of its
+#    contributors may be used to endorse or promote products derived
+#    from this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+# PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+# OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+***************************************************************************/
+#include "TransformHierarchyTest.h"
+
+void TransformHierarchyTest::addTests()
+{
+    addTestToList<TestPropagation>();
+    addTestToList<TestPrevWorldMatrix>();
+    addTestToList<TestSetParent>();
+    addTestToList<TestUpdateBenchmark>();
+}
+
+static glm::mat4 translation(float x)
+{
+    return glm::translate(glm::mat4(), glm::vec3(x, 0, 0));
+}
+
+static float getTranslation(const glm::mat4& m)
+{
+    return m[3].x;
+}
+
+testing_func(TransformHierarchyTest, TestPropagation)
+{
+    TransformHierarchy::SharedPtr pHierarchy = TransformHierarchy::create();
+    uint32_t root = pHierarchy->addNode(TransformHierarchy::kInvalidNode, translation(1));
+    uint32_t child = pHierarchy->addNode(root, translation(2));
+    uint32_t grandChild = pHierarchy->addNode(child, translation(3));
+    uint32_t sibling = pHierarchy->addNode(root, translation(4));
+
+    if (pHierarchy->update() != 4 || pHierarchy->getLevelCount() != 3)
+    {
+        return test_fail("Initial update didn't process all the nodes");
+    }
+    if (getTranslation(pHierarchy->getWorldMatrix(grandChild)) != 6 || getTranslation(pHierarchy->getWorldMatrix(sibling)) != 5)
+    {
+        return test_fail("Wrong world matrix");
+    }
+
+    // Changing a node should only update its subtree
+    pHierarchy->setLocalMatrix(child, translation(10));
+    if (pHierarchy->update() != 2)
+    {
+        return test_fail("Update touched nodes outside the dirty subtree");
+    }
+    if (getTranslation(pHierarchy->getWorldMatrix(grandChild)) != 14 || getTranslation(pHierarchy->getWorldMatrix(sibling)) != 5)
+    {
+        return test_fail("Wrong world matrix after changing a local matrix");
+    }
+
+    if (pHierarchy->update() != 0)
+    {
+        return test_fail("Update without changes recomputed world matrices");
+    }
+
+    return test_pass();
+}
+
+testing_func(TransformHierarchyTest, TestPrevWorldMatrix)
+{
+    TransformHierarchy::SharedPtr pHierarchy = TransformHierarchy::create();
+    uint32_t root = pHierarchy->addNode(TransformHierarchy::kInvalidNode, translation(1));
+    uint32_t child = pHierarchy->addNode(root, translation(1));
+    pHierarchy->update();
+
+    // New nodes don't have a history
+    if (pHierarchy->getPrevWorldMatrix(child) != pHierarchy->getWorldMatrix(child))
+    {
+        return test_fail("New node has a different previous matrix");
+    }
+
+    pHierarchy->setLocalMatrix(root, translation(5));
+    pHierarchy->update();
+    if (getTranslation(pHierarchy->getPrevWorldMatrix(child)) != 2 || getTranslation(pHierarchy->getWorldMatrix(child)) != 6)
+    {
+        return test_fail("Previous matrix doesn't hold the last frame's transform");
+    }
+
+    // Once the node stops moving, the previous matrix should catch up
+    pHierarchy->update();
+    if (pHierarchy->getPrevWorldMatrix(child) != pHierarchy->getWorldMatrix(child))
+    {
+        return test_fail("Previous matrix of a static node wasn't updated");
+    }
+
+    return test_pass();
+}
+
+testing_func(TransformHierarchyTest, TestSetParent)
+{
+    TransformHierarchy::SharedPtr pHierarchy = TransformHierarchy::create();
+    uint32_t a = pHierarchy->addNode(TransformHierarchy::kInvalidNode, translation(1));
+    uint32_t b = pHierarchy->addNode(a, translation(2));
+    uint32_t c = pHierarchy->addNode(TransformHierarchy::kInvalidNode, translation(100));
+    pHierarchy->update();
+
+    if (pHierarchy->setParent(a, b))
+    {
+        return test_fail("setParent() accepted a cycle");
+    }
+
+    // Moving 'a' under 'c' makes the hierarchy deeper, so the nodes have to be reordered
+    if (pHierarchy->setParent(a, c) == false)
+    {
+        return test_fail("setParent() failed");
+    }
+    pHierarchy->update();
+    if (pHierarchy->getLevelCount() != 3 || pHierarchy->getParent(a) != c || getTranslation(pHierarchy->getWorldMatrix(b)) != 103)
+    {
+        return test_fail("Wrong world matrix after re-parenting");
+    }
+
+    return test_pass();
+}
+
+testing_func(TransformHierarchyTest, TestUpdateBenchmark)
+{
+    // A wide, 8-ary tree with 1M nodes
+    const uint32_t nodeCount = 1000000;
+    const uint32_t frameCount = 10;
+    TransformHierarchy::SharedPtr pHierarchy = TransformHierarchy::create();
+    uint32_t root = pHierarchy->addNode(TransformHierarchy::kInvalidNode);
+    for (uint32_t i = 1; i < nodeCount; i++)
+    {
+        pHierarchy->addNode((i - 1) / 8, translation(1));
+    }
+    pHierarchy->update();
+
+    // Moving the root dirties the entire hierarchy
+    auto start = CpuTimer::getCurrentTimePoint();
+    for (uint32_t f = 0; f < frameCount; f++)
+    {
+        pHierarchy->setLocalMatrix(root, translation((float)f));
+        if (pHierarchy->update() != nodeCount)
+        {
+            return test_fail("Moving the root didn't update all the nodes");
+        }
+    }
+    double fullMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) / frameCount;
+
+    // Moving a single leaf
+    start = CpuTimer::getCurrentTimePoint();
+    for (uint32_t f = 0; f < frameCount; f++)
+    {
+        pHierarchy->setLocalMatrix(nodeCount - 1, translation((float)f));
+        pHierarchy->update();
+    }
+    double leafMs = CpuTimer::calcDuration(start, CpuTimer::getCurrentTimePoint()) / frameCount;
+
+    logInfo("1M nodes, " + std::to_string(pHierarchy->getLevelCount()) + " levels: full update " + std::to_string(fullMs) + " ms, single leaf " + std::to_string(leafMs) + " ms");
+
+    // The last root translation was frameCount - 1 and every level below it adds 1
+    float expected = (float)(frameCount - 1) + (pHierarchy->getLevelCount() - 1);
+    if (getTranslation(pHierarchy->getWorldMatrix(nodeCount - 2)) != expected)
+    {
+        return test_fail("Wrong world matrix");
+    }
+
+    return test_pass();
+}
+
+int main()
+{
+    TransformHierarchyTest tht;
+    tht.init(false);
+    tht.run();
+    return 0;
+}